@@ -0,0 +1,694 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include "SimdSupport.h"
+
+namespace {
+
+// 葉に入れる物体の最大数
+constexpr uint32_t kMaxLeafSize = 4;
+// SAHで調べる分割候補の数
+constexpr uint32_t kBinCount = 16;
+// これより深い二分木は数で半分に分ける(探索のスタックをあふれさせない)
+constexpr uint32_t kMedianSplitDepth = 40;
+// 探索のスタックの大きさ(4分岐の深さ * 3 + 1 より大きくする)
+constexpr uint32_t kMaxStackSize = 256;
+// クエリのスタックで、子孫がすべて視錐台の内側にあることを表す印
+constexpr uint32_t kInsideFlag = 0x80000000u;
+
+/// <summary>
+/// 作成中の物体(中心で分割先を決める)
+/// </summary>
+struct BuildPrimitive {
+	BoundingBox bounds;
+	float centroid[3];
+	uint32_t index;
+};
+
+BoundingBox MakeEmptyBox() {
+	const float inf = std::numeric_limits<float>::infinity();
+	return { { inf, inf, inf }, { -inf, -inf, -inf } };
+}
+
+void Grow(BoundingBox& box, const BoundingBox& other) {
+	box.min.x = std::min<float>(box.min.x, other.min.x);
+	box.min.y = std::min<float>(box.min.y, other.min.y);
+	box.min.z = std::min<float>(box.min.z, other.min.z);
+	box.max.x = std::max<float>(box.max.x, other.max.x);
+	box.max.y = std::max<float>(box.max.y, other.max.y);
+	box.max.z = std::max<float>(box.max.z, other.max.z);
+}
+
+void GrowPoint(BoundingBox& box, const float point[3]) {
+	box.min.x = std::min<float>(box.min.x, point[0]);
+	box.min.y = std::min<float>(box.min.y, point[1]);
+	box.min.z = std::min<float>(box.min.z, point[2]);
+	box.max.x = std::max<float>(box.max.x, point[0]);
+	box.max.y = std::max<float>(box.max.y, point[1]);
+	box.max.z = std::max<float>(box.max.z, point[2]);
+}
+
+/// <summary>
+/// 表面積の半分(SAHでは比だけ使う)
+/// </summary>
+float HalfArea(const BoundingBox& box) {
+	const float x = box.max.x - box.min.x;
+	const float y = box.max.y - box.min.y;
+	const float z = box.max.z - box.min.z;
+	if (x < 0.0f || y < 0.0f || z < 0.0f) {
+		return 0.0f;
+	}
+	return x * y + y * z + z * x;
+}
+
+/// <summary>
+/// 分割先の候補に入る物体の箱(4つ目の要素は使わない)
+/// </summary>
+struct alignas(16) Bin {
+	float min[4];
+	float max[4];
+};
+
+void ClearBin(Bin& bin) {
+	const float inf = std::numeric_limits<float>::infinity();
+	for (int i = 0; i < 4; i++) {
+		bin.min[i] = inf;
+		bin.max[i] = -inf;
+	}
+}
+
+/// <summary>
+/// 物体の箱で広げる(BuildPrimitiveは箱の後ろに中心があるので4要素ずつ読んでよい)
+/// </summary>
+void GrowBin(Bin& bin, const BuildPrimitive& primitive) {
+#if SIMD_X86
+	_mm_store_ps(bin.min, _mm_min_ps(_mm_load_ps(bin.min), _mm_loadu_ps(&primitive.bounds.min.x)));
+	_mm_store_ps(bin.max, _mm_max_ps(_mm_load_ps(bin.max), _mm_loadu_ps(&primitive.bounds.max.x)));
+#else
+	const BoundingBox& box = primitive.bounds;
+	bin.min[0] = std::min<float>(bin.min[0], box.min.x);
+	bin.min[1] = std::min<float>(bin.min[1], box.min.y);
+	bin.min[2] = std::min<float>(bin.min[2], box.min.z);
+	bin.max[0] = std::max<float>(bin.max[0], box.max.x);
+	bin.max[1] = std::max<float>(bin.max[1], box.max.y);
+	bin.max[2] = std::max<float>(bin.max[2], box.max.z);
+#endif
+}
+
+void GrowBin(Bin& bin, const Bin& other) {
+	for (int i = 0; i < 3; i++) {
+		bin.min[i] = std::min<float>(bin.min[i], other.min[i]);
+		bin.max[i] = std::max<float>(bin.max[i], other.max[i]);
+	}
+}
+
+BoundingBox ToBox(const Bin& bin) {
+	return { { bin.min[0], bin.min[1], bin.min[2] }, { bin.max[0], bin.max[1], bin.max[2] } };
+}
+
+/// <summary>
+/// 視錐台の平面をSoAにしたもの
+/// </summary>
+struct FrustumPlanes {
+	float normalX[6];
+	float normalY[6];
+	float normalZ[6];
+	float distance[6];
+	float absNormalX[6];
+	float absNormalY[6];
+	float absNormalZ[6];
+};
+
+FrustumPlanes MakeFrustumPlanes(const Frustum& frustum) {
+	FrustumPlanes planes;
+	for (int i = 0; i < 6; i++) {
+		const Plane& plane = frustum.planes[i];
+		planes.normalX[i] = plane.normal.x;
+		planes.normalY[i] = plane.normal.y;
+		planes.normalZ[i] = plane.normal.z;
+		planes.distance[i] = plane.distance;
+		planes.absNormalX[i] = std::fabs(plane.normal.x);
+		planes.absNormalY[i] = std::fabs(plane.normal.y);
+		planes.absNormalZ[i] = std::fabs(plane.normal.z);
+	}
+	return planes;
+}
+
+/// <summary>
+/// 物体1つの視錐台判定(CullBoxesのスカラー版と同じ式にして結果を揃える)
+/// </summary>
+bool IsBoxVisible(const FrustumPlanes& planes, const BoundingBox& box) {
+	const float centerX = (box.min.x + box.max.x) * 0.5f, extentX = (box.max.x - box.min.x) * 0.5f;
+	const float centerY = (box.min.y + box.max.y) * 0.5f, extentY = (box.max.y - box.min.y) * 0.5f;
+	const float centerZ = (box.min.z + box.max.z) * 0.5f, extentZ = (box.max.z - box.min.z) * 0.5f;
+	for (int i = 0; i < 6; i++) {
+		const float d = planes.normalX[i] * centerX + planes.normalY[i] * centerY + planes.normalZ[i] * centerZ + planes.distance[i] +
+			planes.absNormalX[i] * extentX + planes.absNormalY[i] * extentY + planes.absNormalZ[i] * extentZ;
+		if (d < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsBoxOverlapped(const BoundingBox& a, const BoundingBox& b) {
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+		a.min.y <= b.max.y && a.max.y >= b.min.y &&
+		a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+/// <summary>
+/// 半直線と箱の交差(スラブ法)。当たれば入る距離を返す
+/// </summary>
+bool IntersectRayBox(const Vector3& origin, const Vector3& inverseDirection, const BoundingBox& box, float maxDistance, float& distance) {
+	const float x1 = (box.min.x - origin.x) * inverseDirection.x, x2 = (box.max.x - origin.x) * inverseDirection.x;
+	const float y1 = (box.min.y - origin.y) * inverseDirection.y, y2 = (box.max.y - origin.y) * inverseDirection.y;
+	const float z1 = (box.min.z - origin.z) * inverseDirection.z, z2 = (box.max.z - origin.z) * inverseDirection.z;
+	const float tNear = std::max<float>(std::max<float>(std::min<float>(x1, x2), std::min<float>(y1, y2)), std::max<float>(std::min<float>(z1, z2), 0.0f));
+	const float tFar = std::min<float>(std::min<float>(std::max<float>(x1, x2), std::max<float>(y1, y2)), std::min<float>(std::max<float>(z1, z2), maxDistance));
+	distance = tNear;
+	return tNear <= tFar;
+}
+
+/// <summary>
+/// 0の成分を小さな値にして逆数を取る(0 * 無限大でNaNが出ないように)
+/// </summary>
+float SafeInverse(float value) {
+	constexpr float kMinimum = 1e-20f;
+	return 1.0f / (std::fabs(value) < kMinimum ? std::copysign(kMinimum, value) : value);
+}
+
+} // namespace
+
+/// <summary>
+/// 作成中の二分木のノード
+/// </summary>
+struct BoundingVolumeHierarchy::BinaryNode {
+	BoundingBox bounds;
+	uint32_t left; // 葉ならkEmptyChild
+	uint32_t right;
+	uint32_t first;
+	uint32_t count;
+};
+
+/// <summary>
+/// 物体の箱から木を作る
+/// 中心の範囲を軸ごとにkBinCount個に区切り、表面積 * 物体数の和が最小になる所で分ける
+/// </summary>
+/// <param name="bounds">物体の箱</param>
+/// <param name="count">物体数</param>
+void BoundingVolumeHierarchy::Build(const BoundingBox* bounds, size_t count) {
+	assert(count < kInsideFlag);
+	nodes_.clear();
+	primitiveIndices_.clear();
+	primitiveBounds_.clear();
+	depth_ = 0;
+	if (count == 0) {
+		return;
+	}
+
+	std::vector<BuildPrimitive> primitives(count);
+	BoundingBox rootBounds = MakeEmptyBox();
+	BoundingBox rootCentroidBounds = MakeEmptyBox();
+	for (size_t i = 0; i < count; ++i) {
+		const BoundingBox& box = bounds[i];
+		BuildPrimitive& primitive = primitives[i];
+		primitive.bounds = box;
+		primitive.centroid[0] = (box.min.x + box.max.x) * 0.5f;
+		primitive.centroid[1] = (box.min.y + box.max.y) * 0.5f;
+		primitive.centroid[2] = (box.min.z + box.max.z) * 0.5f;
+		primitive.index = uint32_t(i);
+		Grow(rootBounds, box);
+		GrowPoint(rootCentroidBounds, primitive.centroid);
+	}
+
+	// 二分木を作る(子の範囲はprimitivesの連続した区間になる)
+	// 子の箱は分割先の候補から、中心の範囲は並べ替えながら求めて渡す
+	struct Task {
+		uint32_t node;
+		uint32_t first;
+		uint32_t count;
+		uint32_t depth;
+		BoundingBox centroidBounds;
+	};
+	std::vector<BinaryNode> binaryNodes;
+	binaryNodes.reserve(count * 2);
+	binaryNodes.push_back({ rootBounds, kEmptyChild, kEmptyChild, 0, uint32_t(count) });
+	std::vector<Task> tasks;
+	tasks.push_back({ 0, 0, uint32_t(count), 0, rootCentroidBounds });
+	while (!tasks.empty()) {
+		const Task task = tasks.back();
+		tasks.pop_back();
+		// 4分岐の子1つに収まる数なら葉にする(二分木で分けても4分岐にまとめると同じノードに戻る)
+		if (task.count <= kMaxLeafSize) {
+			binaryNodes[task.node].first = task.first;
+			binaryNodes[task.node].count = task.count;
+			continue;
+		}
+		const float centroidMinimums[3] = { task.centroidBounds.min.x, task.centroidBounds.min.y, task.centroidBounds.min.z };
+		const float centroidExtents[3] = {
+			task.centroidBounds.max.x - task.centroidBounds.min.x,
+			task.centroidBounds.max.y - task.centroidBounds.min.y,
+			task.centroidBounds.max.z - task.centroidBounds.min.z };
+
+		// 分割先の候補を数える
+		uint32_t bestAxis = 0;
+		uint32_t bestSplit = 0;
+		float bestCost = std::numeric_limits<float>::infinity();
+		const bool isMedianSplit = task.depth >= kMedianSplitDepth;
+		// 小さなノードは候補を減らす(区切りを調べる手間が物体の数を上回らないように)
+		const uint32_t binCount = std::min<uint32_t>(kBinCount, task.count);
+		Bin binBounds[3][kBinCount];
+		uint32_t binCounts[3][kBinCount] = {};
+		float binScales[3] = {};
+		if (!isMedianSplit && task.count > 1) {
+			for (uint32_t axis = 0; axis < 3; ++axis) {
+				binScales[axis] = centroidExtents[axis] > 0.0f ? float(binCount) * 0.9999f / centroidExtents[axis] : 0.0f;
+				for (uint32_t bin = 0; bin < binCount; ++bin) {
+					ClearBin(binBounds[axis][bin]);
+				}
+			}
+			for (uint32_t i = task.first; i < task.first + task.count; ++i) {
+				const BuildPrimitive& primitive = primitives[i];
+				for (uint32_t axis = 0; axis < 3; ++axis) {
+					const uint32_t bin = std::min<uint32_t>(uint32_t((primitive.centroid[axis] - centroidMinimums[axis]) * binScales[axis]), binCount - 1);
+					GrowBin(binBounds[axis][bin], primitive);
+					++binCounts[axis][bin];
+				}
+			}
+			for (uint32_t axis = 0; axis < 3; ++axis) {
+				if (binScales[axis] == 0.0f) {
+					continue;
+				}
+				// 右から累積した面積と数
+				float rightAreas[kBinCount];
+				uint32_t rightCounts[kBinCount];
+				Bin right;
+				ClearBin(right);
+				uint32_t rightCount = 0;
+				for (uint32_t bin = binCount - 1; bin > 0; --bin) {
+					GrowBin(right, binBounds[axis][bin]);
+					rightCount += binCounts[axis][bin];
+					rightAreas[bin] = HalfArea(ToBox(right));
+					rightCounts[bin] = rightCount;
+				}
+				Bin left;
+				ClearBin(left);
+				uint32_t leftCount = 0;
+				for (uint32_t split = 1; split < binCount; ++split) {
+					GrowBin(left, binBounds[axis][split - 1]);
+					leftCount += binCounts[axis][split - 1];
+					if (leftCount == 0 || rightCounts[split] == 0) {
+						continue;
+					}
+					const float cost = HalfArea(ToBox(left)) * float(leftCount) + rightAreas[split] * float(rightCounts[split]);
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+		}
+
+		BoundingBox leftBounds = MakeEmptyBox(), rightBounds = MakeEmptyBox();
+		BoundingBox leftCentroidBounds = MakeEmptyBox(), rightCentroidBounds = MakeEmptyBox();
+		uint32_t leftCount = 0;
+		if (bestCost < std::numeric_limits<float>::infinity()) {
+			for (uint32_t bin = 0; bin < binCount; ++bin) {
+				Grow(bin < bestSplit ? leftBounds : rightBounds, ToBox(binBounds[bestAxis][bin]));
+			}
+			// 左右に分けながら中心の範囲を求める
+			const float minimum = centroidMinimums[bestAxis];
+			const float scale = binScales[bestAxis];
+			auto isLeft = [&](const BuildPrimitive& primitive) {
+				return std::min<uint32_t>(uint32_t((primitive.centroid[bestAxis] - minimum) * scale), binCount - 1) < bestSplit;
+			};
+			uint32_t begin = task.first;
+			uint32_t end = task.first + task.count;
+			for (;;) {
+				while (begin < end && isLeft(primitives[begin])) {
+					GrowPoint(leftCentroidBounds, primitives[begin++].centroid);
+				}
+				while (begin < end && !isLeft(primitives[end - 1])) {
+					GrowPoint(rightCentroidBounds, primitives[--end].centroid);
+				}
+				if (begin >= end) {
+					break;
+				}
+				std::swap(primitives[begin], primitives[end - 1]);
+			}
+			leftCount = begin - task.first;
+		} else {
+			// 中心が重なっている、または深すぎるときは一番長い軸で数を半分に分ける
+			const uint32_t axis = centroidExtents[0] >= centroidExtents[1] && centroidExtents[0] >= centroidExtents[2] ? 0 :
+				(centroidExtents[1] >= centroidExtents[2] ? 1 : 2);
+			leftCount = task.count / 2;
+			BuildPrimitive* begin = primitives.data() + task.first;
+			std::nth_element(begin, begin + leftCount, begin + task.count, [axis](const BuildPrimitive& a, const BuildPrimitive& b) {
+				return a.centroid[axis] < b.centroid[axis];
+			});
+			for (uint32_t i = 0; i < task.count; ++i) {
+				Grow(i < leftCount ? leftBounds : rightBounds, begin[i].bounds);
+				GrowPoint(i < leftCount ? leftCentroidBounds : rightCentroidBounds, begin[i].centroid);
+			}
+		}
+		const uint32_t left = uint32_t(binaryNodes.size());
+		binaryNodes.push_back({ leftBounds, kEmptyChild, kEmptyChild, task.first, leftCount });
+		binaryNodes.push_back({ rightBounds, kEmptyChild, kEmptyChild, task.first + leftCount, task.count - leftCount });
+		binaryNodes[task.node].left = left;
+		binaryNodes[task.node].right = left + 1;
+		tasks.push_back({ left + 1, task.first + leftCount, task.count - leftCount, task.depth + 1, rightCentroidBounds });
+		tasks.push_back({ left, task.first, leftCount, task.depth + 1, leftCentroidBounds });
+	}
+
+	primitiveIndices_.resize(count);
+	primitiveBounds_.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		primitiveIndices_[i] = primitives[i].index;
+		primitiveBounds_[i] = primitives[i].bounds;
+	}
+
+	// 二分木を4分岐にまとめる
+	nodes_.reserve(binaryNodes.size() / 3 + 1);
+	Collapse(binaryNodes, 0, 1);
+	assert(depth_ * 3 + 1 <= kMaxStackSize);
+}
+
+/// <summary>
+/// 二分木のノードとその子孫を4分岐のノードにする
+/// 表面積の大きい子から開いて、子を4つまで集める
+/// </summary>
+/// <returns>作ったノードの番号</returns>
+uint32_t BoundingVolumeHierarchy::Collapse(const std::vector<BinaryNode>& binaryNodes, uint32_t binaryIndex, uint32_t depth) {
+	depth_ = std::max<uint32_t>(depth_, depth);
+	const uint32_t nodeIndex = uint32_t(nodes_.size());
+	nodes_.emplace_back();
+
+	uint32_t slots[4] = { binaryIndex, kEmptyChild, kEmptyChild, kEmptyChild };
+	uint32_t slotCount = 1;
+	for (;;) {
+		// 開ける(子を持つ)中で一番大きいもの
+		uint32_t open = kEmptyChild;
+		float openArea = -1.0f;
+		for (uint32_t k = 0; k < slotCount; ++k) {
+			const BinaryNode& slot = binaryNodes[slots[k]];
+			if (slot.left != kEmptyChild && HalfArea(slot.bounds) > openArea) {
+				open = k;
+				openArea = HalfArea(slot.bounds);
+			}
+		}
+		if (open == kEmptyChild || slotCount + 1 > 4) {
+			break;
+		}
+		const BinaryNode& opened = binaryNodes[slots[open]];
+		slots[open] = opened.left;
+		slots[slotCount++] = opened.right;
+	}
+
+	const BoundingBox empty = MakeEmptyBox();
+	for (uint32_t k = 0; k < 4; ++k) {
+		const BoundingBox& box = k < slotCount ? binaryNodes[slots[k]].bounds : empty;
+		uint32_t child = kEmptyChild;
+		uint32_t count = 0;
+		if (k < slotCount) {
+			const BinaryNode& slot = binaryNodes[slots[k]];
+			if (slot.left == kEmptyChild) {
+				child = slot.first;
+				count = slot.count;
+			} else {
+				child = Collapse(binaryNodes, slots[k], depth + 1);
+			}
+		}
+		// 子を作るとnodes_が伸びるので、番号で書き込む
+		Node& node = nodes_[nodeIndex];
+		node.minX[k] = box.min.x;
+		node.minY[k] = box.min.y;
+		node.minZ[k] = box.min.z;
+		node.maxX[k] = box.max.x;
+		node.maxY[k] = box.max.y;
+		node.maxZ[k] = box.max.z;
+		node.child[k] = child;
+		node.count[k] = count;
+	}
+	return nodeIndex;
+}
+
+/// <summary>
+/// 木の形を保ったまま箱を作り直す
+/// 子は親より後ろにあるので、後ろから一度なめれば下から順に計算できる
+/// </summary>
+/// <param name="bounds">物体の箱(Buildと同じ順)</param>
+void BoundingVolumeHierarchy::Refit(const BoundingBox* bounds) {
+	for (size_t i = 0; i < primitiveIndices_.size(); ++i) {
+		primitiveBounds_[i] = bounds[primitiveIndices_[i]];
+	}
+	for (size_t nodeIndex = nodes_.size(); nodeIndex > 0; --nodeIndex) {
+		Node& node = nodes_[nodeIndex - 1];
+		for (uint32_t k = 0; k < 4; ++k) {
+			if (node.child[k] == kEmptyChild) {
+				continue;
+			}
+			BoundingBox box = MakeEmptyBox();
+			if (node.count[k] > 0) {
+				for (uint32_t i = node.child[k]; i < node.child[k] + node.count[k]; ++i) {
+					Grow(box, primitiveBounds_[i]);
+				}
+			} else {
+				const Node& child = nodes_[node.child[k]];
+				for (uint32_t j = 0; j < 4; ++j) {
+					Grow(box, { { child.minX[j], child.minY[j], child.minZ[j] }, { child.maxX[j], child.maxY[j], child.maxZ[j] } });
+				}
+			}
+			node.minX[k] = box.min.x;
+			node.minY[k] = box.min.y;
+			node.minZ[k] = box.min.z;
+			node.maxX[k] = box.max.x;
+			node.maxY[k] = box.max.y;
+			node.maxZ[k] = box.max.z;
+		}
+	}
+}
+
+/// <summary>
+/// 視錐台と交わる物体を探す
+/// 子の箱が視錐台の完全に内側なら、その子孫は判定せずにすべて結果に入れる
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="results">交わる物体の番号の書き込み先</param>
+/// <returns>交わる物体の数</returns>
+size_t BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, uint32_t* results) const {
+	if (nodes_.empty()) {
+		return 0;
+	}
+	const FrustumPlanes planes = MakeFrustumPlanes(frustum);
+	size_t resultCount = 0;
+	uint32_t stack[kMaxStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const uint32_t entry = stack[--stackSize];
+		const Node& node = nodes_[entry & ~kInsideFlag];
+		uint32_t intersectMask = 0xF;
+		uint32_t insideMask = 0xF;
+		if (!(entry & kInsideFlag)) {
+			// 4つの子の箱を同時に判定する
+			// 最も外側の頂点が平面の裏なら外、最も内側の頂点がすべての平面の表なら完全に内側
+#if SIMD_X86
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 minX = _mm_loadu_ps(node.minX), maxX = _mm_loadu_ps(node.maxX);
+			const __m128 minY = _mm_loadu_ps(node.minY), maxY = _mm_loadu_ps(node.maxY);
+			const __m128 minZ = _mm_loadu_ps(node.minZ), maxZ = _mm_loadu_ps(node.maxZ);
+			const __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half), extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+			const __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half), extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+			const __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+			__m128 intersect = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			__m128 inside = intersect;
+			for (int i = 0; i < 6; i++) {
+				const __m128 distance = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(centerX, _mm_set1_ps(planes.normalX[i])),
+					_mm_mul_ps(centerY, _mm_set1_ps(planes.normalY[i]))),
+					_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(planes.normalZ[i])), _mm_set1_ps(planes.distance[i])));
+				const __m128 extent = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(extentX, _mm_set1_ps(planes.absNormalX[i])),
+					_mm_mul_ps(extentY, _mm_set1_ps(planes.absNormalY[i]))),
+					_mm_mul_ps(extentZ, _mm_set1_ps(planes.absNormalZ[i])));
+				intersect = _mm_and_ps(intersect, _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(distance, extent), _mm_setzero_ps()));
+			}
+			intersectMask = uint32_t(_mm_movemask_ps(intersect));
+			insideMask = uint32_t(_mm_movemask_ps(inside));
+#else
+			intersectMask = 0;
+			insideMask = 0;
+			for (uint32_t k = 0; k < 4; ++k) {
+				const float centerX = (node.minX[k] + node.maxX[k]) * 0.5f, extentX = (node.maxX[k] - node.minX[k]) * 0.5f;
+				const float centerY = (node.minY[k] + node.maxY[k]) * 0.5f, extentY = (node.maxY[k] - node.minY[k]) * 0.5f;
+				const float centerZ = (node.minZ[k] + node.maxZ[k]) * 0.5f, extentZ = (node.maxZ[k] - node.minZ[k]) * 0.5f;
+				bool isIntersected = true;
+				bool isInside = true;
+				for (int i = 0; i < 6; i++) {
+					const float distance = planes.normalX[i] * centerX + planes.normalY[i] * centerY + (planes.normalZ[i] * centerZ + planes.distance[i]);
+					const float extent = planes.absNormalX[i] * extentX + planes.absNormalY[i] * extentY + planes.absNormalZ[i] * extentZ;
+					isIntersected = isIntersected && distance + extent >= 0.0f;
+					isInside = isInside && distance - extent >= 0.0f;
+				}
+				intersectMask |= uint32_t(isIntersected) << k;
+				insideMask |= uint32_t(isInside) << k;
+			}
+#endif
+		}
+		for (uint32_t k = 0; k < 4; ++k) {
+			if (!((intersectMask >> k) & 1) || node.child[k] == kEmptyChild) {
+				continue;
+			}
+			const bool isInside = (insideMask >> k) & 1;
+			if (node.count[k] == 0) {
+				assert(stackSize < kMaxStackSize);
+				stack[stackSize++] = node.child[k] | (isInside ? kInsideFlag : 0);
+				continue;
+			}
+			// 葉は物体ごとに判定する(完全に内側なら判定しない)
+			for (uint32_t i = node.child[k]; i < node.child[k] + node.count[k]; ++i) {
+				results[resultCount] = primitiveIndices_[i];
+				resultCount += (isInside || IsBoxVisible(planes, primitiveBounds_[i])) ? 1 : 0;
+			}
+		}
+	}
+	return resultCount;
+}
+
+/// <summary>
+/// 箱と重なる物体を探す
+/// </summary>
+/// <param name="box">調べる箱</param>
+/// <param name="results">重なる物体の番号の書き込み先</param>
+/// <returns>重なる物体の数</returns>
+size_t BoundingVolumeHierarchy::QueryOverlap(const BoundingBox& box, uint32_t* results) const {
+	if (nodes_.empty()) {
+		return 0;
+	}
+	size_t resultCount = 0;
+	uint32_t stack[kMaxStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const Node& node = nodes_[stack[--stackSize]];
+#if SIMD_X86
+		__m128 overlap = _mm_and_ps(
+			_mm_cmple_ps(_mm_loadu_ps(node.minX), _mm_set1_ps(box.max.x)),
+			_mm_cmpge_ps(_mm_loadu_ps(node.maxX), _mm_set1_ps(box.min.x)));
+		overlap = _mm_and_ps(overlap, _mm_and_ps(
+			_mm_cmple_ps(_mm_loadu_ps(node.minY), _mm_set1_ps(box.max.y)),
+			_mm_cmpge_ps(_mm_loadu_ps(node.maxY), _mm_set1_ps(box.min.y))));
+		overlap = _mm_and_ps(overlap, _mm_and_ps(
+			_mm_cmple_ps(_mm_loadu_ps(node.minZ), _mm_set1_ps(box.max.z)),
+			_mm_cmpge_ps(_mm_loadu_ps(node.maxZ), _mm_set1_ps(box.min.z))));
+		const uint32_t overlapMask = uint32_t(_mm_movemask_ps(overlap));
+#else
+		uint32_t overlapMask = 0;
+		for (uint32_t k = 0; k < 4; ++k) {
+			const BoundingBox child = { { node.minX[k], node.minY[k], node.minZ[k] }, { node.maxX[k], node.maxY[k], node.maxZ[k] } };
+			overlapMask |= uint32_t(IsBoxOverlapped(child, box)) << k;
+		}
+#endif
+		for (uint32_t k = 0; k < 4; ++k) {
+			if (!((overlapMask >> k) & 1) || node.child[k] == kEmptyChild) {
+				continue;
+			}
+			if (node.count[k] == 0) {
+				assert(stackSize < kMaxStackSize);
+				stack[stackSize++] = node.child[k];
+				continue;
+			}
+			for (uint32_t i = node.child[k]; i < node.child[k] + node.count[k]; ++i) {
+				results[resultCount] = primitiveIndices_[i];
+				resultCount += IsBoxOverlapped(primitiveBounds_[i], box) ? 1 : 0;
+			}
+		}
+	}
+	return resultCount;
+}
+
+/// <summary>
+/// 半直線が最初に当たる物体の箱を探す
+/// 当たった子は近い順にたどり、今までの一番近い物体より遠い子は飛ばす
+/// </summary>
+/// <param name="ray">半直線</param>
+/// <param name="maxDistance">調べる最大の距離</param>
+/// <param name="hit">当たった物体と距離</param>
+/// <returns>当たったか</returns>
+bool BoundingVolumeHierarchy::Raycast(const Ray& ray, float maxDistance, RayHit& hit) const {
+	if (nodes_.empty()) {
+		return false;
+	}
+	const Vector3 inverseDirection = { SafeInverse(ray.direction.x), SafeInverse(ray.direction.y), SafeInverse(ray.direction.z) };
+	hit = { UINT32_MAX, maxDistance };
+	struct StackEntry {
+		uint32_t node;
+		float distance;
+	};
+	StackEntry stack[kMaxStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = { 0, 0.0f };
+	while (stackSize > 0) {
+		const StackEntry entry = stack[--stackSize];
+		if (entry.distance > hit.distance) {
+			continue;
+		}
+		const Node& node = nodes_[entry.node];
+		float distances[4];
+#if SIMD_X86
+		const __m128 originX = _mm_set1_ps(ray.origin.x), inverseX = _mm_set1_ps(inverseDirection.x);
+		const __m128 originY = _mm_set1_ps(ray.origin.y), inverseY = _mm_set1_ps(inverseDirection.y);
+		const __m128 originZ = _mm_set1_ps(ray.origin.z), inverseZ = _mm_set1_ps(inverseDirection.z);
+		const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), originX), inverseX);
+		const __m128 x2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), originX), inverseX);
+		const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), originY), inverseY);
+		const __m128 y2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), originY), inverseY);
+		const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), originZ), inverseZ);
+		const __m128 z2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), originZ), inverseZ);
+		const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2)), _mm_max_ps(_mm_min_ps(z1, z2), _mm_setzero_ps()));
+		const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(x1, x2), _mm_max_ps(y1, y2)), _mm_min_ps(_mm_max_ps(z1, z2), _mm_set1_ps(hit.distance)));
+		const uint32_t hitMask = uint32_t(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+		_mm_storeu_ps(distances, tNear);
+#else
+		uint32_t hitMask = 0;
+		for (uint32_t k = 0; k < 4; ++k) {
+			const BoundingBox child = { { node.minX[k], node.minY[k], node.minZ[k] }, { node.maxX[k], node.maxY[k], node.maxZ[k] } };
+			hitMask |= uint32_t(IntersectRayBox(ray.origin, inverseDirection, child, hit.distance, distances[k])) << k;
+		}
+#endif
+		// 当たった子ノードを遠い順に積む(近いものから取り出す)
+		StackEntry children[4];
+		uint32_t childCount = 0;
+		for (uint32_t k = 0; k < 4; ++k) {
+			if (!((hitMask >> k) & 1) || node.child[k] == kEmptyChild) {
+				continue;
+			}
+			if (node.count[k] == 0) {
+				children[childCount++] = { node.child[k], distances[k] };
+				continue;
+			}
+			for (uint32_t i = node.child[k]; i < node.child[k] + node.count[k]; ++i) {
+				float distance = 0.0f;
+				if (IntersectRayBox(ray.origin, inverseDirection, primitiveBounds_[i], hit.distance, distance) &&
+					(distance < hit.distance || hit.index == UINT32_MAX)) {
+					hit = { primitiveIndices_[i], distance };
+				}
+			}
+		}
+		for (uint32_t c = 1; c < childCount; ++c) {
+			for (uint32_t j = c; j > 0 && children[j - 1].distance < children[j].distance; --j) {
+				std::swap(children[j - 1], children[j]);
+			}
+		}
+		for (uint32_t c = 0; c < childCount; ++c) {
+			assert(stackSize < kMaxStackSize);
+			stack[stackSize++] = children[c];
+		}
+	}
+	return hit.index != UINT32_MAX;
+}
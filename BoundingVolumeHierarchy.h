@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FrustumCulling.h"
+#include "Vector3.h"
+
+/// <summary>
+/// 半直線(directionは正規化しなくてもよい。距離はdirectionの長さを1とした値)
+/// </summary>
+struct Ray {
+	Vector3 origin;
+	Vector3 direction;
+};
+
+/// <summary>
+/// 半直線が当たった物体
+/// </summary>
+struct RayHit {
+	uint32_t index;
+	float distance;
+};
+
+/// <summary>
+/// 物体の境界箱の4分岐BVH
+/// 二分木をSAHで作ってから4分岐にまとめ、ノードは子4つの箱をSoAで持つ(1ノード128byte)
+/// 物体が動いたらRefitで木の形を変えずに箱だけ作り直す
+/// </summary>
+class BoundingVolumeHierarchy {
+public:
+	// 木を作り直す(boundsの番号がクエリの結果になる)
+	void Build(const BoundingBox* bounds, size_t count);
+
+	// 木の形を保ったまま箱を作り直す(boundsはBuildと同じ数、同じ順)
+	// 物体が大きく動くとクエリが遅くなるので、そのときはBuildし直す
+	void Refit(const BoundingBox* bounds);
+
+	// 視錐台と交わる物体の番号をresultsへ書き込み、その数を返す(順は木の順)
+	// 結果はCullBoxesと同じ。resultsは物体数分の領域を用意すること
+	size_t QueryFrustum(const Frustum& frustum, uint32_t* results) const;
+
+	// 箱と重なる物体の番号をresultsへ書き込み、その数を返す
+	size_t QueryOverlap(const BoundingBox& box, uint32_t* results) const;
+
+	// maxDistanceまでで一番近くで当たる境界箱を探す
+	bool Raycast(const Ray& ray, float maxDistance, RayHit& hit) const;
+
+	size_t GetPrimitiveCount() const { return primitiveIndices_.size(); }
+	size_t GetNodeCount() const { return nodes_.size(); }
+	uint32_t GetDepth() const { return depth_; }
+
+private:
+	// 子の箱4つ(空きは最小 > 最大にして何とも交わらないようにする)
+	// countが0なら子ノードの番号、1以上なら葉でprimitiveIndices_の先頭位置
+	struct Node {
+		float minX[4];
+		float minY[4];
+		float minZ[4];
+		float maxX[4];
+		float maxY[4];
+		float maxZ[4];
+		uint32_t child[4];
+		uint32_t count[4];
+	};
+
+	// 空いている子の番号
+	static constexpr uint32_t kEmptyChild = UINT32_MAX;
+
+	struct BinaryNode;
+	uint32_t Collapse(const std::vector<BinaryNode>& binaryNodes, uint32_t binaryIndex, uint32_t depth);
+
+	std::vector<Node> nodes_; // 親は子より前にある
+	std::vector<uint32_t> primitiveIndices_; // 葉の順に並べた物体の番号
+	std::vector<BoundingBox> primitiveBounds_; // 葉の順に並べた物体の箱
+	uint32_t depth_ = 0;
+};
@@ -0,0 +1,55 @@
+#include "D3D12GpuTimeline.h"
+#include <cassert>
+
+/// <summary>
+/// フェンスとイベントを作成する
+/// </summary>
+/// <param name="device">デバイス</param>
+/// <param name="commandQueue">シグナルを積むキュー</param>
+D3D12GpuTimeline::D3D12GpuTimeline(ID3D12Device* device, ID3D12CommandQueue* commandQueue)
+	: commandQueue_(commandQueue) {
+	HRESULT hr = device->CreateFence(fenceValue_, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
+	assert(SUCCEEDED(hr));
+	fenceEvent_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	assert(fenceEvent_ != nullptr);
+}
+
+/// <summary>
+/// フェンスとイベントを解放する(GPUが空いてから呼ぶこと)
+/// </summary>
+D3D12GpuTimeline::~D3D12GpuTimeline() {
+	CloseHandle(fenceEvent_);
+	fence_->Release();
+}
+
+/// <summary>
+/// キューにシグナルを積む
+/// </summary>
+/// <returns>シグナルの値</returns>
+uint64_t D3D12GpuTimeline::Signal() {
+	++fenceValue_;
+	HRESULT hr = commandQueue_->Signal(fence_, fenceValue_);
+	assert(SUCCEEDED(hr));
+	return fenceValue_;
+}
+
+/// <summary>
+/// GPUが処理し終えたシグナルの値
+/// </summary>
+uint64_t D3D12GpuTimeline::GetCompletedValue() {
+	return fence_->GetCompletedValue();
+}
+
+/// <summary>
+/// シグナルにたどり着くまで待つ
+/// </summary>
+/// <param name="value">待つシグナルの値</param>
+void D3D12GpuTimeline::Wait(uint64_t value) {
+	if (fence_->GetCompletedValue() >= value) {
+		return;
+	}
+	// たどり着いたらイベントが立つように設定して待つ
+	HRESULT hr = fence_->SetEventOnCompletion(value, fenceEvent_);
+	assert(SUCCEEDED(hr));
+	WaitForSingleObject(fenceEvent_, INFINITE);
+}
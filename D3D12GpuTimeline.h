@@ -0,0 +1,25 @@
+#pragma once
+#include <Windows.h>
+#include <d3d12.h>
+#include "FrameRing.h"
+
+/// <summary>
+/// コマンドキューとフェンスによるGpuTimeline
+/// </summary>
+class D3D12GpuTimeline : public GpuTimeline {
+public:
+	D3D12GpuTimeline(ID3D12Device* device, ID3D12CommandQueue* commandQueue);
+	~D3D12GpuTimeline() override;
+	D3D12GpuTimeline(const D3D12GpuTimeline&) = delete;
+	D3D12GpuTimeline& operator=(const D3D12GpuTimeline&) = delete;
+
+	uint64_t Signal() override;
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t value) override;
+
+private:
+	ID3D12CommandQueue* commandQueue_ = nullptr;
+	ID3D12Fence* fence_ = nullptr;
+	HANDLE fenceEvent_ = nullptr;
+	uint64_t fenceValue_ = 0;
+};
@@ -0,0 +1,142 @@
+#include "D3D12ResourceAllocator.h"
+#include <cassert>
+
+namespace {
+
+// プールごとの1つのヒープの大きさ
+constexpr uint64_t kUploadBufferHeapSize = 16ull << 20;
+constexpr uint64_t kTextureHeapSize = 64ull << 20;
+constexpr uint64_t kRenderTargetHeapSize = 32ull << 20;
+
+}
+
+/// <summary>
+/// プールを作成する(ヒープは最初にリソースを作るときに確保する)
+/// </summary>
+/// <param name="device">デバイス</param>
+D3D12ResourceAllocator::D3D12ResourceAllocator(ID3D12Device* device)
+	: device_(device) {
+	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
+	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+	// テクスチャとレンダーターゲットはGPUのメモリに置く(テクスチャはステージングからコピーで書き込む)
+	D3D12_HEAP_PROPERTIES defaultHeapProperties{};
+	defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+	// リソースの種類ごとにヒープを分ける(リソースヒープTier1でも使えるように)
+	// バッファは64KB、テクスチャは小さいものが4KB、レンダーターゲットはMSAAも置けるように4MB境界のヒープにする
+	heapSources_[size_t(D3D12HeapPoolType::UploadBuffer)] = std::make_unique<HeapSourceImpl>(device, uploadHeapProperties,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	heapSources_[size_t(D3D12HeapPoolType::Texture)] = std::make_unique<HeapSourceImpl>(device, defaultHeapProperties,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	heapSources_[size_t(D3D12HeapPoolType::RenderTarget)] = std::make_unique<HeapSourceImpl>(device, defaultHeapProperties,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	pools_[size_t(D3D12HeapPoolType::UploadBuffer)] = std::make_unique<HeapPool>(*heapSources_[size_t(D3D12HeapPoolType::UploadBuffer)],
+		kUploadBufferHeapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	pools_[size_t(D3D12HeapPoolType::Texture)] = std::make_unique<HeapPool>(*heapSources_[size_t(D3D12HeapPoolType::Texture)],
+		kTextureHeapSize, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+	pools_[size_t(D3D12HeapPoolType::RenderTarget)] = std::make_unique<HeapPool>(*heapSources_[size_t(D3D12HeapPoolType::RenderTarget)],
+		kRenderTargetHeapSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+}
+
+/// <summary>
+/// ヒープを解放する(リソースはすべてReleaseResourceしておくこと)
+/// </summary>
+D3D12ResourceAllocator::~D3D12ResourceAllocator() {
+	assert(allocations_.empty());
+}
+
+/// <summary>
+/// ヒープの領域にリソースを配置する
+/// </summary>
+/// <param name="poolType">置くヒープの種類</param>
+/// <param name="desc">リソースの設定(Alignmentは0にしておく)</param>
+/// <param name="initialState">最初の状態</param>
+/// <param name="clearValue">クリア値(レンダーターゲットと深度)</param>
+/// <returns>作成したリソース</returns>
+ID3D12Resource* D3D12ResourceAllocator::CreateResource(D3D12HeapPoolType poolType, const D3D12_RESOURCE_DESC& desc,
+	D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue) {
+	D3D12_RESOURCE_DESC placedDesc = desc;
+	// 小さいテクスチャは4KB境界に置けるか試す(置けなければ64KBに戻す)
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo{};
+	if (poolType == D3D12HeapPoolType::Texture && placedDesc.SampleDesc.Count <= 1) {
+		placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		allocationInfo = device_->GetResourceAllocationInfo(0, 1, &placedDesc);
+		if (allocationInfo.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+			placedDesc.Alignment = 0;
+		}
+	}
+	if (placedDesc.Alignment == 0) {
+		allocationInfo = device_->GetResourceAllocationInfo(0, 1, &placedDesc);
+	}
+	if (allocationInfo.SizeInBytes == UINT64_MAX) {
+		return nullptr;
+	}
+
+	HeapPool& pool = *pools_[size_t(poolType)];
+	HeapAllocation allocation{};
+	if (!pool.Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment, allocation)) {
+		return nullptr;
+	}
+	ID3D12Resource* resource = nullptr;
+	HRESULT hr = device_->CreatePlacedResource(static_cast<ID3D12Heap*>(allocation.heap), allocation.offset,
+		&placedDesc, initialState, clearValue, IID_PPV_ARGS(&resource));
+	if (FAILED(hr)) {
+		pool.Free(allocation);
+		return nullptr;
+	}
+	allocations_[resource] = { poolType, allocation };
+	return resource;
+}
+
+/// <summary>
+/// リソースを解放する
+/// </summary>
+/// <param name="resource">CreateResourceで作ったリソース</param>
+void D3D12ResourceAllocator::ReleaseResource(ID3D12Resource* resource) {
+	auto it = allocations_.find(resource);
+	assert(it != allocations_.end());
+	resource->Release();
+	pools_[size_t(it->second.poolType)]->Free(it->second.allocation);
+	allocations_.erase(it);
+}
+
+/// <summary>
+/// プールの統計
+/// </summary>
+HeapPoolStats D3D12ResourceAllocator::GetStats(D3D12HeapPoolType poolType) const {
+	return pools_[size_t(poolType)]->GetStats();
+}
+
+/// <summary>
+/// ヒープの設定を記録する
+/// </summary>
+D3D12ResourceAllocator::HeapSourceImpl::HeapSourceImpl(ID3D12Device* device, const D3D12_HEAP_PROPERTIES& properties, D3D12_HEAP_FLAGS flags, uint64_t alignment)
+	: device_(device), properties_(properties), flags_(flags), alignment_(alignment) {
+}
+
+/// <summary>
+/// ヒープを作る
+/// </summary>
+bool D3D12ResourceAllocator::HeapSourceImpl::CreateHeap(uint64_t size, void*& heap) {
+	D3D12_HEAP_DESC heapDesc{};
+	// ヒープの大きさは境界の倍数にする
+	heapDesc.SizeInBytes = (size + alignment_ - 1) & ~(alignment_ - 1);
+	heapDesc.Properties = properties_;
+	heapDesc.Alignment = alignment_;
+	heapDesc.Flags = flags_;
+	ID3D12Heap* d3d12Heap = nullptr;
+	HRESULT hr = device_->CreateHeap(&heapDesc, IID_PPV_ARGS(&d3d12Heap));
+	if (FAILED(hr)) {
+		return false;
+	}
+	heap = d3d12Heap;
+	return true;
+}
+
+/// <summary>
+/// ヒープを解放する
+/// </summary>
+void D3D12ResourceAllocator::HeapSourceImpl::DestroyHeap(void* heap) {
+	static_cast<ID3D12Heap*>(heap)->Release();
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <d3d12.h>
+#include <memory>
+#include <unordered_map>
+#include "HeapPool.h"
+
+/// <summary>
+/// リソースを置くヒープの種類(リソースの種類ごとにヒープを分ける)
+/// </summary>
+enum class D3D12HeapPoolType {
+	UploadBuffer, // CPUから書き込むバッファ
+	Texture,      // レンダーターゲットと深度以外のテクスチャ
+	RenderTarget, // レンダーターゲットと深度
+	Count,
+};
+
+/// <summary>
+/// 大きなヒープをTLSFで切り分け、そこにリソースを配置する(CreatePlacedResource)
+/// </summary>
+class D3D12ResourceAllocator {
+public:
+	explicit D3D12ResourceAllocator(ID3D12Device* device);
+	~D3D12ResourceAllocator();
+	D3D12ResourceAllocator(const D3D12ResourceAllocator&) = delete;
+	D3D12ResourceAllocator& operator=(const D3D12ResourceAllocator&) = delete;
+
+	// プールのヒープにリソースを作る(失敗したらnullptr)
+	ID3D12Resource* CreateResource(D3D12HeapPoolType poolType, const D3D12_RESOURCE_DESC& desc,
+		D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+	// リソースを解放し、ヒープの領域を戻す
+	void ReleaseResource(ID3D12Resource* resource);
+
+	HeapPoolStats GetStats(D3D12HeapPoolType poolType) const;
+
+private:
+	/// <summary>
+	/// ID3D12Heapを作るHeapSource
+	/// </summary>
+	class HeapSourceImpl : public HeapSource {
+	public:
+		HeapSourceImpl(ID3D12Device* device, const D3D12_HEAP_PROPERTIES& properties, D3D12_HEAP_FLAGS flags, uint64_t alignment);
+		bool CreateHeap(uint64_t size, void*& heap) override;
+		void DestroyHeap(void* heap) override;
+
+	private:
+		ID3D12Device* device_;
+		D3D12_HEAP_PROPERTIES properties_;
+		D3D12_HEAP_FLAGS flags_;
+		uint64_t alignment_;
+	};
+
+	struct PlacedAllocation {
+		D3D12HeapPoolType poolType;
+		HeapAllocation allocation;
+	};
+
+	static constexpr size_t kPoolCount = size_t(D3D12HeapPoolType::Count);
+
+	ID3D12Device* device_;
+	std::unique_ptr<HeapSourceImpl> heapSources_[kPoolCount];
+	std::unique_ptr<HeapPool> pools_[kPoolCount];
+	std::unordered_map<ID3D12Resource*, PlacedAllocation> allocations_;
+};
@@ -0,0 +1,63 @@
+#include "D3D12TextureStreamSink.h"
+
+/// <summary>
+/// テクスチャを置くアロケータとコピーを積むアップローダーを設定する
+/// </summary>
+D3D12TextureStreamSink::D3D12TextureStreamSink(D3D12ResourceAllocator& allocator, D3D12TextureUploader& uploader, GpuTimeline& timeline)
+	: allocator_(allocator), uploader_(uploader), timeline_(timeline) {
+}
+
+/// <summary>
+/// 全mipのテクスチャをCOPY_DESTで作る
+/// </summary>
+/// <param name="texture">デコードしたテクスチャ</param>
+/// <returns>ID3D12Resource*(失敗したらnullptr)</returns>
+void* D3D12TextureStreamSink::CreateTexture(const DecodedTexture& texture) {
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	resourceDesc.Width = texture.width;
+	resourceDesc.Height = texture.height;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = UINT16(texture.mips.size());
+	resourceDesc.Format = texture.format;
+	resourceDesc.SampleDesc.Count = 1;
+	return allocator_.CreateResource(D3D12HeapPoolType::Texture, resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST);
+}
+
+/// <summary>
+/// 1つのmipのコピーを積む(コピーの後はそのmipだけシェーダーから読める)
+/// </summary>
+bool D3D12TextureStreamSink::UploadMip(void* texture, uint32_t mipLevel, const DecodedMip& mip) {
+	ID3D12Resource* resource = static_cast<ID3D12Resource*>(texture);
+	DirectX::Image image{};
+	image.width = mip.width;
+	image.height = mip.height;
+	image.format = resource->GetDesc().Format;
+	image.rowPitch = mip.rowPitch;
+	image.slicePitch = mip.slicePitch;
+	image.pixels = const_cast<uint8_t*>(mip.pixels);
+	return uploader_.UploadSubresource(resource, mipLevel, image);
+}
+
+/// <summary>
+/// 積んだコピーを送る
+/// </summary>
+/// <returns>コピーの後に積んだシグナルの値</returns>
+uint64_t D3D12TextureStreamSink::Submit() {
+	uploader_.Flush();
+	return uploader_.GetLastFenceValue();
+}
+
+/// <summary>
+/// GPUが処理し終えたシグナルの値
+/// </summary>
+uint64_t D3D12TextureStreamSink::GetCompletedValue() {
+	return timeline_.GetCompletedValue();
+}
+
+/// <summary>
+/// テクスチャを解放する
+/// </summary>
+void D3D12TextureStreamSink::DestroyTexture(void* texture) {
+	allocator_.ReleaseResource(static_cast<ID3D12Resource*>(texture));
+}
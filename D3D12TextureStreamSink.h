@@ -0,0 +1,25 @@
+#pragma once
+#include <d3d12.h>
+#include "D3D12ResourceAllocator.h"
+#include "D3D12TextureUploader.h"
+#include "TextureStreamer.h"
+
+/// <summary>
+/// DEFAULTヒープのテクスチャにD3D12TextureUploaderで書き込むTextureUploadSink
+/// 専用のコピーキューの代わりに描画と同じキューへ送り、フェンスで終わりを知る
+/// </summary>
+class D3D12TextureStreamSink : public TextureUploadSink {
+public:
+	D3D12TextureStreamSink(D3D12ResourceAllocator& allocator, D3D12TextureUploader& uploader, GpuTimeline& timeline);
+
+	void* CreateTexture(const DecodedTexture& texture) override;
+	bool UploadMip(void* texture, uint32_t mipLevel, const DecodedMip& mip) override;
+	uint64_t Submit() override;
+	uint64_t GetCompletedValue() override;
+	void DestroyTexture(void* texture) override;
+
+private:
+	D3D12ResourceAllocator& allocator_;
+	D3D12TextureUploader& uploader_;
+	GpuTimeline& timeline_;
+};
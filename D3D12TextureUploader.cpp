@@ -0,0 +1,231 @@
+#include "D3D12TextureUploader.h"
+#include <algorithm>
+#include <cassert>
+
+/// <summary>
+/// ステージングのリングとコピー用のコマンドリストを作成する
+/// </summary>
+/// <param name="device">デバイス</param>
+/// <param name="commandQueue">コピーを送るキュー(描画と同じキュー)</param>
+/// <param name="timeline">commandQueueのシグナル</param>
+/// <param name="stagingSize">ステージングのバイト数</param>
+D3D12TextureUploader::D3D12TextureUploader(ID3D12Device* device, ID3D12CommandQueue* commandQueue, GpuTimeline& timeline, size_t stagingSize)
+	: commandQueue_(commandQueue), timeline_(timeline), pageSource_(device), stagingRing_(pageSource_, stagingSize) {
+	HRESULT hr = S_OK;
+	for (uint32_t i = 0; i < kCommandAllocatorCount; ++i) {
+		hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocators_[i]));
+		assert(SUCCEEDED(hr));
+	}
+	hr = device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators_[0], nullptr, IID_PPV_ARGS(&commandList_));
+	assert(SUCCEEDED(hr));
+	// 最初に積むときにResetするので閉じておく
+	hr = commandList_->Close();
+	assert(SUCCEEDED(hr));
+}
+
+/// <summary>
+/// 送ったコピーが終わるのを待ってから解放する
+/// </summary>
+D3D12TextureUploader::~D3D12TextureUploader() {
+	Flush();
+	WaitForIdle();
+	commandList_->Release();
+	for (uint32_t i = 0; i < kCommandAllocatorCount; ++i) {
+		commandAllocators_[i]->Release();
+	}
+}
+
+/// <summary>
+/// テクスチャの全サブリソースのコピーを積む
+/// </summary>
+/// <param name="texture">COPY_DESTで作ったテクスチャ</param>
+/// <param name="image">書き込む画像(テクスチャと同じフォーマット、大きさ、mip数)</param>
+/// <param name="afterState">コピーの後の状態</param>
+/// <returns>扱えないフォーマットか、ステージングを確保できなければfalse</returns>
+bool D3D12TextureUploader::Upload(ID3D12Resource* texture, const DirectX::ScratchImage& image, D3D12_RESOURCE_STATES afterState) {
+	const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	assert(desc.Format == metadata.format && desc.Width == metadata.width && desc.Height == metadata.height);
+	assert(desc.MipLevels == metadata.mipLevels);
+
+	const bool is3D = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	const uint32_t mipLevels = desc.MipLevels;
+	const uint32_t arraySize = is3D ? 1 : desc.DepthOrArraySize;
+	for (uint32_t arraySlice = 0; arraySlice < arraySize; ++arraySlice) {
+		for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
+			const DirectX::Image* mipImage = image.GetImage(mipLevel, is3D ? 0 : arraySlice, 0);
+			assert(mipImage != nullptr);
+			const uint32_t width = std::max(uint32_t(desc.Width) >> mipLevel, 1u);
+			const uint32_t height = std::max(desc.Height >> mipLevel, 1u);
+			const uint32_t depth = is3D ? std::max(uint32_t(desc.DepthOrArraySize) >> mipLevel, 1u) : 1;
+			if (!CopySubresource(texture, mipLevel + arraySlice * mipLevels, desc.Format, width, height, depth, *mipImage)) {
+				return false;
+			}
+		}
+	}
+
+	// コピーが終わったらシェーダーから読める状態にする
+	Transition(texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, afterState);
+	++stats_.textureCount;
+	return true;
+}
+
+/// <summary>
+/// 1つのサブリソースのコピーを積む
+/// </summary>
+/// <param name="texture">COPY_DESTで作ったテクスチャ</param>
+/// <param name="subresource">サブリソースの番号</param>
+/// <param name="image">書き込む画像(3Dならスライスが続けて並んでいること)</param>
+/// <param name="afterState">コピーの後のこのサブリソースの状態</param>
+/// <returns>扱えないフォーマットか、ステージングを確保できなければfalse</returns>
+bool D3D12TextureUploader::UploadSubresource(ID3D12Resource* texture, uint32_t subresource, const DirectX::Image& image, D3D12_RESOURCE_STATES afterState) {
+	const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+	const bool is3D = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	const uint32_t mipLevel = subresource % desc.MipLevels;
+	const uint32_t width = std::max(uint32_t(desc.Width) >> mipLevel, 1u);
+	const uint32_t height = std::max(desc.Height >> mipLevel, 1u);
+	const uint32_t depth = is3D ? std::max(uint32_t(desc.DepthOrArraySize) >> mipLevel, 1u) : 1;
+	assert(image.width == width && image.height == height);
+	if (!CopySubresource(texture, subresource, desc.Format, width, height, depth, image)) {
+		return false;
+	}
+	Transition(texture, subresource, afterState);
+	return true;
+}
+
+/// <summary>
+/// COPY_DESTから遷移させるバリアを積む
+/// </summary>
+void D3D12TextureUploader::Transition(ID3D12Resource* texture, uint32_t subresource, D3D12_RESOURCE_STATES afterState) {
+	D3D12_RESOURCE_BARRIER barrier{};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+	barrier.Transition.pResource = texture;
+	barrier.Transition.Subresource = subresource;
+	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+	barrier.Transition.StateAfter = afterState;
+	BeginRecording()->ResourceBarrier(1, &barrier);
+}
+
+/// <summary>
+/// サブリソース1つのコピーを積む
+/// </summary>
+/// <returns>扱えないフォーマットか、ステージングを確保できなければfalse</returns>
+bool D3D12TextureUploader::CopySubresource(ID3D12Resource* texture, uint32_t subresource, DXGI_FORMAT format,
+	uint32_t width, uint32_t height, uint32_t depth, const DirectX::Image& image) {
+	TextureFormatBlock block{};
+	TextureFootprint footprint{};
+	if (!GetTextureFormatBlock(format, block) || !ComputeTextureFootprint(format, width, height, depth, 0, footprint)) {
+		return false;
+	}
+	// 入るならサブリソースをまとめて、入らなければスライスごとに入るだけの行ずつ送る
+	const size_t stagingSize = stagingRing_.GetSize();
+	uint32_t rowsPerCopy = footprint.rowCount;
+	uint32_t slicesPerCopy = footprint.depth;
+	if (GetTextureFootprintSize(footprint) > stagingSize) {
+		slicesPerCopy = 1;
+		if (footprint.rowSize > stagingSize) {
+			return false;
+		}
+		rowsPerCopy = uint32_t(std::min<uint64_t>(footprint.rowCount, (stagingSize - footprint.rowSize) / footprint.rowPitch + 1));
+	}
+
+	D3D12_TEXTURE_COPY_LOCATION dst{};
+	dst.pResource = texture;
+	dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	dst.SubresourceIndex = subresource;
+	D3D12_TEXTURE_COPY_LOCATION src{};
+	src.pResource = static_cast<ID3D12Resource*>(stagingRing_.GetPage().handle);
+	src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+
+	for (uint32_t z = 0; z < footprint.depth; z += slicesPerCopy) {
+		for (uint32_t row = 0; row < footprint.rowCount; row += rowsPerCopy) {
+			// 端の範囲はブロックの倍数に切り上げた高さまで
+			TextureFootprint part{};
+			const uint32_t partHeight = std::min(rowsPerCopy, footprint.rowCount - row) * block.height;
+			const uint32_t partDepth = std::min(slicesPerCopy, footprint.depth - z);
+			ComputeTextureFootprint(format, width, partHeight, partDepth, 0, part);
+			UploadAllocation allocation{};
+			if (!AllocateStaging(size_t(GetTextureFootprintSize(part)), allocation)) {
+				return false;
+			}
+			part.offset = allocation.gpuAddress - stagingRing_.GetPage().gpuAddress;
+			CopyTextureRows(static_cast<uint8_t*>(allocation.cpuAddress), part,
+				image.pixels + image.slicePitch * z + image.rowPitch * row, image.rowPitch, image.slicePitch);
+
+			src.PlacedFootprint.Offset = part.offset;
+			src.PlacedFootprint.Footprint = { format, part.width, part.height, part.depth, part.rowPitch };
+			BeginRecording()->CopyTextureRegion(&dst, 0, row * block.height, z, &src, nullptr);
+			stats_.uploadedBytes += allocation.size;
+			++stats_.copyCount;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// ステージングを切り出す(空いていなければ積んだコピーを送り、一番古いものが終わるまで待つ)
+/// </summary>
+bool D3D12TextureUploader::AllocateStaging(size_t size, UploadAllocation& allocation) {
+	stagingRing_.Retire(timeline_.GetCompletedValue());
+	while (!stagingRing_.Allocate(size, kTextureDataPlacementAlignment, allocation)) {
+		Flush();
+		const uint64_t waitValue = stagingRing_.GetOldestFenceValue();
+		if (waitValue == 0) {
+			return false;
+		}
+		timeline_.Wait(waitValue);
+		stagingRing_.Retire(timeline_.GetCompletedValue());
+		++stats_.stallCount;
+	}
+	return true;
+}
+
+/// <summary>
+/// 積み始めていなければコマンドリストを開く
+/// </summary>
+ID3D12GraphicsCommandList* D3D12TextureUploader::BeginRecording() {
+	if (!isRecording_) {
+		// 前回このアロケータで送ったコマンドが終わるまで待つ
+		const uint64_t waitValue = allocatorFenceValues_[allocatorIndex_];
+		if (timeline_.GetCompletedValue() < waitValue) {
+			timeline_.Wait(waitValue);
+		}
+		HRESULT hr = commandAllocators_[allocatorIndex_]->Reset();
+		assert(SUCCEEDED(hr));
+		hr = commandList_->Reset(commandAllocators_[allocatorIndex_], nullptr);
+		assert(SUCCEEDED(hr));
+		isRecording_ = true;
+	}
+	return commandList_;
+}
+
+/// <summary>
+/// 積んだコピーをキューに送る
+/// </summary>
+void D3D12TextureUploader::Flush() {
+	if (!isRecording_) {
+		return;
+	}
+	HRESULT hr = commandList_->Close();
+	assert(SUCCEEDED(hr));
+	ID3D12CommandList* commandLists[] = { commandList_ };
+	commandQueue_->ExecuteCommandLists(1, commandLists);
+	lastFenceValue_ = timeline_.Signal();
+	// このシグナルを過ぎればステージングとアロケータを使い回せる
+	stagingRing_.Submit(lastFenceValue_);
+	allocatorFenceValues_[allocatorIndex_] = lastFenceValue_;
+	allocatorIndex_ = (allocatorIndex_ + 1) % kCommandAllocatorCount;
+	isRecording_ = false;
+	++stats_.flushCount;
+}
+
+/// <summary>
+/// 送ったコピーが終わるまで待つ
+/// </summary>
+void D3D12TextureUploader::WaitForIdle() {
+	if (timeline_.GetCompletedValue() < lastFenceValue_) {
+		timeline_.Wait(lastFenceValue_);
+	}
+	stagingRing_.Retire(timeline_.GetCompletedValue());
+}
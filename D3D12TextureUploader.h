@@ -0,0 +1,76 @@
+#pragma once
+#include <d3d12.h>
+#include <cstdint>
+#include "externals/DirectXTex/DirectXTex.h"
+#include "D3D12UploadPageSource.h"
+#include "FrameRing.h"
+#include "TextureFootprint.h"
+#include "UploadAllocator.h"
+
+/// <summary>
+/// 転送の統計
+/// </summary>
+struct TextureUploadStats {
+	uint64_t textureCount;
+	uint64_t uploadedBytes; // 行の境界合わせを含むステージングのバイト数
+	uint64_t copyCount;     // CopyTextureRegionの回数
+	uint64_t flushCount;    // キューに送った回数
+	uint64_t stallCount;    // ステージングが空くのを待った回数
+};
+
+/// <summary>
+/// DEFAULTヒープのテクスチャへ、ステージング用のリングバッファからコピーで書き込む
+/// コピーはこのクラスのコマンドリストに積み、Flushで描画と同じキューに送る(後の描画はキューの順で待つ)
+/// </summary>
+class D3D12TextureUploader {
+public:
+	D3D12TextureUploader(ID3D12Device* device, ID3D12CommandQueue* commandQueue, GpuTimeline& timeline, size_t stagingSize);
+	~D3D12TextureUploader();
+	D3D12TextureUploader(const D3D12TextureUploader&) = delete;
+	D3D12TextureUploader& operator=(const D3D12TextureUploader&) = delete;
+
+	// 全サブリソースのコピーを積み、afterStateへ遷移させる(textureはCOPY_DESTで作っておく)
+	// ステージングに入りきらないサブリソースは行に分けてコピーし、足りなければ送ってから空くのを待つ
+	bool Upload(ID3D12Resource* texture, const DirectX::ScratchImage& image,
+		D3D12_RESOURCE_STATES afterState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	// 1つのサブリソースのコピーを積み、そのサブリソースだけafterStateへ遷移させる(少しずつ送るとき用)
+	bool UploadSubresource(ID3D12Resource* texture, uint32_t subresource, const DirectX::Image& image,
+		D3D12_RESOURCE_STATES afterState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	// 積んだコピーをキューに送る(積んでいなければ何もしない)
+	void Flush();
+
+	// 送ったコピーが終わるまで待つ
+	void WaitForIdle();
+
+	// ステージングを作れたか(falseならUploadはいつも失敗する)
+	bool IsValid() const { return stagingRing_.IsValid(); }
+
+	// 最後にFlushしたときのシグナルの値
+	uint64_t GetLastFenceValue() const { return lastFenceValue_; }
+	const TextureUploadStats& GetStats() const { return stats_; }
+	size_t GetStagingUsedSize() const { return stagingRing_.GetUsedSize(); }
+	size_t GetStagingSize() const { return stagingRing_.GetSize(); }
+
+private:
+	static constexpr uint32_t kCommandAllocatorCount = 2;
+
+	ID3D12GraphicsCommandList* BeginRecording();
+	bool AllocateStaging(size_t size, UploadAllocation& allocation);
+	bool CopySubresource(ID3D12Resource* texture, uint32_t subresource, DXGI_FORMAT format,
+		uint32_t width, uint32_t height, uint32_t depth, const DirectX::Image& image);
+	void Transition(ID3D12Resource* texture, uint32_t subresource, D3D12_RESOURCE_STATES afterState);
+
+	ID3D12CommandQueue* commandQueue_ = nullptr;
+	GpuTimeline& timeline_;
+	D3D12UploadPageSource pageSource_;
+	RingUploadAllocator stagingRing_;
+	ID3D12CommandAllocator* commandAllocators_[kCommandAllocatorCount] = {};
+	uint64_t allocatorFenceValues_[kCommandAllocatorCount] = {};
+	uint32_t allocatorIndex_ = 0;
+	ID3D12GraphicsCommandList* commandList_ = nullptr;
+	bool isRecording_ = false;
+	uint64_t lastFenceValue_ = 0;
+	TextureUploadStats stats_{};
+};
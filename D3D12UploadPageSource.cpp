@@ -0,0 +1,56 @@
+#include "D3D12UploadPageSource.h"
+#include <cassert>
+
+/// <summary>
+/// ページを作るデバイスを設定する
+/// </summary>
+/// <param name="device">デバイス</param>
+D3D12UploadPageSource::D3D12UploadPageSource(ID3D12Device* device)
+	: device_(device) {
+}
+
+/// <summary>
+/// UPLOADヒープにバッファを作ってMapする
+/// </summary>
+/// <param name="size">バイト数</param>
+/// <param name="page">作成したページ</param>
+/// <returns>作成に失敗したらfalse</returns>
+bool D3D12UploadPageSource::CreatePage(size_t size, UploadPage& page) {
+	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
+	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = size;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	ID3D12Resource* resource = nullptr;
+	HRESULT hr = device_->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&resource));
+	if (FAILED(hr)) {
+		return false;
+	}
+	void* cpuAddress = nullptr;
+	// CPUは書き込むだけなので読み込み範囲は空にする
+	D3D12_RANGE readRange{ 0, 0 };
+	hr = resource->Map(0, &readRange, &cpuAddress);
+	if (FAILED(hr)) {
+		resource->Release();
+		return false;
+	}
+	page = { static_cast<uint8_t*>(cpuAddress), resource->GetGPUVirtualAddress(), size, resource };
+	return true;
+}
+
+/// <summary>
+/// ページのバッファを解放する
+/// </summary>
+/// <param name="page">解放するページ</param>
+void D3D12UploadPageSource::DestroyPage(const UploadPage& page) {
+	ID3D12Resource* resource = static_cast<ID3D12Resource*>(page.handle);
+	assert(resource != nullptr);
+	resource->Unmap(0, nullptr);
+	resource->Release();
+}
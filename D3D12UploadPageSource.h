@@ -0,0 +1,17 @@
+#pragma once
+#include <d3d12.h>
+#include "UploadAllocator.h"
+
+/// <summary>
+/// UPLOADヒープのバッファをページにするUploadPageSource(作成時にMapしたままにする)
+/// </summary>
+class D3D12UploadPageSource : public UploadPageSource {
+public:
+	explicit D3D12UploadPageSource(ID3D12Device* device);
+
+	bool CreatePage(size_t size, UploadPage& page) override;
+	void DestroyPage(const UploadPage& page) override;
+
+private:
+	ID3D12Device* device_ = nullptr;
+};
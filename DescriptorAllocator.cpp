@@ -0,0 +1,140 @@
+#include "DescriptorAllocator.h"
+#include <cassert>
+
+/// <summary>
+/// 番号の範囲を分ける
+/// </summary>
+/// <param name="capacity">ヒープのディスクリプタ数</param>
+/// <param name="reservedCount">先頭の固定で使う数</param>
+/// <param name="transientCount">末尾のフレームごとに使う数</param>
+DescriptorAllocator::DescriptorAllocator(uint32_t capacity, uint32_t reservedCount, uint32_t transientCount)
+	: capacity_(capacity), persistentBegin_(reservedCount), transientBegin_(capacity - transientCount) {
+	assert(uint64_t(reservedCount) + transientCount <= capacity);
+	stats_.persistentCount = transientBegin_ - persistentBegin_;
+	stats_.transientCount = transientCount;
+	// 小さい番号から使うように後ろから積む
+	freeIndices_.reserve(stats_.persistentCount);
+	for (uint32_t index = transientBegin_; index > persistentBegin_; --index) {
+		freeIndices_.push_back(index - 1);
+	}
+	isAllocated_.resize(capacity_, 0);
+}
+
+/// <summary>
+/// 長く使う番号を取る
+/// </summary>
+/// <returns>番号(空きがなければkInvalidIndex)</returns>
+uint32_t DescriptorAllocator::Allocate() {
+	if (freeIndices_.empty()) {
+		++stats_.failedCount;
+		return kInvalidIndex;
+	}
+	const uint32_t index = freeIndices_.back();
+	freeIndices_.pop_back();
+	assert(!isAllocated_[index]);
+	isAllocated_[index] = 1;
+	++stats_.persistentUsedCount;
+	if (stats_.persistentUsedCount > stats_.peakPersistentUsedCount) {
+		stats_.peakPersistentUsedCount = stats_.persistentUsedCount;
+	}
+	return index;
+}
+
+/// <summary>
+/// 番号を解放する(戻るのは次のSubmitのフェンスをGPUが過ぎてから)
+/// </summary>
+/// <param name="index">Allocateで取った番号</param>
+void DescriptorAllocator::Free(uint32_t index) {
+	assert(index >= persistentBegin_ && index < transientBegin_);
+	assert(isAllocated_[index]);
+	isAllocated_[index] = 0;
+	pendingFrees_.push_back(index);
+	++stats_.pendingFreeCount;
+}
+
+/// <summary>
+/// リングから連続した範囲を切り出す
+/// </summary>
+/// <param name="count">ディスクリプタ数</param>
+/// <returns>先頭の番号(今は空きが足りなければkInvalidIndex)</returns>
+uint32_t DescriptorAllocator::AllocateTransient(uint32_t count) {
+	const uint32_t capacity = stats_.transientCount;
+	if (count == 0 || count > capacity) {
+		++stats_.failedCount;
+		return kInvalidIndex;
+	}
+	// すべて戻っていれば先頭から使う
+	if (transientAllocatedTotal_ == transientRetiredTotal_) {
+		transientHead_ = 0;
+		transientTail_ = 0;
+	}
+
+	uint32_t offset = 0;
+	uint32_t consumed = 0;
+	if (transientHead_ > transientTail_ || transientAllocatedTotal_ == transientRetiredTotal_) {
+		// 使用中の範囲より後ろに入らなければ、末尾を捨てて先頭へ折り返す
+		if (count <= capacity - transientHead_) {
+			offset = transientHead_;
+			consumed = count;
+		} else if (count <= transientTail_) {
+			offset = 0;
+			consumed = capacity - transientHead_ + count;
+		} else {
+			++stats_.failedCount;
+			return kInvalidIndex;
+		}
+	} else {
+		// 折り返した後は使用中の先頭までしか使えない
+		if (count <= transientTail_ - transientHead_) {
+			offset = transientHead_;
+			consumed = count;
+		} else {
+			++stats_.failedCount;
+			return kInvalidIndex;
+		}
+	}
+
+	transientHead_ = offset + count;
+	transientAllocatedTotal_ += consumed;
+	stats_.transientUsedCount = uint32_t(transientAllocatedTotal_ - transientRetiredTotal_);
+	return transientBegin_ + offset;
+}
+
+/// <summary>
+/// それまでの解放とリングの範囲にフェンスの値を付ける
+/// </summary>
+/// <param name="fenceValue">それらを使うコマンドの後に積んだシグナルの値</param>
+void DescriptorAllocator::Submit(uint64_t fenceValue) {
+	const size_t freeCount = pendingFrees_.size() - submittedFreeCount_;
+	if (freeCount == 0 && transientAllocatedTotal_ == transientSubmittedTotal_) {
+		return;
+	}
+	assert(submissions_.empty() || submissions_.back().fenceValue <= fenceValue);
+	submissions_.push_back({ fenceValue, freeCount, transientHead_, transientAllocatedTotal_ });
+	submittedFreeCount_ = pendingFrees_.size();
+	transientSubmittedTotal_ = transientAllocatedTotal_;
+}
+
+/// <summary>
+/// GPUが使い終わった番号と範囲を戻す
+/// </summary>
+/// <param name="completedValue">GPUが処理し終えたシグナルの値</param>
+void DescriptorAllocator::Retire(uint64_t completedValue) {
+	while (!submissions_.empty() && submissions_.front().fenceValue <= completedValue) {
+		const Submission& submission = submissions_.front();
+		for (size_t i = 0; i < submission.freeCount; ++i) {
+			freeIndices_.push_back(pendingFrees_.front());
+			pendingFrees_.pop_front();
+		}
+		submittedFreeCount_ -= submission.freeCount;
+		stats_.persistentUsedCount -= uint32_t(submission.freeCount);
+		stats_.pendingFreeCount -= uint32_t(submission.freeCount);
+		// リングを使わなかったSubmitの位置は、先頭に戻した後では古いことがあるので使わない
+		if (submission.transientTotal > transientRetiredTotal_) {
+			transientTail_ = submission.transientHead;
+			transientRetiredTotal_ = submission.transientTotal;
+		}
+		submissions_.pop_front();
+	}
+	stats_.transientUsedCount = uint32_t(transientAllocatedTotal_ - transientRetiredTotal_);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/// <summary>
+/// ディスクリプタの使用状況
+/// </summary>
+struct DescriptorAllocatorStats {
+	uint32_t persistentCount;     // 長く使う領域の数
+	uint32_t persistentUsedCount; // 使用中(解放してGPUを待っているものを含む)
+	uint32_t pendingFreeCount;    // 解放してGPUを待っている数
+	uint32_t transientCount;      // フレームごとに使う領域の数
+	uint32_t transientUsedCount;  // まだ戻していない数(折り返しで捨てた末尾を含む)
+	uint32_t peakPersistentUsedCount;
+	uint32_t failedCount;         // 空きがなくて失敗した回数
+};
+
+/// <summary>
+/// ディスクリプタヒープの番号を管理する(GPUは触らず、番号だけを扱う)
+/// [0, reservedCount)は固定で使う番号(ImGuiなど)、その後ろを長く使う番号のフリーリスト、
+/// 末尾のtransientCount個をフレームごとに連続した範囲を切り出すリングにする
+/// 解放した番号とリングの範囲は、次のSubmitのフェンスの値をGPUが過ぎたらRetireで戻す
+/// </summary>
+class DescriptorAllocator {
+public:
+	// 空きがないときの番号
+	static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+	DescriptorAllocator(uint32_t capacity, uint32_t reservedCount, uint32_t transientCount);
+
+	// 長く使う番号を1つ取る(空きがなければkInvalidIndex)
+	uint32_t Allocate();
+
+	// 番号を解放する(GPUがまだ使っているかもしれないので、次のSubmitのフェンスを過ぎてから使い回す)
+	void Free(uint32_t index);
+
+	// このフレームだけ使う連続したcount個の先頭の番号を取る(空きがなければkInvalidIndex)
+	uint32_t AllocateTransient(uint32_t count);
+
+	// 前回のSubmitからの解放とリングの範囲は、GPUがfenceValueまで進めば使い終わる
+	void Submit(uint64_t fenceValue);
+
+	// completedValueまでにSubmitしたものを戻す
+	void Retire(uint64_t completedValue);
+
+	uint32_t GetCapacity() const { return capacity_; }
+	const DescriptorAllocatorStats& GetStats() const { return stats_; }
+
+private:
+	struct Submission {
+		uint64_t fenceValue;
+		size_t freeCount;          // このSubmitで解放した番号の数(pendingFrees_の先頭から)
+		uint32_t transientHead;    // Submit時点のリングの書き込み位置
+		uint64_t transientTotal;   // Submit時点のリングの累計
+	};
+
+	uint32_t capacity_;
+	uint32_t persistentBegin_;
+	uint32_t transientBegin_;
+	std::vector<uint32_t> freeIndices_; // 後ろから取る
+	std::vector<uint8_t> isAllocated_;  // 二重解放を見つけるため
+	std::deque<uint32_t> pendingFrees_;
+	size_t submittedFreeCount_ = 0;     // pendingFrees_のうちSubmitしたもの
+	std::deque<Submission> submissions_;
+
+	// リング(RingUploadAllocatorと同じく累計で使用量を数える)
+	uint32_t transientHead_ = 0;
+	uint32_t transientTail_ = 0;
+	uint64_t transientAllocatedTotal_ = 0;
+	uint64_t transientRetiredTotal_ = 0;
+	uint64_t transientSubmittedTotal_ = 0;
+
+	DescriptorAllocatorStats stats_{};
+};
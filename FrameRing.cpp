@@ -0,0 +1,108 @@
+#include "FrameRing.h"
+#include <algorithm>
+#include <cassert>
+
+/// <summary>
+/// フレームのリングを作成する
+/// </summary>
+/// <param name="timeline">GPUのキューとフェンス</param>
+/// <param name="frameCount">同時に送るフレーム数(1～kMaxFrameCount)</param>
+FrameRing::FrameRing(GpuTimeline& timeline, uint32_t frameCount)
+	: timeline_(timeline), frameCount_(std::clamp(frameCount, 1u, kMaxFrameCount)) {
+}
+
+/// <summary>
+/// GPUが資源を使い終わるまで待ってから破棄する
+/// </summary>
+FrameRing::~FrameRing() {
+	WaitForIdle();
+}
+
+/// <summary>
+/// 次のフレームを始める
+/// </summary>
+/// <returns>フレームの番号(0～GetFrameCount()-1)</returns>
+uint32_t FrameRing::BeginFrame() {
+	assert(!isRecording_);
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point beginTime = Clock::now();
+	if (stats_.frameCount > 0) {
+		stats_.frameSeconds += std::chrono::duration<double>(beginTime - lastBeginTime_).count();
+	}
+	lastBeginTime_ = beginTime;
+
+	frameIndex_ = uint32_t(frameNumber_ % frameCount_);
+	// 一周して追いついたときだけ、同じ番号の前回のフレームを待つ
+	const uint64_t waitValue = fenceValues_[frameIndex_];
+	uint64_t completedValue = timeline_.GetCompletedValue();
+	if (completedValue < waitValue) {
+		timeline_.Wait(waitValue);
+		completedValue = timeline_.GetCompletedValue();
+		++stats_.stallCount;
+		stats_.stallSeconds += std::chrono::duration<double>(Clock::now() - beginTime).count();
+	}
+
+	// まだGPUが処理している(CPUと重なっている)フレームを数える
+	uint32_t inFlightCount = 0;
+	for (uint32_t i = 0; i < frameCount_; ++i) {
+		if (fenceValues_[i] > completedValue) {
+			++inFlightCount;
+		}
+	}
+	stats_.inFlightSum += inFlightCount;
+	if (inFlightCount > 0) {
+		++stats_.overlapFrameCount;
+	}
+	++stats_.frameCount;
+	isRecording_ = true;
+	return frameIndex_;
+}
+
+/// <summary>
+/// フレームを送り終えたことを記録する
+/// </summary>
+/// <returns>このフレームのシグナルの値</returns>
+uint64_t FrameRing::EndFrame() {
+	assert(isRecording_);
+	fenceValues_[frameIndex_] = timeline_.Signal();
+	++frameNumber_;
+	isRecording_ = false;
+	return fenceValues_[frameIndex_];
+}
+
+/// <summary>
+/// GPUが空くまで待つ
+/// </summary>
+void FrameRing::WaitForIdle() {
+	uint64_t lastValue = 0;
+	for (uint32_t i = 0; i < kMaxFrameCount; ++i) {
+		lastValue = std::max(lastValue, fenceValues_[i]);
+	}
+	if (timeline_.GetCompletedValue() < lastValue) {
+		timeline_.Wait(lastValue);
+	}
+}
+
+/// <summary>
+/// 同時に送るフレーム数を変える
+/// </summary>
+/// <param name="frameCount">フレーム数(1～kMaxFrameCount)</param>
+void FrameRing::SetFrameCount(uint32_t frameCount) {
+	assert(!isRecording_);
+	frameCount = std::clamp(frameCount, 1u, kMaxFrameCount);
+	if (frameCount == frameCount_) {
+		return;
+	}
+	// 番号と資源の対応が変わるので、すべての資源が空いてから切り替える
+	WaitForIdle();
+	frameCount_ = frameCount;
+	frameNumber_ = 0;
+	ResetStats();
+}
+
+/// <summary>
+/// 統計を0に戻す
+/// </summary>
+void FrameRing::ResetStats() {
+	stats_ = {};
+}
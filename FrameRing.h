@@ -0,0 +1,75 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// GPUのキューとフェンス(フレームの進み具合を知るためだけに使う)
+/// </summary>
+class GpuTimeline {
+public:
+	virtual ~GpuTimeline() = default;
+
+	// これまでに積んだコマンドの後にシグナルを積み、その値を返す(値は1から増えていく)
+	virtual uint64_t Signal() = 0;
+
+	// GPUが処理し終えたシグナルの値
+	virtual uint64_t GetCompletedValue() = 0;
+
+	// GPUがvalueまで処理し終えるまでCPUを止める
+	virtual void Wait(uint64_t value) = 0;
+};
+
+/// <summary>
+/// フレームの統計(CPUとGPUの重なり具合)
+/// </summary>
+struct FrameRingStats {
+	uint64_t frameCount;        // BeginFrameの回数
+	uint64_t stallCount;        // GPUを待った回数
+	uint64_t overlapFrameCount; // GPUが前のフレームを処理している間にCPUが次のフレームを始めた回数
+	uint64_t inFlightSum;       // BeginFrameの時点でGPUが処理中だったフレーム数の合計
+	double stallSeconds;        // GPUを待った時間の合計
+	double frameSeconds;        // BeginFrameから次のBeginFrameまでの時間の合計
+};
+
+/// <summary>
+/// 同時にGPUへ送るフレームのリング
+/// フレームごとの資源(コマンドアロケータ、アップロード用のメモリなど)は呼び出し側が
+/// GetFrameIndex()の番号で持ち、BeginFrameが返した後なら再利用してよい
+/// </summary>
+class FrameRing {
+public:
+	static constexpr uint32_t kMaxFrameCount = 4;
+
+	FrameRing(GpuTimeline& timeline, uint32_t frameCount);
+	~FrameRing();
+	FrameRing(const FrameRing&) = delete;
+	FrameRing& operator=(const FrameRing&) = delete;
+
+	// 次のフレームの番号を返す(GPUがその番号の前回のフレームを処理中なら終わるまで待つ)
+	uint32_t BeginFrame();
+
+	// フレームのコマンドを送った後に呼ぶ(シグナルを積み、その値を返す)
+	uint64_t EndFrame();
+
+	// 送ったすべてのフレームが終わるまで待つ
+	void WaitForIdle();
+
+	// 同時に送るフレーム数を変える(いったんGPUが空くまで待つ)
+	void SetFrameCount(uint32_t frameCount);
+
+	uint32_t GetFrameCount() const { return frameCount_; }
+	uint32_t GetFrameIndex() const { return frameIndex_; }
+	const FrameRingStats& GetStats() const { return stats_; }
+	void ResetStats();
+
+private:
+	GpuTimeline& timeline_;
+	uint32_t frameCount_;
+	uint32_t frameIndex_ = 0;
+	uint64_t frameNumber_ = 0;
+	// 番号ごとの最後のフレームのシグナル(0なら未使用)
+	uint64_t fenceValues_[kMaxFrameCount] = {};
+	bool isRecording_ = false;
+	FrameRingStats stats_{};
+	std::chrono::steady_clock::time_point lastBeginTime_{};
+};
@@ -0,0 +1,290 @@
+#include "FrustumCulling.h"
+#include <cmath>
+
+namespace {
+
+/// <summary>
+/// 平面をSoAに並べたもの(SIMDで同じ平面を複数の物体に当てる)
+/// </summary>
+struct FrustumSoA {
+	float normalX[6];
+	float normalY[6];
+	float normalZ[6];
+	float distance[6];
+	// 境界箱用の法線の絶対値
+	float absNormalX[6];
+	float absNormalY[6];
+	float absNormalZ[6];
+};
+
+FrustumSoA MakeFrustumSoA(const Frustum& frustum) {
+	FrustumSoA soa;
+	for (int i = 0; i < 6; i++) {
+		const Plane& plane = frustum.planes[i];
+		soa.normalX[i] = plane.normal.x;
+		soa.normalY[i] = plane.normal.y;
+		soa.normalZ[i] = plane.normal.z;
+		soa.distance[i] = plane.distance;
+		soa.absNormalX[i] = std::fabs(plane.normal.x);
+		soa.absNormalY[i] = std::fabs(plane.normal.y);
+		soa.absNormalZ[i] = std::fabs(plane.normal.z);
+	}
+	return soa;
+}
+
+/// <summary>
+/// 見えている物体の番号を詰めて書き込む
+/// 分岐しないように毎回書き込み、見えているときだけ書き込み位置を進める
+/// </summary>
+inline size_t AppendVisible(uint32_t mask, uint32_t lanes, uint32_t base, uint32_t* visibleIndices, size_t visibleCount) {
+	for (uint32_t lane = 0; lane < lanes; lane++) {
+		visibleIndices[visibleCount] = base + lane;
+		visibleCount += (mask >> lane) & 1;
+	}
+	return visibleCount;
+}
+
+/// <summary>
+/// 境界球1つの判定(スカラー)
+/// </summary>
+inline bool IsSphereVisible(const FrustumSoA& frustum, const BoundingSphere& sphere) {
+	for (int i = 0; i < 6; i++) {
+		const float d = frustum.normalX[i] * sphere.center.x + frustum.normalY[i] * sphere.center.y +
+			frustum.normalZ[i] * sphere.center.z + frustum.distance[i];
+		if (d < -sphere.radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// 境界箱1つの判定(スカラー)
+/// 中心の距離に、法線の向きへの箱の広がりを足したものが負なら外
+/// </summary>
+inline bool IsBoxVisible(const FrustumSoA& frustum, const BoundingBox& box) {
+	const float centerX = (box.min.x + box.max.x) * 0.5f, extentX = (box.max.x - box.min.x) * 0.5f;
+	const float centerY = (box.min.y + box.max.y) * 0.5f, extentY = (box.max.y - box.min.y) * 0.5f;
+	const float centerZ = (box.min.z + box.max.z) * 0.5f, extentZ = (box.max.z - box.min.z) * 0.5f;
+	for (int i = 0; i < 6; i++) {
+		const float d = frustum.normalX[i] * centerX + frustum.normalY[i] * centerY + frustum.normalZ[i] * centerZ + frustum.distance[i] +
+			frustum.absNormalX[i] * extentX + frustum.absNormalY[i] * extentY + frustum.absNormalZ[i] * extentZ;
+		if (d < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#if SIMD_X86
+
+/// <summary>
+/// 境界球4つの判定(SSE2)。見えているものをビットで返す
+/// </summary>
+inline uint32_t CullSpheres4(const FrustumSoA& frustum, const BoundingSphere* spheres) {
+	// 1つ16byteの球を4つ読んで転置し、x, y, z, 半径をそれぞれ4つ持つ
+	__m128 x = _mm_loadu_ps(&spheres[0].center.x);
+	__m128 y = _mm_loadu_ps(&spheres[1].center.x);
+	__m128 z = _mm_loadu_ps(&spheres[2].center.x);
+	__m128 radius = _mm_loadu_ps(&spheres[3].center.x);
+	_MM_TRANSPOSE4_PS(x, y, z, radius);
+	const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+	__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (int i = 0; i < 6; i++) {
+		const __m128 d = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(x, _mm_set1_ps(frustum.normalX[i])),
+			_mm_mul_ps(y, _mm_set1_ps(frustum.normalY[i]))),
+			_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(frustum.normalZ[i])), _mm_set1_ps(frustum.distance[i])));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negativeRadius));
+	}
+	return uint32_t(_mm_movemask_ps(inside));
+}
+
+/// <summary>
+/// 境界箱4つの判定(SSE2)
+/// </summary>
+inline uint32_t CullBoxes4(const FrustumSoA& frustum, const BoundingBox* boxes) {
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 minX = _mm_setr_ps(boxes[0].min.x, boxes[1].min.x, boxes[2].min.x, boxes[3].min.x);
+	const __m128 minY = _mm_setr_ps(boxes[0].min.y, boxes[1].min.y, boxes[2].min.y, boxes[3].min.y);
+	const __m128 minZ = _mm_setr_ps(boxes[0].min.z, boxes[1].min.z, boxes[2].min.z, boxes[3].min.z);
+	const __m128 maxX = _mm_setr_ps(boxes[0].max.x, boxes[1].max.x, boxes[2].max.x, boxes[3].max.x);
+	const __m128 maxY = _mm_setr_ps(boxes[0].max.y, boxes[1].max.y, boxes[2].max.y, boxes[3].max.y);
+	const __m128 maxZ = _mm_setr_ps(boxes[0].max.z, boxes[1].max.z, boxes[2].max.z, boxes[3].max.z);
+	const __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half), extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+	const __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half), extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+	const __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+	__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (int i = 0; i < 6; i++) {
+		const __m128 distance = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(centerX, _mm_set1_ps(frustum.normalX[i])),
+			_mm_mul_ps(centerY, _mm_set1_ps(frustum.normalY[i]))),
+			_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(frustum.normalZ[i])), _mm_set1_ps(frustum.distance[i])));
+		const __m128 extent = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(extentX, _mm_set1_ps(frustum.absNormalX[i])),
+			_mm_mul_ps(extentY, _mm_set1_ps(frustum.absNormalY[i]))),
+			_mm_mul_ps(extentZ, _mm_set1_ps(frustum.absNormalZ[i])));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+	}
+	return uint32_t(_mm_movemask_ps(inside));
+}
+
+/// <summary>
+/// 境界球8つの判定(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 inline uint32_t CullSpheres8(const FrustumSoA& frustum, const BoundingSphere* spheres) {
+	// 下位レーンに球0～3、上位レーンに球4～7を置き、レーンごとに4x4転置する
+	const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&spheres[0].center.x)), _mm_loadu_ps(&spheres[4].center.x), 1);
+	const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&spheres[1].center.x)), _mm_loadu_ps(&spheres[5].center.x), 1);
+	const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&spheres[2].center.x)), _mm_loadu_ps(&spheres[6].center.x), 1);
+	const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&spheres[3].center.x)), _mm_loadu_ps(&spheres[7].center.x), 1);
+	const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	const __m256 x = _mm256_shuffle_ps(t0, t1, 0x44);
+	const __m256 y = _mm256_shuffle_ps(t0, t1, 0xEE);
+	const __m256 z = _mm256_shuffle_ps(t2, t3, 0x44);
+	const __m256 radius = _mm256_shuffle_ps(t2, t3, 0xEE);
+	const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), radius);
+	__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	for (int i = 0; i < 6; i++) {
+		__m256 d = _mm256_fmadd_ps(x, _mm256_set1_ps(frustum.normalX[i]), _mm256_set1_ps(frustum.distance[i]));
+		d = _mm256_fmadd_ps(y, _mm256_set1_ps(frustum.normalY[i]), d);
+		d = _mm256_fmadd_ps(z, _mm256_set1_ps(frustum.normalZ[i]), d);
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negativeRadius, _CMP_GE_OQ));
+	}
+	return uint32_t(_mm256_movemask_ps(inside));
+}
+
+/// <summary>
+/// 境界箱8つの判定(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 inline uint32_t CullBoxes8(const FrustumSoA& frustum, const BoundingBox* boxes) {
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 minX = _mm256_setr_ps(boxes[0].min.x, boxes[1].min.x, boxes[2].min.x, boxes[3].min.x, boxes[4].min.x, boxes[5].min.x, boxes[6].min.x, boxes[7].min.x);
+	const __m256 minY = _mm256_setr_ps(boxes[0].min.y, boxes[1].min.y, boxes[2].min.y, boxes[3].min.y, boxes[4].min.y, boxes[5].min.y, boxes[6].min.y, boxes[7].min.y);
+	const __m256 minZ = _mm256_setr_ps(boxes[0].min.z, boxes[1].min.z, boxes[2].min.z, boxes[3].min.z, boxes[4].min.z, boxes[5].min.z, boxes[6].min.z, boxes[7].min.z);
+	const __m256 maxX = _mm256_setr_ps(boxes[0].max.x, boxes[1].max.x, boxes[2].max.x, boxes[3].max.x, boxes[4].max.x, boxes[5].max.x, boxes[6].max.x, boxes[7].max.x);
+	const __m256 maxY = _mm256_setr_ps(boxes[0].max.y, boxes[1].max.y, boxes[2].max.y, boxes[3].max.y, boxes[4].max.y, boxes[5].max.y, boxes[6].max.y, boxes[7].max.y);
+	const __m256 maxZ = _mm256_setr_ps(boxes[0].max.z, boxes[1].max.z, boxes[2].max.z, boxes[3].max.z, boxes[4].max.z, boxes[5].max.z, boxes[6].max.z, boxes[7].max.z);
+	const __m256 centerX = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half), extentX = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+	const __m256 centerY = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half), extentY = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+	const __m256 centerZ = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half), extentZ = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+	__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	for (int i = 0; i < 6; i++) {
+		__m256 d = _mm256_fmadd_ps(centerX, _mm256_set1_ps(frustum.normalX[i]), _mm256_set1_ps(frustum.distance[i]));
+		d = _mm256_fmadd_ps(centerY, _mm256_set1_ps(frustum.normalY[i]), d);
+		d = _mm256_fmadd_ps(centerZ, _mm256_set1_ps(frustum.normalZ[i]), d);
+		d = _mm256_fmadd_ps(extentX, _mm256_set1_ps(frustum.absNormalX[i]), d);
+		d = _mm256_fmadd_ps(extentY, _mm256_set1_ps(frustum.absNormalY[i]), d);
+		d = _mm256_fmadd_ps(extentZ, _mm256_set1_ps(frustum.absNormalZ[i]), d);
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+	}
+	return uint32_t(_mm256_movemask_ps(inside));
+}
+
+#endif // SIMD_X86
+
+/// <summary>
+/// 使えない命令セットを使える最上位に丸める
+/// </summary>
+SimdLevel ClampSimdLevel(SimdLevel level) {
+	return level > GetSimdLevel() ? GetSimdLevel() : level;
+}
+
+} // namespace
+
+/// <summary>
+/// ビュー射影行列から視錐台の平面を取り出す
+/// clip = v * M なので、clipの各成分は行列の列との内積になる
+/// </summary>
+/// <param name="viewProjection">ビュー行列 * 射影行列</param>
+/// <returns>法線を正規化した6平面</returns>
+Frustum MakeFrustum(const Matrix4x4& viewProjection) {
+	const float(&m)[4][4] = viewProjection.m;
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w
+	const float coefficients[6][4] = {
+		{ m[0][3] + m[0][0], m[1][3] + m[1][0], m[2][3] + m[2][0], m[3][3] + m[3][0] }, // 左
+		{ m[0][3] - m[0][0], m[1][3] - m[1][0], m[2][3] - m[2][0], m[3][3] - m[3][0] }, // 右
+		{ m[0][3] + m[0][1], m[1][3] + m[1][1], m[2][3] + m[2][1], m[3][3] + m[3][1] }, // 下
+		{ m[0][3] - m[0][1], m[1][3] - m[1][1], m[2][3] - m[2][1], m[3][3] - m[3][1] }, // 上
+		{ m[0][2], m[1][2], m[2][2], m[3][2] },                                         // 近
+		{ m[0][3] - m[0][2], m[1][3] - m[1][2], m[2][3] - m[2][2], m[3][3] - m[3][2] }, // 遠
+	};
+	Frustum frustum;
+	for (int i = 0; i < 6; i++) {
+		const float* c = coefficients[i];
+		const float length = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+		frustum.planes[i] = { { c[0] * inverseLength, c[1] * inverseLength, c[2] * inverseLength }, c[3] * inverseLength };
+	}
+	return frustum;
+}
+
+/// <summary>
+/// 境界球を視錐台で判定し、見えているものの番号を詰める
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="spheres">境界球の配列</param>
+/// <param name="count">数</param>
+/// <param name="visibleIndices">見えている番号の書き込み先(count個分)</param>
+/// <param name="level">使う命令セット</param>
+/// <returns>見えている数</returns>
+size_t CullSpheres(const Frustum& frustum, const BoundingSphere* spheres, size_t count, uint32_t* visibleIndices, SimdLevel level) {
+	const FrustumSoA soa = MakeFrustumSoA(frustum);
+	[[maybe_unused]] const SimdLevel usedLevel = ClampSimdLevel(level);
+	size_t visibleCount = 0;
+	size_t i = 0;
+#if SIMD_X86
+	if (usedLevel == SimdLevel::AVX2) {
+		for (; i + 8 <= count; i += 8) {
+			visibleCount = AppendVisible(CullSpheres8(soa, spheres + i), 8, uint32_t(i), visibleIndices, visibleCount);
+		}
+	}
+	if (usedLevel >= SimdLevel::SSE2) {
+		for (; i + 4 <= count; i += 4) {
+			visibleCount = AppendVisible(CullSpheres4(soa, spheres + i), 4, uint32_t(i), visibleIndices, visibleCount);
+		}
+	}
+#endif
+	// 端数はスカラーで判定
+	for (; i < count; i++) {
+		visibleIndices[visibleCount] = uint32_t(i);
+		visibleCount += IsSphereVisible(soa, spheres[i]) ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+/// <summary>
+/// 境界箱を視錐台で判定し、見えているものの番号を詰める
+/// </summary>
+/// <param name="frustum">視錐台</param>
+/// <param name="boxes">境界箱の配列</param>
+/// <param name="count">数</param>
+/// <param name="visibleIndices">見えている番号の書き込み先(count個分)</param>
+/// <param name="level">使う命令セット</param>
+/// <returns>見えている数</returns>
+size_t CullBoxes(const Frustum& frustum, const BoundingBox* boxes, size_t count, uint32_t* visibleIndices, SimdLevel level) {
+	const FrustumSoA soa = MakeFrustumSoA(frustum);
+	[[maybe_unused]] const SimdLevel usedLevel = ClampSimdLevel(level);
+	size_t visibleCount = 0;
+	size_t i = 0;
+#if SIMD_X86
+	if (usedLevel == SimdLevel::AVX2) {
+		for (; i + 8 <= count; i += 8) {
+			visibleCount = AppendVisible(CullBoxes8(soa, boxes + i), 8, uint32_t(i), visibleIndices, visibleCount);
+		}
+	}
+	if (usedLevel >= SimdLevel::SSE2) {
+		for (; i + 4 <= count; i += 4) {
+			visibleCount = AppendVisible(CullBoxes4(soa, boxes + i), 4, uint32_t(i), visibleIndices, visibleCount);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		visibleIndices[visibleCount] = uint32_t(i);
+		visibleCount += IsBoxVisible(soa, boxes[i]) ? 1 : 0;
+	}
+	return visibleCount;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Matrix4x4.h"
+#include "SimdSupport.h"
+#include "Vector3.h"
+
+/// <summary>
+/// 平面(dot(normal, p) + distance >= 0 が内側)
+/// </summary>
+struct Plane {
+	Vector3 normal;
+	float distance;
+};
+
+/// <summary>
+/// 視錐台の6平面(左、右、下、上、近、遠)
+/// </summary>
+struct Frustum {
+	Plane planes[6];
+};
+
+/// <summary>
+/// 境界球
+/// </summary>
+struct BoundingSphere {
+	Vector3 center;
+	float radius;
+};
+
+/// <summary>
+/// 軸に平行な境界箱
+/// </summary>
+struct BoundingBox {
+	Vector3 min;
+	Vector3 max;
+};
+
+// ビュー射影行列(行ベクトル規約、深度0～1)から視錐台の平面を取り出す(法線は正規化する)
+// ワールド座標の境界で判定するならview * projection、ローカル座標ならworld * view * projectionを渡す
+Frustum MakeFrustum(const Matrix4x4& viewProjection);
+
+// 視錐台と交わる境界球の番号を元の順に詰めてvisibleIndicesへ書き込み、その数を返す
+// visibleIndicesはcount個分の領域を用意すること。levelが使えなければ使える最上位に丸める
+size_t CullSpheres(const Frustum& frustum, const BoundingSphere* spheres, size_t count, uint32_t* visibleIndices,
+	SimdLevel level = GetSimdLevel());
+
+// 境界箱の版(平面ごとに最も内側の頂点で判定するので、角の外側は残ることがある)
+size_t CullBoxes(const Frustum& frustum, const BoundingBox* boxes, size_t count, uint32_t* visibleIndices,
+	SimdLevel level = GetSimdLevel());
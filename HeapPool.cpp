@@ -0,0 +1,124 @@
+#include "HeapPool.h"
+#include <algorithm>
+#include <cassert>
+
+/// <summary>
+/// プールを作成する(ヒープは最初に切り出すときに作る)
+/// </summary>
+/// <param name="heapSource">ヒープの作成と解放</param>
+/// <param name="heapSize">1つのヒープのバイト数</param>
+/// <param name="granularity">切り出す単位のバイト数</param>
+HeapPool::HeapPool(HeapSource& heapSource, uint64_t heapSize, uint64_t granularity)
+	: heapSource_(heapSource), heapSize_(heapSize), granularity_(granularity) {
+	assert(heapSize % granularity == 0);
+}
+
+/// <summary>
+/// すべてのヒープを解放する(ヒープ上のリソースはすべて解放してから破棄すること)
+/// </summary>
+HeapPool::~HeapPool() {
+	for (Heap& heap : heaps_) {
+		if (heap.allocator) {
+			assert(heap.allocator->IsEmpty());
+			heapSource_.DestroyHeap(heap.handle);
+		}
+	}
+}
+
+/// <summary>
+/// 領域を切り出す
+/// </summary>
+/// <param name="size">バイト数</param>
+/// <param name="alignment">オフセットの境界(2のべき乗のバイト数)</param>
+/// <param name="allocation">切り出した領域</param>
+/// <returns>ヒープを作れないか、新しいヒープにも入らなければfalse</returns>
+bool HeapPool::Allocate(uint64_t size, uint64_t alignment, HeapAllocation& allocation) {
+	allocation = {};
+	TlsfAllocation tlsfAllocation{};
+	// 今あるヒープに入れる
+	if (size <= heapSize_) {
+		for (size_t i = 0; i < heaps_.size(); ++i) {
+			Heap& heap = heaps_[i];
+			if (!heap.allocator || heap.isDedicated) {
+				continue;
+			}
+			if (heap.allocator->Allocate(size, alignment, tlsfAllocation)) {
+				allocation = { heap.handle, tlsfAllocation.offset, tlsfAllocation.size, uint32_t(i), tlsfAllocation.block };
+				return true;
+			}
+		}
+	}
+
+	// 入らなければヒープを作る(ヒープより大きければそれだけの専用のヒープ)
+	const bool isDedicated = size > heapSize_;
+	const uint64_t newHeapSize = isDedicated ? (size + granularity_ - 1) & ~(granularity_ - 1) : heapSize_;
+	void* handle = nullptr;
+	if (!heapSource_.CreateHeap(newHeapSize, handle)) {
+		return false;
+	}
+	size_t heapIndex = 0;
+	while (heapIndex < heaps_.size() && heaps_[heapIndex].allocator) {
+		++heapIndex;
+	}
+	if (heapIndex == heaps_.size()) {
+		heaps_.emplace_back();
+	}
+	Heap& heap = heaps_[heapIndex];
+	heap = { handle, std::make_unique<TlsfAllocator>(newHeapSize, granularity_), isDedicated };
+	// ヒープの先頭はどの境界にも合っているので普通は入る。入らなければ(ヒープより大きな境界など)作ったヒープを戻す
+	if (!heap.allocator->Allocate(size, alignment, tlsfAllocation)) {
+		heapSource_.DestroyHeap(handle);
+		heap = {};
+		return false;
+	}
+	allocation = { heap.handle, tlsfAllocation.offset, tlsfAllocation.size, uint32_t(heapIndex), tlsfAllocation.block };
+	return true;
+}
+
+/// <summary>
+/// 領域を戻す(ヒープが空になったら、最後の共有ヒープ以外は解放する)
+/// </summary>
+/// <param name="allocation">Allocateで得た領域</param>
+void HeapPool::Free(const HeapAllocation& allocation) {
+	assert(allocation.heapIndex < heaps_.size() && heaps_[allocation.heapIndex].allocator);
+	Heap& heap = heaps_[allocation.heapIndex];
+	heap.allocator->Free(allocation.block);
+	if (!heap.allocator->IsEmpty()) {
+		return;
+	}
+	if (!heap.isDedicated) {
+		// 作り直しを繰り返さないように、共有ヒープは空でも1つは残す
+		const size_t sharedHeapCount = std::count_if(heaps_.begin(), heaps_.end(),
+			[](const Heap& other) { return other.allocator && !other.isDedicated; });
+		if (sharedHeapCount <= 1) {
+			return;
+		}
+	}
+	heapSource_.DestroyHeap(heap.handle);
+	heap = {};
+}
+
+/// <summary>
+/// すべてのヒープの統計をまとめる
+/// </summary>
+HeapPoolStats HeapPool::GetStats() const {
+	HeapPoolStats stats{};
+	uint64_t freeSize = 0;
+	for (const Heap& heap : heaps_) {
+		if (!heap.allocator) {
+			continue;
+		}
+		const TlsfStats heapStats = heap.allocator->GetStats();
+		++stats.heapCount;
+		stats.allocationCount += heapStats.allocationCount;
+		stats.freeBlockCount += heapStats.freeBlockCount;
+		stats.reservedSize += heapStats.capacity;
+		stats.allocatedSize += heapStats.allocatedSize;
+		stats.largestFreeBlock = std::max(stats.largestFreeBlock, heapStats.largestFreeBlock);
+		freeSize += heapStats.freeSize;
+	}
+	if (freeSize > 0) {
+		stats.fragmentation = 1.0f - float(double(stats.largestFreeBlock) / double(freeSize));
+	}
+	return stats;
+}
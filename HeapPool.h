@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TlsfAllocator.h"
+
+/// <summary>
+/// ヒープの作成と解放(HeapPoolはこれを通してだけヒープを得る)
+/// </summary>
+class HeapSource {
+public:
+	virtual ~HeapSource() = default;
+
+	// sizeバイトのヒープを作る(失敗したらfalse)
+	virtual bool CreateHeap(uint64_t size, void*& heap) = 0;
+
+	// ヒープを解放する
+	virtual void DestroyHeap(void* heap) = 0;
+};
+
+/// <summary>
+/// HeapPoolから切り出した領域
+/// </summary>
+struct HeapAllocation {
+	void* heap;
+	uint64_t offset;
+	uint64_t size;
+	uint32_t heapIndex;
+	uint32_t block;
+};
+
+/// <summary>
+/// プール全体の統計
+/// </summary>
+struct HeapPoolStats {
+	uint32_t heapCount;
+	uint32_t allocationCount;
+	uint32_t freeBlockCount;
+	uint64_t reservedSize;
+	uint64_t allocatedSize;
+	uint64_t largestFreeBlock;
+	float fragmentation; // 1 - 最大の空きブロック / 空きの合計
+};
+
+/// <summary>
+/// 大きなヒープを確保し、TLSFで切り分けて渡すプール
+/// ヒープに入らない大きさは専用のヒープを作り、空いたヒープは1つを残して解放する
+/// </summary>
+class HeapPool {
+public:
+	// heapSizeとgranularity(2のべき乗)はバイト数
+	HeapPool(HeapSource& heapSource, uint64_t heapSize, uint64_t granularity);
+	~HeapPool();
+	HeapPool(const HeapPool&) = delete;
+	HeapPool& operator=(const HeapPool&) = delete;
+
+	// sizeバイトをalignment(2のべき乗)の倍数のオフセットに切り出す(ヒープを作れなければfalse)
+	bool Allocate(uint64_t size, uint64_t alignment, HeapAllocation& allocation);
+
+	// 切り出した領域を戻す
+	void Free(const HeapAllocation& allocation);
+
+	HeapPoolStats GetStats() const;
+
+private:
+	struct Heap {
+		void* handle;
+		std::unique_ptr<TlsfAllocator> allocator;
+		bool isDedicated;
+	};
+
+	HeapSource& heapSource_;
+	uint64_t heapSize_;
+	uint64_t granularity_;
+	// 解放したヒープの番号は空けておき、次に作るヒープで使う(切り出した領域の番号が変わらないように)
+	std::vector<Heap> heaps_;
+};
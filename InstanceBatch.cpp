@@ -0,0 +1,59 @@
+#include "InstanceBatch.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "TransformBatch.h"
+#include "TransformationMatrix.h"
+
+namespace {
+
+// 一度に行列を計算するインスタンス数(作業領域をL1に収める)
+constexpr size_t kChunkSize = 128;
+
+} // namespace
+
+/// <summary>
+/// マテリアル順に並べ、行列を計算して書き込む
+/// </summary>
+/// <param name="instances">シーンのインスタンス</param>
+/// <param name="count">インスタンス数</param>
+/// <param name="materialCount">マテリアル数(materialIndexはこれより小さいこと)</param>
+/// <param name="viewProjection">ビュー行列 * 射影行列</param>
+/// <param name="outputs">count個の書き込み先</param>
+void InstanceBatchBuilder::Build(const SceneInstance* instances, size_t count, uint32_t materialCount, const Matrix4x4& viewProjection, InstanceData* outputs) {
+	// マテリアルごとの数を数えて書き込み位置を決める(計数ソート)
+	offsets_.assign(size_t(materialCount) + 1, 0);
+	for (size_t i = 0; i < count; ++i) {
+		assert(instances[i].materialIndex < materialCount);
+		++offsets_[instances[i].materialIndex + 1];
+	}
+	ranges_.clear();
+	for (uint32_t material = 0; material < materialCount; ++material) {
+		if (offsets_[material + 1] > 0) {
+			ranges_.push_back({ material, offsets_[material], offsets_[material + 1] });
+		}
+		offsets_[material + 1] += offsets_[material];
+	}
+	sortedTransforms_.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		const uint32_t position = offsets_[instances[i].materialIndex]++;
+		sortedTransforms_[position] = instances[i].transform;
+	}
+
+	// 範囲ごとに行列をまとめて計算し、マテリアルの番号を付けて書き込む
+	TransformationMatrix matrices[kChunkSize];
+	for (const InstanceDrawRange& range : ranges_) {
+		for (uint32_t first = 0; first < range.instanceCount; first += uint32_t(kChunkSize)) {
+			const uint32_t chunkCount = std::min<uint32_t>(uint32_t(kChunkSize), range.instanceCount - first);
+			const uint32_t base = range.firstInstance + first;
+			ComputeTransformationMatrices(sortedTransforms_.data() + base, chunkCount, viewProjection, matrices);
+			for (uint32_t i = 0; i < chunkCount; ++i) {
+				InstanceData& output = outputs[base + i];
+				std::memcpy(&output.WVP, &matrices[i].WVP, sizeof(Matrix4x4));
+				std::memcpy(&output.world, &matrices[i].world, sizeof(Matrix4x4));
+				output.materialIndex = range.materialIndex;
+				output.padding[0] = output.padding[1] = output.padding[2] = 0;
+			}
+		}
+	}
+}
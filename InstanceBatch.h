@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.h"
+#include "Transform.h"
+#include "Vector4.h"
+
+/// <summary>
+/// インスタンスごとにStructuredBufferへ書き込むデータ(Object3dInstanced.VS.hlslのInstanceData)
+/// </summary>
+struct InstanceData {
+	Matrix4x4 WVP;
+	Matrix4x4 world;
+	uint32_t materialIndex;
+	uint32_t padding[3];
+};
+
+/// <summary>
+/// インスタンス用のマテリアル(Object3dInstanced.PS.hlslのInstanceMaterial)
+/// </summary>
+struct InstanceMaterial {
+	Vector4 color;
+	uint32_t textureIndex; // SRVヒープの番号
+	int32_t enableLighting;
+	uint32_t padding[2];
+};
+
+/// <summary>
+/// シーンに置くインスタンス
+/// </summary>
+struct SceneInstance {
+	Transform transform;
+	uint32_t materialIndex;
+};
+
+/// <summary>
+/// 同じマテリアルが続く範囲
+/// </summary>
+struct InstanceDrawRange {
+	uint32_t materialIndex;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+/// <summary>
+/// インスタンスをマテリアル順に並べ、行列を計算してInstanceDataの列に書き込む
+/// 並べ替えと行列の作業領域はフレームをまたいで使い回す
+/// </summary>
+class InstanceBatchBuilder {
+public:
+	// instancesをmaterialIndexの順(同じマテリアルでは元の順)に並べてoutputsへ書き込む
+	// outputsはアップロードメモリでもよい(先頭から順に一度だけ書く)
+	void Build(const SceneInstance* instances, size_t count, uint32_t materialCount, const Matrix4x4& viewProjection, InstanceData* outputs);
+
+	// 直前のBuildでのマテリアルごとの範囲(インスタンスのないマテリアルは含まない)
+	const std::vector<InstanceDrawRange>& GetRanges() const { return ranges_; }
+
+private:
+	std::vector<uint32_t> offsets_;
+	std::vector<Transform> sortedTransforms_;
+	std::vector<InstanceDrawRange> ranges_;
+};
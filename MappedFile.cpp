@@ -0,0 +1,100 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+/// <summary>
+/// ファイルを開いてメモリに割り当てる
+/// </summary>
+/// <param name="filePath">ファイルパス</param>
+/// <returns>成功したらtrue(空のファイルも成功でサイズ0)</returns>
+bool MappedFile::Open(const std::string& filePath) {
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	if (size_ == 0) {
+		return true;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Close();
+		return false;
+	}
+	mapping_ = mapping;
+	data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr) {
+		Close();
+		return false;
+	}
+#else
+	const int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status {};
+	if (fstat(file, &status) != 0) {
+		close(file);
+		return false;
+	}
+	size_ = static_cast<size_t>(status.st_size);
+	if (size_ > 0) {
+		void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED) {
+			close(file);
+			size_ = 0;
+			return false;
+		}
+		// 先頭から順に読むので先読みを有効にする
+		madvise(data, size_, MADV_SEQUENTIAL);
+		data_ = static_cast<const char*>(data);
+	}
+	// 割り当て後はファイルを閉じてもよい
+	close(file);
+#endif
+	return true;
+}
+
+/// <summary>
+/// 割り当てを解除してファイルを閉じる
+/// </summary>
+void MappedFile::Close() {
+#ifdef _WIN32
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_) {
+		CloseHandle(static_cast<HANDLE>(mapping_));
+	}
+	if (file_) {
+		CloseHandle(static_cast<HANDLE>(file_));
+	}
+	mapping_ = nullptr;
+	file_ = nullptr;
+#else
+	if (data_) {
+		munmap(const_cast<char*>(data_), size_);
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// 読み込み専用でメモリに割り当てたファイル
+/// </summary>
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// ファイルを開いて割り当てる(失敗したらfalse)
+	bool Open(const std::string& filePath);
+	void Close();
+
+	const char* GetData() const { return data_; }
+	size_t GetSize() const { return size_; }
+
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+};
@@ -0,0 +1,769 @@
+#include "MatrixMath.h"
+#include <atomic>
+#include <cmath>
+#include "SinCos.h"
+
+namespace {
+
+//===============================================
+// スカラー実装
+//===============================================
+
+/// <summary>
+/// 4x4行列の乗算(スカラー)
+/// </summary>
+void MultiplyScalar(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		const float a0 = matrix1.m[row][0];
+		const float a1 = matrix1.m[row][1];
+		const float a2 = matrix1.m[row][2];
+		const float a3 = matrix1.m[row][3];
+		for (int column = 0; column < 4; column++) {
+			result.m[row][column] = a0 * matrix2.m[0][column] + a1 * matrix2.m[1][column] +
+				a2 * matrix2.m[2][column] + a3 * matrix2.m[3][column];
+		}
+	}
+}
+
+/// <summary>
+/// 4x4の逆行列(スカラー)
+/// 上2行と下2行の2x2小行列式を共有して余因子を求める
+/// </summary>
+void InverseScalar(const Matrix4x4& matrix, Matrix4x4& result) {
+	const float(&a)[4][4] = matrix.m;
+
+	const float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+	const float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+	const float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+	const float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+	const float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+	const float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+	const float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+	const float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+	const float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+	const float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+	const float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+	const float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+	// 行列式
+	const float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	const float invDet = 1.0f / determinant;
+
+	// 逆行列 = (1 / 行列式) * 共役行列
+	result.m[0][0] = (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * invDet;
+	result.m[0][1] = (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * invDet;
+	result.m[0][2] = (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * invDet;
+	result.m[0][3] = (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * invDet;
+
+	result.m[1][0] = (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * invDet;
+	result.m[1][1] = (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * invDet;
+	result.m[1][2] = (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * invDet;
+	result.m[1][3] = (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * invDet;
+
+	result.m[2][0] = (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * invDet;
+	result.m[2][1] = (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * invDet;
+	result.m[2][2] = (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * invDet;
+	result.m[2][3] = (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * invDet;
+
+	result.m[3][0] = (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * invDet;
+	result.m[3][1] = (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * invDet;
+	result.m[3][2] = (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * invDet;
+	result.m[3][3] = (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * invDet;
+}
+
+/// <summary>
+/// アフィン行列の逆行列(スカラー)
+/// 3x3部分だけを逆行列にし、平行移動は -t * inv(3x3) で求める
+/// </summary>
+void InverseAffineScalar(const Matrix4x4& matrix, Matrix4x4& result) {
+	const float(&a)[4][4] = matrix.m;
+
+	// 余因子(各行の外積)
+	const float c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+	const float c01 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+	const float c02 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+	const float c10 = a[2][1] * a[0][2] - a[2][2] * a[0][1];
+	const float c11 = a[2][2] * a[0][0] - a[2][0] * a[0][2];
+	const float c12 = a[2][0] * a[0][1] - a[2][1] * a[0][0];
+	const float c20 = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+	const float c21 = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+	const float c22 = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+	const float invDet = 1.0f / (a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02);
+
+	result.m[0][0] = c00 * invDet;
+	result.m[0][1] = c10 * invDet;
+	result.m[0][2] = c20 * invDet;
+	result.m[0][3] = 0.0f;
+	result.m[1][0] = c01 * invDet;
+	result.m[1][1] = c11 * invDet;
+	result.m[1][2] = c21 * invDet;
+	result.m[1][3] = 0.0f;
+	result.m[2][0] = c02 * invDet;
+	result.m[2][1] = c12 * invDet;
+	result.m[2][2] = c22 * invDet;
+	result.m[2][3] = 0.0f;
+
+	for (int column = 0; column < 3; column++) {
+		result.m[3][column] = -(a[3][0] * result.m[0][column] + a[3][1] * result.m[1][column] + a[3][2] * result.m[2][column]);
+	}
+	result.m[3][3] = 1.0f;
+}
+
+/// <summary>
+/// 行ベクトルと行列の乗算(スカラー)
+/// </summary>
+void TransformScalar(const Vector4& vector, const Matrix4x4& matrix, Vector4& result) {
+	const float(&a)[4][4] = matrix.m;
+	result.x = vector.x * a[0][0] + vector.y * a[1][0] + vector.z * a[2][0] + vector.w * a[3][0];
+	result.y = vector.x * a[0][1] + vector.y * a[1][1] + vector.z * a[2][1] + vector.w * a[3][1];
+	result.z = vector.x * a[0][2] + vector.y * a[1][2] + vector.z * a[2][2] + vector.w * a[3][2];
+	result.w = vector.x * a[0][3] + vector.y * a[1][3] + vector.z * a[2][3] + vector.w * a[3][3];
+}
+
+/// <summary>
+/// 行列配列の乗算(スカラー)
+/// </summary>
+void MultiplyArrayScalar(const Matrix4x4* matrices, const Matrix4x4& matrix, Matrix4x4* outputs, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		MultiplyScalar(matrices[i], matrix, outputs[i]);
+	}
+}
+
+#if SIMD_X86
+
+//===============================================
+// SSE2実装
+//===============================================
+
+#define SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), SHUFFLE_MASK(x, y, z, w))
+#define SHUFFLE(v1, v2, x, y, z, w) _mm_shuffle_ps((v1), (v2), SHUFFLE_MASK(x, y, z, w))
+
+/// <summary>
+/// 行ベクトルと行列の乗算(行列の4行を渡す)
+/// </summary>
+inline __m128 TransformRow(__m128 vector, __m128 row0, __m128 row1, __m128 row2, __m128 row3) {
+	__m128 result = _mm_mul_ps(SWIZZLE(vector, 0, 0, 0, 0), row0);
+	result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(vector, 1, 1, 1, 1), row1));
+	result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(vector, 2, 2, 2, 2), row2));
+	result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(vector, 3, 3, 3, 3), row3));
+	return result;
+}
+
+/// <summary>
+/// 4x4行列の乗算(SSE2)
+/// </summary>
+void MultiplySSE2(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	const __m128 b0 = _mm_loadu_ps(matrix2.m[0]);
+	const __m128 b1 = _mm_loadu_ps(matrix2.m[1]);
+	const __m128 b2 = _mm_loadu_ps(matrix2.m[2]);
+	const __m128 b3 = _mm_loadu_ps(matrix2.m[3]);
+	// 先に全行を読んでおくことで result と matrix1 が同じでも正しく動く
+	const __m128 a0 = _mm_loadu_ps(matrix1.m[0]);
+	const __m128 a1 = _mm_loadu_ps(matrix1.m[1]);
+	const __m128 a2 = _mm_loadu_ps(matrix1.m[2]);
+	const __m128 a3 = _mm_loadu_ps(matrix1.m[3]);
+	_mm_storeu_ps(result.m[0], TransformRow(a0, b0, b1, b2, b3));
+	_mm_storeu_ps(result.m[1], TransformRow(a1, b0, b1, b2, b3));
+	_mm_storeu_ps(result.m[2], TransformRow(a2, b0, b1, b2, b3));
+	_mm_storeu_ps(result.m[3], TransformRow(a3, b0, b1, b2, b3));
+}
+
+// 2x2行列(x y / z w)の積 A * B
+inline __m128 Mat2Mul(__m128 a, __m128 b) {
+	return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// 2x2行列の 余因子(A) * B
+inline __m128 Mat2AdjMul(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// 2x2行列の A * 余因子(B)
+inline __m128 Mat2MulAdj(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/// <summary>
+/// 4x4の逆行列(SSE2)
+/// 2x2のブロック行列に分けて余因子を求める
+/// </summary>
+void InverseSSE2(const Matrix4x4& matrix, Matrix4x4& result) {
+	const __m128 row0 = _mm_loadu_ps(matrix.m[0]);
+	const __m128 row1 = _mm_loadu_ps(matrix.m[1]);
+	const __m128 row2 = _mm_loadu_ps(matrix.m[2]);
+	const __m128 row3 = _mm_loadu_ps(matrix.m[3]);
+
+	// | A B |
+	// | C D |
+	const __m128 a = _mm_movelh_ps(row0, row1);
+	const __m128 b = _mm_movehl_ps(row1, row0);
+	const __m128 c = _mm_movelh_ps(row2, row3);
+	const __m128 d = _mm_movehl_ps(row3, row2);
+
+	// (|A| |B| |C| |D|)
+	const __m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(SHUFFLE(row0, row2, 0, 2, 0, 2), SHUFFLE(row1, row3, 1, 3, 1, 3)),
+		_mm_mul_ps(SHUFFLE(row0, row2, 1, 3, 1, 3), SHUFFLE(row1, row3, 0, 2, 0, 2)));
+	const __m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+	const __m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+	const __m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+	const __m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+
+	const __m128 dc = Mat2AdjMul(d, c);
+	const __m128 ab = Mat2AdjMul(a, b);
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 trace = _mm_mul_ps(ab, SWIZZLE(dc, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+	trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+	const __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+	const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+	x = _mm_mul_ps(x, invDet);
+	y = _mm_mul_ps(y, invDet);
+	z = _mm_mul_ps(z, invDet);
+	w = _mm_mul_ps(w, invDet);
+
+	// 余因子の並び替えと書き込みをまとめて行う
+	_mm_storeu_ps(result.m[0], SHUFFLE(x, y, 3, 1, 3, 1));
+	_mm_storeu_ps(result.m[1], SHUFFLE(x, y, 2, 0, 2, 0));
+	_mm_storeu_ps(result.m[2], SHUFFLE(z, w, 3, 1, 3, 1));
+	_mm_storeu_ps(result.m[3], SHUFFLE(z, w, 2, 0, 2, 0));
+}
+
+// 3次元の外積(wは0になる)
+inline __m128 Cross(__m128 a, __m128 b) {
+	return _mm_sub_ps(
+		_mm_mul_ps(SWIZZLE(a, 1, 2, 0, 3), SWIZZLE(b, 2, 0, 1, 3)),
+		_mm_mul_ps(SWIZZLE(a, 2, 0, 1, 3), SWIZZLE(b, 1, 2, 0, 3)));
+}
+
+/// <summary>
+/// アフィン行列の逆行列(SSE2)
+/// </summary>
+void InverseAffineSSE2(const Matrix4x4& matrix, Matrix4x4& result) {
+	const __m128 maskXYZ = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	const __m128 row0 = _mm_and_ps(_mm_loadu_ps(matrix.m[0]), maskXYZ);
+	const __m128 row1 = _mm_and_ps(_mm_loadu_ps(matrix.m[1]), maskXYZ);
+	const __m128 row2 = _mm_and_ps(_mm_loadu_ps(matrix.m[2]), maskXYZ);
+	const __m128 translate = _mm_loadu_ps(matrix.m[3]);
+
+	__m128 c0 = Cross(row1, row2);
+	__m128 c1 = Cross(row2, row0);
+	__m128 c2 = Cross(row0, row1);
+	__m128 c3 = _mm_setzero_ps();
+
+	// 行列式 = row0・(row1 x row2)
+	__m128 determinant = _mm_mul_ps(row0, c0);
+	determinant = _mm_add_ps(determinant, SWIZZLE(determinant, 2, 3, 0, 1));
+	determinant = _mm_add_ps(determinant, SWIZZLE(determinant, 1, 0, 3, 2));
+	const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+	// 余因子を転置したものが逆行列
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	c0 = _mm_mul_ps(c0, invDet);
+	c1 = _mm_mul_ps(c1, invDet);
+	c2 = _mm_mul_ps(c2, invDet);
+
+	__m128 inverseTranslate = _mm_mul_ps(SWIZZLE(translate, 0, 0, 0, 0), c0);
+	inverseTranslate = _mm_add_ps(inverseTranslate, _mm_mul_ps(SWIZZLE(translate, 1, 1, 1, 1), c1));
+	inverseTranslate = _mm_add_ps(inverseTranslate, _mm_mul_ps(SWIZZLE(translate, 2, 2, 2, 2), c2));
+	inverseTranslate = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), inverseTranslate);
+
+	_mm_storeu_ps(result.m[0], c0);
+	_mm_storeu_ps(result.m[1], c1);
+	_mm_storeu_ps(result.m[2], c2);
+	_mm_storeu_ps(result.m[3], inverseTranslate);
+}
+
+/// <summary>
+/// 行ベクトルと行列の乗算(SSE2)
+/// </summary>
+void TransformSSE2(const Vector4& vector, const Matrix4x4& matrix, Vector4& result) {
+	const __m128 v = _mm_loadu_ps(&vector.x);
+	_mm_storeu_ps(&result.x, TransformRow(v,
+		_mm_loadu_ps(matrix.m[0]), _mm_loadu_ps(matrix.m[1]), _mm_loadu_ps(matrix.m[2]), _mm_loadu_ps(matrix.m[3])));
+}
+
+/// <summary>
+/// 行列配列の乗算(SSE2)
+/// </summary>
+void MultiplyArraySSE2(const Matrix4x4* matrices, const Matrix4x4& matrix, Matrix4x4* outputs, size_t count) {
+	const __m128 b0 = _mm_loadu_ps(matrix.m[0]);
+	const __m128 b1 = _mm_loadu_ps(matrix.m[1]);
+	const __m128 b2 = _mm_loadu_ps(matrix.m[2]);
+	const __m128 b3 = _mm_loadu_ps(matrix.m[3]);
+	for (size_t i = 0; i < count; i++) {
+		const __m128 a0 = _mm_loadu_ps(matrices[i].m[0]);
+		const __m128 a1 = _mm_loadu_ps(matrices[i].m[1]);
+		const __m128 a2 = _mm_loadu_ps(matrices[i].m[2]);
+		const __m128 a3 = _mm_loadu_ps(matrices[i].m[3]);
+		_mm_storeu_ps(outputs[i].m[0], TransformRow(a0, b0, b1, b2, b3));
+		_mm_storeu_ps(outputs[i].m[1], TransformRow(a1, b0, b1, b2, b3));
+		_mm_storeu_ps(outputs[i].m[2], TransformRow(a2, b0, b1, b2, b3));
+		_mm_storeu_ps(outputs[i].m[3], TransformRow(a3, b0, b1, b2, b3));
+	}
+}
+
+//===============================================
+// AVX2実装
+//===============================================
+
+/// <summary>
+/// 2行分(ymmの上下128bitに1行ずつ)を右の行列で変換
+/// </summary>
+SIMD_TARGET_AVX2 inline __m256 TransformRows2(__m256 rows, __m256 b0, __m256 b1, __m256 b2, __m256 b3) {
+	__m256 result = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+	result = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1, result);
+	result = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2, result);
+	result = _mm256_fmadd_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3, result);
+	return result;
+}
+
+/// <summary>
+/// 4x4行列の乗算(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 void MultiplyAVX2(const Matrix4x4& matrix1, const Matrix4x4& matrix2, Matrix4x4& result) {
+	const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[0]));
+	const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[1]));
+	const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[2]));
+	const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix2.m[3]));
+	const __m256 a01 = _mm256_loadu_ps(matrix1.m[0]);
+	const __m256 a23 = _mm256_loadu_ps(matrix1.m[2]);
+	_mm256_storeu_ps(result.m[0], TransformRows2(a01, b0, b1, b2, b3));
+	_mm256_storeu_ps(result.m[2], TransformRows2(a23, b0, b1, b2, b3));
+}
+
+/// <summary>
+/// 行列配列の乗算(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 void MultiplyArrayAVX2(const Matrix4x4* matrices, const Matrix4x4& matrix, Matrix4x4* outputs, size_t count) {
+	const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.m[0]));
+	const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.m[1]));
+	const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.m[2]));
+	const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.m[3]));
+	for (size_t i = 0; i < count; i++) {
+		const __m256 a01 = _mm256_loadu_ps(matrices[i].m[0]);
+		const __m256 a23 = _mm256_loadu_ps(matrices[i].m[2]);
+		_mm256_storeu_ps(outputs[i].m[0], TransformRows2(a01, b0, b1, b2, b3));
+		_mm256_storeu_ps(outputs[i].m[2], TransformRows2(a23, b0, b1, b2, b3));
+	}
+}
+
+#undef SHUFFLE
+#undef SWIZZLE
+#undef SHUFFLE_MASK
+
+#endif // SIMD_X86
+
+/// <summary>
+/// 回転行列に拡縮と移動を合成してアフィン行列を作る
+/// 各行を拡縮し、移動の行は t * (S * R) になる
+/// </summary>
+void ComposeAffineMatrix(const Vector3& scale, const float(&rotation)[3][3], const Vector3& translate, Matrix4x4& result) {
+	const float scales[3] = { scale.x, scale.y, scale.z };
+	for (int row = 0; row < 3; row++) {
+		result.m[row][0] = scales[row] * rotation[row][0];
+		result.m[row][1] = scales[row] * rotation[row][1];
+		result.m[row][2] = scales[row] * rotation[row][2];
+		result.m[row][3] = 0.0f;
+	}
+	for (int column = 0; column < 3; column++) {
+		result.m[3][column] = translate.x * result.m[0][column] + translate.y * result.m[1][column] + translate.z * result.m[2][column];
+	}
+	result.m[3][3] = 1.0f;
+}
+
+/// <summary>
+/// アフィン行列(4列目が(0,0,0,1))と任意の行列の乗算
+/// 左の4列目の掛け算を省く
+/// </summary>
+void MultiplyAffine(const Matrix4x4& affine, const Matrix4x4& matrix, Matrix4x4& result) {
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			result.m[row][column] = affine.m[row][0] * matrix.m[0][column] + affine.m[row][1] * matrix.m[1][column] +
+				affine.m[row][2] * matrix.m[2][column] + (row == 3 ? matrix.m[3][column] : 0.0f);
+		}
+	}
+}
+
+/// <summary>
+/// 命令セットごとの関数テーブル
+/// </summary>
+struct MatrixKernels {
+	SimdLevel level;
+	void (*multiply)(const Matrix4x4&, const Matrix4x4&, Matrix4x4&);
+	void (*inverse)(const Matrix4x4&, Matrix4x4&);
+	void (*inverseAffine)(const Matrix4x4&, Matrix4x4&);
+	void (*transform)(const Vector4&, const Matrix4x4&, Vector4&);
+	void (*multiplyArray)(const Matrix4x4*, const Matrix4x4&, Matrix4x4*, size_t);
+};
+
+// 命令セットごとの関数テーブル(書き換えないので、切り替えはポインタの差し替えだけで済む)
+const MatrixKernels kScalarKernels = { SimdLevel::Scalar, MultiplyScalar, InverseScalar, InverseAffineScalar, TransformScalar, MultiplyArrayScalar };
+#if SIMD_X86
+const MatrixKernels kSSE2Kernels = { SimdLevel::SSE2, MultiplySSE2, InverseSSE2, InverseAffineSSE2, TransformSSE2, MultiplyArraySSE2 };
+const MatrixKernels kAVX2Kernels = { SimdLevel::AVX2, MultiplyAVX2, InverseSSE2, InverseAffineSSE2, TransformSSE2, MultiplyArrayAVX2 };
+#endif
+
+/// <summary>
+/// 指定した命令セットの関数テーブルを選ぶ
+/// </summary>
+const MatrixKernels* SelectMatrixKernels(SimdLevel level) {
+	// CPUが対応している範囲に丸める
+	if (level > GetSimdLevel()) {
+		level = GetSimdLevel();
+	}
+#if SIMD_X86
+	if (level == SimdLevel::AVX2) {
+		return &kAVX2Kernels;
+	}
+	if (level == SimdLevel::SSE2) {
+		return &kSSE2Kernels;
+	}
+#endif
+	return &kScalarKernels;
+}
+
+// 現在の関数テーブル(別スレッドのMultiplyなどと同時にSetMatrixMathLevelを呼んでもよい)
+std::atomic<const MatrixKernels*>& GetMatrixKernelsPointer() {
+	static std::atomic<const MatrixKernels*> kernels{ SelectMatrixKernels(GetSimdLevel()) };
+	return kernels;
+}
+
+const MatrixKernels& GetMatrixKernels() {
+	return *GetMatrixKernelsPointer().load(std::memory_order_acquire);
+}
+
+} // namespace
+
+/// <summary>
+/// 行列演算で使う命令セットを変更
+/// </summary>
+/// <param name="level">命令セット</param>
+void SetMatrixMathLevel(SimdLevel level) {
+	GetMatrixKernelsPointer().store(SelectMatrixKernels(level), std::memory_order_release);
+}
+
+/// <summary>
+/// 行列演算で使っている命令セットを取得
+/// </summary>
+/// <returns>命令セット</returns>
+SimdLevel GetMatrixMathLevel() {
+	return GetMatrixKernels().level;
+}
+
+/// <summary>
+/// 4x4の単位行列の作成
+/// </summary>
+/// <returns>4x4の単位行列</returns>
+Matrix4x4 MakeIdentityMatrix4x4() {
+	Matrix4x4 identityMatrix;
+
+	identityMatrix.m[0][0] = 1.0f;
+	identityMatrix.m[0][1] = 0.0f;
+	identityMatrix.m[0][2] = 0.0f;
+	identityMatrix.m[0][3] = 0.0f;
+
+	identityMatrix.m[1][0] = 0.0f;
+	identityMatrix.m[1][1] = 1.0f;
+	identityMatrix.m[1][2] = 0.0f;
+	identityMatrix.m[1][3] = 0.0f;
+
+	identityMatrix.m[2][0] = 0.0f;
+	identityMatrix.m[2][1] = 0.0f;
+	identityMatrix.m[2][2] = 1.0f;
+	identityMatrix.m[2][3] = 0.0f;
+
+	identityMatrix.m[3][0] = 0.0f;
+	identityMatrix.m[3][1] = 0.0f;
+	identityMatrix.m[3][2] = 0.0f;
+	identityMatrix.m[3][3] = 1.0f;
+
+	return identityMatrix;
+}
+
+/// <summary>
+/// 4x4の拡縮行列を作成
+/// </summary>
+/// <param name="scale">scaleの変数</param>
+/// <returns>4x4の拡縮行列</returns>
+Matrix4x4 MakeScaleMatrix(const Vector3& scale) {
+	Matrix4x4 scaleMatirx;
+
+	scaleMatirx.m[0][0] = scale.x;
+	scaleMatirx.m[0][1] = 0.0f;
+	scaleMatirx.m[0][2] = 0.0f;
+	scaleMatirx.m[0][3] = 0.0f;
+
+	scaleMatirx.m[1][0] = 0.0f;
+	scaleMatirx.m[1][1] = scale.y;
+	scaleMatirx.m[1][2] = 0.0f;
+	scaleMatirx.m[1][3] = 0.0f;
+
+	scaleMatirx.m[2][0] = 0.0f;
+	scaleMatirx.m[2][1] = 0.0f;
+	scaleMatirx.m[2][2] = scale.z;
+	scaleMatirx.m[2][3] = 0.0f;
+
+	scaleMatirx.m[3][0] = 0.0f;
+	scaleMatirx.m[3][1] = 0.0f;
+	scaleMatirx.m[3][2] = 0.0f;
+	scaleMatirx.m[3][3] = 1.0f;
+
+	return scaleMatirx;
+}
+
+/// <summary>
+/// z軸の回転行列を作成
+/// </summary>
+/// <param name="rotateZ">rotateZの変数</param>
+/// <returns>z軸の回転行列</returns>
+Matrix4x4 MakeRotateZMatrix(float rotateZ) {
+	Matrix4x4 rotateZMatrix;
+	float sinZ, cosZ;
+	SinCos(rotateZ, sinZ, cosZ);
+
+	rotateZMatrix = {
+		cosZ, sinZ, 0.0f, 0.0f,
+		-sinZ, cosZ, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+
+	return rotateZMatrix;
+}
+
+/// <summary>
+/// MakeAffineMatrix関数
+/// 拡縮・回転・移動の行列を掛け合わせずに、各要素を直接求める
+/// (T * S * (Rx * Ry * Rz) と同じ結果になる)
+/// </summary>
+/// <param name="scale">拡縮</param>
+/// <param name="rotate">回転</param>
+/// <param name="translate">移動</param>
+/// <returns>4x4アフィン行列</returns>
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	float sinX, cosX, sinY, cosY, sinZ, cosZ;
+	SinCos(rotate.x, sinX, cosX);
+	SinCos(rotate.y, sinY, cosY);
+	SinCos(rotate.z, sinZ, cosZ);
+
+	// 回転行列(Rx * Ry * Rz)
+	const float rotation[3][3] = {
+		{ cosY * cosZ, cosY * sinZ, -sinY },
+		{ sinX * sinY * cosZ - cosX * sinZ, sinX * sinY * sinZ + cosX * cosZ, sinX * cosY },
+		{ cosX * sinY * cosZ + sinX * sinZ, cosX * sinY * sinZ - sinX * cosZ, cosX * cosY },
+	};
+
+	Matrix4x4 affineMatrix;
+	ComposeAffineMatrix(scale, rotation, translate, affineMatrix);
+	return affineMatrix;
+}
+
+/// <summary>
+/// MakeAffineMatrix関数(クォータニオン版)
+/// </summary>
+/// <param name="scale">拡縮</param>
+/// <param name="rotate">回転(単位クォータニオン)</param>
+/// <param name="translate">移動</param>
+/// <returns>4x4アフィン行列</returns>
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+	const float xx = rotate.x * rotate.x, yy = rotate.y * rotate.y, zz = rotate.z * rotate.z;
+	const float xy = rotate.x * rotate.y, xz = rotate.x * rotate.z, yz = rotate.y * rotate.z;
+	const float wx = rotate.w * rotate.x, wy = rotate.w * rotate.y, wz = rotate.w * rotate.z;
+
+	// 行ベクトル規約の回転行列
+	const float rotation[3][3] = {
+		{ 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy) },
+		{ 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx) },
+		{ 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy) },
+	};
+
+	Matrix4x4 affineMatrix;
+	ComposeAffineMatrix(scale, rotation, translate, affineMatrix);
+	return affineMatrix;
+}
+
+/// <summary>
+/// オイラー角(X→Y→Zの順に回転)と同じ回転を表すクォータニオンを作成
+/// </summary>
+/// <param name="rotate">オイラー角</param>
+/// <returns>単位クォータニオン</returns>
+Quaternion MakeRotateQuaternion(const Vector3& rotate) {
+	float sinX, cosX, sinY, cosY, sinZ, cosZ;
+	SinCos(rotate.x * 0.5f, sinX, cosX);
+	SinCos(rotate.y * 0.5f, sinY, cosY);
+	SinCos(rotate.z * 0.5f, sinZ, cosZ);
+
+	// qz * qy * qx
+	return {
+		sinX * cosY * cosZ - cosX * sinY * sinZ,
+		cosX * sinY * cosZ + sinX * cosY * sinZ,
+		cosX * cosY * sinZ - sinX * sinY * cosZ,
+		cosX * cosY * cosZ + sinX * sinY * sinZ,
+	};
+}
+
+/// <summary>
+/// ワールド行列とWVP行列を一度に作成
+/// </summary>
+/// <param name="transform">拡縮・回転・移動</param>
+/// <param name="viewProjection">ビュー行列 * 射影行列</param>
+/// <returns>WVP行列とワールド行列</returns>
+TransformationMatrix MakeTransformationMatrix(const Transform& transform, const Matrix4x4& viewProjection) {
+	TransformationMatrix transformationMatrix;
+	transformationMatrix.world = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
+	MultiplyAffine(transformationMatrix.world, viewProjection, transformationMatrix.WVP);
+	return transformationMatrix;
+}
+
+/// <summary>
+/// 平行移動行列の作成
+/// </summary>
+/// <param name="translate"></param>
+/// <returns></returns>
+Matrix4x4 MakeTranslateMatrix(const Vector3& translate) {
+	Matrix4x4 translateMatrix;
+
+	translateMatrix = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		translate.x, translate.y, translate.z, 1.0f
+	};
+
+	return translateMatrix;
+}
+
+/// <summary>
+/// 4x4行列の乗算
+/// </summary>
+/// <param name="matrix1">4x4行列 1</param>
+/// <param name="matrix2">4x4行列 2</param>
+/// <returns>4x4行列の乗算</returns>
+Matrix4x4 Multiply(const Matrix4x4& matrix1, const Matrix4x4& matrix2) {
+	Matrix4x4 multiplyMatrix;
+	GetMatrixKernels().multiply(matrix1, matrix2, multiplyMatrix);
+	return multiplyMatrix;
+}
+
+/// <summary>
+/// 複数の行列に同じ行列を右から掛ける
+/// </summary>
+/// <param name="matrices">左から掛ける行列の配列</param>
+/// <param name="matrix">右から掛ける行列</param>
+/// <param name="outputs">書き込み先(matricesと同じでもよい)</param>
+/// <param name="count">行列の数</param>
+void MultiplyArray(const Matrix4x4* matrices, const Matrix4x4& matrix, Matrix4x4* outputs, size_t count) {
+	GetMatrixKernels().multiplyArray(matrices, matrix, outputs, count);
+}
+
+/// <summary>
+/// 行ベクトルと行列の乗算
+/// </summary>
+/// <param name="vector">行ベクトル</param>
+/// <param name="matrix">行列</param>
+/// <returns>vector * matrix</returns>
+Vector4 Multiply(const Vector4& vector, const Matrix4x4& matrix) {
+	Vector4 result;
+	GetMatrixKernels().transform(vector, matrix, result);
+	return result;
+}
+
+/// <summary>
+/// 座標変換(w = 1として変換し、wで除算する)
+/// </summary>
+/// <param name="point">座標</param>
+/// <param name="matrix">行列</param>
+/// <returns>変換後の座標</returns>
+Vector3 TransformPoint(const Vector3& point, const Matrix4x4& matrix) {
+	Vector4 result = Multiply(Vector4{ point.x, point.y, point.z, 1.0f }, matrix);
+	return { result.x / result.w, result.y / result.w, result.z / result.w };
+}
+
+/// <summary>
+/// MakePerspectiveFovMatirx関数
+/// </summary>
+/// <param name="fovY">画角</param>
+/// <param name="aspectRaito">アスペクト比</param>
+/// <param name="nearClip">近平面への距離</param>
+/// <param name="farClip">遠平面への距離</param>
+/// <returns>透視射影行列</returns>
+Matrix4x4 MakePerspectiveFovMatirx(float fovY, float aspectRaito, float nearClip, float farClip) {
+	Matrix4x4 perspectiveFovMatirx;
+
+	perspectiveFovMatirx = {
+		1.0f / aspectRaito * (cosf(fovY / 2.0f) / sinf(fovY / 2.0f)), 0.0f, 0.0f, 0.0f,
+		0.0f, (cosf(fovY / 2.0f) / sinf(fovY / 2.0f)), 0.0f, 0.0f,
+		0.0f, 0.0f, farClip / (farClip - nearClip), 1.0f,
+		0.0f, 0.0f, -nearClip * farClip / (farClip - nearClip), 0.0f
+	};
+
+	return perspectiveFovMatirx;
+}
+
+/// <summary>
+/// 4x4の逆行列の作成
+/// </summary>
+/// <param name="matrix">元の行列</param>
+/// <returns>逆行列</returns>
+Matrix4x4 Inverse(const Matrix4x4& matrix) {
+	Matrix4x4 inverseMatrix;
+	GetMatrixKernels().inverse(matrix, inverseMatrix);
+	return inverseMatrix;
+}
+
+/// <summary>
+/// アフィン行列(4列目が(0,0,0,1))の逆行列の作成
+/// </summary>
+/// <param name="matrix">元のアフィン行列</param>
+/// <returns>逆行列</returns>
+Matrix4x4 InverseAffine(const Matrix4x4& matrix) {
+	Matrix4x4 inverseMatrix;
+	GetMatrixKernels().inverseAffine(matrix, inverseMatrix);
+	return inverseMatrix;
+}
+
+/// <summary>
+/// MakeOrthographicMatrix関数
+/// </summary>
+/// <param name="left">left</param>
+/// <param name="top">top</param>
+/// <param name="right">right</param>
+/// <param name="bottom">bottom</param>
+/// <param name="nearClip">nearClip</param>
+/// <param name="farClip">farClip</param>
+/// <returns>3次元正射影行列</returns>
+Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
+	Matrix4x4 orthographicMatrix;
+
+	orthographicMatrix.m[0][0] = 2.0f / (right - left);
+	orthographicMatrix.m[0][1] = 0.0f;
+	orthographicMatrix.m[0][2] = 0.0f;
+	orthographicMatrix.m[0][3] = 0.0f;
+
+	orthographicMatrix.m[1][0] = 0.0f;
+	orthographicMatrix.m[1][1] = 2.0f / (top - bottom);
+	orthographicMatrix.m[1][2] = 0.0f;
+	orthographicMatrix.m[1][3] = 0.0f;
+
+	orthographicMatrix.m[2][0] = 0.0f;
+	orthographicMatrix.m[2][1] = 0.0f;
+	orthographicMatrix.m[2][2] = 1.0f / (farClip - nearClip);
+	orthographicMatrix.m[2][3] = 0.0f;
+
+	orthographicMatrix.m[3][0] = (left + right) / (left - right);
+	orthographicMatrix.m[3][1] = (top + bottom) / bottom - top;
+	orthographicMatrix.m[3][2] = (nearClip) / (nearClip - farClip);
+	orthographicMatrix.m[3][3] = 1.0f;
+
+	return orthographicMatrix;
+}
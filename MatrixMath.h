@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include "Matrix4x4.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Quaternion.h"
+#include "Transform.h"
+#include "TransformationMatrix.h"
+#include "SimdSupport.h"
+
+// 行列の生成
+Matrix4x4 MakeIdentityMatrix4x4();
+Matrix4x4 MakeScaleMatrix(const Vector3& scale);
+Matrix4x4 MakeRotateZMatrix(float rotateZ);
+Matrix4x4 MakeTranslateMatrix(const Vector3& translate);
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+Quaternion MakeRotateQuaternion(const Vector3& rotate);
+Matrix4x4 MakePerspectiveFovMatirx(float fovY, float aspectRaito, float nearClip, float farClip);
+Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip);
+
+// 行列の演算(行ベクトル規約: v' = v * M)
+Matrix4x4 Multiply(const Matrix4x4& matrix1, const Matrix4x4& matrix2);
+Matrix4x4 Inverse(const Matrix4x4& matrix);
+Matrix4x4 InverseAffine(const Matrix4x4& matrix);
+Vector4 Multiply(const Vector4& vector, const Matrix4x4& matrix);
+Vector3 TransformPoint(const Vector3& point, const Matrix4x4& matrix);
+
+// ワールド行列とWVP行列を一度に作成(WVP = world * viewProjection)
+TransformationMatrix MakeTransformationMatrix(const Transform& transform, const Matrix4x4& viewProjection);
+
+// 複数の行列に同じ行列を右から掛ける(outputs[i] = matrices[i] * matrix)
+void MultiplyArray(const Matrix4x4* matrices, const Matrix4x4& matrix, Matrix4x4* outputs, size_t count);
+
+// 行列演算で使う命令セットを変更(CPUが対応していない場合は対応している最上位に丸める)
+// 切り替えは関数テーブルのポインタを原子的に差し替えるだけなので、ほかのスレッドが計算中でもよい
+void SetMatrixMathLevel(SimdLevel level);
+SimdLevel GetMatrixMathLevel();
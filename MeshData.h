@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "VertexData.h"
+
+/// <summary>
+/// インデックス付きのメッシュ
+/// </summary>
+struct MeshData {
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+};
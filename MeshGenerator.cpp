@@ -0,0 +1,124 @@
+#include "MeshGenerator.h"
+#include <cassert>
+#include <limits>
+#include "SinCos.h"
+
+namespace {
+
+constexpr float kPi = 3.14159265358979323846f;
+
+} // namespace
+
+/// <summary>
+/// UV球のメッシュを作成する
+/// </summary>
+/// <param name="subdivision">緯度・経度の分割数</param>
+/// <returns>共有頂点とインデックス</returns>
+MeshData GenerateSphereMesh(uint32_t subdivision) {
+	assert(subdivision >= 2);
+	const float kLonEvery = 2.0f * kPi / float(subdivision);
+	const float kLatEvery = kPi / float(subdivision);
+
+	// 緯度・経度ごとのsin/cosを先にまとめて求めておく
+	std::vector<float> sinLat(subdivision + 1), cosLat(subdivision + 1);
+	std::vector<float> sinLon(subdivision + 1), cosLon(subdivision + 1);
+	SinCosSequence(-kPi / 2.0f, kLatEvery, sinLat.data(), cosLat.data(), subdivision + 1);
+	SinCosSequence(0.0f, kLonEvery, sinLon.data(), cosLon.data(), subdivision + 1);
+
+	MeshData mesh;
+	// 極は経度ごとに1つ(UVのため)、それ以外の緯線は継ぎ目の分だけ1つ多く持つ
+	const size_t vertexCount = size_t(subdivision - 1) * (subdivision + 1) + size_t(subdivision) * 2;
+	const size_t triangleCount = size_t(subdivision) * subdivision * 2 - size_t(subdivision) * 2;
+	assert(vertexCount <= std::numeric_limits<uint32_t>::max());
+	mesh.vertices.reserve(vertexCount);
+	mesh.indices.reserve(triangleCount * 3);
+
+	// 緯度・経度のインデックスから頂点を追加する
+	auto addVertex = [&](uint32_t latIndex, uint32_t lonIndex, float u) {
+		VertexData vertex{};
+		vertex.position.x = cosLat[latIndex] * cosLon[lonIndex];
+		vertex.position.y = sinLat[latIndex];
+		vertex.position.z = cosLat[latIndex] * sinLon[lonIndex];
+		vertex.position.w = 1.0f;
+		vertex.texcoord.x = u;
+		vertex.texcoord.y = 1.0f - float(latIndex) / float(subdivision);
+		vertex.normal.x = vertex.position.x;
+		vertex.normal.y = vertex.position.y;
+		vertex.normal.z = vertex.position.z;
+		mesh.vertices.push_back(vertex);
+	};
+
+	// 南極(経度ごとに1つ、UVは区間の中央)
+	const uint32_t southPole = 0;
+	for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+		addVertex(0, lonIndex, (float(lonIndex) + 0.5f) / float(subdivision));
+	}
+	// 中間の緯線
+	const uint32_t ringStart = subdivision;
+	for (uint32_t latIndex = 1; latIndex < subdivision; ++latIndex) {
+		for (uint32_t lonIndex = 0; lonIndex <= subdivision; ++lonIndex) {
+			addVertex(latIndex, lonIndex, float(lonIndex) / float(subdivision));
+		}
+	}
+	// 北極
+	const uint32_t northPole = ringStart + (subdivision - 1) * (subdivision + 1);
+	for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+		addVertex(subdivision, lonIndex, (float(lonIndex) + 0.5f) / float(subdivision));
+	}
+	assert(mesh.vertices.size() == vertexCount);
+
+	// 緯度・経度から中間の緯線の頂点番号
+	auto ring = [&](uint32_t latIndex, uint32_t lonIndex) {
+		return ringStart + (latIndex - 1) * (subdivision + 1) + lonIndex;
+	};
+
+	// 向きは展開していたときと同じ
+	// (lat, lon), (lat + 1, lon), (lat, lon + 1) と (lat + 1, lon), (lat + 1, lon + 1), (lat, lon + 1)
+	for (uint32_t latIndex = 0; latIndex < subdivision; ++latIndex) {
+		for (uint32_t lonIndex = 0; lonIndex < subdivision; ++lonIndex) {
+			if (latIndex == 0) {
+				// 南極側は1つ目の三角形が縮退するので2つ目だけ
+				mesh.indices.push_back(ring(1, lonIndex));
+				mesh.indices.push_back(ring(1, lonIndex + 1));
+				mesh.indices.push_back(southPole + lonIndex);
+			} else if (latIndex == subdivision - 1) {
+				// 北極側は2つ目の三角形が縮退するので1つ目だけ
+				mesh.indices.push_back(ring(latIndex, lonIndex));
+				mesh.indices.push_back(northPole + lonIndex);
+				mesh.indices.push_back(ring(latIndex, lonIndex + 1));
+			} else {
+				mesh.indices.push_back(ring(latIndex, lonIndex));
+				mesh.indices.push_back(ring(latIndex + 1, lonIndex));
+				mesh.indices.push_back(ring(latIndex, lonIndex + 1));
+				mesh.indices.push_back(ring(latIndex + 1, lonIndex));
+				mesh.indices.push_back(ring(latIndex + 1, lonIndex + 1));
+				mesh.indices.push_back(ring(latIndex, lonIndex + 1));
+			}
+		}
+	}
+	assert(mesh.indices.size() == triangleCount * 3);
+	return mesh;
+}
+
+/// <summary>
+/// 16bitインデックスを使えるか
+/// </summary>
+/// <param name="mesh">メッシュ</param>
+/// <returns>すべての頂点番号が16bitに収まるならtrue</returns>
+bool CanUseIndex16(const MeshData& mesh) {
+	return mesh.vertices.size() <= size_t(std::numeric_limits<uint16_t>::max()) + 1;
+}
+
+/// <summary>
+/// インデックスを16bitに変換する
+/// </summary>
+/// <param name="indices">32bitインデックス</param>
+/// <returns>16bitインデックス</returns>
+std::vector<uint16_t> MakeIndices16(const std::vector<uint32_t>& indices) {
+	std::vector<uint16_t> result(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		assert(indices[i] <= std::numeric_limits<uint16_t>::max());
+		result[i] = static_cast<uint16_t>(indices[i]);
+	}
+	return result;
+}
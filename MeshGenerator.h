@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MeshData.h"
+
+// 緯度・経度で分割したUV球を作成(頂点は共有し、極の縮退三角形は作らない)
+// subdivision は 2 以上
+MeshData GenerateSphereMesh(uint32_t subdivision);
+
+// 32bitインデックスを16bitに詰める(頂点数が65536以下のときだけ使える)
+bool CanUseIndex16(const MeshData& mesh);
+std::vector<uint16_t> MakeIndices16(const std::vector<uint32_t>& indices);
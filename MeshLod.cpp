@@ -0,0 +1,69 @@
+#include "MeshLod.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "MeshSimplifier.h"
+#include "VertexCache.h"
+
+/// <summary>
+/// LODの列を作成する
+/// </summary>
+/// <param name="mesh">元のメッシュ(LOD0)</param>
+/// <param name="maxLevelCount">LODの最大の段階数(LOD0を含む)</param>
+/// <param name="reductionRatio">1段階ごとの三角形数の比率(0～1)</param>
+/// <param name="maxError">許容する幾何誤差</param>
+/// <returns>すべての段階のインデックスをつなげたもの</returns>
+MeshLodChain GenerateLodChain(const MeshData& mesh, uint32_t maxLevelCount, float reductionRatio, float maxError) {
+	assert(reductionRatio > 0.0f && reductionRatio < 1.0f);
+	MeshLodChain chain;
+	chain.indices = mesh.indices;
+	chain.lods.push_back({ 0, uint32_t(mesh.indices.size()), 0.0f });
+
+	std::vector<uint32_t> previous = mesh.indices;
+	float previousError = 0.0f;
+	for (uint32_t level = 1; level < maxLevelCount; ++level) {
+		const size_t targetIndexCount = size_t(float(previous.size() / 3) * reductionRatio) * 3;
+		float error = 0.0f;
+		// 前の段階から簡略化する(誤差は段階ごとに増えていくようにする)
+		std::vector<uint32_t> indices = SimplifyMesh(mesh, previous, targetIndexCount, maxError, &error);
+		error = std::max(error, previousError);
+		// ほとんど減らなかったらそれ以上は作らない
+		if (indices.empty() || indices.size() > previous.size() * 9 / 10) {
+			break;
+		}
+		OptimizeVertexCache(indices, mesh.vertices.size());
+		chain.lods.push_back({ uint32_t(chain.indices.size()), uint32_t(indices.size()), error });
+		chain.indices.insert(chain.indices.end(), indices.begin(), indices.end());
+		previous.swap(indices);
+		previousError = error;
+	}
+	return chain;
+}
+
+/// <summary>
+/// 画面上の大きさからLODを選ぶ
+/// </summary>
+/// <param name="chain">LODの列</param>
+/// <param name="worldScale">ワールド行列の最大の拡大率</param>
+/// <param name="distance">カメラからの距離</param>
+/// <param name="fovY">縦の画角(ラジアン)</param>
+/// <param name="screenHeight">画面の高さ(ピクセル)</param>
+/// <param name="pixelThreshold">許容する画面上の誤差(ピクセル)</param>
+/// <returns>LODの番号</returns>
+uint32_t SelectLod(const MeshLodChain& chain, float worldScale, float distance, float fovY, float screenHeight, float pixelThreshold) {
+	if (chain.lods.empty()) {
+		return 0;
+	}
+	// 距離1での1単位が何ピクセルになるか
+	const float pixelsPerUnit = screenHeight * 0.5f / std::tan(fovY * 0.5f);
+	const float safeDistance = std::max(distance, 1e-4f);
+	uint32_t selected = 0;
+	for (uint32_t level = 1; level < uint32_t(chain.lods.size()); ++level) {
+		const float pixels = chain.lods[level].error * worldScale / safeDistance * pixelsPerUnit;
+		if (pixels > pixelThreshold) {
+			break;
+		}
+		selected = level;
+	}
+	return selected;
+}
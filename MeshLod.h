@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MeshData.h"
+
+/// <summary>
+/// LODの1段階(インデックスの範囲と幾何誤差)
+/// </summary>
+struct MeshLod {
+	uint32_t indexStart;
+	uint32_t indexCount;
+	float error;
+};
+
+/// <summary>
+/// 頂点バッファを共有するLODの列(0が最も細かい)
+/// </summary>
+struct MeshLodChain {
+	std::vector<uint32_t> indices;
+	std::vector<MeshLod> lods;
+};
+
+// 段階ごとに三角形数をreductionRatio倍にしたLODを作る(誤差がmaxErrorを超える段階は作らない)
+MeshLodChain GenerateLodChain(const MeshData& mesh, uint32_t maxLevelCount, float reductionRatio, float maxError);
+
+// 画面上の誤差がpixelThreshold以下になる最も粗いLODを選ぶ
+// worldScale: ワールド行列の最大の拡大率、distance: カメラからの距離
+// fovY/screenHeight: 透視投影の縦の画角(ラジアン)と画面の高さ(ピクセル)
+uint32_t SelectLod(const MeshLodChain& chain, float worldScale, float distance, float fovY, float screenHeight, float pixelThreshold);
@@ -0,0 +1,361 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "Vector3.h"
+
+namespace {
+
+/// <summary>
+/// 平面までの距離の二乗和を表す二次形式(対称4x4行列の上三角と重み)
+/// </summary>
+struct Quadric {
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+	double weight;
+};
+
+/// <summary>
+/// 二次形式を足す
+/// </summary>
+void AddQuadric(Quadric& result, const Quadric& quadric) {
+	result.a00 += quadric.a00;
+	result.a01 += quadric.a01;
+	result.a02 += quadric.a02;
+	result.a03 += quadric.a03;
+	result.a11 += quadric.a11;
+	result.a12 += quadric.a12;
+	result.a13 += quadric.a13;
+	result.a22 += quadric.a22;
+	result.a23 += quadric.a23;
+	result.a33 += quadric.a33;
+	result.weight += quadric.weight;
+}
+
+/// <summary>
+/// 平面 ax + by + cz + d = 0 の二次形式(重み付き)
+/// </summary>
+Quadric MakePlaneQuadric(double a, double b, double c, double d, double weight) {
+	return {
+		weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+		weight * b * b, weight * b * c, weight * b * d,
+		weight * c * c, weight * c * d,
+		weight * d * d,
+		weight,
+	};
+}
+
+/// <summary>
+/// 点での平均二乗距離
+/// </summary>
+double EvaluateQuadric(const Quadric& q, const Vector3& p) {
+	const double x = p.x, y = p.y, z = p.z;
+	const double value =
+		q.a00 * x * x + 2.0 * q.a01 * x * y + 2.0 * q.a02 * x * z + 2.0 * q.a03 * x +
+		q.a11 * y * y + 2.0 * q.a12 * y * z + 2.0 * q.a13 * y +
+		q.a22 * z * z + 2.0 * q.a23 * z +
+		q.a33;
+	return q.weight > 0.0 ? std::max(value, 0.0) / q.weight : 0.0;
+}
+
+/// <summary>
+/// 三角形の法線(正規化しない)
+/// </summary>
+Vector3 TriangleNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2) {
+	const Vector3 e1 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+	const Vector3 e2 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+	return { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+}
+
+/// <summary>
+/// 縮約の候補(fromをtoに寄せる)
+/// </summary>
+struct Collapse {
+	uint32_t from;
+	uint32_t to;
+	float cost;
+};
+
+/// <summary>
+/// 同じ位置の頂点をまとめた番号を求める
+/// </summary>
+/// <returns>頂点ごとの位置の番号と、位置の数</returns>
+size_t BuildPositionGroups(const std::vector<Vector3>& positions, std::vector<uint32_t>& groups) {
+	const size_t vertexCount = positions.size();
+	std::vector<uint32_t> order(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i) {
+		order[i] = uint32_t(i);
+	}
+	// ビット列で比較して並べ、同じ位置を隣り合わせる
+	std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+		const int compare = std::memcmp(&positions[lhs], &positions[rhs], sizeof(Vector3));
+		return compare != 0 ? compare < 0 : lhs < rhs;
+	});
+	groups.assign(vertexCount, 0);
+	size_t groupCount = 0;
+	for (size_t i = 0; i < vertexCount; ++i) {
+		if (i > 0 && std::memcmp(&positions[order[i]], &positions[order[i - 1]], sizeof(Vector3)) != 0) {
+			groupCount++;
+		}
+		groups[order[i]] = uint32_t(groupCount);
+	}
+	return vertexCount > 0 ? groupCount + 1 : 0;
+}
+
+/// <summary>
+/// 縮約しても位相が壊れないか(両端に共通の隣接頂点が、辺を挟む三角形の頂点だけか)
+/// </summary>
+/// <param name="scratch">作業用の配列(呼び出しごとに確保しないように使い回す)</param>
+bool SatisfiesLinkCondition(const Collapse& collapse, const std::vector<uint32_t>& indices,
+	const std::vector<uint32_t>& adjacency, const std::vector<uint32_t>& adjacencyOffset, const std::vector<uint32_t>& remap,
+	std::vector<uint32_t> (&scratch)[3]) {
+	std::vector<uint32_t>& fromNeighbors = scratch[0];
+	std::vector<uint32_t>& toNeighbors = scratch[1];
+	std::vector<uint32_t>& opposite = scratch[2];
+	fromNeighbors.clear();
+	toNeighbors.clear();
+	opposite.clear();
+	for (uint32_t a = adjacencyOffset[collapse.from]; a < adjacencyOffset[collapse.from + 1]; ++a) {
+		const uint32_t t = adjacency[a];
+		const uint32_t v[3] = { remap[indices[t * 3]], remap[indices[t * 3 + 1]], remap[indices[t * 3 + 2]] };
+		const bool hasTo = v[0] == collapse.to || v[1] == collapse.to || v[2] == collapse.to;
+		for (uint32_t vertex : v) {
+			if (vertex == collapse.from || vertex == collapse.to) {
+				continue;
+			}
+			fromNeighbors.push_back(vertex);
+			if (hasTo) {
+				opposite.push_back(vertex);
+			}
+		}
+	}
+	for (uint32_t a = adjacencyOffset[collapse.to]; a < adjacencyOffset[collapse.to + 1]; ++a) {
+		const uint32_t t = adjacency[a];
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t vertex = remap[indices[t * 3 + k]];
+			if (vertex != collapse.from && vertex != collapse.to) {
+				toNeighbors.push_back(vertex);
+			}
+		}
+	}
+	for (std::vector<uint32_t>* list : { &fromNeighbors, &toNeighbors, &opposite }) {
+		std::sort(list->begin(), list->end());
+		list->erase(std::unique(list->begin(), list->end()), list->end());
+	}
+	size_t commonCount = 0;
+	for (uint32_t vertex : fromNeighbors) {
+		commonCount += std::binary_search(toNeighbors.begin(), toNeighbors.end(), vertex) ? 1 : 0;
+	}
+	return commonCount == opposite.size();
+}
+
+} // namespace
+
+/// <summary>
+/// メッシュを簡略化する
+/// </summary>
+/// <param name="mesh">頂点を持つメッシュ</param>
+/// <param name="indices">簡略化する三角形リスト</param>
+/// <param name="targetIndexCount">目標のインデックス数</param>
+/// <param name="maxError">許容する幾何誤差</param>
+/// <param name="resultError">実際の誤差の書き込み先</param>
+/// <returns>簡略化した三角形リスト</returns>
+std::vector<uint32_t> SimplifyMesh(const MeshData& mesh, const std::vector<uint32_t>& indices,
+	size_t targetIndexCount, float maxError, float* resultError) {
+	assert(indices.size() % 3 == 0);
+	const size_t vertexCount = mesh.vertices.size();
+	std::vector<Vector3> positions(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i) {
+		positions[i] = { mesh.vertices[i].position.x, mesh.vertices[i].position.y, mesh.vertices[i].position.z };
+	}
+
+	// 同じ位置の頂点(UVの継ぎ目)をまとめる
+	std::vector<uint32_t> groups;
+	const size_t groupCount = BuildPositionGroups(positions, groups);
+	std::vector<uint32_t> groupVertexCount(groupCount, 0);
+	std::vector<bool> isUsed(vertexCount, false);
+	for (uint32_t index : indices) {
+		isUsed[index] = true;
+	}
+	for (size_t i = 0; i < vertexCount; ++i) {
+		if (isUsed[i]) {
+			groupVertexCount[groups[i]]++;
+		}
+	}
+
+	// 位置で見た辺のうち、逆向きの辺がないものは開いた境界
+	std::vector<bool> isLocked(groupCount, false);
+	{
+		std::vector<uint64_t> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int k = 0; k < 3; ++k) {
+				const uint64_t a = groups[indices[i + k]];
+				const uint64_t b = groups[indices[i + (k + 1) % 3]];
+				edges.push_back((a << 32) | b);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		for (uint64_t edge : edges) {
+			const uint64_t reversed = (edge << 32) | (edge >> 32);
+			if (!std::binary_search(edges.begin(), edges.end(), reversed)) {
+				isLocked[edge >> 32] = true;
+				isLocked[edge & 0xffffffffu] = true;
+			}
+		}
+	}
+	for (size_t g = 0; g < groupCount; ++g) {
+		if (groupVertexCount[g] > 1) {
+			isLocked[g] = true;
+		}
+	}
+
+	// 面積で重み付けした面の二次形式を位置ごとに足す
+	std::vector<Quadric> quadrics(groupCount, Quadric{});
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const Vector3& p0 = positions[indices[i]];
+		const Vector3& p1 = positions[indices[i + 1]];
+		const Vector3& p2 = positions[indices[i + 2]];
+		const Vector3 normal = TriangleNormal(p0, p1, p2);
+		const double length = std::sqrt(double(normal.x) * normal.x + double(normal.y) * normal.y + double(normal.z) * normal.z);
+		if (length <= 0.0) {
+			continue;
+		}
+		const double a = normal.x / length, b = normal.y / length, c = normal.z / length;
+		const double d = -(a * p0.x + b * p0.y + c * p0.z);
+		const Quadric quadric = MakePlaneQuadric(a, b, c, d, length * 0.5);
+		for (int k = 0; k < 3; ++k) {
+			AddQuadric(quadrics[groups[indices[i + k]]], quadric);
+		}
+	}
+
+	std::vector<uint32_t> result = indices;
+	const double maxCost = double(maxError) * maxError;
+	double worstCost = 0.0;
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> isTouched(vertexCount);
+	std::vector<uint32_t> linkScratch[3];
+
+	while (result.size() > targetIndexCount) {
+		const size_t triangleCount = result.size() / 3;
+
+		// 頂点ごとの隣接三角形
+		std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+		for (uint32_t index : result) {
+			adjacencyOffset[index + 1]++;
+		}
+		for (size_t i = 0; i < vertexCount; ++i) {
+			adjacencyOffset[i + 1] += adjacencyOffset[i];
+		}
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i) {
+				adjacency[cursor[result[i]]++] = uint32_t(i / 3);
+			}
+		}
+
+		// 縮約の候補を誤差の小さい順に並べる
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (int k = 0; k < 3; ++k) {
+				const uint32_t a = result[i + k];
+				const uint32_t b = result[i + (k + 1) % 3];
+				for (const auto& [from, to] : { std::pair{ a, b }, std::pair{ b, a } }) {
+					if (isLocked[groups[from]] || groups[from] == groups[to]) {
+						continue;
+					}
+					Quadric quadric = quadrics[groups[from]];
+					AddQuadric(quadric, quadrics[groups[to]]);
+					const double cost = EvaluateQuadric(quadric, positions[to]);
+					if (cost <= maxCost) {
+						collapses.push_back({ from, to, float(cost) });
+					}
+				}
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+			if (lhs.cost != rhs.cost) {
+				return lhs.cost < rhs.cost;
+			}
+			return lhs.from != rhs.from ? lhs.from < rhs.from : lhs.to < rhs.to;
+		});
+
+		// 1回の走査では1つの頂点が関わる縮約は1回だけにする
+		for (size_t i = 0; i < vertexCount; ++i) {
+			remap[i] = uint32_t(i);
+		}
+		std::fill(isTouched.begin(), isTouched.end(), false);
+		size_t removedTriangles = 0;
+		const size_t removeLimit = triangleCount - targetIndexCount / 3;
+		size_t appliedCount = 0;
+		for (const Collapse& collapse : collapses) {
+			if (removedTriangles >= removeLimit) {
+				break;
+			}
+			if (isTouched[collapse.from] || isTouched[collapse.to]) {
+				continue;
+			}
+			// 寄せた後に向きが反転する三角形があれば縮約しない
+			bool isFlipped = false;
+			size_t degenerateCount = 0;
+			for (uint32_t a = adjacencyOffset[collapse.from]; a < adjacencyOffset[collapse.from + 1] && !isFlipped; ++a) {
+				const uint32_t t = adjacency[a];
+				uint32_t v[3] = { remap[result[t * 3]], remap[result[t * 3 + 1]], remap[result[t * 3 + 2]] };
+				if (v[0] == collapse.to || v[1] == collapse.to || v[2] == collapse.to) {
+					degenerateCount++;
+					continue;
+				}
+				const Vector3 before = TriangleNormal(positions[v[0]], positions[v[1]], positions[v[2]]);
+				for (uint32_t& vertex : v) {
+					if (vertex == collapse.from) {
+						vertex = collapse.to;
+					}
+				}
+				const Vector3 after = TriangleNormal(positions[v[0]], positions[v[1]], positions[v[2]]);
+				const float dot = before.x * after.x + before.y * after.y + before.z * after.z;
+				isFlipped = dot <= 0.0f;
+			}
+			if (isFlipped || !SatisfiesLinkCondition(collapse, result, adjacency, adjacencyOffset, remap, linkScratch)) {
+				continue;
+			}
+			remap[collapse.from] = collapse.to;
+			isTouched[collapse.from] = true;
+			isTouched[collapse.to] = true;
+			AddQuadric(quadrics[groups[collapse.to]], quadrics[groups[collapse.from]]);
+			worstCost = std::max(worstCost, double(collapse.cost));
+			removedTriangles += degenerateCount;
+			appliedCount++;
+		}
+		if (appliedCount == 0) {
+			break;
+		}
+
+		// 縮約を反映し、つぶれた三角形を取り除く
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const uint32_t v0 = remap[result[i]], v1 = remap[result[i + 1]], v2 = remap[result[i + 2]];
+			if (v0 == v1 || v1 == v2 || v2 == v0) {
+				continue;
+			}
+			result[write++] = v0;
+			result[write++] = v1;
+			result[write++] = v2;
+		}
+		result.resize(write);
+	}
+
+	if (resultError) {
+		*resultError = float(std::sqrt(worstCost));
+	}
+	return result;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshData.h"
+
+// 二次誤差(QEM)による辺の縮約でメッシュを簡略化する
+// 頂点は既存のものに寄せるだけなので、頂点バッファは元のメッシュのものをそのまま使える
+// UVの継ぎ目(同じ位置に複数の頂点がある)と開いた境界の頂点は動かさない
+//
+// indices         : 簡略化する三角形リスト(mesh.verticesを指す)
+// targetIndexCount: 目標のインデックス数(これ以下になるか、これ以上縮約できなくなるまで続ける)
+// maxError        : 許容する幾何誤差(元の面からの二乗平均距離、メッシュの座標系の単位)
+// resultError     : 実際の誤差の書き込み先(nullptrでもよい)
+std::vector<uint32_t> SimplifyMesh(const MeshData& mesh, const std::vector<uint32_t>& indices,
+	size_t targetIndexCount, float maxError, float* resultError = nullptr);
@@ -0,0 +1,365 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr uint8_t kNotInMeshlet = 0xFF;
+
+// 候補の評価で新しい頂点数に足す重み
+// 法線がメッシュレットの平均に近いもの(コーンが狭くなる)、中心に近いもの(球が小さくなる)、
+// 周りに未使用の三角形が少ないもの(取り残された小さなメッシュレットができにくい)を優先する
+constexpr float kConeWeight = 0.5f;
+constexpr float kDistanceWeight = 0.5f;
+constexpr float kLiveWeight = 0.1f;
+
+Vector3 Subtract(const Vector3& a, const Vector3& b) {
+	return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+float Dot(const Vector3& a, const Vector3& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+float Length(const Vector3& v) {
+	return std::sqrt(Dot(v, v));
+}
+
+Vector3 Normalize(const Vector3& v) {
+	const float length = Length(v);
+	return length > 0.0f ? Vector3{ v.x / length, v.y / length, v.z / length } : Vector3{ 0.0f, 0.0f, 0.0f };
+}
+
+Vector3 ToVector3(const Vector4& v) {
+	return { v.x, v.y, v.z };
+}
+
+/// <summary>
+/// 三角形の単位法線(面積が0なら0ベクトル)
+/// </summary>
+Vector3 TriangleUnitNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2) {
+	const Vector3 e1 = Subtract(p1, p0);
+	const Vector3 e2 = Subtract(p2, p0);
+	return Normalize({ e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x });
+}
+
+/// <summary>
+/// 点を囲む球(Ritterの方法。最小ではないが十分に小さい。点がなければ原点で半径0)
+/// </summary>
+void ComputeBoundingSphere(const Vector3* points, size_t count, Vector3& center, float& radius) {
+	if (count == 0) {
+		center = { 0.0f, 0.0f, 0.0f };
+		radius = 0.0f;
+		return;
+	}
+	// 各軸で最も離れた2点のうち、一番長い組を初期の直径にする
+	size_t minIndex[3] = {}, maxIndex[3] = {};
+	for (size_t i = 1; i < count; ++i) {
+		const float p[3] = { points[i].x, points[i].y, points[i].z };
+		for (int axis = 0; axis < 3; ++axis) {
+			const float minValue[3] = { points[minIndex[0]].x, points[minIndex[1]].y, points[minIndex[2]].z };
+			const float maxValue[3] = { points[maxIndex[0]].x, points[maxIndex[1]].y, points[maxIndex[2]].z };
+			if (p[axis] < minValue[axis]) {
+				minIndex[axis] = i;
+			}
+			if (p[axis] > maxValue[axis]) {
+				maxIndex[axis] = i;
+			}
+		}
+	}
+	int bestAxis = 0;
+	float bestDistance = -1.0f;
+	for (int axis = 0; axis < 3; ++axis) {
+		const Vector3 d = Subtract(points[maxIndex[axis]], points[minIndex[axis]]);
+		if (Dot(d, d) > bestDistance) {
+			bestDistance = Dot(d, d);
+			bestAxis = axis;
+		}
+	}
+	const Vector3& a = points[minIndex[bestAxis]];
+	const Vector3& b = points[maxIndex[bestAxis]];
+	center = { (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f };
+	radius = std::sqrt(bestDistance) * 0.5f;
+
+	// はみ出した点を含むように広げる
+	for (size_t i = 0; i < count; ++i) {
+		const Vector3 d = Subtract(points[i], center);
+		const float distance = Length(d);
+		if (distance > radius) {
+			const float newRadius = (radius + distance) * 0.5f;
+			const float shift = (newRadius - radius) / distance;
+			center = { center.x + d.x * shift, center.y + d.y * shift, center.z + d.z * shift };
+			radius = newRadius;
+		}
+	}
+}
+
+/// <summary>
+/// メッシュレットの境界球と法線コーンを求める
+/// </summary>
+MeshletBounds ComputeMeshletBounds(const MeshletData& data, const Meshlet& meshlet, const std::vector<VertexData>& vertices) {
+	MeshletBounds bounds{};
+	// 頂点がなければ大きさ0の球で、コーンでは捨てない
+	if (meshlet.vertexCount == 0) {
+		bounds.coneCutoff = 1.0f;
+		return bounds;
+	}
+	Vector3 points[kMeshletMaxVertices]{};
+	for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+		points[i] = ToVector3(vertices[data.vertices[meshlet.vertexOffset + i]].position);
+	}
+	ComputeBoundingSphere(points, meshlet.vertexCount, bounds.center, bounds.radius);
+
+	// 面積のある三角形の法線の平均をコーンの軸にする
+	Vector3 normals[kMeshletMaxTriangles];
+	uint32_t normalCount = 0;
+	Vector3 axis = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+		const uint8_t* triangle = &data.triangles[meshlet.triangleOffset + t * 3];
+		const Vector3 normal = TriangleUnitNormal(points[triangle[0]], points[triangle[1]], points[triangle[2]]);
+		if (Dot(normal, normal) == 0.0f) {
+			continue;
+		}
+		normals[normalCount++] = normal;
+		axis = { axis.x + normal.x, axis.y + normal.y, axis.z + normal.z };
+	}
+	axis = Normalize(axis);
+	float minDot = 1.0f;
+	for (uint32_t i = 0; i < normalCount; ++i) {
+		minDot = std::min(minDot, Dot(normals[i], axis));
+	}
+	bounds.coneAxis = axis;
+	bounds.coneApex = bounds.center;
+	// 法線が半球以上に広がっていたら裏向き判定はできない
+	if (normalCount == 0 || minDot <= 0.0f) {
+		bounds.coneCutoff = 1.0f;
+		return bounds;
+	}
+	bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+
+	// 頂点をすべての三角形の平面の裏側に置く(軸の逆向きに中心から下げる)
+	float maxT = 0.0f;
+	for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+		const uint8_t* triangle = &data.triangles[meshlet.triangleOffset + t * 3];
+		const Vector3& p0 = points[triangle[0]];
+		const Vector3 normal = TriangleUnitNormal(p0, points[triangle[1]], points[triangle[2]]);
+		const float dn = Dot(normal, axis);
+		if (dn <= 0.0f) {
+			continue;
+		}
+		maxT = std::max(maxT, Dot(Subtract(bounds.center, p0), normal) / dn);
+	}
+	bounds.coneApex = { bounds.center.x - axis.x * maxT, bounds.center.y - axis.y * maxT, bounds.center.z - axis.z * maxT };
+	return bounds;
+}
+
+}
+
+/// <summary>
+/// 三角形をメッシュレットに分ける
+/// </summary>
+/// <param name="vertices">頂点(インデックスが指すもの)</param>
+/// <param name="indices">三角形のインデックス(頂点キャッシュ順に並べておくと分割がまとまりやすい)</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="output">追加先</param>
+void BuildMeshlets(const std::vector<VertexData>& vertices, const uint32_t* indices, size_t indexCount, MeshletData& output) {
+	assert(indexCount % 3 == 0);
+	const size_t triangleCount = indexCount / 3;
+	const size_t vertexCount = vertices.size();
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// 頂点から三角形への隣接(CSR)
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t i = 0; i < indexCount; ++i) {
+		assert(indices[i] < vertexCount);
+		++adjacencyOffset[indices[i] + 1];
+	}
+	for (size_t v = 0; v < vertexCount; ++v) {
+		adjacencyOffset[v + 1] += adjacencyOffset[v];
+	}
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indexCount; ++i) {
+			adjacency[cursor[indices[i]]++] = uint32_t(i / 3);
+		}
+	}
+	std::vector<Vector3> triangleNormals(triangleCount);
+	std::vector<Vector3> triangleCentroids(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		const Vector3 p0 = ToVector3(vertices[indices[t * 3 + 0]].position);
+		const Vector3 p1 = ToVector3(vertices[indices[t * 3 + 1]].position);
+		const Vector3 p2 = ToVector3(vertices[indices[t * 3 + 2]].position);
+		triangleNormals[t] = TriangleUnitNormal(p0, p1, p2);
+		triangleCentroids[t] = { (p0.x + p1.x + p2.x) / 3.0f, (p0.y + p1.y + p2.y) / 3.0f, (p0.z + p1.z + p2.z) / 3.0f };
+	}
+
+	std::vector<bool> isEmitted(triangleCount, false);
+	std::vector<uint8_t> localIndex(vertexCount, kNotInMeshlet);
+	// 頂点ごとの未使用の三角形数(取り残された三角形が出にくいように、残りが少ない所から使う)
+	std::vector<uint32_t> liveTriangleCount(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v) {
+		liveTriangleCount[v] = adjacencyOffset[v + 1] - adjacencyOffset[v];
+	}
+	size_t seedCursor = 0;
+	Meshlet previousMeshlet{};
+	size_t emittedCount = 0;
+
+	Meshlet meshlet{ uint32_t(output.vertices.size()), uint32_t(output.triangles.size()), 0, 0 };
+	Vector3 normalSum = { 0.0f, 0.0f, 0.0f };
+	Vector3 positionSum = { 0.0f, 0.0f, 0.0f };
+
+	auto finishMeshlet = [&]() {
+		previousMeshlet = meshlet;
+		output.meshlets.push_back(meshlet);
+		output.bounds.push_back(ComputeMeshletBounds(output, meshlet, vertices));
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+			localIndex[output.vertices[meshlet.vertexOffset + i]] = kNotInMeshlet;
+		}
+		meshlet = { uint32_t(output.vertices.size()), uint32_t(output.triangles.size()), 0, 0 };
+		normalSum = { 0.0f, 0.0f, 0.0f };
+		positionSum = { 0.0f, 0.0f, 0.0f };
+	};
+
+	while (emittedCount < triangleCount) {
+		// 次に足す三角形を選ぶ
+		size_t best = SIZE_MAX;
+		if (meshlet.triangleCount == 0) {
+			// 直前のメッシュレットに接する三角形から、周りの残りが最も少ないものを始点にする
+			uint32_t bestLiveCount = 0;
+			for (uint32_t i = 0; i < previousMeshlet.vertexCount; ++i) {
+				const uint32_t vertex = output.vertices[previousMeshlet.vertexOffset + i];
+				for (uint32_t a = adjacencyOffset[vertex]; a < adjacencyOffset[vertex + 1]; ++a) {
+					const uint32_t triangle = adjacency[a];
+					if (isEmitted[triangle]) {
+						continue;
+					}
+					const uint32_t liveCount =
+						liveTriangleCount[indices[triangle * 3 + 0]] +
+						liveTriangleCount[indices[triangle * 3 + 1]] +
+						liveTriangleCount[indices[triangle * 3 + 2]];
+					if (best == SIZE_MAX || liveCount < bestLiveCount || (liveCount == bestLiveCount && triangle < best)) {
+						best = triangle;
+						bestLiveCount = liveCount;
+					}
+				}
+			}
+			// 接する三角形がなければ(別の連結成分)元の順で次の三角形にする
+			if (best == SIZE_MAX) {
+				while (isEmitted[seedCursor]) {
+					++seedCursor;
+				}
+				best = seedCursor;
+			}
+		} else {
+			// メッシュレットの頂点を共有する三角形から、新しい頂点が少なく向きが揃うものを選ぶ
+			const Vector3 axis = Normalize(normalSum);
+			const float inverseCount = 1.0f / float(meshlet.vertexCount);
+			const Vector3 center = { positionSum.x * inverseCount, positionSum.y * inverseCount, positionSum.z * inverseCount };
+			float radius = 0.0f;
+			for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+				radius = std::max(radius, Length(Subtract(ToVector3(vertices[output.vertices[meshlet.vertexOffset + i]].position), center)));
+			}
+			const float inverseRadius = radius > 0.0f ? 1.0f / radius : 0.0f;
+			float bestScore = 0.0f;
+			for (uint32_t i = 0; i < meshlet.vertexCount; ++i) {
+				const uint32_t vertex = output.vertices[meshlet.vertexOffset + i];
+				for (uint32_t a = adjacencyOffset[vertex]; a < adjacencyOffset[vertex + 1]; ++a) {
+					const uint32_t triangle = adjacency[a];
+					if (isEmitted[triangle]) {
+						continue;
+					}
+					uint32_t newVertexCount = 0;
+					for (int corner = 0; corner < 3; ++corner) {
+						newVertexCount += localIndex[indices[triangle * 3 + corner]] == kNotInMeshlet ? 1 : 0;
+					}
+					if (meshlet.vertexCount + newVertexCount > kMeshletMaxVertices) {
+						continue;
+					}
+					const uint32_t liveCount =
+						liveTriangleCount[indices[triangle * 3 + 0]] +
+						liveTriangleCount[indices[triangle * 3 + 1]] +
+						liveTriangleCount[indices[triangle * 3 + 2]];
+					const float score = float(newVertexCount) +
+						kConeWeight * (1.0f - Dot(triangleNormals[triangle], axis)) +
+						kDistanceWeight * Length(Subtract(triangleCentroids[triangle], center)) * inverseRadius +
+						kLiveWeight * float(liveCount);
+					if (best == SIZE_MAX || score < bestScore || (score == bestScore && triangle < best)) {
+						best = triangle;
+						bestScore = score;
+					}
+				}
+			}
+			// 隣に足せる三角形がなければ次のメッシュレットにする
+			if (best == SIZE_MAX) {
+				finishMeshlet();
+				continue;
+			}
+		}
+
+		// 三角形を追加する
+		output.triangles.resize(output.triangles.size() + 3);
+		uint8_t* triangle = &output.triangles[output.triangles.size() - 3];
+		for (int corner = 0; corner < 3; ++corner) {
+			const uint32_t vertex = indices[best * 3 + corner];
+			if (localIndex[vertex] == kNotInMeshlet) {
+				localIndex[vertex] = uint8_t(meshlet.vertexCount++);
+				output.vertices.push_back(vertex);
+				const Vector4& position = vertices[vertex].position;
+				positionSum = { positionSum.x + position.x, positionSum.y + position.y, positionSum.z + position.z };
+			}
+			triangle[corner] = localIndex[vertex];
+		}
+		++meshlet.triangleCount;
+		const Vector3& normal = triangleNormals[best];
+		normalSum = { normalSum.x + normal.x, normalSum.y + normal.y, normalSum.z + normal.z };
+		isEmitted[best] = true;
+		++emittedCount;
+		for (int corner = 0; corner < 3; ++corner) {
+			--liveTriangleCount[indices[best * 3 + corner]];
+		}
+
+		// 上限に達したら閉じる(頂点は三角形1つ分の余地がなければ閉じる)
+		if (meshlet.triangleCount == kMeshletMaxTriangles || meshlet.vertexCount + 1 > kMeshletMaxVertices) {
+			finishMeshlet();
+		}
+	}
+	if (meshlet.triangleCount > 0) {
+		finishMeshlet();
+	}
+}
+
+/// <summary>
+/// メッシュレットが視点から完全に裏向きか
+/// </summary>
+/// <param name="bounds">メッシュレットの境界</param>
+/// <param name="eye">視点(メッシュのローカル座標)</param>
+/// <returns>すべての三角形が裏向きならtrue</returns>
+bool IsMeshletBackfacing(const MeshletBounds& bounds, const Vector3& eye) {
+	// 視点がコーンの頂点から軸の逆向きに広がる領域の中にあれば、すべての三角形の平面の裏側にいる
+	const Vector3 direction = Subtract(bounds.coneApex, eye);
+	return Dot(direction, bounds.coneAxis) > bounds.coneCutoff * Length(direction);
+}
+
+/// <summary>
+/// 裏向きのメッシュレットを除く
+/// </summary>
+/// <param name="data">メッシュレットの列</param>
+/// <param name="eye">視点(メッシュのローカル座標)</param>
+/// <param name="visibleMeshlets">残ったメッシュレットの番号</param>
+/// <returns>残った三角形数</returns>
+uint32_t CullMeshlets(const MeshletData& data, const Vector3& eye, std::vector<uint32_t>& visibleMeshlets) {
+	visibleMeshlets.clear();
+	uint32_t triangleCount = 0;
+	for (size_t i = 0; i < data.bounds.size(); ++i) {
+		if (IsMeshletBackfacing(data.bounds[i], eye)) {
+			continue;
+		}
+		visibleMeshlets.push_back(uint32_t(i));
+		triangleCount += data.meshlets[i].triangleCount;
+	}
+	return triangleCount;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector3.h"
+#include "VertexData.h"
+
+// 1つのメッシュレットに入れる頂点数と三角形数の上限
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+/// <summary>
+/// メッシュレット(頂点と三角形の範囲)
+/// </summary>
+struct Meshlet {
+	uint32_t vertexOffset;   // MeshletData::vertices の先頭
+	uint32_t triangleOffset; // MeshletData::triangles の先頭(3要素で1三角形)
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+};
+
+/// <summary>
+/// メッシュレットの境界球と法線コーン(メッシュのローカル座標)
+/// </summary>
+struct MeshletBounds {
+	Vector3 center;
+	float radius;
+	Vector3 coneApex;
+	float coneCutoff; // sin(コーンの半角)。1ならカリングできない
+	Vector3 coneAxis;
+};
+
+/// <summary>
+/// メッシュレットの列(カリングで見る境界は別の配列にまとめる)
+/// </summary>
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> bounds;
+	std::vector<uint32_t> vertices; // 元の頂点番号
+	std::vector<uint8_t> triangles; // メッシュレット内の頂点番号
+};
+
+// インデックス付きの三角形をメッシュレットに分けてoutputの後ろに追加する
+// 隣接する三角形を新しい頂点が少ない順に足していき、上限に達したら次のメッシュレットにする
+void BuildMeshlets(const std::vector<VertexData>& vertices, const uint32_t* indices, size_t indexCount, MeshletData& output);
+
+// 視点(メッシュのローカル座標)から見てメッシュレットのすべての三角形が裏向きか
+bool IsMeshletBackfacing(const MeshletBounds& bounds, const Vector3& eye);
+
+// 裏向きでないメッシュレットの番号を集め、残った三角形数を返す
+uint32_t CullMeshlets(const MeshletData& data, const Vector3& eye, std::vector<uint32_t>& visibleMeshlets);
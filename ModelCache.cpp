@@ -0,0 +1,173 @@
+#include "ModelCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// ファイルの先頭の識別子とバージョン(VertexDataなどの形式を変えたら上げる)
+constexpr char kModelCacheMagic[4] = { 'C', 'G', 'M', 'C' };
+constexpr uint32_t kModelCacheVersion = 1;
+
+/// <summary>
+/// キャッシュファイルのヘッダー
+/// </summary>
+struct ModelCacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t materialCount;
+	uint32_t subsetCount;
+	uint64_t stringSize;
+};
+
+/// <summary>
+/// マテリアルの固定長部分(文字列は後ろにまとめて置く)
+/// </summary>
+struct ModelCacheMaterial {
+	Vector4 diffuseColor;
+	uint32_t nameLength;
+	uint32_t textureFilePathLength;
+};
+
+} // namespace
+
+/// <summary>
+/// 元ファイルのサイズと更新時刻を取得する
+/// </summary>
+/// <param name="filePath">元ファイルのパス</param>
+/// <param name="stamp">書き込み先</param>
+/// <returns>取得できたらtrue</returns>
+bool GetModelSourceStamp(const std::string& filePath, ModelSourceStamp& stamp) {
+	std::error_code error;
+	const uintmax_t size = std::filesystem::file_size(filePath, error);
+	if (error) {
+		return false;
+	}
+	const std::filesystem::file_time_type time = std::filesystem::last_write_time(filePath, error);
+	if (error) {
+		return false;
+	}
+	stamp.size = uint64_t(size);
+	stamp.lastWriteTime = int64_t(time.time_since_epoch().count());
+	return true;
+}
+
+/// <summary>
+/// キャッシュを書き出す
+/// </summary>
+/// <param name="cachePath">キャッシュのパス</param>
+/// <param name="stamp">元ファイルの情報</param>
+/// <param name="modelData">モデル</param>
+/// <returns>書き出せたらtrue</returns>
+bool WriteModelCache(const std::string& cachePath, const ModelSourceStamp& stamp, const ModelData& modelData) {
+	ModelCacheHeader header{};
+	std::memcpy(header.magic, kModelCacheMagic, sizeof(header.magic));
+	header.version = kModelCacheVersion;
+	header.sourceSize = stamp.size;
+	header.sourceTime = stamp.lastWriteTime;
+	header.vertexCount = uint32_t(modelData.mesh.vertices.size());
+	header.indexCount = uint32_t(modelData.mesh.indices.size());
+	header.materialCount = uint32_t(modelData.materials.size());
+	header.subsetCount = uint32_t(modelData.subsets.size());
+
+	std::vector<ModelCacheMaterial> materials;
+	std::string strings;
+	for (const MaterialData& material : modelData.materials) {
+		materials.push_back({ material.diffuseColor, uint32_t(material.name.size()), uint32_t(material.textureFilePath.size()) });
+		strings += material.name;
+		strings += material.textureFilePath;
+	}
+	header.stringSize = strings.size();
+
+	// 途中で失敗しても壊れたキャッシュが残らないように一時ファイルに書いてから置き換える
+	const std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(modelData.mesh.vertices.data()), sizeof(VertexData) * header.vertexCount);
+		file.write(reinterpret_cast<const char*>(modelData.mesh.indices.data()), sizeof(uint32_t) * header.indexCount);
+		file.write(reinterpret_cast<const char*>(modelData.subsets.data()), sizeof(ModelSubset) * header.subsetCount);
+		file.write(reinterpret_cast<const char*>(materials.data()), sizeof(ModelCacheMaterial) * header.materialCount);
+		file.write(strings.data(), strings.size());
+		if (!file) {
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	return !error;
+}
+
+/// <summary>
+/// キャッシュを読み込む
+/// </summary>
+/// <param name="cachePath">キャッシュのパス</param>
+/// <param name="stamp">元ファイルの情報(一致しなければ読み込まない)</param>
+/// <param name="modelData">結果の書き込み先</param>
+/// <returns>読み込めたらtrue</returns>
+bool ReadModelCache(const std::string& cachePath, const ModelSourceStamp& stamp, ModelData& modelData) {
+	std::ifstream file(cachePath, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	const std::streamoff fileSize = file.tellg();
+	if (fileSize < std::streamoff(sizeof(ModelCacheHeader))) {
+		return false;
+	}
+	// 1回で全体を読む
+	std::vector<char> buffer(static_cast<size_t>(fileSize));
+	file.seekg(0);
+	if (!file.read(buffer.data(), fileSize)) {
+		return false;
+	}
+
+	ModelCacheHeader header;
+	std::memcpy(&header, buffer.data(), sizeof(header));
+	if (std::memcmp(header.magic, kModelCacheMagic, sizeof(header.magic)) != 0 || header.version != kModelCacheVersion ||
+		header.sourceSize != stamp.size || header.sourceTime != stamp.lastWriteTime) {
+		return false;
+	}
+	const uint64_t expectedSize = sizeof(ModelCacheHeader) + uint64_t(sizeof(VertexData)) * header.vertexCount +
+		uint64_t(sizeof(uint32_t)) * header.indexCount + uint64_t(sizeof(ModelSubset)) * header.subsetCount +
+		uint64_t(sizeof(ModelCacheMaterial)) * header.materialCount + header.stringSize;
+	if (expectedSize != uint64_t(fileSize)) {
+		return false;
+	}
+
+	const char* p = buffer.data() + sizeof(header);
+	auto readArray = [&p](auto& output, size_t count) {
+		output.resize(count);
+		const size_t bytes = sizeof(output[0]) * count;
+		std::memcpy(output.data(), p, bytes);
+		p += bytes;
+	};
+	readArray(modelData.mesh.vertices, header.vertexCount);
+	readArray(modelData.mesh.indices, header.indexCount);
+	readArray(modelData.subsets, header.subsetCount);
+	std::vector<ModelCacheMaterial> materials;
+	readArray(materials, header.materialCount);
+
+	const char* strings = p;
+	const char* stringsEnd = p + header.stringSize;
+	modelData.materials.clear();
+	for (const ModelCacheMaterial& material : materials) {
+		if (uint64_t(stringsEnd - strings) < uint64_t(material.nameLength) + material.textureFilePathLength) {
+			return false;
+		}
+		MaterialData data{};
+		data.diffuseColor = material.diffuseColor;
+		data.name.assign(strings, material.nameLength);
+		strings += material.nameLength;
+		data.textureFilePath.assign(strings, material.textureFilePathLength);
+		strings += material.textureFilePathLength;
+		modelData.materials.push_back(std::move(data));
+	}
+	return true;
+}
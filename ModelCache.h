@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "ModelData.h"
+
+/// <summary>
+/// 元ファイルの同一性の確認に使う情報
+/// </summary>
+struct ModelSourceStamp {
+	uint64_t size;
+	int64_t lastWriteTime;
+};
+
+// 元ファイルのサイズと更新時刻(取得できなければfalse)
+bool GetModelSourceStamp(const std::string& filePath, ModelSourceStamp& stamp);
+
+// キャッシュの書き出し・読み込み(読み込みは1回のreadで行い、stampが一致しなければfalse)
+bool WriteModelCache(const std::string& cachePath, const ModelSourceStamp& stamp, const ModelData& modelData);
+bool ReadModelCache(const std::string& cachePath, const ModelSourceStamp& stamp, ModelData& modelData);
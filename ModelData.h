@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshData.h"
+#include "Vector4.h"
+
+/// <summary>
+/// モデルのマテリアル(MTLから読んだもの)
+/// </summary>
+struct MaterialData {
+	std::string name;
+	Vector4 diffuseColor;
+	std::string textureFilePath;
+};
+
+/// <summary>
+/// 同じマテリアルで描画するインデックスの範囲
+/// </summary>
+struct ModelSubset {
+	uint32_t materialIndex;
+	uint32_t indexStart;
+	uint32_t indexCount;
+};
+
+/// <summary>
+/// モデル
+/// </summary>
+struct ModelData {
+	MeshData mesh;
+	std::vector<MaterialData> materials;
+	std::vector<ModelSubset> subsets;
+};
@@ -0,0 +1,747 @@
+#include "ObjLoader.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include "MappedFile.h"
+#include "ModelCache.h"
+#include "ThreadPool.h"
+#include "Vector2.h"
+#include "Vector3.h"
+
+namespace {
+
+constexpr uint32_t kMissingIndex = UINT32_MAX;
+
+// 並列に読むときのチャンクの最小サイズ(これより小さいファイルは分けない)
+constexpr size_t kMinChunkSize = 1 << 20;
+// スレッドあたりのチャンク数(行の密度の偏りをならす)
+constexpr size_t kChunksPerThread = 4;
+
+// ObjCorner::localMask のビット(負のインデックスはチャンクの先頭からの相対値で持つ)
+constexpr uint8_t kLocalPosition = 1 << 0;
+constexpr uint8_t kLocalTexcoord = 1 << 1;
+constexpr uint8_t kLocalNormal = 1 << 2;
+
+/// <summary>
+/// 面の頂点(v/vt/vnのインデックス、0始まり。ないものは-1)
+/// </summary>
+struct ObjCorner {
+	int32_t position;
+	int32_t texcoord;
+	int32_t normal;
+	uint8_t localMask;
+};
+
+/// <summary>
+/// usemtlの位置
+/// </summary>
+struct ObjMaterialUse {
+	std::string_view name;
+	size_t cornerStart;
+};
+
+/// <summary>
+/// OBJのテキストの一部を解析した結果
+/// </summary>
+struct ObjChunk {
+	std::vector<Vector3> positions;
+	std::vector<Vector2> texcoords;
+	std::vector<Vector3> normals;
+	// 三角形に分割済みの面の頂点(3つで1つの三角形)
+	std::vector<ObjCorner> corners;
+	std::vector<ObjMaterialUse> materialUses;
+	std::vector<std::string_view> materialLibraries;
+	// 解析できなかった行の数
+	size_t errorCount = 0;
+};
+
+/// <summary>
+/// 空白とタブを読み飛ばす
+/// </summary>
+const char* SkipSpaces(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
+	return p;
+}
+
+/// <summary>
+/// 空白まで読み飛ばす
+/// </summary>
+const char* SkipToken(const char* p, const char* end) {
+	while (p < end && *p != ' ' && *p != '\t') {
+		++p;
+	}
+	return p;
+}
+
+/// <summary>
+/// 行の先頭が指定のキーワードで、その後が空白か
+/// </summary>
+bool MatchKeyword(const char* p, const char* end, std::string_view keyword) {
+	const size_t length = keyword.size();
+	return size_t(end - p) > length && std::memcmp(p, keyword.data(), length) == 0 && (p[length] == ' ' || p[length] == '\t');
+}
+
+/// <summary>
+/// 浮動小数点数を1つ読む
+/// </summary>
+bool ParseFloat(const char*& p, const char* end, float& value) {
+	p = SkipSpaces(p, end);
+	if (p < end && *p == '+') {
+		++p;
+	}
+	const std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) {
+		return false;
+	}
+	p = result.ptr;
+	return true;
+}
+
+/// <summary>
+/// 整数を1つ読む
+/// </summary>
+bool ParseInt(const char*& p, const char* end, int32_t& value) {
+	// 面のインデックスは数が多いので、from_charsを使わずに直接読む
+	bool negative = false;
+	if (p < end && *p == '-') {
+		negative = true;
+		++p;
+	}
+	const char* start = p;
+	int64_t result = 0;
+	while (p < end && unsigned(*p - '0') < 10u) {
+		result = result * 10 + (*p - '0');
+		if (result > INT32_MAX) {
+			return false;
+		}
+		++p;
+	}
+	if (p == start) {
+		return false;
+	}
+	value = int32_t(negative ? -result : result);
+	return true;
+}
+
+/// <summary>
+/// 行の残りを前後の空白を除いた文字列として取り出す
+/// </summary>
+std::string_view RestOfLine(const char* p, const char* end) {
+	p = SkipSpaces(p, end);
+	while (end > p && (end[-1] == ' ' || end[-1] == '\t')) {
+		--end;
+	}
+	return std::string_view(p, size_t(end - p));
+}
+
+/// <summary>
+/// テキストを行の境目でおおよそ等分する
+/// </summary>
+/// <param name="begin">テキストの先頭</param>
+/// <param name="end">テキストの終端</param>
+/// <param name="count">分割数</param>
+/// <returns>境目の位置(先頭と終端を含み、空のチャンクは作らない)</returns>
+std::vector<const char*> SplitLines(const char* begin, const char* end, size_t count) {
+	std::vector<const char*> boundaries{ begin };
+	const size_t size = size_t(end - begin);
+	for (size_t i = 1; i < count; ++i) {
+		const char* p = begin + size / count * i;
+		if (p <= boundaries.back()) {
+			continue;
+		}
+		// 次の行の先頭まで進める
+		const char* newline = static_cast<const char*>(std::memchr(p - 1, '\n', size_t(end - (p - 1))));
+		if (!newline || newline + 1 >= end) {
+			break;
+		}
+		if (newline + 1 > boundaries.back()) {
+			boundaries.push_back(newline + 1);
+		}
+	}
+	boundaries.push_back(end);
+	return boundaries;
+}
+
+/// <summary>
+/// OBJのインデックスを0始まりにする(負の値はこれまでの数からの相対値)
+/// </summary>
+bool ResolveIndex(int32_t value, size_t localCount, int32_t& index, uint8_t& localMask, uint8_t localBit) {
+	if (value > 0) {
+		index = value - 1;
+		return true;
+	}
+	if (value < 0) {
+		// チャンクの先頭より前を指すこともあるので、結合時にチャンクの開始位置を足す
+		index = int32_t(int64_t(localCount) + value);
+		localMask |= localBit;
+		return true;
+	}
+	return false;
+}
+
+/// <summary>
+/// 面の頂点1つ(v, v/vt, v//vn, v/vt/vn)を読む
+/// </summary>
+bool ParseCorner(const char*& p, const char* end, const ObjChunk& chunk, ObjCorner& corner) {
+	corner = { -1, -1, -1, 0 };
+	int32_t value = 0;
+	if (!ParseInt(p, end, value) || !ResolveIndex(value, chunk.positions.size(), corner.position, corner.localMask, kLocalPosition)) {
+		return false;
+	}
+	if (p < end && *p == '/') {
+		++p;
+		if (p < end && *p != '/') {
+			if (!ParseInt(p, end, value) || !ResolveIndex(value, chunk.texcoords.size(), corner.texcoord, corner.localMask, kLocalTexcoord)) {
+				return false;
+			}
+		}
+		if (p < end && *p == '/') {
+			++p;
+			if (!ParseInt(p, end, value) || !ResolveIndex(value, chunk.normals.size(), corner.normal, corner.localMask, kLocalNormal)) {
+				return false;
+			}
+		}
+	}
+	// 頂点の後は空白か行末
+	return p == end || *p == ' ' || *p == '\t';
+}
+
+/// <summary>
+/// OBJのテキストを解析する(文字列はテキストを指すだけで確保しない)
+/// </summary>
+/// <param name="begin">テキストの先頭(行の先頭)</param>
+/// <param name="end">テキストの終端(行の終わり)</param>
+/// <param name="chunk">結果の書き込み先</param>
+void ParseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+	// 面の頂点は1つ数バイトなので、再確保が何度も起きないように大まかに確保しておく
+	chunk.corners.reserve(size_t(end - begin) / 32);
+	const char* p = begin;
+	while (p < end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+		const char* next = lineEnd ? lineEnd + 1 : end;
+		if (!lineEnd) {
+			lineEnd = end;
+		}
+		if (lineEnd > p && lineEnd[-1] == '\r') {
+			--lineEnd;
+		}
+		p = SkipSpaces(p, lineEnd);
+
+		if (MatchKeyword(p, lineEnd, "v")) {
+			// 位置(右手系から左手系にするためxを反転)
+			p += 1;
+			Vector3 position{};
+			if (ParseFloat(p, lineEnd, position.x) && ParseFloat(p, lineEnd, position.y) && ParseFloat(p, lineEnd, position.z)) {
+				position.x *= -1.0f;
+				chunk.positions.push_back(position);
+			} else {
+				chunk.errorCount++;
+				chunk.positions.push_back({ 0.0f, 0.0f, 0.0f });
+			}
+		} else if (MatchKeyword(p, lineEnd, "vt")) {
+			// UV(vは上下を反転)
+			p += 2;
+			Vector2 texcoord{};
+			if (ParseFloat(p, lineEnd, texcoord.x)) {
+				// vは省略できる
+				if (!ParseFloat(p, lineEnd, texcoord.y)) {
+					texcoord.y = 0.0f;
+				}
+				texcoord.y = 1.0f - texcoord.y;
+			} else {
+				chunk.errorCount++;
+			}
+			chunk.texcoords.push_back(texcoord);
+		} else if (MatchKeyword(p, lineEnd, "vn")) {
+			p += 2;
+			Vector3 normal{};
+			if (ParseFloat(p, lineEnd, normal.x) && ParseFloat(p, lineEnd, normal.y) && ParseFloat(p, lineEnd, normal.z)) {
+				normal.x *= -1.0f;
+			} else {
+				chunk.errorCount++;
+			}
+			chunk.normals.push_back(normal);
+		} else if (MatchKeyword(p, lineEnd, "f")) {
+			// 多角形は扇形に分割し、xを反転した分だけ三角形の向きも反転する
+			p += 1;
+			const size_t cornerStart = chunk.corners.size();
+			ObjCorner first{}, previous{}, current{};
+			size_t count = 0;
+			bool failed = false;
+			for (p = SkipSpaces(p, lineEnd); p < lineEnd; p = SkipSpaces(p, lineEnd)) {
+				if (!ParseCorner(p, lineEnd, chunk, current)) {
+					failed = true;
+					break;
+				}
+				if (count == 0) {
+					first = current;
+				} else if (count >= 2) {
+					chunk.corners.push_back(first);
+					chunk.corners.push_back(current);
+					chunk.corners.push_back(previous);
+				}
+				previous = current;
+				count++;
+			}
+			if (failed) {
+				// 途中まで追加した三角形は捨てる
+				chunk.corners.resize(cornerStart);
+				chunk.errorCount++;
+			}
+		} else if (MatchKeyword(p, lineEnd, "usemtl")) {
+			chunk.materialUses.push_back({ RestOfLine(p + 6, lineEnd), chunk.corners.size() });
+		} else if (MatchKeyword(p, lineEnd, "mtllib")) {
+			chunk.materialLibraries.push_back(RestOfLine(p + 6, lineEnd));
+		}
+		// コメント(#)、o、g、sなどは読み飛ばす
+		p = next;
+	}
+}
+
+/// <summary>
+/// 面の頂点のv/vt/vnの組(全体の通し番号。ないものはkMissingIndex)
+/// </summary>
+struct CornerKey {
+	uint32_t position;
+	uint32_t texcoord;
+	uint32_t normal;
+};
+
+/// <summary>
+/// v/vt/vnの組から頂点番号を引くハッシュ表(オープンアドレス法、線形探索)
+/// 面は近い番号のvを続けて参照することが多いので、vの番号順に場所を割り当ててキャッシュミスを減らす
+/// </summary>
+class CornerMap {
+public:
+	CornerMap(size_t expectedCount, size_t positionCount) {
+		// vごとに 2^positionShift_ 個の場所を持つ
+		size_t positionCapacity = 1;
+		while (positionCapacity < positionCount) {
+			positionCapacity <<= 1;
+		}
+		positionShift_ = 1;
+		while ((positionCapacity << positionShift_) < expectedCount * 2) {
+			positionShift_++;
+		}
+		slots_.assign(positionCapacity << positionShift_, Slot{ 0, 0, 0, kMissingIndex });
+		mask_ = slots_.size() - 1;
+	}
+
+	/// <summary>
+	/// 組を探し、なければvalueで追加する
+	/// </summary>
+	/// <returns>見つかった、または追加した頂点番号</returns>
+	uint32_t FindOrInsert(const CornerKey& key, uint32_t value) {
+		if ((count_ + 1) * 2 > slots_.size()) {
+			Grow();
+		}
+		size_t i = Hash(key.position, key.texcoord, key.normal);
+		while (true) {
+			Slot& slot = slots_[i];
+			if (slot.value == kMissingIndex) {
+				slot = { key.position, key.texcoord, key.normal, value };
+				count_++;
+				return value;
+			}
+			if (slot.position == key.position && slot.texcoord == key.texcoord && slot.normal == key.normal) {
+				return slot.value;
+			}
+			i = (i + 1) & mask_;
+		}
+	}
+
+private:
+	struct Slot {
+		uint32_t position;
+		uint32_t texcoord;
+		uint32_t normal;
+		uint32_t value;
+	};
+
+	size_t Hash(uint32_t position, uint32_t texcoord, uint32_t normal) const {
+		// vの場所の中でvt/vnによって振り分ける
+		const uint32_t mix = (texcoord * 0x9e3779b1u) ^ (normal * 0x85ebca77u) ^ (position * 0xc2b2ae35u);
+		return ((size_t(position) << positionShift_) + (mix >> (32 - positionShift_))) & mask_;
+	}
+
+	void Grow() {
+		std::vector<Slot> old;
+		old.swap(slots_);
+		slots_.assign(old.size() * 2, Slot{ 0, 0, 0, kMissingIndex });
+		mask_ = slots_.size() - 1;
+		positionShift_++;
+		for (const Slot& slot : old) {
+			if (slot.value == kMissingIndex) {
+				continue;
+			}
+			size_t i = Hash(slot.position, slot.texcoord, slot.normal);
+			while (slots_[i].value != kMissingIndex) {
+				i = (i + 1) & mask_;
+			}
+			slots_[i] = slot;
+		}
+	}
+
+	std::vector<Slot> slots_;
+	size_t mask_ = 0;
+	uint32_t positionShift_ = 1;
+	size_t count_ = 0;
+};
+
+/// <summary>
+/// マテリアル名から番号を引く(なければ白のマテリアルを追加する)
+/// </summary>
+uint32_t FindMaterialIndex(std::vector<MaterialData>& materials, std::string_view name) {
+	for (size_t i = 0; i < materials.size(); ++i) {
+		if (materials[i].name == name) {
+			return uint32_t(i);
+		}
+	}
+	materials.push_back({ std::string(name), { 1.0f, 1.0f, 1.0f, 1.0f }, "" });
+	return uint32_t(materials.size() - 1);
+}
+
+/// <summary>
+/// 解析したチャンクを順に結合してモデルを作る
+/// チャンクごとの処理は並列に行い、頂点の番号付けだけをチャンクの順に行うので、結果はチャンクの分け方によらない
+/// </summary>
+/// <param name="chunks">ファイルの先頭から順に並んだチャンク</param>
+/// <param name="chunkCount">チャンクの数</param>
+/// <param name="modelData">結果の書き込み先(materialsは読み込み済みのものを使う)</param>
+/// <param name="threadPool">スレッドプール(nullptrなら順に処理する)</param>
+/// <returns>範囲外のインデックスがなければtrue</returns>
+bool BuildModelData(const ObjChunk* chunks, size_t chunkCount, ModelData& modelData, ThreadPool* threadPool) {
+	// 各チャンクのv/vt/vnと面の頂点の開始位置(累積和)
+	std::vector<size_t> positionOffsets(chunkCount), texcoordOffsets(chunkCount), normalOffsets(chunkCount), cornerOffsets(chunkCount);
+	size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (size_t c = 0; c < chunkCount; ++c) {
+		positionOffsets[c] = positionCount;
+		texcoordOffsets[c] = texcoordCount;
+		normalOffsets[c] = normalCount;
+		cornerOffsets[c] = cornerCount;
+		positionCount += chunks[c].positions.size();
+		texcoordCount += chunks[c].texcoords.size();
+		normalCount += chunks[c].normals.size();
+		cornerCount += chunks[c].corners.size();
+	}
+	std::vector<Vector3> positions(positionCount), normals(normalCount);
+	std::vector<Vector2> texcoords(texcoordCount);
+	ParallelFor(threadPool, chunkCount, [&](size_t c) {
+		std::copy(chunks[c].positions.begin(), chunks[c].positions.end(), positions.begin() + positionOffsets[c]);
+		std::copy(chunks[c].texcoords.begin(), chunks[c].texcoords.end(), texcoords.begin() + texcoordOffsets[c]);
+		std::copy(chunks[c].normals.begin(), chunks[c].normals.end(), normals.begin() + normalOffsets[c]);
+	});
+
+	// インデックスを0始まりの通し番号にする(省略なら-1、範囲外なら-2)
+	auto resolve = [](int32_t index, bool local, size_t offset, size_t count) -> int64_t {
+		if (index < 0 && !local) {
+			return -1;
+		}
+		const int64_t global = local ? int64_t(offset) + index : int64_t(index);
+		return global >= 0 && global < int64_t(count) ? global : -2;
+	};
+
+	// チャンクごとに v/vt/vn の組を重複なしで初出順に並べ、面の頂点をその番号にする
+	struct ChunkVertices {
+		std::vector<CornerKey> keys;
+		std::vector<uint32_t> indices;
+		bool failed = false;
+	};
+	std::vector<ChunkVertices> chunkVertices(chunkCount);
+	ParallelFor(threadPool, chunkCount, [&](size_t c) {
+		const ObjChunk& chunk = chunks[c];
+		ChunkVertices& result = chunkVertices[c];
+		result.indices.resize(chunk.corners.size());
+		CornerMap cornerMap(chunk.corners.size() / 4, chunk.positions.size());
+		for (size_t i = 0; i < chunk.corners.size(); ++i) {
+			const ObjCorner& corner = chunk.corners[i];
+			const int64_t position = resolve(corner.position, corner.localMask & kLocalPosition, positionOffsets[c], positionCount);
+			const int64_t texcoord = resolve(corner.texcoord, corner.localMask & kLocalTexcoord, texcoordOffsets[c], texcoordCount);
+			const int64_t normal = resolve(corner.normal, corner.localMask & kLocalNormal, normalOffsets[c], normalCount);
+			if (position < 0 || texcoord == -2 || normal == -2) {
+				result.failed = true;
+				result.indices[i] = kMissingIndex;
+				continue;
+			}
+			const CornerKey key = {
+				uint32_t(position),
+				texcoord < 0 ? kMissingIndex : uint32_t(texcoord),
+				normal < 0 ? kMissingIndex : uint32_t(normal),
+			};
+			const uint32_t newIndex = uint32_t(result.keys.size());
+			const uint32_t index = cornerMap.FindOrInsert(key, newIndex);
+			if (index == newIndex) {
+				result.keys.push_back(key);
+			}
+			result.indices[i] = index;
+		}
+	});
+
+	// チャンクの順に全体の番号を付ける(チャンクが1つならそのまま)
+	std::vector<CornerKey> vertexKeys;
+	std::vector<std::vector<uint32_t>> remaps(chunkCount);
+	bool succeeded = true;
+	if (chunkCount == 1) {
+		vertexKeys.swap(chunkVertices[0].keys);
+		succeeded = !chunkVertices[0].failed;
+	} else {
+		size_t uniqueCount = 0;
+		for (const ChunkVertices& result : chunkVertices) {
+			uniqueCount += result.keys.size();
+		}
+		CornerMap cornerMap(uniqueCount, positionCount);
+		vertexKeys.reserve(uniqueCount);
+		for (size_t c = 0; c < chunkCount; ++c) {
+			const ChunkVertices& result = chunkVertices[c];
+			succeeded &= !result.failed;
+			remaps[c].resize(result.keys.size());
+			for (size_t k = 0; k < result.keys.size(); ++k) {
+				const uint32_t newIndex = uint32_t(vertexKeys.size());
+				const uint32_t index = cornerMap.FindOrInsert(result.keys[k], newIndex);
+				if (index == newIndex) {
+					vertexKeys.push_back(result.keys[k]);
+				}
+				remaps[c][k] = index;
+			}
+		}
+	}
+
+	MeshData& mesh = modelData.mesh;
+	mesh.indices.resize(cornerCount);
+	ParallelFor(threadPool, chunkCount, [&](size_t c) {
+		const ChunkVertices& result = chunkVertices[c];
+		uint32_t* output = mesh.indices.data() + cornerOffsets[c];
+		for (size_t i = 0; i < result.indices.size(); ++i) {
+			const uint32_t index = result.indices[i];
+			// 壊れたインデックスは0番の頂点を指しておく
+			output[i] = index == kMissingIndex ? 0 : (chunkCount == 1 ? index : remaps[c][index]);
+		}
+	});
+
+	// 頂点を組み立てる
+	mesh.vertices.resize(vertexKeys.size());
+	const size_t kVertexBlockSize = 1 << 16;
+	ParallelFor(threadPool, (vertexKeys.size() + kVertexBlockSize - 1) / kVertexBlockSize, [&](size_t block) {
+		const size_t end = std::min(vertexKeys.size(), (block + 1) * kVertexBlockSize);
+		for (size_t i = block * kVertexBlockSize; i < end; ++i) {
+			const CornerKey& key = vertexKeys[i];
+			VertexData& vertex = mesh.vertices[i];
+			const Vector3& p = positions[key.position];
+			vertex.position = { p.x, p.y, p.z, 1.0f };
+			vertex.texcoord = key.texcoord == kMissingIndex ? Vector2{ 0.0f, 0.0f } : texcoords[key.texcoord];
+			vertex.normal = key.normal == kMissingIndex ? Vector3{ 0.0f, 0.0f, 0.0f } : normals[key.normal];
+		}
+	});
+	if (!mesh.indices.empty() && mesh.vertices.empty()) {
+		mesh.indices.clear();
+		return false;
+	}
+
+	// vnのない頂点は面積で重み付けした面の法線を足し合わせて求める
+	std::vector<uint32_t> computedNormalVertices;
+	for (size_t i = 0; i < vertexKeys.size(); ++i) {
+		if (vertexKeys[i].normal == kMissingIndex) {
+			computedNormalVertices.push_back(uint32_t(i));
+		}
+	}
+	if (!computedNormalVertices.empty()) {
+		std::vector<bool> needsNormal(mesh.vertices.size(), false);
+		for (uint32_t index : computedNormalVertices) {
+			needsNormal[index] = true;
+		}
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			const uint32_t i0 = mesh.indices[i], i1 = mesh.indices[i + 1], i2 = mesh.indices[i + 2];
+			if (!needsNormal[i0] && !needsNormal[i1] && !needsNormal[i2]) {
+				continue;
+			}
+			const Vector4& p0 = mesh.vertices[i0].position;
+			const Vector4& p1 = mesh.vertices[i1].position;
+			const Vector4& p2 = mesh.vertices[i2].position;
+			const Vector3 e1 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+			const Vector3 e2 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			const Vector3 faceNormal = { e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+			for (uint32_t index : { i0, i1, i2 }) {
+				if (needsNormal[index]) {
+					Vector3& normal = mesh.vertices[index].normal;
+					normal = { normal.x + faceNormal.x, normal.y + faceNormal.y, normal.z + faceNormal.z };
+				}
+			}
+		}
+		for (uint32_t index : computedNormalVertices) {
+			Vector3& normal = mesh.vertices[index].normal;
+			const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			normal = length > 0.0f ? Vector3{ normal.x / length, normal.y / length, normal.z / length } : Vector3{ 0.0f, 1.0f, 0.0f };
+		}
+	}
+
+	// usemtlごとの範囲(続けて同じマテリアルなら1つにまとめる)
+	modelData.subsets.clear();
+	uint32_t currentMaterial = kMissingIndex;
+	size_t subsetStart = 0;
+	size_t chunkCornerStart = 0;
+	auto flush = [&](size_t subsetEnd) {
+		if (subsetEnd <= subsetStart) {
+			return;
+		}
+		if (currentMaterial == kMissingIndex) {
+			currentMaterial = FindMaterialIndex(modelData.materials, "default");
+		}
+		if (!modelData.subsets.empty() && modelData.subsets.back().materialIndex == currentMaterial) {
+			modelData.subsets.back().indexCount += uint32_t(subsetEnd - subsetStart);
+		} else {
+			modelData.subsets.push_back({ currentMaterial, uint32_t(subsetStart), uint32_t(subsetEnd - subsetStart) });
+		}
+		subsetStart = subsetEnd;
+	};
+	for (size_t c = 0; c < chunkCount; ++c) {
+		for (const ObjMaterialUse& use : chunks[c].materialUses) {
+			flush(chunkCornerStart + use.cornerStart);
+			currentMaterial = FindMaterialIndex(modelData.materials, use.name);
+			subsetStart = chunkCornerStart + use.cornerStart;
+		}
+		chunkCornerStart += chunks[c].corners.size();
+	}
+	flush(mesh.indices.size());
+	return succeeded;
+}
+
+} // namespace
+
+/// <summary>
+/// OBJファイルを読み込む
+/// </summary>
+/// <param name="directoryPath">ファイルのあるディレクトリ</param>
+/// <param name="filename">ファイル名</param>
+/// <param name="modelData">結果の書き込み先</param>
+/// <param name="threadPool">スレッドプール(nullptrなら分割せずに読む)</param>
+/// <returns>すべて読み込めたらtrue</returns>
+bool LoadObjFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData, ThreadPool* threadPool) {
+	MappedFile file;
+	if (!file.Open(directoryPath + "/" + filename)) {
+		return false;
+	}
+	return LoadObjText(file.GetData(), file.GetSize(), directoryPath, modelData, threadPool);
+}
+
+/// <summary>
+/// メモリ上のOBJのテキストを読み込む
+/// </summary>
+/// <param name="text">テキストの先頭</param>
+/// <param name="size">テキストのバイト数</param>
+/// <param name="directoryPath">mtllibのファイルを探すディレクトリ</param>
+/// <param name="modelData">結果の書き込み先</param>
+/// <param name="threadPool">スレッドプール(nullptrなら順に処理する)</param>
+/// <param name="chunkCount">分割数(0なら大きさとスレッド数から決める)</param>
+/// <returns>すべて読み込めたらtrue</returns>
+bool LoadObjText(const char* text, size_t size, const std::string& directoryPath, ModelData& modelData, ThreadPool* threadPool, size_t chunkCount) {
+	const char* begin = text;
+	const char* end = begin + size;
+
+	// 小さいファイルやスレッドプールがないときは分けない
+	if (chunkCount == 0) {
+		chunkCount = 1;
+		if (threadPool) {
+			chunkCount = std::min((threadPool->GetWorkerCount() + 1) * kChunksPerThread, std::max<size_t>(1, size / kMinChunkSize));
+		}
+	}
+	const std::vector<const char*> boundaries = SplitLines(begin, end, chunkCount);
+	chunkCount = boundaries.size() - 1;
+
+	std::vector<ObjChunk> chunks(chunkCount);
+	ParallelFor(threadPool, chunkCount, [&](size_t c) {
+		ParseObjChunk(boundaries[c], boundaries[c + 1], chunks[c]);
+	});
+
+	modelData.materials.clear();
+	bool succeeded = true;
+	for (const ObjChunk& chunk : chunks) {
+		succeeded &= chunk.errorCount == 0;
+		for (std::string_view library : chunk.materialLibraries) {
+			succeeded &= LoadMaterialTemplateFile(directoryPath, std::string(library), modelData.materials);
+		}
+	}
+	succeeded &= BuildModelData(chunks.data(), chunkCount, modelData, threadPool);
+	return succeeded;
+}
+
+/// <summary>
+/// MTLファイルを読み込む
+/// </summary>
+/// <param name="directoryPath">ファイルのあるディレクトリ</param>
+/// <param name="filename">ファイル名</param>
+/// <param name="materials">読み込んだマテリアルの追加先</param>
+/// <returns>読み込めたらtrue</returns>
+bool LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename, std::vector<MaterialData>& materials) {
+	MappedFile file;
+	if (!file.Open(directoryPath + "/" + filename)) {
+		return false;
+	}
+	const char* p = file.GetData();
+	const char* end = p + file.GetSize();
+	MaterialData* material = nullptr;
+	while (p < end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+		const char* next = lineEnd ? lineEnd + 1 : end;
+		if (!lineEnd) {
+			lineEnd = end;
+		}
+		if (lineEnd > p && lineEnd[-1] == '\r') {
+			--lineEnd;
+		}
+		p = SkipSpaces(p, lineEnd);
+
+		if (MatchKeyword(p, lineEnd, "newmtl")) {
+			materials.push_back({ std::string(RestOfLine(p + 6, lineEnd)), { 1.0f, 1.0f, 1.0f, 1.0f }, "" });
+			material = &materials.back();
+		} else if (material && MatchKeyword(p, lineEnd, "Kd")) {
+			p += 2;
+			Vector4& color = material->diffuseColor;
+			ParseFloat(p, lineEnd, color.x);
+			ParseFloat(p, lineEnd, color.y);
+			ParseFloat(p, lineEnd, color.z);
+		} else if (material && MatchKeyword(p, lineEnd, "d")) {
+			p += 1;
+			ParseFloat(p, lineEnd, material->diffuseColor.w);
+		} else if (material && MatchKeyword(p, lineEnd, "map_Kd")) {
+			// オプション(-s など)の後の最後のトークンをファイル名とする
+			const char* token = p + 6;
+			for (const char* q = SkipSpaces(token, lineEnd); q < lineEnd; q = SkipSpaces(SkipToken(q, lineEnd), lineEnd)) {
+				token = q;
+			}
+			material->textureFilePath = directoryPath + "/" + std::string(RestOfLine(token, lineEnd));
+		}
+		p = next;
+	}
+	return true;
+}
+
+/// <summary>
+/// キャッシュを使ってモデルを読み込む
+/// </summary>
+/// <param name="directoryPath">ファイルのあるディレクトリ</param>
+/// <param name="filename">OBJのファイル名</param>
+/// <param name="modelData">結果の書き込み先</param>
+/// <param name="threadPool">スレッドプール(nullptrなら分割せずに読む)</param>
+/// <returns>読み込めたらtrue</returns>
+bool LoadModelFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData, ThreadPool* threadPool) {
+	const std::string filePath = directoryPath + "/" + filename;
+	const std::string cachePath = filePath + ".meshcache";
+	ModelSourceStamp stamp{};
+	if (!GetModelSourceStamp(filePath, stamp)) {
+		return false;
+	}
+	if (ReadModelCache(cachePath, stamp, modelData)) {
+		return true;
+	}
+	if (!LoadObjFile(directoryPath, filename, modelData, threadPool)) {
+		return false;
+	}
+	// 書き出せなくても読み込みは成功とする
+	WriteModelCache(cachePath, stamp, modelData);
+	return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include "ModelData.h"
+
+class ThreadPool;
+
+// OBJ(+MTL)を読み込む
+// 左手座標系に合わせてxと三角形の向きを反転し、UVのvを反転する
+// v/vt/vnの組が同じ頂点は共有し、vnがない頂点は面の法線から求める
+// threadPoolを渡すと行の境目で分けたチャンクを並列に解析する(結果はスレッド数によらず同じ)
+bool LoadObjFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData, ThreadPool* threadPool = nullptr);
+
+// メモリ上のOBJのテキストを読み込む(mtllibはdirectoryPathから探す)
+// chunkCountが0ならファイルの大きさとスレッド数から分割数を決める(0以外は分け方を変えて結果を比べるテスト用)
+bool LoadObjText(const char* text, size_t size, const std::string& directoryPath, ModelData& modelData, ThreadPool* threadPool = nullptr,
+	size_t chunkCount = 0);
+
+// MTLを読み込んでmaterialsに追加する
+bool LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename, std::vector<MaterialData>& materials);
+
+// バイナリキャッシュ(filename + ".meshcache")があればそれを使い、なければOBJを読んでキャッシュを書く
+bool LoadModelFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData, ThreadPool* threadPool = nullptr);
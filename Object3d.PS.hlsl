@@ -14,10 +14,16 @@ struct DirectionalLight
     float intensity;
 };
 
+struct TextureIndex
+{
+    uint index;
+};
+
 ConstantBuffer<Material> gMaterial : register(b0);
-Texture2D<float4> gTexture : register(t0);
+Texture2D<float4> gTextures[] : register(t0);
 SamplerState gSampler : register(s0);
 ConstantBuffer<DirectionalLight> gDirectionalLight : register(b1);
+ConstantBuffer<TextureIndex> gTextureIndex : register(b2);
 
 struct PixelShaderOutput
 {
@@ -28,7 +34,7 @@ PixelShaderOutput main(VertexShaderOutput input)
 {
     PixelShaderOutput output;
     float4 transformedUV = mul(float4(input.texcoord, 0.0f, 1.0f), gMaterial.uvTransform);
-    float4 textureColor = gTexture.Sample(gSampler, transformedUV.xy);
+    float4 textureColor = gTextures[gTextureIndex.index].Sample(gSampler, transformedUV.xy);
     if (gMaterial.enableLighting != 0)
     {
         float NdotL = dot(normalize(input.normal), -gDirectionalLight.direction);
@@ -3,4 +3,13 @@ struct VertexShaderOutput
     float4 position : SV_POSITION;
     float2 texcoord : TEXCOORD0;
     float3 normal : NORMAL0;
+};
+
+// インスタンス描画用(マテリアルの番号を補間せずに渡す)
+struct InstancedVertexShaderOutput
+{
+    float4 position : SV_POSITION;
+    float2 texcoord : TEXCOORD0;
+    float3 normal : NORMAL0;
+    nointerpolation uint materialIndex : MATERIAL0;
 };
\ No newline at end of file
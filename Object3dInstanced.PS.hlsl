@@ -0,0 +1,46 @@
+#include "Object3d.hlsli"
+
+// InstanceBatch.hのInstanceMaterial
+struct InstanceMaterial
+{
+    float4 color;
+    uint textureIndex;
+    int enableLighting;
+    uint2 padding;
+};
+
+struct DirectionalLight
+{
+    float4 color;
+    float3 direction;
+    float intensity;
+};
+
+Texture2D<float4> gTextures[] : register(t0);
+SamplerState gSampler : register(s0);
+ConstantBuffer<DirectionalLight> gDirectionalLight : register(b1);
+StructuredBuffer<InstanceMaterial> gInstanceMaterials : register(t1, space1);
+
+struct PixelShaderOutput
+{
+    float4 color : SV_TARGET0;
+};
+
+PixelShaderOutput main(InstancedVertexShaderOutput input)
+{
+    PixelShaderOutput output;
+    InstanceMaterial material = gInstanceMaterials[input.materialIndex];
+    // 番号はインスタンスごとに違い、同じウェーブの中でもばらつくのでNonUniformResourceIndexを付ける
+    float4 textureColor = gTextures[NonUniformResourceIndex(material.textureIndex)].Sample(gSampler, input.texcoord);
+    if (material.enableLighting != 0)
+    {
+        float NdotL = dot(normalize(input.normal), -gDirectionalLight.direction);
+        float cos = pow(NdotL * 0.5f + 0.5f, 2.0f);
+        output.color = material.color * textureColor * gDirectionalLight.color * cos * gDirectionalLight.intensity;
+    }
+    else
+    {
+        output.color = material.color * textureColor;
+    }
+    return output;
+}
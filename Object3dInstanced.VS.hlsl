@@ -0,0 +1,30 @@
+#include "Object3d.hlsli"
+
+// InstanceBatch.hのInstanceData
+struct InstanceData
+{
+    float4x4 WVP;
+    float4x4 World;
+    uint materialIndex;
+    uint3 padding;
+};
+
+StructuredBuffer<InstanceData> gInstances : register(t0, space1);
+
+struct VertexShaderInput
+{
+    float4 position : POSITION0;
+    float2 texccord : TEXCOORD0;
+    float3 normal : NORMAL0;
+};
+
+InstancedVertexShaderOutput main(VertexShaderInput input, uint instanceId : SV_InstanceID)
+{
+    InstancedVertexShaderOutput output;
+    InstanceData instance = gInstances[instanceId];
+    output.position = mul(input.position, instance.WVP);
+    output.texcoord = input.texccord;
+    output.normal = normalize(mul(input.normal, (float3x3) instance.World));
+    output.materialIndex = instance.materialIndex;
+    return output;
+}
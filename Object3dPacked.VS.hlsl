@@ -0,0 +1,37 @@
+#include "Object3d.hlsli"
+
+struct TransformationMatrix
+{
+    float4x4 WVP;
+    float4x4 World;
+};
+
+ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
+
+// PackedVertexData(R16G16B16A16_SNORM / R16G16_SNORM / R16G16_FLOAT)
+struct VertexShaderInput
+{
+    float4 position : POSITION0;
+    float2 normal : NORMAL0;
+    float2 texcoord : TEXCOORD0;
+};
+
+// 八面体写像した法線を戻す
+float3 DecodeOctahedralNormal(float2 encoded)
+{
+    float3 normal = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    // 0以上なら-t、負なら+t
+    normal.xy -= t * (step(0.0f, normal.xy) * 2.0f - 1.0f);
+    return normalize(normal);
+}
+
+VertexShaderOutput main(VertexShaderInput input)
+{
+    VertexShaderOutput output;
+    // 位置の展開はWVPに含まれている
+    output.position = mul(input.position, gTransformationMatrix.WVP);
+    output.texcoord = input.texcoord;
+    output.normal = normalize(mul(DecodeOctahedralNormal(input.normal), (float3x3) gTransformationMatrix.World));
+    return output;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// 圧縮した頂点(16byte)
+/// </summary>
+struct PackedVertexData {
+	// 位置(R16G16B16A16_SNORM、メッシュの範囲で正規化。wは常に32767(=1.0)で、展開の行列の平行移動に使う)
+	int16_t position[4];
+	// 八面体写像した法線(R16G16_SNORM)
+	int16_t normal[2];
+	// UV(R16G16_FLOAT)
+	uint16_t texcoord[2];
+};
@@ -0,0 +1,164 @@
+#include "SceneGraph.h"
+#include <algorithm>
+#include <cassert>
+#include "MatrixMath.h"
+
+/// <summary>
+/// ノードを末尾に追加する(親は必ず前にあるので順序は崩れない)
+/// </summary>
+/// <param name="parent">親のノード(なければkNoParent)</param>
+/// <param name="local">親から見た変換</param>
+/// <returns>追加したノード</returns>
+SceneGraph::NodeHandle SceneGraph::AddNode(NodeHandle parent, const Transform& local) {
+	const uint32_t index = uint32_t(handles_.size());
+	const NodeHandle handle = NodeHandle(indices_.size());
+	parents_.push_back(parent == kNoParent ? kNoParent : indices_[parent]);
+	locals_.push_back(local);
+	worlds_.push_back(MakeIdentityMatrix4x4());
+	dirty_.push_back(1);
+	handles_.push_back(handle);
+	indices_.push_back(index);
+	firstDirty_ = std::min(firstDirty_, index);
+	return handle;
+}
+
+/// <summary>
+/// 親を付け替える
+/// </summary>
+/// <param name="node">付け替えるノード</param>
+/// <param name="parent">新しい親(なければkNoParent)</param>
+void SceneGraph::SetParent(NodeHandle node, NodeHandle parent) {
+	const uint32_t index = indices_[node];
+	const uint32_t parentIndex = parent == kNoParent ? kNoParent : indices_[parent];
+#ifdef _DEBUG
+	// 自分の子孫を親にすると輪になる
+	for (uint32_t ancestor = parentIndex; ancestor != kNoParent; ancestor = parents_[ancestor]) {
+		assert(ancestor != index);
+	}
+#endif
+	parents_[index] = parentIndex;
+	dirty_[index] = 1;
+	firstDirty_ = std::min(firstDirty_, index);
+	if (parentIndex != kNoParent && parentIndex > index) {
+		Reorder();
+	}
+}
+
+/// <summary>
+/// ローカル変換を書き換える
+/// </summary>
+void SceneGraph::SetLocal(NodeHandle node, const Transform& local) {
+	const uint32_t index = indices_[node];
+	locals_[index] = local;
+	dirty_[index] = 1;
+	firstDirty_ = std::min(firstDirty_, index);
+}
+
+/// <summary>
+/// 親のハンドルを返す
+/// </summary>
+SceneGraph::NodeHandle SceneGraph::GetParent(NodeHandle node) const {
+	const uint32_t parentIndex = parents_[indices_[node]];
+	return parentIndex == kNoParent ? kNoParent : handles_[parentIndex];
+}
+
+/// <summary>
+/// 変更されたノードと子孫のワールド行列を計算する
+/// 親は子より前にあるので、親を計算し直したかどうかは子を見る時点で決まっている
+/// </summary>
+/// <returns>計算し直したノード数</returns>
+size_t SceneGraph::UpdateWorld() {
+	const uint32_t count = uint32_t(handles_.size());
+	size_t updatedCount = 0;
+	for (uint32_t index = std::min(firstDirty_, count); index < count; ++index) {
+		const uint32_t parentIndex = parents_[index];
+		// 親を計算し直していれば子もやり直す(dirty_は走査が終わるまで残しておき、子が見る)
+		if (!dirty_[index] && (parentIndex == kNoParent || !dirty_[parentIndex])) {
+			continue;
+		}
+		dirty_[index] = 1;
+		const Transform& local = locals_[index];
+		const Matrix4x4 localMatrix = MakeAffineMatrix(local.scale, local.rotate, local.translate);
+		worlds_[index] = parentIndex == kNoParent ? localMatrix : Multiply(localMatrix, worlds_[parentIndex]);
+		++updatedCount;
+	}
+	// 計算したノードの印を消す(変更のあった範囲だけ)
+	if (firstDirty_ < count) {
+		std::fill(dirty_.begin() + firstDirty_, dirty_.end(), uint8_t(0));
+	}
+	firstDirty_ = UINT32_MAX;
+	return updatedCount;
+}
+
+/// <summary>
+/// 親が子より前に来るように並べ直す(根の順と兄弟の順は保つ)
+/// </summary>
+void SceneGraph::Reorder() {
+	const uint32_t count = uint32_t(handles_.size());
+	// 子の一覧を親ごとに詰めて並べる
+	std::vector<uint32_t> childOffsets(size_t(count) + 1, 0);
+	for (uint32_t index = 0; index < count; ++index) {
+		if (parents_[index] != kNoParent) {
+			++childOffsets[parents_[index] + 1];
+		}
+	}
+	for (uint32_t index = 0; index < count; ++index) {
+		childOffsets[index + 1] += childOffsets[index];
+	}
+	std::vector<uint32_t> children(childOffsets[count]);
+	std::vector<uint32_t> cursor(childOffsets.begin(), childOffsets.end() - 1);
+	for (uint32_t index = 0; index < count; ++index) {
+		if (parents_[index] != kNoParent) {
+			children[cursor[parents_[index]]++] = index;
+		}
+	}
+
+	// 根から深さ優先でたどった順を新しい順にする(親は必ず先に出て、部分木は連続する)
+	std::vector<uint32_t> order;
+	order.reserve(count);
+	std::vector<uint32_t> stack;
+	for (uint32_t root = 0; root < count; ++root) {
+		if (parents_[root] != kNoParent) {
+			continue;
+		}
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const uint32_t index = stack.back();
+			stack.pop_back();
+			order.push_back(index);
+			// 兄弟の順を保つため逆から積む
+			for (uint32_t child = childOffsets[index + 1]; child > childOffsets[index]; --child) {
+				stack.push_back(children[child - 1]);
+			}
+		}
+	}
+	assert(order.size() == count);
+
+	// 古い位置から新しい位置への対応で配列を作り直す
+	std::vector<uint32_t> newIndices(count);
+	for (uint32_t newIndex = 0; newIndex < count; ++newIndex) {
+		newIndices[order[newIndex]] = newIndex;
+	}
+	std::vector<uint32_t> parents(count);
+	std::vector<Transform> locals(count);
+	std::vector<Matrix4x4> worlds(count);
+	std::vector<uint8_t> dirty(count);
+	std::vector<NodeHandle> handles(count);
+	for (uint32_t newIndex = 0; newIndex < count; ++newIndex) {
+		const uint32_t oldIndex = order[newIndex];
+		parents[newIndex] = parents_[oldIndex] == kNoParent ? kNoParent : newIndices[parents_[oldIndex]];
+		locals[newIndex] = locals_[oldIndex];
+		worlds[newIndex] = worlds_[oldIndex];
+		dirty[newIndex] = dirty_[oldIndex];
+		handles[newIndex] = handles_[oldIndex];
+		indices_[handles_[oldIndex]] = newIndex;
+	}
+	parents_.swap(parents);
+	locals_.swap(locals);
+	worlds_.swap(worlds);
+	dirty_.swap(dirty);
+	handles_.swap(handles);
+	// 変更のあったノードの位置が変わったので先頭から走査する
+	firstDirty_ = 0;
+	++reorderCount_;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.h"
+#include "Transform.h"
+
+/// <summary>
+/// 親子関係を持つノードのローカル変換とワールド行列
+/// ノードは親が必ず子より前に来る順(トポロジカル順)で配列に並べ、
+/// UpdateWorldは変更されたノードとその子孫だけを先頭から一度なめて計算する
+/// </summary>
+class SceneGraph {
+public:
+	using NodeHandle = uint32_t;
+	// 親がないときの番号
+	static constexpr NodeHandle kNoParent = UINT32_MAX;
+
+	// ノードを追加する(parentは既にあるノードかkNoParent)
+	NodeHandle AddNode(NodeHandle parent, const Transform& local);
+
+	// 親を付け替える(子孫を親にはできない)。親が後ろにあれば並べ直す
+	void SetParent(NodeHandle node, NodeHandle parent);
+
+	// ローカル変換を書き換え、次のUpdateWorldで子孫とともに計算し直す
+	void SetLocal(NodeHandle node, const Transform& local);
+
+	// 変更されたノードと子孫のワールド行列を計算する
+	// 戻り値は計算し直したノード数
+	size_t UpdateWorld();
+
+	const Transform& GetLocal(NodeHandle node) const { return locals_[indices_[node]]; }
+	// 直前のUpdateWorldの結果(SetLocalしただけでは変わらない)
+	const Matrix4x4& GetWorld(NodeHandle node) const { return worlds_[indices_[node]]; }
+	NodeHandle GetParent(NodeHandle node) const;
+	size_t GetNodeCount() const { return handles_.size(); }
+	// ノードの並べ直しが起きた回数
+	uint32_t GetReorderCount() const { return reorderCount_; }
+
+private:
+	void Reorder();
+
+	// 配列の位置(トポロジカル順)ごとのデータ
+	std::vector<uint32_t> parents_; // 親の位置(kNoParentなら根)
+	std::vector<Transform> locals_;
+	std::vector<Matrix4x4> worlds_;
+	std::vector<uint8_t> dirty_;    // ローカル変換を変えた、または新しく追加した
+	std::vector<NodeHandle> handles_;
+	// ハンドルから配列の位置(並べ直してもハンドルは変わらない)
+	std::vector<uint32_t> indices_;
+	uint32_t firstDirty_ = UINT32_MAX; // 走査を始める位置
+	uint32_t reorderCount_ = 0;
+};
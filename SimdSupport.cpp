@@ -0,0 +1,71 @@
+#include "SimdSupport.h"
+#if SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+/// <summary>
+/// CPUIDとOSのレジスタ保存状態からAVX2+FMAが使えるかを判定
+/// </summary>
+/// <returns>使えるならtrue</returns>
+bool IsAvx2Supported() {
+#if SIMD_X86 && defined(_MSC_VER)
+	int info[4] = {};
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !avx || !fma) {
+		return false;
+	}
+	// XMM/YMMの状態をOSが保存しているか
+	if ((_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif SIMD_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+} // namespace
+
+/// <summary>
+/// 実行中のCPUで使える最上位の命令セットを取得
+/// </summary>
+/// <returns>命令セット</returns>
+SimdLevel GetSimdLevel() {
+	static const SimdLevel level = [] {
+#if SIMD_X86
+		return IsAvx2Supported() ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}();
+	return level;
+}
+
+/// <summary>
+/// 命令セットの名前を取得
+/// </summary>
+/// <param name="level">命令セット</param>
+/// <returns>名前</returns>
+const char* GetSimdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::SSE2:
+		return "SSE2";
+	case SimdLevel::AVX2:
+		return "AVX2";
+	default:
+		return "Scalar";
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// x64ではSSE2が必ず使える
+#if defined(_M_X64) || defined(__x86_64__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+// AVX2/FMAを使う関数に付ける(MSVCは指定なしで組み込み関数を使える)
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+/// <summary>
+/// 実行時に使用する命令セット
+/// </summary>
+enum class SimdLevel {
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+// 実行中のCPUで使える最上位の命令セットを取得(初回に判定して以降はキャッシュ)
+SimdLevel GetSimdLevel();
+
+// 命令セットの名前
+const char* GetSimdLevelName(SimdLevel level);
@@ -0,0 +1,204 @@
+#include "SinCos.h"
+#include <cmath>
+#include <cstdint>
+#include "SimdSupport.h"
+
+namespace {
+
+// 2/π
+constexpr float kTwoOverPi = 0.636619772367581343f;
+// π/2 を3つに分けたもの(Cody-Waiteの引数還元用。上位ほど下位ビットが0)
+constexpr float kHalfPi1 = 1.5703125f;
+constexpr float kHalfPi2 = 4.837512969970703125e-4f;
+constexpr float kHalfPi3 = 7.54978995489188216e-8f;
+
+// [-π/4, π/4] での近似多項式の係数(Cephes)
+constexpr float kSin1 = -1.6666654611e-1f;
+constexpr float kSin2 = 8.3321608736e-3f;
+constexpr float kSin3 = -1.9515295891e-4f;
+constexpr float kCos1 = 4.166664568298827e-2f;
+constexpr float kCos2 = -1.388731625493765e-3f;
+constexpr float kCos3 = 2.443315711809948e-5f;
+
+// 漸化式を多項式の値に戻す間隔
+constexpr size_t kReseedInterval = 32;
+
+/// <summary>
+/// 1つの角度のsin/cos(スカラー)
+/// </summary>
+void SinCosScalar(float angle, float& sine, float& cosine) {
+	// 象限と還元後の角度
+	const float quadrantF = std::nearbyint(angle * kTwoOverPi);
+	const int32_t quadrant = static_cast<int32_t>(quadrantF);
+	float x = angle - quadrantF * kHalfPi1;
+	x = x - quadrantF * kHalfPi2;
+	x = x - quadrantF * kHalfPi3;
+
+	const float x2 = x * x;
+	const float s = x + x * x2 * (kSin1 + x2 * (kSin2 + x2 * kSin3));
+	const float c = 1.0f - 0.5f * x2 + x2 * x2 * (kCos1 + x2 * (kCos2 + x2 * kCos3));
+
+	// 象限に応じて入れ替えと符号反転
+	const bool swap = (quadrant & 1) != 0;
+	const float resultSin = swap ? c : s;
+	const float resultCos = swap ? s : c;
+	sine = (quadrant & 2) ? -resultSin : resultSin;
+	cosine = ((quadrant + 1) & 2) ? -resultCos : resultCos;
+}
+
+#if SIMD_X86
+
+/// <summary>
+/// 4つの角度のsin/cos(SSE2)
+/// </summary>
+inline void SinCos4(__m128 angle, __m128& sine, __m128& cosine) {
+	const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(kTwoOverPi)));
+	const __m128 quadrantF = _mm_cvtepi32_ps(quadrant);
+	__m128 x = _mm_sub_ps(angle, _mm_mul_ps(quadrantF, _mm_set1_ps(kHalfPi1)));
+	x = _mm_sub_ps(x, _mm_mul_ps(quadrantF, _mm_set1_ps(kHalfPi2)));
+	x = _mm_sub_ps(x, _mm_mul_ps(quadrantF, _mm_set1_ps(kHalfPi3)));
+
+	const __m128 x2 = _mm_mul_ps(x, x);
+	__m128 s = _mm_add_ps(_mm_set1_ps(kSin2), _mm_mul_ps(x2, _mm_set1_ps(kSin3)));
+	s = _mm_add_ps(_mm_set1_ps(kSin1), _mm_mul_ps(x2, s));
+	s = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), s));
+	__m128 c = _mm_add_ps(_mm_set1_ps(kCos2), _mm_mul_ps(x2, _mm_set1_ps(kCos3)));
+	c = _mm_add_ps(_mm_set1_ps(kCos1), _mm_mul_ps(x2, c));
+	c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), x2)), _mm_mul_ps(_mm_mul_ps(x2, x2), c));
+
+	// 奇数象限ではsinとcosを入れ替える
+	const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	const __m128 resultSin = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+	const __m128 resultCos = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+	// 象限のビット1を符号ビットへ
+	const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+	const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(
+		_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+	sine = _mm_xor_ps(resultSin, sinSign);
+	cosine = _mm_xor_ps(resultCos, cosSign);
+}
+
+/// <summary>
+/// 配列の角度のsin/cos(SSE2)
+/// </summary>
+size_t SinCosArraySSE2(const float* angles, float* sines, float* cosines, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 sine, cosine;
+		SinCos4(_mm_loadu_ps(angles + i), sine, cosine);
+		_mm_storeu_ps(sines + i, sine);
+		_mm_storeu_ps(cosines + i, cosine);
+	}
+	return i;
+}
+
+/// <summary>
+/// 8つの角度のsin/cos(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 inline void SinCos8(__m256 angle, __m256& sine, __m256& cosine) {
+	const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(angle, _mm256_set1_ps(kTwoOverPi)));
+	const __m256 quadrantF = _mm256_cvtepi32_ps(quadrant);
+	__m256 x = _mm256_fnmadd_ps(quadrantF, _mm256_set1_ps(kHalfPi1), angle);
+	x = _mm256_fnmadd_ps(quadrantF, _mm256_set1_ps(kHalfPi2), x);
+	x = _mm256_fnmadd_ps(quadrantF, _mm256_set1_ps(kHalfPi3), x);
+
+	const __m256 x2 = _mm256_mul_ps(x, x);
+	__m256 s = _mm256_fmadd_ps(x2, _mm256_set1_ps(kSin3), _mm256_set1_ps(kSin2));
+	s = _mm256_fmadd_ps(x2, s, _mm256_set1_ps(kSin1));
+	s = _mm256_fmadd_ps(_mm256_mul_ps(x, x2), s, x);
+	__m256 c = _mm256_fmadd_ps(x2, _mm256_set1_ps(kCos3), _mm256_set1_ps(kCos2));
+	c = _mm256_fmadd_ps(x2, c, _mm256_set1_ps(kCos1));
+	c = _mm256_fmadd_ps(_mm256_mul_ps(x2, x2), c, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), x2, _mm256_set1_ps(1.0f)));
+
+	const __m256 swap = _mm256_castsi256_ps(_mm256_slli_epi32(quadrant, 31));
+	const __m256 resultSin = _mm256_blendv_ps(s, c, swap);
+	const __m256 resultCos = _mm256_blendv_ps(c, s, swap);
+	const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+	const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+		_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+	sine = _mm256_xor_ps(resultSin, sinSign);
+	cosine = _mm256_xor_ps(resultCos, cosSign);
+}
+
+/// <summary>
+/// 配列の角度のsin/cos(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 size_t SinCosArrayAVX2(const float* angles, float* sines, float* cosines, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 sine, cosine;
+		SinCos8(_mm256_loadu_ps(angles + i), sine, cosine);
+		_mm256_storeu_ps(sines + i, sine);
+		_mm256_storeu_ps(cosines + i, cosine);
+	}
+	return i;
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+/// <summary>
+/// 1つの角度のsin/cosを求める
+/// </summary>
+/// <param name="angle">角度(ラジアン)</param>
+/// <param name="sine">sinの書き込み先</param>
+/// <param name="cosine">cosの書き込み先</param>
+void SinCos(float angle, float& sine, float& cosine) {
+	SinCosScalar(angle, sine, cosine);
+}
+
+/// <summary>
+/// 配列の角度のsin/cosをまとめて求める
+/// </summary>
+/// <param name="angles">角度(ラジアン)の配列</param>
+/// <param name="sines">sinの書き込み先</param>
+/// <param name="cosines">cosの書き込み先</param>
+/// <param name="count">角度の数</param>
+void SinCosArray(const float* angles, float* sines, float* cosines, size_t count) {
+	size_t i = 0;
+#if SIMD_X86
+	if (GetSimdLevel() == SimdLevel::AVX2) {
+		i = SinCosArrayAVX2(angles, sines, cosines, count);
+	}
+	i += SinCosArraySSE2(angles + i, sines + i, cosines + i, count - i);
+#endif
+	// 端数はスカラーで計算
+	for (; i < count; i++) {
+		float sine, cosine;
+		SinCosScalar(angles[i], sine, cosine);
+		sines[i] = sine;
+		cosines[i] = cosine;
+	}
+}
+
+/// <summary>
+/// 等間隔の角度のsin/cosを漸化式で求める
+/// </summary>
+/// <param name="start">最初の角度(ラジアン)</param>
+/// <param name="step">角度の間隔(ラジアン)</param>
+/// <param name="sines">sinの書き込み先</param>
+/// <param name="cosines">cosの書き込み先</param>
+/// <param name="count">角度の数</param>
+void SinCosSequence(float start, float step, float* sines, float* cosines, size_t count) {
+	float sinStep, cosStep;
+	SinCosScalar(step, sinStep, cosStep);
+
+	float sine = 0.0f;
+	float cosine = 1.0f;
+	for (size_t i = 0; i < count; i++) {
+		if (i % kReseedInterval == 0) {
+			// 一定間隔で多項式の値に戻す
+			SinCosScalar(start + step * static_cast<float>(i), sine, cosine);
+		} else {
+			// sin(a + d) = sin(a)cos(d) + cos(a)sin(d)
+			// cos(a + d) = cos(a)cos(d) - sin(a)sin(d)
+			const float nextSin = sine * cosStep + cosine * sinStep;
+			const float nextCos = cosine * cosStep - sine * sinStep;
+			sine = nextSin;
+			cosine = nextCos;
+		}
+		sines[i] = sine;
+		cosines[i] = cosine;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+
+// sin/cosを多項式近似でまとめて求める
+//
+// 精度(倍精度のsin/cosとの比較):
+//   |angle| <= 2π    : sin/cos ともに最大 1.6 ULP(値の絶対値が2^-24未満になる零点のごく近くを除く)
+//   |angle| <= 8192  : 絶対誤差 1e-7 以下(零点のごく近くでは引数の還元誤差によりULPでの誤差が大きくなる)
+//   漸化式(SinCosSequence)は角度が ±20 以内なら絶対誤差 3e-6 以下
+//   (角度はfloatで start + step * i を求めるので、それより大きいとその丸め誤差が乗る)
+// tests/SinCosTest.cppで確かめている
+
+// 1つの角度のsin/cos
+void SinCos(float angle, float& sine, float& cosine);
+
+// 配列の角度のsin/cos(SSE2で4個、AVX2で8個ずつ計算する)
+// sines/cosines は angles と同じ領域でもよい
+void SinCosArray(const float* angles, float* sines, float* cosines, size_t count);
+
+// 等間隔の角度 start + step * i (i = 0..count-1) のsin/cos
+// 加法定理による回転の漸化式で求め、誤差が溜まらないように一定間隔で多項式の値に戻す
+void SinCosSequence(float start, float step, float* sines, float* cosines, size_t count);
@@ -0,0 +1,338 @@
+#include "TextureCooker.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <png.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include "MappedFile.h"
+#include "TextureFootprint.h"
+#include "externals/DirectXTex/DirectXTex.h"
+
+namespace {
+
+// 焼き込みの形式のバージョン(mipの作り方や圧縮の設定を変えたら上げ、古い出力を使わないようにする)
+constexpr uint64_t kTextureCookVersion = 1;
+
+// 設定の名前に使う文字列(TextureCompression、TextureCookQualityの順)
+constexpr const char* kCompressionNames[] = { "auto", "bc1", "bc3", "bc7", "rgba8" };
+constexpr const char* kQualityNames[] = { "fast", "normal", "slow" };
+
+/// <summary>
+/// UTF-8のパスをDirectXTexに渡す形にする
+/// </summary>
+std::wstring ToWidePath(const std::string& path) {
+#ifdef _WIN32
+	const int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), int(path.size()), nullptr, 0);
+	std::wstring widePath(size_t(wideLength), L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path.c_str(), int(path.size()), widePath.data(), wideLength);
+	return widePath;
+#else
+	return std::filesystem::path(path).wstring();
+#endif
+}
+
+/// <summary>
+/// 元画像を読み込む(WindowsはWIC、それ以外はlibpng)
+/// </summary>
+bool LoadSourceImage(const MappedFile& source, bool isSrgb, DirectX::ScratchImage& image) {
+#ifdef _WIN32
+	const HRESULT hr = DirectX::LoadFromWICMemory(source.GetData(), source.GetSize(),
+		isSrgb ? DirectX::WIC_FLAGS_FORCE_SRGB : DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, image);
+	return SUCCEEDED(hr);
+#else
+	png_image png{};
+	png.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_memory(&png, source.GetData(), source.GetSize())) {
+		return false;
+	}
+	png.format = PNG_FORMAT_RGBA;
+	if (FAILED(image.Initialize2D(isSrgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM, png.width, png.height, 1, 1))) {
+		png_image_free(&png);
+		return false;
+	}
+	const DirectX::Image* pixels = image.GetImage(0, 0, 0);
+	if (!png_image_finish_read(&png, nullptr, pixels->pixels, png_int_32(pixels->rowPitch), nullptr)) {
+		png_image_free(&png);
+		return false;
+	}
+	return true;
+#endif
+}
+
+/// <summary>
+/// 圧縮先のフォーマットを選ぶ
+/// BCは最上位のmipが4の倍数でないとD3D12で作れないので、そのときは圧縮しない
+/// </summary>
+DXGI_FORMAT SelectCookedFormat(const TextureCookSettings& settings, const DirectX::ScratchImage& image) {
+	const DirectX::TexMetadata& metadata = image.GetMetadata();
+	const bool isBlockAligned = metadata.width % 4 == 0 && metadata.height % 4 == 0;
+	TextureCompression compression = isBlockAligned ? settings.compression : TextureCompression::None;
+	if (compression == TextureCompression::Auto) {
+		compression = image.IsAlphaAllOpaque() ? TextureCompression::BC1 : TextureCompression::BC3;
+	}
+	switch (compression) {
+	case TextureCompression::BC1:
+		return settings.isSrgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+	case TextureCompression::BC3:
+		return settings.isSrgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+	case TextureCompression::BC7:
+		return settings.isSrgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+	default:
+		return metadata.format;
+	}
+}
+
+/// <summary>
+/// mipをすべて詰めて並べたときのバイト数
+/// </summary>
+uint64_t ComputeMipChainBytes(DXGI_FORMAT format, uint64_t width, uint64_t height, uint32_t mipLevels) {
+	uint64_t bytes = 0;
+	for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
+		uint64_t rowPitch = 0;
+		uint64_t slicePitch = 0;
+		if (ComputeTexturePitch(format, std::max<uint64_t>(width >> mipLevel, 1), std::max<uint64_t>(height >> mipLevel, 1), rowPitch, slicePitch)) {
+			bytes += slicePitch;
+		}
+	}
+	return bytes;
+}
+
+/// <summary>
+/// 書き出した(または既にある)DDSの情報を結果に入れる
+/// </summary>
+void FillCookResult(const DirectX::TexMetadata& metadata, bool isSrgb, TextureCookResult& result) {
+	result.format = metadata.format;
+	result.width = uint32_t(metadata.width);
+	result.height = uint32_t(metadata.height);
+	result.mipLevels = uint32_t(metadata.mipLevels);
+	result.uncompressedBytes = ComputeMipChainBytes(isSrgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM,
+		metadata.width, metadata.height, result.mipLevels);
+	result.cookedBytes = ComputeMipChainBytes(metadata.format, metadata.width, metadata.height, result.mipLevels);
+}
+
+} // namespace
+
+/// <summary>
+/// 元ファイルの中身のハッシュ(FNV-1a 64bit。先に形式のバージョンを混ぜる)
+/// </summary>
+/// <param name="data">中身</param>
+/// <param name="size">バイト数</param>
+/// <returns>ハッシュ</returns>
+uint64_t ComputeTextureSourceHash(const void* data, size_t size) {
+	constexpr uint64_t kOffsetBasis = 14695981039346656037ull;
+	constexpr uint64_t kPrime = 1099511628211ull;
+	uint64_t hash = kOffsetBasis;
+	for (int i = 0; i < 8; i++) {
+		hash = (hash ^ ((kTextureCookVersion >> (i * 8)) & 0xFF)) * kPrime;
+	}
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * kPrime;
+	}
+	return hash;
+}
+
+/// <summary>
+/// 元ファイルを読んでハッシュを求める
+/// </summary>
+/// <param name="sourcePath">元ファイルのパス</param>
+/// <param name="hash">ハッシュの書き込み先</param>
+/// <returns>読めなければfalse</returns>
+bool ComputeTextureSourceHashFromFile(const std::string& sourcePath, uint64_t& hash) {
+	MappedFile source;
+	if (!source.Open(sourcePath)) {
+		return false;
+	}
+	hash = ComputeTextureSourceHash(source.GetData(), source.GetSize());
+	return true;
+}
+
+/// <summary>
+/// 設定の名前(圧縮_色空間_品質)
+/// </summary>
+std::string GetTextureCookSettingsName(const TextureCookSettings& settings) {
+	return std::format("{}_{}_{}", kCompressionNames[int(settings.compression)], settings.isSrgb ? "srgb" : "linear",
+		kQualityNames[int(settings.quality)]);
+}
+
+/// <summary>
+/// 設定の名前を設定に戻す
+/// </summary>
+/// <param name="name">設定の名前(例: "bc7_srgb_normal")</param>
+/// <param name="settings">設定の書き込み先</param>
+/// <returns>GetTextureCookSettingsNameが作る名前でなければfalse</returns>
+bool ParseTextureCookSettingsName(const std::string& name, TextureCookSettings& settings) {
+	for (size_t compression = 0; compression < std::size(kCompressionNames); ++compression) {
+		for (size_t quality = 0; quality < std::size(kQualityNames); ++quality) {
+			for (bool isSrgb : { true, false }) {
+				const TextureCookSettings candidate = { TextureCompression(compression), isSrgb, TextureCookQuality(quality) };
+				if (name == GetTextureCookSettingsName(candidate)) {
+					settings = candidate;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// 出力のパスを作る
+/// </summary>
+/// <param name="sourcePath">元ファイルのパス</param>
+/// <param name="sourceHash">元ファイルの中身のハッシュ</param>
+/// <param name="settings">焼き込みの設定</param>
+/// <returns>出力のパス</returns>
+std::string GetCookedTexturePath(const std::string& sourcePath, uint64_t sourceHash, const TextureCookSettings& settings) {
+	const std::filesystem::path source(sourcePath);
+	const std::string fileName = std::format("{}_{:016x}_{}.dds", source.stem().string(), sourceHash, GetTextureCookSettingsName(settings));
+	return (source.parent_path() / kCookedTextureDirectory / fileName).generic_string();
+}
+
+/// <summary>
+/// 焼き込み済みのファイルを探す
+/// 名前の設定の部分を読み、sRGBかどうかが一致するものだけを使う
+/// 同じ中身から違う設定で焼いたものが複数あれば、品質の高いもの、同じなら名前の順で最初のものを使う
+/// </summary>
+/// <param name="sourcePath">元ファイルのパス</param>
+/// <param name="sourceHash">元ファイルの中身のハッシュ</param>
+/// <param name="isSrgb">sRGBとして焼いたものを探すならtrue</param>
+/// <returns>見つかったパス(なければ空)</returns>
+std::string FindCookedTexture(const std::string& sourcePath, uint64_t sourceHash, bool isSrgb) {
+	const std::filesystem::path source(sourcePath);
+	const std::string prefix = std::format("{}_{:016x}_", source.stem().string(), sourceHash);
+	std::error_code error;
+	std::filesystem::directory_iterator iterator(source.parent_path() / kCookedTextureDirectory, error);
+	if (error) {
+		return {};
+	}
+	std::string found;
+	std::string foundFileName;
+	TextureCookQuality foundQuality = TextureCookQuality::Fast;
+	for (const std::filesystem::directory_entry& entry : iterator) {
+		const std::string fileName = entry.path().filename().string();
+		if (fileName.size() <= prefix.size() || fileName.compare(0, prefix.size(), prefix) != 0 || entry.path().extension() != ".dds") {
+			continue;
+		}
+		TextureCookSettings settings{};
+		if (!ParseTextureCookSettingsName(entry.path().stem().string().substr(prefix.size()), settings) || settings.isSrgb != isSrgb) {
+			continue;
+		}
+		if (found.empty() || settings.quality > foundQuality || (settings.quality == foundQuality && fileName < foundFileName)) {
+			found = entry.path().generic_string();
+			foundFileName = fileName;
+			foundQuality = settings.quality;
+		}
+	}
+	return found;
+}
+
+/// <summary>
+/// 焼き込みが出力するフォーマットか(圧縮しないときは読み込んだ画像のフォーマットのまま)
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="isSrgb">sRGBのフォーマットであるべきならtrue</param>
+/// <returns>出力するフォーマットで、sRGBかどうかが一致すればtrue</returns>
+bool IsCookedTextureFormat(DXGI_FORMAT format, bool isSrgb) {
+	switch (format) {
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		return isSrgb;
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		return !isSrgb;
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// 元画像を焼き込んでDDSを書き出す
+/// 途中で止まっても壊れたファイルを使わないよう、一時ファイルに書いてから名前を変える
+/// </summary>
+/// <param name="sourcePath">元ファイルのパス</param>
+/// <param name="settings">焼き込みの設定</param>
+/// <param name="isForced">出力があっても作り直す</param>
+/// <param name="result">結果</param>
+/// <returns>失敗したらfalse</returns>
+bool CookTexture(const std::string& sourcePath, const TextureCookSettings& settings, bool isForced, TextureCookResult& result) {
+	result = {};
+	MappedFile source;
+	if (!source.Open(sourcePath)) {
+		return false;
+	}
+	result.outputPath = GetCookedTexturePath(sourcePath, ComputeTextureSourceHash(source.GetData(), source.GetSize()), settings);
+	const std::wstring outputPathW = ToWidePath(result.outputPath);
+
+	std::error_code error;
+	if (!isForced && std::filesystem::exists(result.outputPath, error)) {
+		DirectX::TexMetadata metadata{};
+		if (SUCCEEDED(DirectX::GetMetadataFromDDSFile(outputPathW.c_str(), DirectX::DDS_FLAGS_NONE, metadata)) &&
+			IsCookedTextureFormat(metadata.format, settings.isSrgb)) {
+			FillCookResult(metadata, settings.isSrgb, result);
+			result.isCached = true;
+			return true;
+		}
+	}
+
+	DirectX::ScratchImage image;
+	if (!LoadSourceImage(source, settings.isSrgb, image)) {
+		return false;
+	}
+	DirectX::ScratchImage mipImages;
+	HRESULT hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+		settings.isSrgb ? DirectX::TEX_FILTER_SRGB : DirectX::TEX_FILTER_DEFAULT, 0, mipImages);
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	const DXGI_FORMAT format = SelectCookedFormat(settings, mipImages);
+	const DirectX::ScratchImage* output = &mipImages;
+	DirectX::ScratchImage compressed;
+	double compressSeconds = 0.0;
+	if (format != mipImages.GetMetadata().format) {
+		// すべてのmipのブロック行をまとめてスレッドプールで分担する(スレッド数はSetParallelThreadLimitで変えられる)
+		const auto compressStartTime = std::chrono::steady_clock::now();
+		DirectX::TEX_COMPRESS_FLAGS compressFlags = DirectX::TEX_COMPRESS_PARALLEL;
+		if (settings.quality == TextureCookQuality::Fast) {
+			compressFlags |= DirectX::TEX_COMPRESS_BC_FAST | DirectX::TEX_COMPRESS_BC7_QUALITY_FAST;
+		} else if (settings.quality == TextureCookQuality::Slow) {
+			compressFlags |= DirectX::TEX_COMPRESS_BC7_QUALITY_SLOW;
+		}
+		hr = DirectX::Compress(mipImages.GetImages(), mipImages.GetImageCount(), mipImages.GetMetadata(), format,
+			compressFlags, DirectX::TEX_THRESHOLD_DEFAULT, compressed);
+		if (FAILED(hr)) {
+			return false;
+		}
+		compressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - compressStartTime).count();
+		output = &compressed;
+	}
+
+	std::filesystem::create_directories(std::filesystem::path(result.outputPath).parent_path(), error);
+	const std::string temporaryPath = result.outputPath + ".tmp";
+	hr = DirectX::SaveToDDSFile(output->GetImages(), output->GetImageCount(), output->GetMetadata(), DirectX::DDS_FLAGS_NONE,
+		ToWidePath(temporaryPath).c_str());
+	if (FAILED(hr)) {
+		return false;
+	}
+	std::filesystem::rename(temporaryPath, result.outputPath, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	FillCookResult(output->GetMetadata(), settings.isSrgb, result);
+	result.compressSeconds = compressSeconds;
+	return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// 焼き込みで使う圧縮
+/// </summary>
+enum class TextureCompression {
+	Auto, // 不透明ならBC1、そうでなければBC3
+	BC1,
+	BC3,
+	BC7,
+	None, // RGBA8のまま(mipだけ作る)
+};
+
+/// <summary>
+/// 圧縮の品質(速さと引き換え。形式は変わらないが画素は変わるので、出力のファイル名に入れる)
+/// </summary>
+enum class TextureCookQuality {
+	Fast,   // BC1/BC3はSIMDのエンコーダー、BC7は試すモードを最小限にする
+	Normal, // BC7はブロックを分類して、見込みのあるモードと分割だけを試す
+	Slow,   // BC7はすべてのモードを試す
+};
+
+/// <summary>
+/// 焼き込みの設定(すべて出力のファイル名に入る)
+/// </summary>
+struct TextureCookSettings {
+	TextureCompression compression = TextureCompression::Auto;
+	bool isSrgb = true;
+	TextureCookQuality quality = TextureCookQuality::Normal;
+};
+
+/// <summary>
+/// 焼き込みの結果
+/// </summary>
+struct TextureCookResult {
+	std::string outputPath;
+	DXGI_FORMAT format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipLevels;
+	uint64_t uncompressedBytes; // RGBA8でmipを持ったときの画素のバイト数
+	uint64_t cookedBytes;       // 書き出した画素のバイト数
+	double compressSeconds;     // 圧縮にかかった時間(圧縮しなかったら0)
+	bool isCached;              // 同じ鍵の出力が既にあったので何もしなかった
+};
+
+// 焼き込んだファイルを置くディレクトリ(元ファイルと同じディレクトリの下)
+constexpr char kCookedTextureDirectory[] = "cooked";
+
+// 元ファイルの中身のハッシュ(焼き込みの形式を変えたらTextureCooker.cppのバージョンを上げる)
+uint64_t ComputeTextureSourceHash(const void* data, size_t size);
+bool ComputeTextureSourceHashFromFile(const std::string& sourcePath, uint64_t& hash);
+
+// 設定の名前(ファイル名に使う。例: "bc7_srgb_normal")
+std::string GetTextureCookSettingsName(const TextureCookSettings& settings);
+
+// 設定の名前を設定に戻す(GetTextureCookSettingsNameの逆。知らない名前ならfalse)
+bool ParseTextureCookSettingsName(const std::string& name, TextureCookSettings& settings);
+
+// 出力のパス(<元のディレクトリ>/cooked/<元の名前>_<ハッシュ16桁>_<設定の名前>.dds)
+std::string GetCookedTexturePath(const std::string& sourcePath, uint64_t sourceHash, const TextureCookSettings& settings);
+
+// 元ファイルの中身に対応し、sRGBかどうかが一致する焼き込み済みのファイルを探す(なければ空)
+// 圧縮と品質は問わず、複数あれば品質の高いものを使う
+std::string FindCookedTexture(const std::string& sourcePath, uint64_t sourceHash, bool isSrgb);
+
+// 焼き込みが出力するフォーマットで、sRGBかどうかが一致するか(読み込んだDDSの確認に使う)
+bool IsCookedTextureFormat(DXGI_FORMAT format, bool isSrgb);
+
+// 元画像を読んでmipを作り、圧縮してDDSに書き出す(同じ鍵の出力があり、isForcedでなければ何もしない)
+// Windowsでは呼ぶスレッドでCOMを初期化しておくこと(WICで読むため)
+bool CookTexture(const std::string& sourcePath, const TextureCookSettings& settings, bool isForced, TextureCookResult& result);
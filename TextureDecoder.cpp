@@ -0,0 +1,106 @@
+#include "TextureDecoder.h"
+#include <Windows.h>
+#include <memory>
+#include "TextureCooker.h"
+#include "externals/DirectXTex/DirectXTex.h"
+
+namespace {
+
+/// <summary>
+/// WICを使うスレッドごとにCOMを初期化し、スレッドの終了時に終了処理をする
+/// </summary>
+struct ComThreadScope {
+	ComThreadScope() {
+		hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	}
+	~ComThreadScope() {
+		// 別の方式で初期化済みのスレッド(RPC_E_CHANGED_MODE)では終了処理をしない
+		if (SUCCEEDED(hr)) {
+			CoUninitialize();
+		}
+	}
+	HRESULT hr;
+};
+
+/// <summary>
+/// UTF-8のパスをワイド文字にする
+/// </summary>
+std::wstring ToWidePath(const std::string& path) {
+	const int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), int(path.size()), nullptr, 0);
+	std::wstring widePath(size_t(wideLength), L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path.c_str(), int(path.size()), widePath.data(), wideLength);
+	return widePath;
+}
+
+/// <summary>
+/// mipを持つ画像をDecodedTextureにする(画素はstorageが持ち続ける)
+/// </summary>
+void FillDecodedTexture(const std::shared_ptr<DirectX::ScratchImage>& mipImages, DecodedTexture& texture) {
+	const DirectX::TexMetadata& metadata = mipImages->GetMetadata();
+	texture.format = metadata.format;
+	texture.width = uint32_t(metadata.width);
+	texture.height = uint32_t(metadata.height);
+	texture.mips.clear();
+	for (size_t mipLevel = 0; mipLevel < metadata.mipLevels; ++mipLevel) {
+		const DirectX::Image* mip = mipImages->GetImage(mipLevel, 0, 0);
+		texture.mips.push_back({ mip->pixels, mip->rowPitch, mip->slicePitch, uint32_t(mip->width), uint32_t(mip->height) });
+	}
+	texture.storage = mipImages;
+}
+
+/// <summary>
+/// 焼き込み済みのDDSがあればそれを読む
+/// WICで読むときと同じくsRGBとして焼いたものだけを使い、読んだDDSのフォーマットと形も確かめる
+/// </summary>
+bool LoadCookedTexture(const std::string& filePath, DecodedTexture& texture) {
+	uint64_t sourceHash = 0;
+	if (!ComputeTextureSourceHashFromFile(filePath, sourceHash)) {
+		return false;
+	}
+	const std::string cookedPath = FindCookedTexture(filePath, sourceHash, true);
+	if (cookedPath.empty()) {
+		return false;
+	}
+	auto cookedImages = std::make_shared<DirectX::ScratchImage>();
+	DirectX::TexMetadata metadata{};
+	if (FAILED(DirectX::LoadFromDDSFile(ToWidePath(cookedPath).c_str(), DirectX::DDS_FLAGS_NONE, &metadata, *cookedImages))) {
+		return false;
+	}
+	if (!IsCookedTextureFormat(metadata.format, true) || metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D ||
+		metadata.arraySize != 1 || metadata.depth != 1 || metadata.IsCubemap()) {
+		return false;
+	}
+	FillDecodedTexture(cookedImages, texture);
+	return true;
+}
+
+}
+
+/// <summary>
+/// 画像ファイルを読み込んでmipを作る
+/// 中身が同じ焼き込み済みのDDSがあれば、デコードもmip作りもせずにそれを使う
+/// </summary>
+/// <param name="filePath">ファイルのパス(UTF-8)</param>
+/// <param name="texture">読み込んだテクスチャ</param>
+/// <returns>読み込めなければfalse</returns>
+bool DecodeTextureFile(const std::string& filePath, DecodedTexture& texture) {
+	if (LoadCookedTexture(filePath, texture)) {
+		return true;
+	}
+
+	thread_local ComThreadScope comThreadScope;
+
+	DirectX::ScratchImage image{};
+	HRESULT hr = DirectX::LoadFromWICFile(ToWidePath(filePath).c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
+	if (FAILED(hr)) {
+		return false;
+	}
+	auto mipImages = std::make_shared<DirectX::ScratchImage>();
+	hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, *mipImages);
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	FillDecodedTexture(mipImages, texture);
+	return true;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+#include "TextureStreamer.h"
+
+// 画像ファイルをWICで読み込み、sRGBとしてmipを作る(どのスレッドから呼んでもよい)
+// resources/cooked/に同じ中身からsRGBで焼き込んだDDSがあればそちらを読む
+bool DecodeTextureFile(const std::string& filePath, DecodedTexture& texture);
@@ -0,0 +1,410 @@
+#include "TextureFootprint.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/// <summary>
+/// 1ピクセルのビット数(DirectXTexのBitsPerPixelと同じ値。不明なフォーマットは0)
+/// </summary>
+uint32_t GetBitsPerPixel(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return 128;
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return 96;
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_Y416:
+		return 64;
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+	case DXGI_FORMAT_AYUV:
+	case DXGI_FORMAT_Y410:
+		return 32;
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_D16_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_A8P8:
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+		return 16;
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+	case DXGI_FORMAT_AI44:
+	case DXGI_FORMAT_IA44:
+	case DXGI_FORMAT_P8:
+		return 8;
+
+	case DXGI_FORMAT_R1_UNORM:
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+/// <summary>
+/// 平面が複数あるフォーマット(YUVの4:2:0など)か
+/// </summary>
+bool IsPlanarFormat(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+	case DXGI_FORMAT_NV11:
+	case DXGI_FORMAT_P208:
+	case DXGI_FORMAT_V208:
+	case DXGI_FORMAT_V408:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// D3D12では深度とステンシルが別の平面になるフォーマットか
+/// </summary>
+bool HasStencilPlane(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+}
+
+/// <summary>
+/// ブロックの大きさを求める
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="block">ブロックの幅、高さ、ビット数</param>
+/// <returns>平面が複数あるか不明なフォーマットならfalse</returns>
+bool GetTextureFormatBlock(DXGI_FORMAT format, TextureFormatBlock& block) {
+	switch (format) {
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		block = { 4, 4, 64 };
+		return true;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		block = { 4, 4, 128 };
+		return true;
+
+	// 横2ピクセルで1組のフォーマット
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_YUY2:
+		block = { 2, 1, 32 };
+		return true;
+
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		block = { 2, 1, 64 };
+		return true;
+
+	default:
+		if (IsPlanarFormat(format)) {
+			return false;
+		}
+		block = { 1, 1, GetBitsPerPixel(format) };
+		return block.bits != 0;
+	}
+}
+
+/// <summary>
+/// 詰めて並べたときの行と1枚のバイト数を求める
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="width">幅(ピクセル)</param>
+/// <param name="height">高さ(ピクセル)</param>
+/// <param name="rowPitch">行のバイト数</param>
+/// <param name="slicePitch">1枚のバイト数(平面が複数あるフォーマットは全平面の合計)</param>
+/// <returns>不明なフォーマットか、高さが2の倍数であるべきフォーマットで奇数ならfalse</returns>
+bool ComputeTexturePitch(DXGI_FORMAT format, uint64_t width, uint64_t height, uint64_t& rowPitch, uint64_t& slicePitch) {
+	// 平面が複数あるものは輝度の平面に色差の平面が続く
+	switch (format) {
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+		if (height % 2 != 0) {
+			return false;
+		}
+		rowPitch = ((width + 1) >> 1) * 2;
+		slicePitch = rowPitch * (height + ((height + 1) >> 1));
+		return true;
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		if (height % 2 != 0) {
+			return false;
+		}
+		rowPitch = ((width + 1) >> 1) * 4;
+		slicePitch = rowPitch * (height + ((height + 1) >> 1));
+		return true;
+
+	case DXGI_FORMAT_NV11:
+		rowPitch = ((width + 3) >> 2) * 4;
+		slicePitch = rowPitch * height * 2;
+		return true;
+
+	case DXGI_FORMAT_P208:
+		rowPitch = ((width + 1) >> 1) * 2;
+		slicePitch = rowPitch * height * 2;
+		return true;
+
+	case DXGI_FORMAT_V208:
+		if (height % 2 != 0) {
+			return false;
+		}
+		rowPitch = width;
+		slicePitch = rowPitch * (height + (((height + 1) >> 1) * 2));
+		return true;
+
+	case DXGI_FORMAT_V408:
+		rowPitch = width;
+		slicePitch = rowPitch * (height + ((height >> 1) * 4));
+		return true;
+
+	default:
+		break;
+	}
+
+	TextureFormatBlock block{};
+	if (!GetTextureFormatBlock(format, block)) {
+		return false;
+	}
+	uint64_t blockCountX = (width + block.width - 1) / block.width;
+	uint64_t blockCountY = height;
+	// 圧縮フォーマットは1x1や2x2でも1ブロックを使う
+	if (block.height > 1) {
+		blockCountX = std::max<uint64_t>(1, blockCountX);
+		blockCountY = std::max<uint64_t>(1, (height + block.height - 1) / block.height);
+	}
+	rowPitch = (blockCountX * block.bits + 7) / 8;
+	slicePitch = rowPitch * blockCountY;
+	return true;
+}
+
+/// <summary>
+/// 1枚の行数を求める
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="height">高さ(ピクセル)</param>
+/// <returns>行数(圧縮フォーマットはブロックの行数、平面が複数あるものは全平面の合計)</returns>
+uint64_t ComputeTextureRowCount(DXGI_FORMAT format, uint64_t height) {
+	switch (format) {
+	case DXGI_FORMAT_NV11:
+	case DXGI_FORMAT_P208:
+		return height * 2;
+	case DXGI_FORMAT_V208:
+		return height + (((height + 1) >> 1) * 2);
+	case DXGI_FORMAT_V408:
+		return height + ((height >> 1) * 4);
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+	case DXGI_FORMAT_420_OPAQUE:
+		return height + ((height + 1) >> 1);
+	default:
+		break;
+	}
+	TextureFormatBlock block{};
+	if (GetTextureFormatBlock(format, block) && block.height > 1) {
+		return std::max<uint64_t>(1, (height + block.height - 1) / block.height);
+	}
+	return height;
+}
+
+/// <summary>
+/// 範囲をバッファに置いたときの配置を求める
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="width">幅(ピクセル)</param>
+/// <param name="height">高さ(ピクセル)</param>
+/// <param name="depth">奥行き(スライス数)</param>
+/// <param name="offset">置きたい位置(kTextureDataPlacementAlignmentに切り上げる)</param>
+/// <param name="footprint">配置</param>
+/// <returns>コピーで扱えないフォーマットならfalse</returns>
+bool ComputeTextureFootprint(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depth, uint64_t offset, TextureFootprint& footprint) {
+	TextureFormatBlock block{};
+	// 平面ごとに別のコピーになるフォーマットは扱わない
+	if (HasStencilPlane(format) || !GetTextureFormatBlock(format, block)) {
+		return false;
+	}
+	footprint.offset = AlignUp(offset, kTextureDataPlacementAlignment);
+	// コピーの範囲はブロックの倍数で指定する
+	footprint.width = uint32_t(AlignUp(std::max(width, 1u), block.width));
+	footprint.height = uint32_t(AlignUp(std::max(height, 1u), block.height));
+	footprint.depth = std::max(depth, 1u);
+	footprint.rowCount = footprint.height / block.height;
+	footprint.rowSize = (uint64_t(footprint.width / block.width) * block.bits + 7) / 8;
+	const uint64_t rowPitch = AlignUp(footprint.rowSize, kTextureDataPitchAlignment);
+	if (rowPitch > UINT32_MAX) {
+		return false;
+	}
+	footprint.rowPitch = uint32_t(rowPitch);
+	return true;
+}
+
+/// <summary>
+/// 全サブリソースの配置を求める
+/// </summary>
+/// <param name="format">フォーマット</param>
+/// <param name="width">mip 0の幅</param>
+/// <param name="height">mip 0の高さ</param>
+/// <param name="depthOrArraySize">3Dなら奥行き、それ以外は配列の数</param>
+/// <param name="mipLevels">mipの数</param>
+/// <param name="is3D">3Dテクスチャか</param>
+/// <param name="footprints">サブリソースごとの配置</param>
+/// <returns>全体のバイト数(失敗したら0)</returns>
+uint64_t ComputeTextureFootprints(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depthOrArraySize,
+	uint32_t mipLevels, bool is3D, TextureFootprint* footprints) {
+	const uint32_t arraySize = is3D ? 1 : depthOrArraySize;
+	uint64_t offset = 0;
+	for (uint32_t arraySlice = 0; arraySlice < arraySize; ++arraySlice) {
+		for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
+			TextureFootprint& footprint = footprints[mipLevel + arraySlice * mipLevels];
+			const uint32_t depth = is3D ? std::max(depthOrArraySize >> mipLevel, 1u) : 1;
+			if (!ComputeTextureFootprint(format, std::max(width >> mipLevel, 1u), std::max(height >> mipLevel, 1u), depth, offset, footprint)) {
+				return 0;
+			}
+			offset = footprint.offset + GetTextureFootprintSize(footprint);
+		}
+	}
+	return offset;
+}
+
+/// <summary>
+/// 配置が占めるバイト数
+/// </summary>
+uint64_t GetTextureFootprintSize(const TextureFootprint& footprint) {
+	const uint64_t totalRowCount = uint64_t(footprint.rowCount) * footprint.depth;
+	if (totalRowCount == 0) {
+		return 0;
+	}
+	return footprint.rowPitch * (totalRowCount - 1) + footprint.rowSize;
+}
+
+/// <summary>
+/// 詰めて並べた画像を配置に合わせてコピーする
+/// </summary>
+/// <param name="dst">コピー先(配置のoffsetの位置)</param>
+/// <param name="footprint">配置</param>
+/// <param name="src">コピー元</param>
+/// <param name="srcRowPitch">コピー元の行のバイト数</param>
+/// <param name="srcSlicePitch">コピー元の1スライスのバイト数</param>
+void CopyTextureRows(uint8_t* dst, const TextureFootprint& footprint, const uint8_t* src, size_t srcRowPitch, size_t srcSlicePitch) {
+	const uint64_t dstSlicePitch = uint64_t(footprint.rowPitch) * footprint.rowCount;
+	// 行の間隔が同じなら1回でコピーする
+	if (srcRowPitch == footprint.rowPitch && srcSlicePitch == dstSlicePitch) {
+		std::memcpy(dst, src, size_t(GetTextureFootprintSize(footprint)));
+		return;
+	}
+	for (uint32_t z = 0; z < footprint.depth; ++z) {
+		uint8_t* dstSlice = dst + dstSlicePitch * z;
+		const uint8_t* srcSlice = src + srcSlicePitch * z;
+		for (uint32_t row = 0; row < footprint.rowCount; ++row) {
+			std::memcpy(dstSlice + size_t(footprint.rowPitch) * row, srcSlice + srcRowPitch * row, size_t(footprint.rowSize));
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+
+// コピー元バッファの行の境界(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)
+constexpr uint32_t kTextureDataPitchAlignment = 256;
+// コピー元バッファのサブリソースの先頭の境界(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT)
+constexpr uint32_t kTextureDataPlacementAlignment = 512;
+
+/// <summary>
+/// フォーマットの1ブロック(圧縮は4x4、YUY2などは2x1、それ以外は1x1)
+/// </summary>
+struct TextureFormatBlock {
+	uint32_t width;
+	uint32_t height;
+	uint32_t bits; // 1ブロックのビット数
+};
+
+/// <summary>
+/// バッファに置いたサブリソース1つ分の配置(D3D12_PLACED_SUBRESOURCE_FOOTPRINTと同じ意味)
+/// </summary>
+struct TextureFootprint {
+	uint64_t offset;   // バッファの先頭からのバイト数
+	uint32_t width;    // ブロックの倍数に切り上げたピクセル数
+	uint32_t height;
+	uint32_t depth;
+	uint32_t rowPitch; // 行の間隔(kTextureDataPitchAlignmentの倍数)
+	uint32_t rowCount; // 1スライスの行数(圧縮フォーマットはブロックの行数)
+	uint64_t rowSize;  // 1行のうち実際にデータがあるバイト数
+};
+
+// ブロックの大きさを求める(平面が複数あるフォーマットと不明なフォーマットはfalse)
+bool GetTextureFormatBlock(DXGI_FORMAT format, TextureFormatBlock& block);
+
+// 詰めて並べたときの行と1枚のバイト数(DirectXTexのComputePitchをCP_FLAGS_NONEで呼んだときと同じ値)
+bool ComputeTexturePitch(DXGI_FORMAT format, uint64_t width, uint64_t height, uint64_t& rowPitch, uint64_t& slicePitch);
+
+// 1枚の行数(DirectXTexのComputeScanlinesと同じ値)
+uint64_t ComputeTextureRowCount(DXGI_FORMAT format, uint64_t height);
+
+// width x height x depthの範囲をoffsetから置いたときの配置を求める
+bool ComputeTextureFootprint(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depth, uint64_t offset, TextureFootprint& footprint);
+
+// 全サブリソース(D3D12の番号順: mip + arraySlice * mipLevels)の配置を求める(GetCopyableFootprintsと同じ並べ方)
+// footprintsにはmipLevels * (is3D ? 1 : depthOrArraySize)個の領域が必要。全体のバイト数を返す(失敗したら0)
+uint64_t ComputeTextureFootprints(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depthOrArraySize,
+	uint32_t mipLevels, bool is3D, TextureFootprint* footprints);
+
+// 配置が占めるバイト数(最後の行は詰めた大きさ)
+uint64_t GetTextureFootprintSize(const TextureFootprint& footprint);
+
+// 詰めて並べた画像を配置に合わせてコピーする(dstは配置のoffsetの位置を指す)
+void CopyTextureRows(uint8_t* dst, const TextureFootprint& footprint, const uint8_t* src, size_t srcRowPitch, size_t srcSlicePitch);
@@ -0,0 +1,188 @@
+#include "TextureStreamer.h"
+#include <cassert>
+#include <utility>
+
+/// <summary>
+/// ワーカーを起動する
+/// </summary>
+/// <param name="sink">GPUへのコピー先</param>
+/// <param name="decode">パスからテクスチャを読み込みmipを作る処理(ワーカーで呼ぶ)</param>
+/// <param name="workerCount">ワーカー数(0ならCPUのスレッド数-1)</param>
+/// <param name="uploadBytesPerUpdate">1回のUpdateで送るバイト数の目安(少なくとも1つのmipは送る)</param>
+TextureStreamer::TextureStreamer(TextureUploadSink& sink, DecodeFunction decode, size_t workerCount, uint64_t uploadBytesPerUpdate)
+	: sink_(sink), decode_(std::move(decode)), uploadBytesPerUpdate_(uploadBytesPerUpdate) {
+	workerPool_ = std::make_unique<ThreadPool>(workerCount);
+}
+
+/// <summary>
+/// 残っているデコードを取り消し、テクスチャを解放する
+/// </summary>
+TextureStreamer::~TextureStreamer() {
+	isCancelling_ = true;
+	workerPool_.reset();
+	for (Entry& entry : entries_) {
+		if (entry.texture) {
+			sink_.DestroyTexture(entry.texture);
+		}
+	}
+}
+
+/// <summary>
+/// 読み込みを要求する
+/// </summary>
+/// <param name="path">テクスチャのパス</param>
+/// <returns>状態を調べるための番号</returns>
+TextureStreamer::TextureHandle TextureStreamer::Request(const std::string& path) {
+	if (stats_.requestedCount == 0) {
+		firstRequestTime_ = Clock::now();
+	}
+	const TextureHandle handle = TextureHandle(entries_.size());
+	entries_.push_back({ path, TextureResidency::Decoding, nullptr, DXGI_FORMAT_UNKNOWN, 0, kNoResidentMip, {} });
+	++stats_.requestedCount;
+	stats_.allResidentSeconds = 0.0;
+
+	workerPool_->Enqueue([this, handle, path]() {
+		DecodeResult result{ handle, false, 0.0, {} };
+		if (!isCancelling_) {
+			const Clock::time_point beginTime = Clock::now();
+			result.isSucceeded = decode_(path, result.texture) && !result.texture.mips.empty();
+			result.seconds = std::chrono::duration<double>(Clock::now() - beginTime).count();
+		}
+		std::lock_guard<std::mutex> lock(resultMutex_);
+		results_.push_back(std::move(result));
+	});
+	return handle;
+}
+
+/// <summary>
+/// 読み込みを進める
+/// </summary>
+void TextureStreamer::Update() {
+	ReceiveDecodedTextures();
+	RetireUploads();
+	SubmitUploads();
+}
+
+/// <summary>
+/// デコードの済んだテクスチャの入れ物を作り、mipを送る順に並べる
+/// </summary>
+void TextureStreamer::ReceiveDecodedTextures() {
+	std::vector<DecodeResult> results;
+	{
+		std::lock_guard<std::mutex> lock(resultMutex_);
+		results.swap(results_);
+	}
+	for (DecodeResult& result : results) {
+		stats_.decodeSeconds += result.seconds;
+		Entry& entry = entries_[result.handle];
+		if (!result.isSucceeded) {
+			Fail(result.handle);
+			continue;
+		}
+		entry.texture = sink_.CreateTexture(result.texture);
+		if (!entry.texture) {
+			Fail(result.handle);
+			continue;
+		}
+		entry.residency = TextureResidency::Uploading;
+		entry.format = result.texture.format;
+		entry.mipLevels = uint32_t(result.texture.mips.size());
+		entry.decoded = std::move(result.texture);
+		for (uint32_t mipLevel = 0; mipLevel < entry.mipLevels; ++mipLevel) {
+			const DecodedMip& mip = entry.decoded.mips[mipLevel];
+			// 同じ大きさなら粗いmipを先にするため、粗いものから番号を振る
+			pendingUploads_.push({ mip.slicePitch, uploadSequence_ + (entry.mipLevels - 1 - mipLevel), result.handle, mipLevel });
+		}
+		uploadSequence_ += entry.mipLevels;
+	}
+}
+
+/// <summary>
+/// GPUが終えたコピーを反映する
+/// </summary>
+void TextureStreamer::RetireUploads() {
+	if (inFlightUploads_.empty()) {
+		return;
+	}
+	const uint64_t completedValue = sink_.GetCompletedValue();
+	size_t retiredCount = 0;
+	for (; retiredCount < inFlightUploads_.size() && inFlightUploads_[retiredCount].fenceValue <= completedValue; ++retiredCount) {
+		const InFlightUpload& upload = inFlightUploads_[retiredCount];
+		Entry& entry = entries_[upload.handle];
+		if (entry.residency != TextureResidency::Uploading) {
+			continue;
+		}
+		// 粗い順に送っているので、終わったmipまでは途切れず使える
+		assert(entry.residentMip == kNoResidentMip || upload.mipLevel < entry.residentMip);
+		if (entry.residentMip == kNoResidentMip && stats_.firstVisibleSeconds == 0.0) {
+			stats_.firstVisibleSeconds = GetSecondsSinceFirstRequest();
+		}
+		entry.residentMip = upload.mipLevel;
+		if (upload.mipLevel == 0) {
+			entry.residency = TextureResidency::Resident;
+			entry.decoded = {};
+			++stats_.residentCount;
+			if (stats_.residentCount == 1) {
+				stats_.firstResidentSeconds = GetSecondsSinceFirstRequest();
+			}
+			if (IsIdle()) {
+				stats_.allResidentSeconds = GetSecondsSinceFirstRequest();
+			}
+		}
+	}
+	inFlightUploads_.erase(inFlightUploads_.begin(), inFlightUploads_.begin() + retiredCount);
+}
+
+/// <summary>
+/// 待っているmipを小さいものから目安のバイト数まで送る
+/// </summary>
+void TextureStreamer::SubmitUploads() {
+	uint64_t uploadedBytes = 0;
+	const size_t firstInFlight = inFlightUploads_.size();
+	while (!pendingUploads_.empty()) {
+		const PendingUpload upload = pendingUploads_.top();
+		Entry& entry = entries_[upload.handle];
+		if (entry.residency != TextureResidency::Uploading) {
+			pendingUploads_.pop();
+			continue;
+		}
+		if (uploadedBytes > 0 && uploadedBytes + upload.size > uploadBytesPerUpdate_) {
+			break;
+		}
+		pendingUploads_.pop();
+		if (!sink_.UploadMip(entry.texture, upload.mipLevel, entry.decoded.mips[upload.mipLevel])) {
+			Fail(upload.handle);
+			continue;
+		}
+		uploadedBytes += upload.size;
+		inFlightUploads_.push_back({ upload.handle, upload.mipLevel, 0 });
+	}
+	if (inFlightUploads_.size() == firstInFlight) {
+		return;
+	}
+	const uint64_t fenceValue = sink_.Submit();
+	for (size_t i = firstInFlight; i < inFlightUploads_.size(); ++i) {
+		inFlightUploads_[i].fenceValue = fenceValue;
+	}
+	stats_.uploadedBytes += uploadedBytes;
+}
+
+/// <summary>
+/// 失敗にする(テクスチャはGPUが使っているかもしれないので破棄まで残す)
+/// </summary>
+void TextureStreamer::Fail(TextureHandle handle) {
+	Entry& entry = entries_[handle];
+	entry.residency = TextureResidency::Failed;
+	entry.decoded = {};
+	++stats_.failedCount;
+	if (IsIdle()) {
+		stats_.allResidentSeconds = GetSecondsSinceFirstRequest();
+	}
+}
+
+/// <summary>
+/// 最初のRequestからの秒数
+/// </summary>
+double TextureStreamer::GetSecondsSinceFirstRequest() const {
+	return std::chrono::duration<double>(Clock::now() - firstRequestTime_).count();
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <dxgiformat.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+/// <summary>
+/// デコードした1つのmip(画素はDecodedTexture::storageが持つ)
+/// </summary>
+struct DecodedMip {
+	const uint8_t* pixels;
+	size_t rowPitch;
+	size_t slicePitch;
+	uint32_t width;
+	uint32_t height;
+};
+
+/// <summary>
+/// デコードしてmipを作ったテクスチャ
+/// </summary>
+struct DecodedTexture {
+	DXGI_FORMAT format;
+	uint32_t width;
+	uint32_t height;
+	std::vector<DecodedMip> mips; // 0が最も細かい
+	std::shared_ptr<void> storage; // 画素を持つもの(ScratchImageなど)
+};
+
+/// <summary>
+/// テクスチャの状態
+/// </summary>
+enum class TextureResidency {
+	Decoding,  // ワーカーで読み込みとmipの作成を待っている
+	Uploading, // 粗いmipから順にGPUへ送っている(一部は使えることがある)
+	Resident,  // すべてのmipが使える
+	Failed,
+};
+
+/// <summary>
+/// GPUへのコピー先(TextureStreamerはこれを通してだけGPUを触る)
+/// </summary>
+class TextureUploadSink {
+public:
+	virtual ~TextureUploadSink() = default;
+
+	// 全mipの入れ物を作る(失敗したらnullptr)
+	virtual void* CreateTexture(const DecodedTexture& texture) = 0;
+
+	// 1つのmipのコピーを積む
+	virtual bool UploadMip(void* texture, uint32_t mipLevel, const DecodedMip& mip) = 0;
+
+	// 積んだコピーを送り、それが終わったとわかるフェンスの値を返す
+	virtual uint64_t Submit() = 0;
+
+	// GPUが処理し終えたフェンスの値
+	virtual uint64_t GetCompletedValue() = 0;
+
+	// テクスチャを解放する
+	virtual void DestroyTexture(void* texture) = 0;
+};
+
+/// <summary>
+/// 読み込みの統計(時間は最初のRequestから)
+/// </summary>
+struct TextureStreamingStats {
+	uint32_t requestedCount;
+	uint32_t residentCount;
+	uint32_t failedCount;
+	uint64_t uploadedBytes;
+	double decodeSeconds;        // ワーカーでのデコード時間の合計
+	double firstVisibleSeconds;  // 最初にどれかのmipが使えるようになるまで
+	double firstResidentSeconds; // 最初にすべてのmipが使えるようになるまで
+	double allResidentSeconds;   // 要求したすべてが終わるまで(終わるまでは0)
+};
+
+/// <summary>
+/// テクスチャをワーカーで読み込み、できたものから粗いmipを先にGPUへ送る
+/// 状態の更新とGPUへのコピーはメインスレッドのUpdateだけで行う
+/// </summary>
+class TextureStreamer {
+public:
+	using TextureHandle = uint32_t;
+	using DecodeFunction = std::function<bool(const std::string& path, DecodedTexture& texture)>;
+	// まだどのmipも使えないときのGetResidentMip
+	static constexpr uint32_t kNoResidentMip = UINT32_MAX;
+
+	// decodeはワーカーから同時に呼ばれる。uploadBytesPerUpdateは1回のUpdateで送る目安
+	TextureStreamer(TextureUploadSink& sink, DecodeFunction decode, size_t workerCount, uint64_t uploadBytesPerUpdate);
+	// GPUがコピーとテクスチャを使い終わってから破棄すること(まだデコードしていない要求は取り消す)
+	~TextureStreamer();
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// 読み込みを要求する(同じパスでも別のテクスチャになる)
+	TextureHandle Request(const std::string& path);
+
+	// デコードの済んだものを受け取り、コピーを送り、終わったコピーを反映する(毎フレーム呼ぶ)
+	void Update();
+
+	TextureResidency GetResidency(TextureHandle handle) const { return entries_[handle].residency; }
+	// 使える最も細かいmip(これより粗いmipはすべて使える)
+	uint32_t GetResidentMip(TextureHandle handle) const { return entries_[handle].residentMip; }
+	uint32_t GetMipLevels(TextureHandle handle) const { return entries_[handle].mipLevels; }
+	DXGI_FORMAT GetFormat(TextureHandle handle) const { return entries_[handle].format; }
+	void* GetTexture(TextureHandle handle) const { return entries_[handle].texture; }
+	const std::string& GetPath(TextureHandle handle) const { return entries_[handle].path; }
+
+	// 要求したすべてが使えるか失敗した
+	bool IsIdle() const { return stats_.residentCount + stats_.failedCount == stats_.requestedCount; }
+	const TextureStreamingStats& GetStats() const { return stats_; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string path;
+		TextureResidency residency;
+		void* texture;
+		DXGI_FORMAT format;
+		uint32_t mipLevels;
+		uint32_t residentMip;
+		DecodedTexture decoded; // すべて送り終えるまで持つ
+	};
+
+	struct DecodeResult {
+		TextureHandle handle;
+		bool isSucceeded;
+		double seconds;
+		DecodedTexture texture;
+	};
+
+	// 送るのを待っているmip(小さいものから送る。同じテクスチャでは粗い順になる)
+	struct PendingUpload {
+		uint64_t size;
+		uint64_t sequence;
+		TextureHandle handle;
+		uint32_t mipLevel;
+		bool operator>(const PendingUpload& other) const {
+			return size != other.size ? size > other.size : sequence > other.sequence;
+		}
+	};
+
+	struct InFlightUpload {
+		TextureHandle handle;
+		uint32_t mipLevel;
+		uint64_t fenceValue;
+	};
+
+	void ReceiveDecodedTextures();
+	void RetireUploads();
+	void SubmitUploads();
+	void Fail(TextureHandle handle);
+	double GetSecondsSinceFirstRequest() const;
+
+	TextureUploadSink& sink_;
+	DecodeFunction decode_;
+	uint64_t uploadBytesPerUpdate_;
+	std::vector<Entry> entries_;
+	std::priority_queue<PendingUpload, std::vector<PendingUpload>, std::greater<PendingUpload>> pendingUploads_;
+	std::vector<InFlightUpload> inFlightUploads_;
+	uint64_t uploadSequence_ = 0;
+	Clock::time_point firstRequestTime_{};
+	TextureStreamingStats stats_{};
+
+	// ワーカーから渡される結果
+	std::mutex resultMutex_;
+	std::vector<DecodeResult> results_;
+	std::atomic<bool> isCancelling_{ false };
+
+	// 最後に宣言して最初に破棄する(ワーカーが止まってから他のメンバーを破棄する)
+	std::unique_ptr<ThreadPool> workerPool_;
+};
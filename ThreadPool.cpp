@@ -0,0 +1,128 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+/// <summary>
+/// ワーカースレッドを起動する
+/// </summary>
+/// <param name="workerCount">ワーカー数(0ならCPUのスレッド数-1)</param>
+ThreadPool::ThreadPool(size_t workerCount) {
+	if (workerCount == 0) {
+		const unsigned int hardwareCount = std::thread::hardware_concurrency();
+		workerCount = hardwareCount > 1 ? hardwareCount - 1 : 0;
+	}
+	workers_.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; ++i) {
+		workers_.emplace_back([this]() { WorkerMain(); });
+	}
+}
+
+/// <summary>
+/// 残っているタスクを実行し終えてからワーカーを止める
+/// </summary>
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+	}
+	condition_.notify_all();
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+}
+
+/// <summary>
+/// タスクを追加する
+/// </summary>
+/// <param name="task">タスク</param>
+void ThreadPool::Enqueue(std::function<void()> task) {
+	if (workers_.empty()) {
+		// ワーカーがいなければその場で実行する
+		task();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push_back(std::move(task));
+	}
+	condition_.notify_one();
+}
+
+/// <summary>
+/// 番号ごとの処理を並列に実行する
+/// </summary>
+/// <param name="count">番号の数</param>
+/// <param name="function">番号を受け取る処理</param>
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& function) {
+	if (count == 0) {
+		return;
+	}
+	// 遅れて始まったワーカーが参照しても大丈夫なように共有で持つ
+	struct State {
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable condition;
+		const std::function<void(size_t)>* function = nullptr;
+		size_t count = 0;
+	};
+	auto state = std::make_shared<State>();
+	state->function = &function;
+	state->count = count;
+
+	auto run = [](State& s) {
+		for (size_t i = s.next.fetch_add(1); i < s.count; i = s.next.fetch_add(1)) {
+			(*s.function)(i);
+			if (s.done.fetch_add(1) + 1 == s.count) {
+				std::lock_guard<std::mutex> lock(s.mutex);
+				s.condition.notify_all();
+			}
+		}
+	};
+
+	const size_t helperCount = std::min(workers_.size(), count - 1);
+	for (size_t i = 0; i < helperCount; ++i) {
+		Enqueue([state, run]() { run(*state); });
+	}
+	// 呼び出し側も処理する(ワーカーから呼ばれても止まらない)
+	run(*state);
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&]() { return state->done.load() == count; });
+}
+
+/// <summary>
+/// ワーカースレッドの処理
+/// </summary>
+void ThreadPool::WorkerMain() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return isStopping_ || !tasks_.empty(); });
+			if (tasks_.empty()) {
+				return;
+			}
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+		task();
+	}
+}
+
+/// <summary>
+/// スレッドプールがあれば並列に、なければ順に実行する
+/// </summary>
+/// <param name="pool">スレッドプール(nullptrでもよい)</param>
+/// <param name="count">番号の数</param>
+/// <param name="function">番号を受け取る処理</param>
+void ParallelFor(ThreadPool* pool, size_t count, const std::function<void(size_t)>& function) {
+	if (pool) {
+		pool->ParallelFor(count, function);
+		return;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		function(i);
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// ワーカースレッドでタスクを実行するスレッドプール
+/// </summary>
+class ThreadPool {
+public:
+	// workerCountが0ならCPUのスレッド数-1(呼び出し側も処理に加わるため)
+	explicit ThreadPool(size_t workerCount = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// タスクを追加する(完了は待たない)
+	void Enqueue(std::function<void()> task);
+
+	// function(0)～function(count - 1)をワーカーと呼び出し側で分担して実行し、すべて終わるまで待つ
+	void ParallelFor(size_t count, const std::function<void(size_t)>& function);
+
+	size_t GetWorkerCount() const { return workers_.size(); }
+
+private:
+	void WorkerMain();
+
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::function<void()>> tasks_;
+	bool isStopping_ = false;
+};
+
+// poolがnullptrなら呼び出し側だけで順に実行する
+void ParallelFor(ThreadPool* pool, size_t count, const std::function<void(size_t)>& function);
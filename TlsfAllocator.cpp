@@ -0,0 +1,270 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace {
+
+uint32_t Log2(uint64_t value) {
+	return uint32_t(std::bit_width(value)) - 1;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+/// <summary>
+/// 範囲全体を1つの空きブロックにする
+/// </summary>
+/// <param name="capacity">範囲のバイト数(granularityの倍数)</param>
+/// <param name="granularity">管理の単位(2のべき乗)</param>
+TlsfAllocator::TlsfAllocator(uint64_t capacity, uint64_t granularity)
+	: capacity_(capacity / granularity), granularity_(granularity), granularityLog2_(Log2(granularity)) {
+	assert(std::has_single_bit(granularity));
+	assert(capacity % granularity == 0 && capacity_ > 0);
+	for (uint32_t firstLevel = 0; firstLevel < kFirstLevelCount; ++firstLevel) {
+		std::fill(std::begin(freeLists_[firstLevel]), std::end(freeLists_[firstLevel]), kInvalidBlock);
+	}
+	const uint32_t block = NewBlock();
+	blocks_[block] = { 0, capacity_, kInvalidBlock, kInvalidBlock, kInvalidBlock, kInvalidBlock, false };
+	InsertFreeBlock(block);
+}
+
+/// <summary>
+/// 領域を切り出す
+/// </summary>
+/// <param name="size">バイト数</param>
+/// <param name="alignment">オフセットの境界(2のべき乗のバイト数)</param>
+/// <param name="allocation">切り出した領域</param>
+/// <returns>入る空きがなければfalse</returns>
+bool TlsfAllocator::Allocate(uint64_t size, uint64_t alignment, TlsfAllocation& allocation) {
+	assert(std::has_single_bit(alignment));
+	allocation = { 0, 0, kInvalidBlock };
+	const uint64_t unitSize = std::max<uint64_t>(1, (size + granularity_ - 1) >> granularityLog2_);
+	const uint64_t unitAlignment = alignment > granularity_ ? alignment >> granularityLog2_ : 1;
+	if (unitSize > capacity_) {
+		return false;
+	}
+
+	// まず境界を考えずに探し、見つかったブロックがそのまま境界に合えば使う
+	uint32_t block = FindFreeBlock(unitSize);
+	if (block != kInvalidBlock && unitAlignment > 1 &&
+		AlignUp(blocks_[block].offset, unitAlignment) + unitSize > blocks_[block].offset + blocks_[block].size) {
+		block = kInvalidBlock;
+	}
+	// 合わなければ境界合わせの余白も含めて入るブロックを探す
+	if (block == kInvalidBlock && unitAlignment > 1 && unitSize + unitAlignment - 1 <= capacity_) {
+		block = FindFreeBlock(unitSize + unitAlignment - 1);
+	}
+	if (block == kInvalidBlock) {
+		return false;
+	}
+	RemoveFreeBlock(block);
+
+	// 境界までの余白を前の空きブロックとして切り離す
+	const uint64_t padding = AlignUp(blocks_[block].offset, unitAlignment) - blocks_[block].offset;
+	if (padding > 0) {
+		const uint32_t rest = SplitBlock(block, padding);
+		InsertFreeBlock(block);
+		block = rest;
+	}
+	// 余りを後ろの空きブロックとして切り離す
+	if (blocks_[block].size > unitSize) {
+		InsertFreeBlock(SplitBlock(block, unitSize));
+	}
+
+	blocks_[block].isFree = false;
+	++allocationCount_;
+	allocation = { blocks_[block].offset << granularityLog2_, blocks_[block].size << granularityLog2_, block };
+	return true;
+}
+
+/// <summary>
+/// 領域を戻す
+/// </summary>
+/// <param name="block">Allocateで得た番号</param>
+void TlsfAllocator::Free(uint32_t block) {
+	assert(block < blocks_.size() && !blocks_[block].isFree);
+	--allocationCount_;
+
+	// 前が空いていればつなげる
+	const uint32_t previous = blocks_[block].previousPhysical;
+	if (previous != kInvalidBlock && blocks_[previous].isFree) {
+		RemoveFreeBlock(previous);
+		blocks_[previous].size += blocks_[block].size;
+		blocks_[previous].nextPhysical = blocks_[block].nextPhysical;
+		if (blocks_[block].nextPhysical != kInvalidBlock) {
+			blocks_[blocks_[block].nextPhysical].previousPhysical = previous;
+		}
+		DeleteBlock(block);
+		block = previous;
+	}
+	// 後ろが空いていればつなげる
+	const uint32_t next = blocks_[block].nextPhysical;
+	if (next != kInvalidBlock && blocks_[next].isFree) {
+		RemoveFreeBlock(next);
+		blocks_[block].size += blocks_[next].size;
+		blocks_[block].nextPhysical = blocks_[next].nextPhysical;
+		if (blocks_[next].nextPhysical != kInvalidBlock) {
+			blocks_[blocks_[next].nextPhysical].previousPhysical = block;
+		}
+		DeleteBlock(next);
+	}
+	InsertFreeBlock(block);
+}
+
+/// <summary>
+/// 統計を求める
+/// </summary>
+TlsfStats TlsfAllocator::GetStats() const {
+	TlsfStats stats{};
+	stats.capacity = capacity_ << granularityLog2_;
+	stats.freeSize = freeSize_ << granularityLog2_;
+	stats.allocatedSize = stats.capacity - stats.freeSize;
+	stats.allocationCount = allocationCount_;
+	stats.freeBlockCount = freeBlockCount_;
+	// 最大の空きブロックは一番大きいリストの中にある
+	if (firstLevelBitmap_ != 0) {
+		const uint32_t firstLevel = Log2(firstLevelBitmap_);
+		const uint32_t secondLevel = Log2(secondLevelBitmaps_[firstLevel]);
+		uint64_t largest = 0;
+		for (uint32_t block = freeLists_[firstLevel][secondLevel]; block != kInvalidBlock; block = blocks_[block].nextFree) {
+			largest = std::max(largest, blocks_[block].size);
+		}
+		stats.largestFreeBlock = largest << granularityLog2_;
+		stats.fragmentation = 1.0f - float(double(largest) / double(freeSize_));
+	}
+	return stats;
+}
+
+/// <summary>
+/// 大きさから入れるリストの番号を求める
+/// </summary>
+void TlsfAllocator::MappingInsert(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) {
+	if (size < kSecondLevelCount) {
+		// 小さいものは1単位ごとのリスト
+		firstLevel = 0;
+		secondLevel = uint32_t(size);
+	} else {
+		const uint32_t log2 = Log2(size);
+		secondLevel = uint32_t(size >> (log2 - kSecondLevelLog2)) ^ kSecondLevelCount;
+		firstLevel = log2 - kSecondLevelLog2 + 1;
+	}
+}
+
+/// <summary>
+/// size以上が必ず入っているリストから空きブロックを探す
+/// </summary>
+/// <returns>見つからなければkInvalidBlock</returns>
+uint32_t TlsfAllocator::FindFreeBlock(uint64_t size) const {
+	// 同じリストには小さいものも混ざるので、次のリストの境界まで切り上げてから探す
+	if (size >= kSecondLevelCount) {
+		size += (uint64_t(1) << (Log2(size) - kSecondLevelLog2)) - 1;
+	}
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	MappingInsert(size, firstLevel, secondLevel);
+	if (firstLevel >= kFirstLevelCount) {
+		return kInvalidBlock;
+	}
+	uint32_t secondLevelMap = secondLevelBitmaps_[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0) {
+		const uint64_t firstLevelMap = firstLevel + 1 < 64 ? firstLevelBitmap_ & (~uint64_t(0) << (firstLevel + 1)) : 0;
+		if (firstLevelMap == 0) {
+			return kInvalidBlock;
+		}
+		firstLevel = uint32_t(std::countr_zero(firstLevelMap));
+		secondLevelMap = secondLevelBitmaps_[firstLevel];
+	}
+	secondLevel = uint32_t(std::countr_zero(secondLevelMap));
+	return freeLists_[firstLevel][secondLevel];
+}
+
+/// <summary>
+/// 空きブロックをリストの先頭に入れる
+/// </summary>
+void TlsfAllocator::InsertFreeBlock(uint32_t block) {
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	MappingInsert(blocks_[block].size, firstLevel, secondLevel);
+	const uint32_t head = freeLists_[firstLevel][secondLevel];
+	blocks_[block].isFree = true;
+	blocks_[block].previousFree = kInvalidBlock;
+	blocks_[block].nextFree = head;
+	if (head != kInvalidBlock) {
+		blocks_[head].previousFree = block;
+	}
+	freeLists_[firstLevel][secondLevel] = block;
+	firstLevelBitmap_ |= uint64_t(1) << firstLevel;
+	secondLevelBitmaps_[firstLevel] |= 1u << secondLevel;
+	freeSize_ += blocks_[block].size;
+	++freeBlockCount_;
+}
+
+/// <summary>
+/// 空きブロックをリストから外す
+/// </summary>
+void TlsfAllocator::RemoveFreeBlock(uint32_t block) {
+	uint32_t firstLevel = 0;
+	uint32_t secondLevel = 0;
+	MappingInsert(blocks_[block].size, firstLevel, secondLevel);
+	const uint32_t previous = blocks_[block].previousFree;
+	const uint32_t next = blocks_[block].nextFree;
+	if (previous != kInvalidBlock) {
+		blocks_[previous].nextFree = next;
+	} else {
+		freeLists_[firstLevel][secondLevel] = next;
+		// リストが空になったらビットを落とす
+		if (next == kInvalidBlock) {
+			secondLevelBitmaps_[firstLevel] &= ~(1u << secondLevel);
+			if (secondLevelBitmaps_[firstLevel] == 0) {
+				firstLevelBitmap_ &= ~(uint64_t(1) << firstLevel);
+			}
+		}
+	}
+	if (next != kInvalidBlock) {
+		blocks_[next].previousFree = previous;
+	}
+	blocks_[block].isFree = false;
+	freeSize_ -= blocks_[block].size;
+	--freeBlockCount_;
+}
+
+/// <summary>
+/// ブロックの記録を用意する(使い終わった記録を再利用する)
+/// </summary>
+uint32_t TlsfAllocator::NewBlock() {
+	if (!unusedBlocks_.empty()) {
+		const uint32_t block = unusedBlocks_.back();
+		unusedBlocks_.pop_back();
+		return block;
+	}
+	blocks_.push_back({});
+	return uint32_t(blocks_.size() - 1);
+}
+
+/// <summary>
+/// ブロックの記録を再利用に回す
+/// </summary>
+void TlsfAllocator::DeleteBlock(uint32_t block) {
+	unusedBlocks_.push_back(block);
+}
+
+/// <summary>
+/// ブロックを先頭size単位と残りに分ける
+/// </summary>
+/// <returns>残りのブロック(どのリストにも入っていない)</returns>
+uint32_t TlsfAllocator::SplitBlock(uint32_t block, uint64_t size) {
+	assert(size < blocks_[block].size);
+	const uint32_t rest = NewBlock();
+	Block& original = blocks_[block];
+	blocks_[rest] = { original.offset + size, original.size - size, block, original.nextPhysical, kInvalidBlock, kInvalidBlock, false };
+	if (original.nextPhysical != kInvalidBlock) {
+		blocks_[original.nextPhysical].previousPhysical = rest;
+	}
+	original.nextPhysical = rest;
+	original.size = size;
+	return rest;
+}
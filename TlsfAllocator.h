@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// TlsfAllocatorから切り出した領域
+/// </summary>
+struct TlsfAllocation {
+	uint64_t offset;
+	uint64_t size;
+	uint32_t block; // Freeに渡す番号
+};
+
+/// <summary>
+/// 空き領域の統計
+/// </summary>
+struct TlsfStats {
+	uint64_t capacity;
+	uint64_t allocatedSize;
+	uint64_t freeSize;
+	uint64_t largestFreeBlock;
+	uint32_t allocationCount;
+	uint32_t freeBlockCount;
+	float fragmentation; // 1 - 最大の空きブロック / 空きの合計(0なら空きが1つにまとまっている)
+};
+
+/// <summary>
+/// 二段の分離適合(TLSF)で1つの範囲[0, capacity)を切り分けるアロケータ
+/// 空きブロックを大きさの範囲ごとのリストに入れ、ビットマップから定数時間で見つける
+/// メモリそのものは持たず、オフセットだけを管理する(GPUのヒープなどに使う)
+/// </summary>
+class TlsfAllocator {
+public:
+	static constexpr uint32_t kInvalidBlock = UINT32_MAX;
+
+	// capacityとgranularity(2のべき乗)はバイト数。大きさと配置はgranularity単位に切り上げる
+	TlsfAllocator(uint64_t capacity, uint64_t granularity);
+
+	// sizeバイトをalignment(2のべき乗)の倍数のオフセットに切り出す(空きがなければfalse)
+	bool Allocate(uint64_t size, uint64_t alignment, TlsfAllocation& allocation);
+
+	// 切り出した領域を戻す(隣の空きとつなげる)
+	void Free(uint32_t block);
+
+	bool IsEmpty() const { return allocationCount_ == 0; }
+	uint64_t GetCapacity() const { return capacity_ * granularity_; }
+	TlsfStats GetStats() const;
+
+private:
+	// 2段目の分割数(1段目の2のべき乗の範囲を32に分ける)
+	static constexpr uint32_t kSecondLevelLog2 = 5;
+	static constexpr uint32_t kSecondLevelCount = 1u << kSecondLevelLog2;
+	static constexpr uint32_t kFirstLevelCount = 64 - kSecondLevelLog2 + 1;
+
+	struct Block {
+		uint64_t offset; // granularity単位
+		uint64_t size;   // granularity単位
+		uint32_t previousPhysical;
+		uint32_t nextPhysical;
+		uint32_t previousFree;
+		uint32_t nextFree;
+		bool isFree;
+	};
+
+	static void MappingInsert(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+	uint32_t FindFreeBlock(uint64_t size) const;
+	void InsertFreeBlock(uint32_t block);
+	void RemoveFreeBlock(uint32_t block);
+	uint32_t NewBlock();
+	void DeleteBlock(uint32_t block);
+	uint32_t SplitBlock(uint32_t block, uint64_t size);
+
+	uint64_t capacity_;
+	uint64_t granularity_;
+	uint32_t granularityLog2_;
+	std::vector<Block> blocks_;
+	std::vector<uint32_t> unusedBlocks_;
+	uint64_t firstLevelBitmap_ = 0;
+	uint32_t secondLevelBitmaps_[kFirstLevelCount] = {};
+	uint32_t freeLists_[kFirstLevelCount][kSecondLevelCount];
+	uint64_t freeSize_ = 0;
+	uint32_t allocationCount_ = 0;
+	uint32_t freeBlockCount_ = 0;
+};
@@ -0,0 +1,282 @@
+#include "TransformBatch.h"
+#include "MatrixMath.h"
+#include "SimdSupport.h"
+#include "SinCos.h"
+
+namespace {
+
+// 一度にSoAへ並べ替えるインスタンス数
+constexpr size_t kChunkSize = 64;
+
+/// <summary>
+/// Transformをインスタンス方向に並べ替えたもの(Structure of Arrays)
+/// </summary>
+struct TransformSoA {
+	alignas(32) float scaleX[kChunkSize];
+	alignas(32) float scaleY[kChunkSize];
+	alignas(32) float scaleZ[kChunkSize];
+	alignas(32) float rotateX[kChunkSize];
+	alignas(32) float rotateY[kChunkSize];
+	alignas(32) float rotateZ[kChunkSize];
+	alignas(32) float sinX[kChunkSize];
+	alignas(32) float cosX[kChunkSize];
+	alignas(32) float sinY[kChunkSize];
+	alignas(32) float cosY[kChunkSize];
+	alignas(32) float sinZ[kChunkSize];
+	alignas(32) float cosZ[kChunkSize];
+	alignas(32) float translateX[kChunkSize];
+	alignas(32) float translateY[kChunkSize];
+	alignas(32) float translateZ[kChunkSize];
+};
+
+/// <summary>
+/// AoSのTransformをSoAに並べ替え、回転のsin/cosを求める
+/// </summary>
+void GatherTransforms(const Transform* transforms, size_t count, TransformSoA& soa) {
+	for (size_t i = 0; i < count; i++) {
+		const Transform& transform = transforms[i];
+		soa.scaleX[i] = transform.scale.x;
+		soa.scaleY[i] = transform.scale.y;
+		soa.scaleZ[i] = transform.scale.z;
+		soa.rotateX[i] = transform.rotate.x;
+		soa.rotateY[i] = transform.rotate.y;
+		soa.rotateZ[i] = transform.rotate.z;
+		soa.translateX[i] = transform.translate.x;
+		soa.translateY[i] = transform.translate.y;
+		soa.translateZ[i] = transform.translate.z;
+	}
+	// 軸ごとにまとめてsin/cosを求める
+	SinCosArray(soa.rotateX, soa.sinX, soa.cosX, count);
+	SinCosArray(soa.rotateY, soa.sinY, soa.cosY, count);
+	SinCosArray(soa.rotateZ, soa.sinZ, soa.cosZ, count);
+}
+
+/// <summary>
+/// 1インスタンス分の計算(スカラー)
+/// MakeAffineMatrixと同じ T * S * (Rx * Ry * Rz) を要素ごとに直接求める
+/// </summary>
+void ComputeOne(const TransformSoA& soa, size_t i, const Matrix4x4& viewProjection, TransformationMatrix& output) {
+	const float sinX = soa.sinX[i], cosX = soa.cosX[i];
+	const float sinY = soa.sinY[i], cosY = soa.cosY[i];
+	const float sinZ = soa.sinZ[i], cosZ = soa.cosZ[i];
+
+	float(&world)[4][4] = output.world.m;
+	world[0][0] = soa.scaleX[i] * (cosY * cosZ);
+	world[0][1] = soa.scaleX[i] * (cosY * sinZ);
+	world[0][2] = soa.scaleX[i] * (-sinY);
+	world[0][3] = 0.0f;
+	world[1][0] = soa.scaleY[i] * (sinX * sinY * cosZ - cosX * sinZ);
+	world[1][1] = soa.scaleY[i] * (sinX * sinY * sinZ + cosX * cosZ);
+	world[1][2] = soa.scaleY[i] * (sinX * cosY);
+	world[1][3] = 0.0f;
+	world[2][0] = soa.scaleZ[i] * (cosX * sinY * cosZ + sinX * sinZ);
+	world[2][1] = soa.scaleZ[i] * (cosX * sinY * sinZ - sinX * cosZ);
+	world[2][2] = soa.scaleZ[i] * (cosX * cosY);
+	world[2][3] = 0.0f;
+	for (int column = 0; column < 3; column++) {
+		world[3][column] = soa.translateX[i] * world[0][column] + soa.translateY[i] * world[1][column] + soa.translateZ[i] * world[2][column];
+	}
+	world[3][3] = 1.0f;
+
+	// ワールド行列はアフィンなので4列目の掛け算を省く
+	const float(&vp)[4][4] = viewProjection.m;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			output.WVP.m[row][column] = world[row][0] * vp[0][column] + world[row][1] * vp[1][column] +
+				world[row][2] * vp[2][column] + (row == 3 ? vp[3][column] : 0.0f);
+		}
+	}
+}
+
+#if SIMD_X86
+
+/// <summary>
+/// 4インスタンス分の計算(SSE2)
+/// 各レジスタは同じ要素を4インスタンス分持つ
+/// </summary>
+void ComputeBlock4(const TransformSoA& soa, size_t i, const Matrix4x4& viewProjection, TransformationMatrix* outputs) {
+	const __m128 sinX = _mm_load_ps(soa.sinX + i), cosX = _mm_load_ps(soa.cosX + i);
+	const __m128 sinY = _mm_load_ps(soa.sinY + i), cosY = _mm_load_ps(soa.cosY + i);
+	const __m128 sinZ = _mm_load_ps(soa.sinZ + i), cosZ = _mm_load_ps(soa.cosZ + i);
+	const __m128 scaleX = _mm_load_ps(soa.scaleX + i);
+	const __m128 scaleY = _mm_load_ps(soa.scaleY + i);
+	const __m128 scaleZ = _mm_load_ps(soa.scaleZ + i);
+	const __m128 translateX = _mm_load_ps(soa.translateX + i);
+	const __m128 translateY = _mm_load_ps(soa.translateY + i);
+	const __m128 translateZ = _mm_load_ps(soa.translateZ + i);
+
+	const __m128 sinXsinY = _mm_mul_ps(sinX, sinY);
+	const __m128 cosXsinY = _mm_mul_ps(cosX, sinY);
+
+	// ワールド行列の上3行(w[row][column])
+	__m128 w[4][4];
+	w[0][0] = _mm_mul_ps(scaleX, _mm_mul_ps(cosY, cosZ));
+	w[0][1] = _mm_mul_ps(scaleX, _mm_mul_ps(cosY, sinZ));
+	w[0][2] = _mm_mul_ps(scaleX, _mm_sub_ps(_mm_setzero_ps(), sinY));
+	w[1][0] = _mm_mul_ps(scaleY, _mm_sub_ps(_mm_mul_ps(sinXsinY, cosZ), _mm_mul_ps(cosX, sinZ)));
+	w[1][1] = _mm_mul_ps(scaleY, _mm_add_ps(_mm_mul_ps(sinXsinY, sinZ), _mm_mul_ps(cosX, cosZ)));
+	w[1][2] = _mm_mul_ps(scaleY, _mm_mul_ps(sinX, cosY));
+	w[2][0] = _mm_mul_ps(scaleZ, _mm_add_ps(_mm_mul_ps(cosXsinY, cosZ), _mm_mul_ps(sinX, sinZ)));
+	w[2][1] = _mm_mul_ps(scaleZ, _mm_sub_ps(_mm_mul_ps(cosXsinY, sinZ), _mm_mul_ps(sinX, cosZ)));
+	w[2][2] = _mm_mul_ps(scaleZ, _mm_mul_ps(cosX, cosY));
+	// 平行移動の行
+	for (int column = 0; column < 3; column++) {
+		w[3][column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(translateX, w[0][column]), _mm_mul_ps(translateY, w[1][column])),
+			_mm_mul_ps(translateZ, w[2][column]));
+	}
+	w[0][3] = w[1][3] = w[2][3] = _mm_setzero_ps();
+	w[3][3] = _mm_set1_ps(1.0f);
+
+	// WVP = world * viewProjection
+	const float(&vp)[4][4] = viewProjection.m;
+	__m128 wvp[4][4];
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			__m128 sum = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(w[row][0], _mm_set1_ps(vp[0][column])),
+				_mm_mul_ps(w[row][1], _mm_set1_ps(vp[1][column]))),
+				_mm_mul_ps(w[row][2], _mm_set1_ps(vp[2][column])));
+			if (row == 3) {
+				sum = _mm_add_ps(sum, _mm_set1_ps(vp[3][column]));
+			}
+			wvp[row][column] = sum;
+		}
+	}
+
+	// SoAからインスタンスごとの行に転置して書き込む
+	for (int row = 0; row < 4; row++) {
+		__m128 c0 = w[row][0], c1 = w[row][1], c2 = w[row][2], c3 = w[row][3];
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(outputs[0].world.m[row], c0);
+		_mm_storeu_ps(outputs[1].world.m[row], c1);
+		_mm_storeu_ps(outputs[2].world.m[row], c2);
+		_mm_storeu_ps(outputs[3].world.m[row], c3);
+
+		c0 = wvp[row][0], c1 = wvp[row][1], c2 = wvp[row][2], c3 = wvp[row][3];
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(outputs[0].WVP.m[row], c0);
+		_mm_storeu_ps(outputs[1].WVP.m[row], c1);
+		_mm_storeu_ps(outputs[2].WVP.m[row], c2);
+		_mm_storeu_ps(outputs[3].WVP.m[row], c3);
+	}
+}
+
+/// <summary>
+/// 4本のymmを128bitレーンごとに転置し、インスタンス8個分の同じ行を書き込む
+/// </summary>
+SIMD_TARGET_AVX2 inline void StoreTransposed8(__m256 c0, __m256 c1, __m256 c2, __m256 c3, float* const* rows) {
+	const __m256 t0 = _mm256_unpacklo_ps(c0, c1);
+	const __m256 t1 = _mm256_unpacklo_ps(c2, c3);
+	const __m256 t2 = _mm256_unpackhi_ps(c0, c1);
+	const __m256 t3 = _mm256_unpackhi_ps(c2, c3);
+	const __m256 r0 = _mm256_shuffle_ps(t0, t1, 0x44);
+	const __m256 r1 = _mm256_shuffle_ps(t0, t1, 0xEE);
+	const __m256 r2 = _mm256_shuffle_ps(t2, t3, 0x44);
+	const __m256 r3 = _mm256_shuffle_ps(t2, t3, 0xEE);
+	_mm_storeu_ps(rows[0], _mm256_castps256_ps128(r0));
+	_mm_storeu_ps(rows[1], _mm256_castps256_ps128(r1));
+	_mm_storeu_ps(rows[2], _mm256_castps256_ps128(r2));
+	_mm_storeu_ps(rows[3], _mm256_castps256_ps128(r3));
+	_mm_storeu_ps(rows[4], _mm256_extractf128_ps(r0, 1));
+	_mm_storeu_ps(rows[5], _mm256_extractf128_ps(r1, 1));
+	_mm_storeu_ps(rows[6], _mm256_extractf128_ps(r2, 1));
+	_mm_storeu_ps(rows[7], _mm256_extractf128_ps(r3, 1));
+}
+
+/// <summary>
+/// 8インスタンス分の計算(AVX2)
+/// </summary>
+SIMD_TARGET_AVX2 void ComputeBlock8(const TransformSoA& soa, size_t i, const Matrix4x4& viewProjection, TransformationMatrix* outputs) {
+	const __m256 sinX = _mm256_load_ps(soa.sinX + i), cosX = _mm256_load_ps(soa.cosX + i);
+	const __m256 sinY = _mm256_load_ps(soa.sinY + i), cosY = _mm256_load_ps(soa.cosY + i);
+	const __m256 sinZ = _mm256_load_ps(soa.sinZ + i), cosZ = _mm256_load_ps(soa.cosZ + i);
+	const __m256 scaleX = _mm256_load_ps(soa.scaleX + i);
+	const __m256 scaleY = _mm256_load_ps(soa.scaleY + i);
+	const __m256 scaleZ = _mm256_load_ps(soa.scaleZ + i);
+	const __m256 translateX = _mm256_load_ps(soa.translateX + i);
+	const __m256 translateY = _mm256_load_ps(soa.translateY + i);
+	const __m256 translateZ = _mm256_load_ps(soa.translateZ + i);
+
+	const __m256 sinXsinY = _mm256_mul_ps(sinX, sinY);
+	const __m256 cosXsinY = _mm256_mul_ps(cosX, sinY);
+
+	__m256 w[4][4];
+	w[0][0] = _mm256_mul_ps(scaleX, _mm256_mul_ps(cosY, cosZ));
+	w[0][1] = _mm256_mul_ps(scaleX, _mm256_mul_ps(cosY, sinZ));
+	w[0][2] = _mm256_mul_ps(scaleX, _mm256_sub_ps(_mm256_setzero_ps(), sinY));
+	w[1][0] = _mm256_mul_ps(scaleY, _mm256_fmsub_ps(sinXsinY, cosZ, _mm256_mul_ps(cosX, sinZ)));
+	w[1][1] = _mm256_mul_ps(scaleY, _mm256_fmadd_ps(sinXsinY, sinZ, _mm256_mul_ps(cosX, cosZ)));
+	w[1][2] = _mm256_mul_ps(scaleY, _mm256_mul_ps(sinX, cosY));
+	w[2][0] = _mm256_mul_ps(scaleZ, _mm256_fmadd_ps(cosXsinY, cosZ, _mm256_mul_ps(sinX, sinZ)));
+	w[2][1] = _mm256_mul_ps(scaleZ, _mm256_fmsub_ps(cosXsinY, sinZ, _mm256_mul_ps(sinX, cosZ)));
+	w[2][2] = _mm256_mul_ps(scaleZ, _mm256_mul_ps(cosX, cosY));
+	for (int column = 0; column < 3; column++) {
+		w[3][column] = _mm256_fmadd_ps(translateZ, w[2][column],
+			_mm256_fmadd_ps(translateY, w[1][column], _mm256_mul_ps(translateX, w[0][column])));
+	}
+	w[0][3] = w[1][3] = w[2][3] = _mm256_setzero_ps();
+	w[3][3] = _mm256_set1_ps(1.0f);
+
+	const float(&vp)[4][4] = viewProjection.m;
+	__m256 wvp[4][4];
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			__m256 sum = row == 3 ? _mm256_set1_ps(vp[3][column]) : _mm256_setzero_ps();
+			sum = _mm256_fmadd_ps(w[row][0], _mm256_set1_ps(vp[0][column]), sum);
+			sum = _mm256_fmadd_ps(w[row][1], _mm256_set1_ps(vp[1][column]), sum);
+			sum = _mm256_fmadd_ps(w[row][2], _mm256_set1_ps(vp[2][column]), sum);
+			wvp[row][column] = sum;
+		}
+	}
+
+	for (int row = 0; row < 4; row++) {
+		float* worldRows[8];
+		float* wvpRows[8];
+		for (int k = 0; k < 8; k++) {
+			worldRows[k] = outputs[k].world.m[row];
+			wvpRows[k] = outputs[k].WVP.m[row];
+		}
+		StoreTransposed8(w[row][0], w[row][1], w[row][2], w[row][3], worldRows);
+		StoreTransposed8(wvp[row][0], wvp[row][1], wvp[row][2], wvp[row][3], wvpRows);
+	}
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+/// <summary>
+/// 複数のTransformからWVP行列とワールド行列をまとめて計算する
+/// </summary>
+/// <param name="transforms">Transformの配列</param>
+/// <param name="count">インスタンス数</param>
+/// <param name="viewProjection">ビュー行列 * 射影行列</param>
+/// <param name="outputs">書き込み先(count個の連続した領域)</param>
+void ComputeTransformationMatrices(const Transform* transforms, size_t count, const Matrix4x4& viewProjection, TransformationMatrix* outputs) {
+	// SetMatrixMathLevelで命令セットを落とした場合はそれに従う
+	[[maybe_unused]] const SimdLevel level = GetMatrixMathLevel();
+	TransformSoA soa;
+
+	for (size_t chunkStart = 0; chunkStart < count; chunkStart += kChunkSize) {
+		const size_t chunkCount = count - chunkStart < kChunkSize ? count - chunkStart : kChunkSize;
+		GatherTransforms(transforms + chunkStart, chunkCount, soa);
+
+		size_t i = 0;
+#if SIMD_X86
+		if (level == SimdLevel::AVX2) {
+			for (; i + 8 <= chunkCount; i += 8) {
+				ComputeBlock8(soa, i, viewProjection, outputs + chunkStart + i);
+			}
+		}
+		if (level >= SimdLevel::SSE2) {
+			for (; i + 4 <= chunkCount; i += 4) {
+				ComputeBlock4(soa, i, viewProjection, outputs + chunkStart + i);
+			}
+		}
+#endif
+		// 端数はスカラーで計算
+		for (; i < chunkCount; i++) {
+			ComputeOne(soa, i, viewProjection, outputs[chunkStart + i]);
+		}
+	}
+}
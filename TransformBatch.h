@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include "Matrix4x4.h"
+#include "Transform.h"
+#include "TransformationMatrix.h"
+
+// 複数のTransformからWVP行列とワールド行列をまとめて計算する
+// outputs[i].world = MakeAffineMatrix(transforms[i])
+// outputs[i].WVP   = outputs[i].world * viewProjection
+// 命令セットはMultiplyなどと同じくGetMatrixMathLevel()のものを使う
+void ComputeTransformationMatrices(const Transform* transforms, size_t count, const Matrix4x4& viewProjection, TransformationMatrix* outputs);
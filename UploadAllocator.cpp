@@ -0,0 +1,195 @@
+#include "UploadAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+/// <summary>
+/// アロケータを作成する(ページは最初に切り出すときに作る)
+/// </summary>
+/// <param name="pageSource">ページの作成と解放</param>
+/// <param name="pageSize">1ページのバイト数</param>
+LinearUploadAllocator::LinearUploadAllocator(UploadPageSource& pageSource, size_t pageSize)
+	: pageSource_(pageSource), pageSize_(pageSize) {
+	assert(pageSize > 0);
+}
+
+/// <summary>
+/// すべてのページを解放する(GPUが使い終わってから破棄すること)
+/// </summary>
+LinearUploadAllocator::~LinearUploadAllocator() {
+	Reset();
+	for (const UploadPage& page : pages_) {
+		pageSource_.DestroyPage(page);
+	}
+}
+
+/// <summary>
+/// 領域を切り出す
+/// </summary>
+/// <param name="size">バイト数</param>
+/// <param name="alignment">GPUアドレスの境界(2のべき乗)</param>
+/// <param name="allocation">切り出した領域</param>
+/// <returns>ページを作れなければfalse</returns>
+bool LinearUploadAllocator::Allocate(size_t size, size_t alignment, UploadAllocation& allocation) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+	allocation = {};
+
+	// ページより大きいものは専用のページにする(次のResetで解放する)
+	if (size > pageSize_) {
+		UploadPage page{};
+		if (!pageSource_.CreatePage(size, page)) {
+			return false;
+		}
+		assert(page.gpuAddress % alignment == 0);
+		largePages_.push_back(page);
+		usedSize_ += size;
+		peakUsedSize_ = std::max(peakUsedSize_, usedSize_);
+		allocation = { page.cpuAddress, page.gpuAddress, size };
+		return true;
+	}
+
+	while (true) {
+		if (pageIndex_ == pages_.size()) {
+			UploadPage page{};
+			if (!pageSource_.CreatePage(pageSize_, page)) {
+				return false;
+			}
+			pages_.push_back(page);
+		}
+		const UploadPage& page = pages_[pageIndex_];
+		// 境界はページ内の位置ではなくGPUアドレスで合わせる
+		const uint64_t alignedAddress = (page.gpuAddress + offset_ + alignment - 1) & ~uint64_t(alignment - 1);
+		const size_t alignedOffset = size_t(alignedAddress - page.gpuAddress);
+		if (alignedOffset <= page.size && size <= page.size - alignedOffset) {
+			allocation = { page.cpuAddress + alignedOffset, alignedAddress, size };
+			usedSize_ += alignedOffset + size - offset_;
+			peakUsedSize_ = std::max(peakUsedSize_, usedSize_);
+			offset_ = alignedOffset + size;
+			return true;
+		}
+		// 空のページにも収まらない(ページのアドレスが境界に合っていない)ならあきらめる
+		if (offset_ == 0) {
+			return false;
+		}
+		// 収まらなければ残りを捨てて次のページへ
+		usedSize_ += page.size - std::min(offset_, page.size);
+		++pageIndex_;
+		offset_ = 0;
+	}
+}
+
+/// <summary>
+/// すべての領域を戻す
+/// </summary>
+void LinearUploadAllocator::Reset() {
+	for (const UploadPage& page : largePages_) {
+		pageSource_.DestroyPage(page);
+	}
+	largePages_.clear();
+	pageIndex_ = 0;
+	offset_ = 0;
+	usedSize_ = 0;
+}
+
+/// <summary>
+/// 輪にするページを作成する(作れなければ大きさ0の無効なアロケータになる。IsValidで確かめる)
+/// </summary>
+/// <param name="pageSource">ページの作成と解放</param>
+/// <param name="size">輪のバイト数</param>
+RingUploadAllocator::RingUploadAllocator(UploadPageSource& pageSource, size_t size)
+	: pageSource_(pageSource) {
+	if (!pageSource_.CreatePage(size, page_) || page_.cpuAddress == nullptr) {
+		page_ = {};
+	}
+}
+
+/// <summary>
+/// ページを解放する(GPUが使い終わってから破棄すること)
+/// </summary>
+RingUploadAllocator::~RingUploadAllocator() {
+	if (IsValid()) {
+		pageSource_.DestroyPage(page_);
+	}
+}
+
+/// <summary>
+/// 領域を切り出す
+/// </summary>
+/// <param name="size">バイト数</param>
+/// <param name="alignment">ページ先頭からのオフセットの境界(2のべき乗)</param>
+/// <param name="allocation">切り出した領域</param>
+/// <returns>今は空きが足りなければfalse(Retireしてからやり直す)。ページがなければいつもfalse</returns>
+bool RingUploadAllocator::Allocate(size_t size, size_t alignment, UploadAllocation& allocation) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+	assert(page_.gpuAddress % alignment == 0);
+	allocation = {};
+	const size_t capacity = page_.size;
+	if (!IsValid() || size > capacity) {
+		return false;
+	}
+	// すべて戻っていれば先頭から使う
+	if (allocatedTotal_ == retiredTotal_) {
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	const size_t alignedHead = (head_ + alignment - 1) & ~(alignment - 1);
+	size_t offset = 0;
+	size_t consumed = 0;
+	if (head_ > tail_ || allocatedTotal_ == retiredTotal_) {
+		// 使用中の領域より後ろに入らなければ、末尾を捨てて先頭へ折り返す
+		if (alignedHead <= capacity && size <= capacity - alignedHead) {
+			offset = alignedHead;
+			consumed = alignedHead - head_ + size;
+		} else if (size <= tail_) {
+			offset = 0;
+			consumed = capacity - head_ + size;
+		} else {
+			return false;
+		}
+	} else {
+		// 折り返した後は使用中の先頭までしか使えない
+		if (alignedHead <= tail_ && size <= tail_ - alignedHead) {
+			offset = alignedHead;
+			consumed = alignedHead - head_ + size;
+		} else {
+			return false;
+		}
+	}
+
+	head_ = offset + size;
+	allocatedTotal_ += consumed;
+	allocation = { page_.cpuAddress + offset, page_.gpuAddress + offset, size };
+	return true;
+}
+
+/// <summary>
+/// 前回のSubmitからの領域にフェンスの値を付ける
+/// </summary>
+/// <param name="fenceValue">それらの領域を読むコマンドの後に積んだシグナルの値</param>
+void RingUploadAllocator::Submit(uint64_t fenceValue) {
+	if (allocatedTotal_ == submittedTotal_) {
+		return;
+	}
+	assert(submissions_.empty() || submissions_.back().fenceValue <= fenceValue);
+	submissions_.push_back({ fenceValue, head_, allocatedTotal_ });
+	submittedTotal_ = allocatedTotal_;
+}
+
+/// <summary>
+/// GPUが使い終わった領域を戻す
+/// </summary>
+/// <param name="completedValue">GPUが処理し終えたシグナルの値</param>
+void RingUploadAllocator::Retire(uint64_t completedValue) {
+	while (!submissions_.empty() && submissions_.front().fenceValue <= completedValue) {
+		tail_ = submissions_.front().head;
+		retiredTotal_ = submissions_.front().allocatedTotal;
+		submissions_.pop_front();
+	}
+}
+
+/// <summary>
+/// 一番古いSubmitのフェンスの値
+/// </summary>
+uint64_t RingUploadAllocator::GetOldestFenceValue() const {
+	return submissions_.empty() ? 0 : submissions_.front().fenceValue;
+}
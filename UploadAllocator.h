@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+/// <summary>
+/// CPUから書き込めてGPUから読めるメモリの1ページ
+/// </summary>
+struct UploadPage {
+	uint8_t* cpuAddress;
+	uint64_t gpuAddress;
+	size_t size;
+	void* handle; // ページを作った側が解放に使う(D3D12ならID3D12Resource*)
+};
+
+/// <summary>
+/// ページから切り出した領域
+/// </summary>
+struct UploadAllocation {
+	void* cpuAddress;
+	uint64_t gpuAddress;
+	size_t size;
+};
+
+/// <summary>
+/// ページの作成と解放(LinearUploadAllocatorはこれを通してだけメモリを得る)
+/// </summary>
+class UploadPageSource {
+public:
+	virtual ~UploadPageSource() = default;
+
+	// sizeバイトのページを作る(失敗したらfalse)
+	virtual bool CreatePage(size_t size, UploadPage& page) = 0;
+
+	// ページを解放する
+	virtual void DestroyPage(const UploadPage& page) = 0;
+};
+
+/// <summary>
+/// ページの先頭から順に切り出すだけのアロケータ
+/// 個別の解放はなく、GPUが使い終わったらResetでまとめて戻す(フレームごとに1つ持つ)
+/// </summary>
+class LinearUploadAllocator {
+public:
+	// 定数バッファの配置の境界(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT)
+	static constexpr size_t kConstantBufferAlignment = 256;
+
+	LinearUploadAllocator(UploadPageSource& pageSource, size_t pageSize);
+	~LinearUploadAllocator();
+	LinearUploadAllocator(const LinearUploadAllocator&) = delete;
+	LinearUploadAllocator& operator=(const LinearUploadAllocator&) = delete;
+
+	// sizeバイトをGPUアドレスがalignment(2のべき乗)の倍数になる位置に切り出す
+	// ページに収まらなければ次のページに移り、ページより大きければ専用のページを作る
+	bool Allocate(size_t size, size_t alignment, UploadAllocation& allocation);
+
+	// 定数を256バイト境界に書き込む(大きさも256バイトの倍数に切り上げる)
+	template<typename T>
+	bool AllocateConstant(const T& value, UploadAllocation& allocation);
+
+	// すべての領域を戻す(ページは次のフレームで使い回す。専用のページは解放する)
+	void Reset();
+
+	size_t GetPageSize() const { return pageSize_; }
+	size_t GetPageCount() const { return pages_.size(); }
+	// Resetからの使用量(境界合わせの隙間とページ末尾の余りを含む)
+	size_t GetUsedSize() const { return usedSize_; }
+	size_t GetPeakUsedSize() const { return peakUsedSize_; }
+
+private:
+	UploadPageSource& pageSource_;
+	size_t pageSize_;
+	std::vector<UploadPage> pages_;
+	std::vector<UploadPage> largePages_;
+	size_t pageIndex_ = 0;
+	size_t offset_ = 0;
+	size_t usedSize_ = 0;
+	size_t peakUsedSize_ = 0;
+};
+
+/// <summary>
+/// 1ページを輪のように使い回すアロケータ(テクスチャの転送など、大きさがまちまちで寿命がフェンスで決まるもの用)
+/// Submitでそれまでの領域にフェンスの値を付け、GPUがそこまで進んだらRetireで戻す
+/// </summary>
+class RingUploadAllocator {
+public:
+	// ページを作れなければIsValidがfalseになり、Allocateはいつも失敗する
+	RingUploadAllocator(UploadPageSource& pageSource, size_t size);
+	~RingUploadAllocator();
+	RingUploadAllocator(const RingUploadAllocator&) = delete;
+	RingUploadAllocator& operator=(const RingUploadAllocator&) = delete;
+
+	// ページを作れたか
+	bool IsValid() const { return page_.cpuAddress != nullptr; }
+
+	// sizeバイトをalignment(2のべき乗)の倍数のオフセットに切り出す(今空いていなければfalse)
+	bool Allocate(size_t size, size_t alignment, UploadAllocation& allocation);
+
+	// 前回のSubmitから切り出した領域は、GPUがfenceValueまで進めば使い終わる
+	void Submit(uint64_t fenceValue);
+
+	// completedValueまでにSubmitした領域を戻す
+	void Retire(uint64_t completedValue);
+
+	// 空けるために待つべき一番古いフェンスの値(Submitした領域がなければ0)
+	uint64_t GetOldestFenceValue() const;
+
+	const UploadPage& GetPage() const { return page_; }
+	size_t GetSize() const { return page_.size; }
+	// まだ戻していないバイト数(境界合わせの隙間と折り返しで捨てた末尾を含む)
+	size_t GetUsedSize() const { return size_t(allocatedTotal_ - retiredTotal_); }
+
+private:
+	struct Submission {
+		uint64_t fenceValue;
+		size_t head;            // Submit時点の書き込み位置(戻すとここが使用中の先頭になる)
+		uint64_t allocatedTotal; // Submit時点の累計
+	};
+
+	UploadPageSource& pageSource_;
+	UploadPage page_{};
+	size_t head_ = 0; // 次に書き込む位置
+	size_t tail_ = 0; // 使用中の先頭
+	uint64_t allocatedTotal_ = 0;
+	uint64_t retiredTotal_ = 0;
+	uint64_t submittedTotal_ = 0;
+	std::deque<Submission> submissions_;
+};
+
+/// <summary>
+/// 定数を書き込む
+/// </summary>
+/// <param name="value">定数</param>
+/// <param name="allocation">書き込んだ領域</param>
+/// <returns>切り出せなければfalse</returns>
+template<typename T>
+bool LinearUploadAllocator::AllocateConstant(const T& value, UploadAllocation& allocation) {
+	const size_t size = (sizeof(T) + kConstantBufferAlignment - 1) & ~(kConstantBufferAlignment - 1);
+	if (!Allocate(size, kConstantBufferAlignment, allocation)) {
+		return false;
+	}
+	std::memcpy(allocation.cpuAddress, &value, sizeof(T));
+	return true;
+}
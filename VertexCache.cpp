@@ -0,0 +1,242 @@
+#include "VertexCache.h"
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// スコア計算で想定するキャッシュの大きさ(LRU)
+constexpr int32_t kCacheSize = 32;
+// 直前の三角形で使った頂点のスコア
+constexpr float kLastTriangleScore = 0.75f;
+// キャッシュ内の位置によるスコアの減衰
+constexpr float kCacheDecayPower = 1.5f;
+// 残りの三角形が少ない頂点を優先する度合い
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+// 残りの三角形数のスコアを表にしておく上限
+constexpr uint32_t kMaxValenceTable = 64;
+
+/// <summary>
+/// Forsyth法のスコア表
+/// </summary>
+struct VertexScoreTable {
+	float cache[kCacheSize];
+	float valence[kMaxValenceTable];
+};
+
+/// <summary>
+/// スコア表を作成する
+/// </summary>
+VertexScoreTable MakeVertexScoreTable() {
+	VertexScoreTable table{};
+	for (int32_t i = 0; i < kCacheSize; ++i) {
+		if (i < 3) {
+			// 直前の三角形の頂点はどの順で使ってもよいので同じスコア
+			table.cache[i] = kLastTriangleScore;
+		} else {
+			const float scaler = 1.0f / float(kCacheSize - 3);
+			table.cache[i] = std::pow(1.0f - float(i - 3) * scaler, kCacheDecayPower);
+		}
+	}
+	for (uint32_t i = 0; i < kMaxValenceTable; ++i) {
+		table.valence[i] = i == 0 ? 0.0f : kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+	}
+	return table;
+}
+
+/// <summary>
+/// 頂点のスコア
+/// </summary>
+/// <param name="table">スコア表</param>
+/// <param name="cachePosition">キャッシュ内の位置(入っていなければ-1)</param>
+/// <param name="remaining">まだ出力していない三角形の数</param>
+float VertexScore(const VertexScoreTable& table, int32_t cachePosition, uint32_t remaining) {
+	if (remaining == 0) {
+		// もう使わない頂点
+		return -1.0f;
+	}
+	float score = cachePosition < 0 ? 0.0f : table.cache[cachePosition];
+	score += remaining < kMaxValenceTable ? table.valence[remaining]
+		: kValenceBoostScale * std::pow(float(remaining), -kValenceBoostPower);
+	return score;
+}
+
+} // namespace
+
+/// <summary>
+/// 変換後頂点キャッシュの効率が良くなるように三角形を並べ替える
+/// </summary>
+/// <param name="indices">三角形リストのインデックス(並べ替えて上書きする)</param>
+/// <param name="vertexCount">頂点数</param>
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+	assert(indices.size() % 3 == 0);
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+	static const VertexScoreTable table = MakeVertexScoreTable();
+
+	// 頂点ごとの隣接三角形(CSR形式)
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices) {
+		assert(index < vertexCount);
+		remaining[index]++;
+	}
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t i = 0; i < vertexCount; ++i) {
+		adjacencyOffset[i + 1] = adjacencyOffset[i] + remaining[i];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			adjacency[cursor[indices[i]]++] = uint32_t(i / 3);
+		}
+	}
+
+	// 頂点と三角形のスコア
+	std::vector<int32_t> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i) {
+		vertexScore[i] = VertexScore(table, -1, remaining[i]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+	}
+
+	// 最初はスコアが最大の三角形から始める
+	size_t bestTriangle = 0;
+	for (size_t t = 1; t < triangleCount; ++t) {
+		if (triangleScore[t] > triangleScore[bestTriangle]) {
+			bestTriangle = t;
+		}
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	// キャッシュ(先頭が最新)。更新中は三角形の3頂点分だけはみ出す
+	uint32_t cache[kCacheSize + 3];
+	int32_t cacheUsed = 0;
+	// キャッシュから候補が見つからなかったときに未出力の三角形を探す位置
+	size_t scanCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		if (bestTriangle == SIZE_MAX) {
+			// キャッシュ内の頂点の三角形を使い切ったので、未出力の三角形を先頭から順に探す
+			while (emitted[scanCursor]) {
+				scanCursor++;
+			}
+			bestTriangle = scanCursor;
+		}
+		const uint32_t* triangle = &indices[bestTriangle * 3];
+		output.push_back(triangle[0]);
+		output.push_back(triangle[1]);
+		output.push_back(triangle[2]);
+		emitted[bestTriangle] = true;
+
+		// 頂点の隣接リストから出力した三角形を取り除く
+		for (int32_t k = 0; k < 3; ++k) {
+			const uint32_t vertex = triangle[k];
+			uint32_t* begin = &adjacency[adjacencyOffset[vertex]];
+			const uint32_t count = remaining[vertex];
+			for (uint32_t j = 0; j < count; ++j) {
+				if (begin[j] == bestTriangle) {
+					begin[j] = begin[count - 1];
+					break;
+				}
+			}
+			remaining[vertex]--;
+		}
+
+		// キャッシュの先頭に三角形の頂点を入れ、残りを後ろにずらす
+		uint32_t newCache[kCacheSize + 3];
+		int32_t newCacheUsed = 0;
+		for (int32_t k = 0; k < 3; ++k) {
+			newCache[newCacheUsed++] = triangle[k];
+		}
+		for (int32_t j = 0; j < cacheUsed; ++j) {
+			const uint32_t vertex = cache[j];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+				newCache[newCacheUsed++] = vertex;
+			}
+		}
+		for (int32_t j = 0; j < newCacheUsed; ++j) {
+			cache[j] = newCache[j];
+		}
+		cacheUsed = newCacheUsed;
+
+		// キャッシュ内の頂点のスコアを更新し、次の三角形を選ぶ
+		bestTriangle = SIZE_MAX;
+		float bestScore = -1.0f;
+		for (int32_t j = 0; j < cacheUsed; ++j) {
+			const uint32_t vertex = cache[j];
+			// はみ出した頂点はキャッシュから外れる
+			const int32_t position = j < kCacheSize ? j : -1;
+			cachePosition[vertex] = position;
+			const float score = VertexScore(table, position, remaining[vertex]);
+			const float delta = score - vertexScore[vertex];
+			vertexScore[vertex] = score;
+			const uint32_t* adjacent = &adjacency[adjacencyOffset[vertex]];
+			for (uint32_t a = 0; a < remaining[vertex]; ++a) {
+				const uint32_t t = adjacent[a];
+				triangleScore[t] += delta;
+				if (position >= 0 && triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+		if (cacheUsed > kCacheSize) {
+			cacheUsed = kCacheSize;
+		}
+	}
+
+	indices.swap(output);
+}
+
+/// <summary>
+/// 頂点を初めて使われる順に並べ替える
+/// </summary>
+/// <param name="mesh">メッシュ(頂点とインデックスを書き換える)</param>
+void OptimizeVertexFetch(MeshData& mesh) {
+	const uint32_t kUnused = UINT32_MAX;
+	std::vector<uint32_t> remap(mesh.vertices.size(), kUnused);
+	std::vector<VertexData> vertices;
+	vertices.reserve(mesh.vertices.size());
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == kUnused) {
+			remap[index] = uint32_t(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+	// どの三角形からも使われない頂点は捨てる
+	mesh.vertices.swap(vertices);
+}
+
+/// <summary>
+/// ACMR(三角形1つあたりの頂点シェーダー実行回数)を求める
+/// </summary>
+/// <param name="indices">三角形リストのインデックス</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="cacheSize">FIFOキャッシュの大きさ</param>
+/// <returns>ACMR(0.5が理想、3.0が最悪)</returns>
+float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+	assert(indices.size() % 3 == 0);
+	if (indices.empty()) {
+		return 0.0f;
+	}
+	// 頂点がキャッシュに入ったときのミス回数を覚えておき、その後のミスがcacheSize回未満ならまだ残っている
+	std::vector<size_t> cachedAt(vertexCount, 0);
+	size_t misses = 0;
+	for (uint32_t index : indices) {
+		assert(index < vertexCount);
+		if (cachedAt[index] == 0 || misses - cachedAt[index] + 1 > cacheSize) {
+			misses++;
+			cachedAt[index] = misses;
+		}
+	}
+	return float(misses) / float(indices.size() / 3);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshData.h"
+
+// 変換後頂点キャッシュに当たりやすいように三角形を並べ替える(Forsyth法)
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// 三角形が初めて使う順に頂点を並べ替え、インデックスを振り直す(頂点フェッチの局所性を上げる)
+void OptimizeVertexFetch(MeshData& mesh);
+
+// FIFOキャッシュを想定した三角形1つあたりの頂点変換回数(ACMR)
+float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize);
@@ -0,0 +1,231 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include "MatrixMath.h"
+
+namespace {
+
+constexpr float kSnorm16Max = 32767.0f;
+
+/// <summary>
+/// [-1, 1] を16bitのSNORMにする
+/// </summary>
+int16_t FloatToSnorm16(float value) {
+	value = std::clamp(value, -1.0f, 1.0f);
+	return static_cast<int16_t>(std::lround(value * kSnorm16Max));
+}
+
+/// <summary>
+/// 16bitのSNORMを [-1, 1] に戻す(-32768も-1になる)
+/// </summary>
+float Snorm16ToFloat(int16_t value) {
+	return std::max(float(value) / kSnorm16Max, -1.0f);
+}
+
+/// <summary>
+/// 0を正として符号を返す
+/// </summary>
+float SignNotZero(float value) {
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+} // namespace
+
+/// <summary>
+/// 頂点を囲む範囲から位置の量子化範囲を求める
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <param name="count">頂点数</param>
+/// <returns>量子化範囲</returns>
+VertexQuantization ComputeVertexQuantization(const VertexData* vertices, size_t count) {
+	VertexQuantization quantization{ {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f} };
+	if (count == 0) {
+		return quantization;
+	}
+	Vector3 minimum = { vertices[0].position.x, vertices[0].position.y, vertices[0].position.z };
+	Vector3 maximum = minimum;
+	for (size_t i = 1; i < count; ++i) {
+		const Vector4& position = vertices[i].position;
+		minimum = { std::min(minimum.x, position.x), std::min(minimum.y, position.y), std::min(minimum.z, position.z) };
+		maximum = { std::max(maximum.x, position.x), std::max(maximum.y, position.y), std::max(maximum.z, position.z) };
+	}
+	quantization.center = { (minimum.x + maximum.x) * 0.5f, (minimum.y + maximum.y) * 0.5f, (minimum.z + maximum.z) * 0.5f };
+	quantization.extent = { (maximum.x - minimum.x) * 0.5f, (maximum.y - minimum.y) * 0.5f, (maximum.z - minimum.z) * 0.5f };
+	// 平らな軸は0で割らないように1にしておく(値はすべて0になる)
+	if (quantization.extent.x <= 0.0f) { quantization.extent.x = 1.0f; }
+	if (quantization.extent.y <= 0.0f) { quantization.extent.y = 1.0f; }
+	if (quantization.extent.z <= 0.0f) { quantization.extent.z = 1.0f; }
+	return quantization;
+}
+
+/// <summary>
+/// 量子化した位置を元に戻す行列を作成する
+/// </summary>
+/// <param name="quantization">量子化範囲</param>
+/// <returns>拡大縮小と平行移動の行列</returns>
+Matrix4x4 MakeDequantizeMatrix(const VertexQuantization& quantization) {
+	Matrix4x4 result = MakeScaleMatrix(quantization.extent);
+	result.m[3][0] = quantization.center.x;
+	result.m[3][1] = quantization.center.y;
+	result.m[3][2] = quantization.center.z;
+	return result;
+}
+
+/// <summary>
+/// 頂点を圧縮する
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <param name="count">頂点数</param>
+/// <param name="quantization">位置の量子化範囲</param>
+/// <param name="outputs">圧縮した頂点の書き込み先</param>
+void PackVertices(const VertexData* vertices, size_t count, const VertexQuantization& quantization, PackedVertexData* outputs) {
+	const Vector3 inverseExtent = { 1.0f / quantization.extent.x, 1.0f / quantization.extent.y, 1.0f / quantization.extent.z };
+	for (size_t i = 0; i < count; ++i) {
+		const VertexData& vertex = vertices[i];
+		PackedVertexData& packed = outputs[i];
+		packed.position[0] = FloatToSnorm16((vertex.position.x - quantization.center.x) * inverseExtent.x);
+		packed.position[1] = FloatToSnorm16((vertex.position.y - quantization.center.y) * inverseExtent.y);
+		packed.position[2] = FloatToSnorm16((vertex.position.z - quantization.center.z) * inverseExtent.z);
+		// wは1になるようにしておけばシェーダーでそのまま使える
+		packed.position[3] = static_cast<int16_t>(kSnorm16Max);
+		EncodeOctahedralNormal(vertex.normal, packed.normal[0], packed.normal[1]);
+		packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+		packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+	}
+}
+
+/// <summary>
+/// 頂点を圧縮する
+/// </summary>
+/// <param name="vertices">頂点</param>
+/// <param name="quantization">位置の量子化範囲</param>
+/// <returns>圧縮した頂点</returns>
+std::vector<PackedVertexData> PackVertices(const std::vector<VertexData>& vertices, const VertexQuantization& quantization) {
+	std::vector<PackedVertexData> result(vertices.size());
+	PackVertices(vertices.data(), vertices.size(), quantization, result.data());
+	return result;
+}
+
+/// <summary>
+/// 圧縮した頂点を展開する
+/// </summary>
+/// <param name="vertex">圧縮した頂点</param>
+/// <param name="quantization">位置の量子化範囲</param>
+/// <returns>展開した頂点</returns>
+VertexData UnpackVertex(const PackedVertexData& vertex, const VertexQuantization& quantization) {
+	VertexData result{};
+	result.position.x = quantization.center.x + Snorm16ToFloat(vertex.position[0]) * quantization.extent.x;
+	result.position.y = quantization.center.y + Snorm16ToFloat(vertex.position[1]) * quantization.extent.y;
+	result.position.z = quantization.center.z + Snorm16ToFloat(vertex.position[2]) * quantization.extent.z;
+	result.position.w = 1.0f;
+	result.texcoord.x = HalfToFloat(vertex.texcoord[0]);
+	result.texcoord.y = HalfToFloat(vertex.texcoord[1]);
+	result.normal = DecodeOctahedralNormal(vertex.normal[0], vertex.normal[1]);
+	return result;
+}
+
+/// <summary>
+/// 法線を八面体写像で2つの16bit値にする
+/// </summary>
+/// <param name="normal">正規化された法線</param>
+/// <param name="x">1つ目の値</param>
+/// <param name="y">2つ目の値</param>
+void EncodeOctahedralNormal(const Vector3& normal, int16_t& x, int16_t& y) {
+	// 八面体に射影する
+	const float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (length <= 0.0f) {
+		x = 0;
+		y = 0;
+		return;
+	}
+	float u = normal.x / length;
+	float v = normal.y / length;
+	// 下半分は外側の三角形に折り返す
+	if (normal.z < 0.0f) {
+		const float foldedU = (1.0f - std::fabs(v)) * SignNotZero(u);
+		const float foldedV = (1.0f - std::fabs(u)) * SignNotZero(v);
+		u = foldedU;
+		v = foldedV;
+	}
+	x = FloatToSnorm16(u);
+	y = FloatToSnorm16(v);
+}
+
+/// <summary>
+/// 八面体写像した法線を戻す
+/// </summary>
+/// <param name="x">1つ目の値</param>
+/// <param name="y">2つ目の値</param>
+/// <returns>正規化された法線</returns>
+Vector3 DecodeOctahedralNormal(int16_t x, int16_t y) {
+	Vector3 normal{ Snorm16ToFloat(x), Snorm16ToFloat(y), 0.0f };
+	normal.z = 1.0f - std::fabs(normal.x) - std::fabs(normal.y);
+	// 折り返した分を戻す
+	const float t = std::max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	const float inverseLength = 1.0f / std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	normal.x *= inverseLength;
+	normal.y *= inverseLength;
+	normal.z *= inverseLength;
+	return normal;
+}
+
+/// <summary>
+/// 単精度を半精度にする
+/// </summary>
+/// <param name="value">単精度の値</param>
+/// <returns>半精度のビット列</returns>
+uint16_t FloatToHalf(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+	uint32_t absolute = bits & 0x7fffffffu;
+
+	if (absolute >= 0x7f800000u) {
+		// 無限大とNaN(NaNは仮数の最上位ビットを立てて保つ)
+		return sign | 0x7c00u | (absolute > 0x7f800000u ? 0x0200u : 0u);
+	}
+	if (absolute >= 0x477ff000u) {
+		// 65520以上は丸めると無限大
+		return sign | 0x7c00u;
+	}
+	if (absolute < 0x38800000u) {
+		// 2^-14未満は非正規化数(2^24倍した整数に最近接偶数丸め)
+		float magnitude;
+		std::memcpy(&magnitude, &absolute, sizeof(magnitude));
+		return sign | static_cast<uint16_t>(std::nearbyint(magnitude * 16777216.0f));
+	}
+	// 指数の偏りを付け替え、落とす13bitを最近接偶数丸め
+	const uint32_t odd = (absolute >> 13) & 1u;
+	absolute += 0xc8000000u + 0x0fffu + odd;
+	return sign | static_cast<uint16_t>(absolute >> 13);
+}
+
+/// <summary>
+/// 半精度を単精度にする
+/// </summary>
+/// <param name="value">半精度のビット列</param>
+/// <returns>単精度の値</returns>
+float HalfToFloat(uint16_t value) {
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1fu;
+	const uint32_t mantissa = value & 0x03ffu;
+
+	float result;
+	if (exponent == 0) {
+		// 0と非正規化数
+		result = float(mantissa) * (1.0f / 16777216.0f);
+		return sign ? -result : result;
+	}
+	uint32_t bits;
+	if (exponent == 0x1fu) {
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+	}
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix4x4.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "VertexData.h"
+#include "PackedVertexData.h"
+
+/// <summary>
+/// 位置の量子化範囲(position = center + snorm * extent)
+/// </summary>
+struct VertexQuantization {
+	Vector3 center;
+	Vector3 extent;
+};
+
+// 頂点の範囲から量子化範囲を求める
+VertexQuantization ComputeVertexQuantization(const VertexData* vertices, size_t count);
+
+// 量子化した位置を元の位置に戻す行列(WVPに左から掛けて使う)
+Matrix4x4 MakeDequantizeMatrix(const VertexQuantization& quantization);
+
+// 頂点の圧縮・展開
+void PackVertices(const VertexData* vertices, size_t count, const VertexQuantization& quantization, PackedVertexData* outputs);
+std::vector<PackedVertexData> PackVertices(const std::vector<VertexData>& vertices, const VertexQuantization& quantization);
+VertexData UnpackVertex(const PackedVertexData& vertex, const VertexQuantization& quantization);
+
+// 八面体写像による法線の圧縮・展開(normalは正規化済み)
+void EncodeOctahedralNormal(const Vector3& normal, int16_t& x, int16_t& y);
+Vector3 DecodeOctahedralNormal(int16_t x, int16_t y);
+
+// 半精度浮動小数点との変換(最近接偶数丸め)
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
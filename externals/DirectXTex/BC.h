@@ -43,8 +43,22 @@ namespace DirectX
         BC_FLAGS_USE_3SUBSETS = 0x80000,
         // By default, BC7 skips mode 0 & 2; this flag adds those modes back
 
-        BC_FLAGS_FORCE_BC7_MODE6 = 0x100000,
-        // BC7 should only use mode 6; skip other modes
+        BC_FLAGS_BC7_QUALITY_NORMAL = 0x0,
+        // BC7 classifies each block and refines a few candidate modes/partitions ranked by estimated error
+
+        BC_FLAGS_BC7_QUALITY_FAST = 0x100000,
+        // BC7 uses the fewest candidates (mostly mode 6) and stops at a looser error target
+
+        BC_FLAGS_FORCE_BC7_MODE6 = BC_FLAGS_BC7_QUALITY_FAST,
+        // Older name for BC_FLAGS_BC7_QUALITY_FAST
+
+        BC_FLAGS_FAST = 0x200000,
+        // BC1/BC3 use the SIMD fast encoders (see BCFast.cpp) for 8-bit RGBA sources
+
+        BC_FLAGS_BC7_QUALITY_SLOW = 0x400000,
+        // BC7 searches every mode, rotation and index mode (the search used before quality levels)
+
+        BC_FLAGS_BC7_QUALITY_MASK = 0x500000,
     };
 
     //-------------------------------------------------------------------------------------
@@ -336,4 +350,37 @@ namespace DirectX
     void D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 
+    // Encodes one row of blocks from R8G8B8A8 pixels; height is the number of source rows (1-4) and
+    // partial blocks replicate their edge pixels. Dithering and perceptual weighting are not supported.
+    void D3DXEncodeBC1FastRow(
+        _Out_writes_(((width + 3) / 4) * 8) uint8_t *pBC, _In_ const uint8_t *pSource, _In_ size_t rowPitch,
+        _In_ size_t width, _In_range_(1, 4) size_t height, _In_ float threshold, _In_ uint32_t flags) noexcept;
+    void D3DXEncodeBC3FastRow(
+        _Out_writes_(((width + 3) / 4) * 16) uint8_t *pBC, _In_ const uint8_t *pSource, _In_ size_t rowPitch,
+        _In_ size_t width, _In_range_(1, 4) size_t height, _In_ uint32_t flags) noexcept;
+
+    // Decodes one row of blocks straight to R8G8B8A8 pixels; width and height are the pixels to write
+    // (height 1-4). Results match the float decoders stored as UNORM8 (except exact halfway BC1 3-color
+    // midpoints, see BCFast.cpp), with BC4 replicated to RGB and BC5 leaving blue at 0 as ConvertScanline does.
+    typedef void (*BC_DECODE_ROW)(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height);
+
+    void D3DXDecodeBC1FastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 8) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+    void D3DXDecodeBC2FastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 16) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+    void D3DXDecodeBC3FastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 16) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+    void D3DXDecodeBC4UFastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 8) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+    void D3DXDecodeBC5UFastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 16) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+    void D3DXDecodeBC7FastRow(
+        _Out_ uint8_t *pDest, _In_ size_t rowPitch, _In_reads_(((width + 3) / 4) * 16) const uint8_t *pBC,
+        _In_ size_t width, _In_range_(1, 4) size_t height) noexcept;
+
 } // namespace
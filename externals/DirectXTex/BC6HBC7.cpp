@@ -647,6 +647,22 @@ namespace
             uStartBit += uNumBits;
         }
 
+        // Returns the 64 bits starting at uStartBit (zero past the end), so runs of small fields
+        // can be taken with shifts instead of a GetBits call each
+        uint64_t GetBits64(_In_ size_t uStartBit) const noexcept
+        {
+            static_assert(SizeInBytes == 16, "GetBits64 expects a 128-bit block");
+            assert(uStartBit < 128);
+            uint64_t lo, hi;
+            memcpy(&lo, m_uBits, sizeof(lo));
+            memcpy(&hi, m_uBits + sizeof(lo), sizeof(hi));
+            if (uStartBit == 0)
+                return lo;
+            if (uStartBit < 64)
+                return (lo >> uStartBit) | (hi << (64 - uStartBit));
+            return hi >> (uStartBit - 64);
+        }
+
     private:
         uint8_t m_uBits[SizeInBytes];
     };
@@ -763,6 +779,7 @@ namespace
     {
     public:
         void Decode(_Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA* pOut) const noexcept;
+        void Decode(_Out_writes_(NUM_PIXELS_PER_BLOCK) LDRColorA* pOut) const noexcept;
         void Encode(uint32_t flags, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
 
     private:
@@ -857,6 +874,15 @@ namespace
             _In_ const LDREndPntPair& endPts, _In_ float fMinErr) const noexcept;
         static float RoughMSE(_Inout_ EncodeParams* pEP, _In_ size_t uShape, _In_ size_t uIndexMode) noexcept;
 
+        void EncodeExhaustive(_In_ uint32_t flags, _Inout_ EncodeParams* pEP, _In_ bool bHasAlpha) noexcept;
+        void EncodeClassified(_In_ uint32_t flags, _Inout_ EncodeParams* pEP, _In_ bool bHasAlpha) noexcept;
+        float EncodeSolid(_Inout_ EncodeParams* pEP) noexcept;
+        void RefineCandidate(_Inout_ EncodeParams* pEP, _In_ uint8_t uMode, _In_ size_t uShape, _In_ size_t uIndexMode,
+            _Inout_ D3DX_BC7& best, _Inout_ float& fMSEBest) noexcept;
+        void RefinePartitioned(_Inout_ EncodeParams* pEP, _In_reads_(uNumModes) const uint8_t aModes[], _In_ size_t uNumModes,
+            _In_ size_t uShapes, _In_ size_t uRefines, _In_ float fTargetError, _In_ bool bAlpha,
+            _Inout_ D3DX_BC7& best, _Inout_ float& fMSEBest) noexcept;
+
     private:
         static constexpr uint8_t c_NumModes = 8;
 
@@ -1637,6 +1663,165 @@ namespace
         #endif
         }
     }
+
+    void FillWithErrorColors(_Out_writes_(NUM_PIXELS_PER_BLOCK) LDRColorA* pOut) noexcept
+    {
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+        #ifdef _DEBUG
+            pOut[i] = LDRColorA(255, 0, 255, 255);
+        #else
+            pOut[i] = LDRColorA(0, 0, 0, 255);
+        #endif
+        }
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // BC7 block classification
+    //-------------------------------------------------------------------------------------
+    enum BC7_BLOCK_CLASS : uint8_t
+    {
+        BC7_BLOCK_SOLID,            // Every pixel is the same color
+        BC7_BLOCK_GRADIENT,         // Opaque and close to a single line through color space
+        BC7_BLOCK_ALPHA,            // Some pixels have alpha below 255
+        BC7_BLOCK_HIGH_VARIANCE,    // Opaque and needs more than one line (partitioned modes)
+    };
+
+    struct BC7Quality
+    {
+        float fTargetError;     // Stop searching once the block error is at or below this
+        float fGradientError;   // Opaque blocks with a line fit error up to this are gradients
+        size_t uShapes;         // Best partitions (by line fit) that get a rough estimate per partitioned mode
+        size_t uRefines;        // Best partitioned candidates (by rough estimate) that get a full refinement
+    };
+
+    // Errors are sums of squared 8-bit differences over the block's 16 pixels, as returned by Refine
+    constexpr BC7Quality c_BC7QualityFast = { 16.0f * 12.0f, 16.0f * 48.0f, 2, 1 };
+    constexpr BC7Quality c_BC7QualityNormal = { 16.0f * 1.0f, 16.0f * 12.0f, 12, 6 };
+
+    // Squared distance of one subset's pixels from their principal axis, summed over pixels and channels.
+    // That is the error the subset would have with unlimited endpoint and index precision, so it ranks
+    // partitions without fitting any endpoints.
+    float LineFitError(
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const LDRColorA aPixels[],
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const uint8_t aPartition[],
+        uint8_t uSubset,
+        bool bAlpha) noexcept
+    {
+        const size_t uChannels = bAlpha ? 4 : 3;
+        float afSum[4] = {};
+        float afCov[4][4] = {};
+        size_t np = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (aPartition[i] != uSubset)
+                continue;
+
+            const float c[4] = { float(aPixels[i].r), float(aPixels[i].g), float(aPixels[i].b), float(aPixels[i].a) };
+            for (size_t j = 0; j < uChannels; ++j)
+            {
+                afSum[j] += c[j];
+                for (size_t k = j; k < uChannels; ++k)
+                    afCov[j][k] += c[j] * c[k];
+            }
+            ++np;
+        }
+
+        if (np < 2)
+            return 0.0f;
+
+        const float fInvCount = 1.0f / float(np);
+        float fTrace = 0.0f;
+        size_t uLargest = 0;
+        for (size_t j = 0; j < uChannels; ++j)
+        {
+            for (size_t k = j; k < uChannels; ++k)
+            {
+                afCov[j][k] -= afSum[j] * afSum[k] * fInvCount;
+                afCov[k][j] = afCov[j][k];
+            }
+            fTrace += afCov[j][j];
+            if (afCov[j][j] > afCov[uLargest][uLargest])
+                uLargest = j;
+        }
+
+        if (fTrace <= 0.0f)
+            return 0.0f;
+
+        // Power iteration for the principal axis, starting from the row with the largest variance
+        float v[4] = {};
+        for (size_t j = 0; j < uChannels; ++j)
+            v[j] = afCov[uLargest][j];
+
+        for (size_t iter = 0; iter < 4; ++iter)
+        {
+            float w[4] = {};
+            float fScale = 0.0f;
+            for (size_t j = 0; j < uChannels; ++j)
+            {
+                for (size_t k = 0; k < uChannels; ++k)
+                    w[j] += afCov[j][k] * v[k];
+                fScale = std::max<float>(fScale, fabsf(w[j]));
+            }
+
+            if (fScale <= 0.0f)
+                break;
+
+            for (size_t j = 0; j < uChannels; ++j)
+                v[j] = w[j] / fScale;
+        }
+
+        // Variance along the axis (Rayleigh quotient); the rest is off the line
+        float fVV = 0.0f;
+        float fVCV = 0.0f;
+        for (size_t j = 0; j < uChannels; ++j)
+        {
+            float w = 0.0f;
+            for (size_t k = 0; k < uChannels; ++k)
+                w += afCov[j][k] * v[k];
+            fVV += v[j] * v[j];
+            fVCV += v[j] * w;
+        }
+
+        if (fVV <= 0.0f)
+            return fTrace;
+
+        return std::max<float>(0.0f, fTrace - fVCV / fVV);
+    }
+
+    inline float EstimatePartitionError(
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const LDRColorA aPixels[],
+        size_t uPartitions,
+        size_t uShape,
+        bool bAlpha) noexcept
+    {
+        float fError = 0.0f;
+        for (size_t p = 0; p <= uPartitions; ++p)
+            fError += LineFitError(aPixels, g_aPartitionTable[uPartitions][uShape], uint8_t(p), bAlpha);
+        return fError;
+    }
+
+    BC7_BLOCK_CLASS ClassifyBC7Block(
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const LDRColorA aPixels[],
+        bool bHasAlpha,
+        float fGradientError) noexcept
+    {
+        bool bSolid = true;
+        for (size_t i = 1; i < NUM_PIXELS_PER_BLOCK && bSolid; ++i)
+        {
+            bSolid = (aPixels[i].r == aPixels[0].r) && (aPixels[i].g == aPixels[0].g)
+                && (aPixels[i].b == aPixels[0].b) && (aPixels[i].a == aPixels[0].a);
+        }
+
+        if (bSolid)
+            return BC7_BLOCK_SOLID;
+
+        if (bHasAlpha)
+            return BC7_BLOCK_ALPHA;
+
+        return (EstimatePartitionError(aPixels, 0, 0, false) <= fGradientError) ? BC7_BLOCK_GRADIENT : BC7_BLOCK_HIGH_VARIANCE;
+    }
 }
 
 
@@ -2555,6 +2740,20 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
 {
     assert(pOut);
 
+    LDRColorA aPixels[NUM_PIXELS_PER_BLOCK];
+    Decode(aPixels);
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        pOut[i] = HDRColorA(aPixels[i]);
+    }
+}
+
+_Use_decl_annotations_
+void D3DX_BC7::Decode(LDRColorA* pOut) const noexcept
+{
+    assert(pOut);
+
     size_t uFirst = 0;
     while (uFirst < 128 && !GetBit(uFirst)) {}
     const uint8_t uMode = uint8_t(uFirst - 1);
@@ -2587,40 +2786,19 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
 
         assert(uNumEndPts <= (BC7_MAX_REGIONS << 1));
 
-        // Red channel
-        for (i = 0; i < uNumEndPts; i++)
-        {
-            if (uStartBit + RGBAPrec.r > 128)
-            {
-            #if defined(_WIN32) && defined(_DEBUG)
-                OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
-            #endif
-                FillWithErrorColors(pOut);
-                return;
-            }
-
-            c[i].r = GetBits(uStartBit, RGBAPrec.r);
-        }
-
-        // Green channel
-        for (i = 0; i < uNumEndPts; i++)
+        // Endpoints are stored a channel at a time, and each channel's fields fit in one 64-bit read
+        for (uint8_t ch = 0; ch < BC7_NUM_CHANNELS; ch++)
         {
-            if (uStartBit + RGBAPrec.g > 128)
+            const size_t uPrec = RGBAPrec[ch];
+            if (!uPrec)
             {
-            #if defined(_WIN32) && defined(_DEBUG)
-                OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
-            #endif
-                FillWithErrorColors(pOut);
-                return;
+                // Modes without alpha bits are opaque
+                for (i = 0; i < uNumEndPts; i++)
+                    c[i][ch] = 255u;
+                continue;
             }
 
-            c[i].g = GetBits(uStartBit, RGBAPrec.g);
-        }
-
-        // Blue channel
-        for (i = 0; i < uNumEndPts; i++)
-        {
-            if (uStartBit + RGBAPrec.b > 128)
+            if (uStartBit + uNumEndPts * uPrec > 128)
             {
             #if defined(_WIN32) && defined(_DEBUG)
                 OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
@@ -2629,22 +2807,13 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
                 return;
             }
 
-            c[i].b = GetBits(uStartBit, RGBAPrec.b);
-        }
-
-        // Alpha channel
-        for (i = 0; i < uNumEndPts; i++)
-        {
-            if (uStartBit + RGBAPrec.a > 128)
+            uint64_t uBits = GetBits64(uStartBit);
+            for (i = 0; i < uNumEndPts; i++)
             {
-            #if defined(_WIN32) && defined(_DEBUG)
-                OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
-            #endif
-                FillWithErrorColors(pOut);
-                return;
+                c[i][ch] = uint8_t(uBits & ((1u << uPrec) - 1u));
+                uBits >>= uPrec;
             }
-
-            c[i].a = RGBAPrec.a ? GetBits(uStartBit, RGBAPrec.a) : 255u;
+            uStartBit += uNumEndPts * uPrec;
         }
 
         // P-bits
@@ -2686,11 +2855,33 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
 
         uint8_t w1[NUM_PIXELS_PER_BLOCK], w2[NUM_PIXELS_PER_BLOCK];
 
-        // read color indices
+        // read color indices (at most 63 bits, so one 64-bit read covers them)
+        const uint8_t* const pFixUp = g_aFixUp[uPartitions][uShape];
+        const size_t uColorIndexBits = NUM_PIXELS_PER_BLOCK * uIndexPrec - uPartitions - 1u;
+        if (uStartBit + uColorIndexBits > 128)
+        {
+        #if defined(_WIN32) && defined(_DEBUG)
+            OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
+        #endif
+            FillWithErrorColors(pOut);
+            return;
+        }
+
+        uint64_t uBits = GetBits64(uStartBit);
         for (i = 0; i < NUM_PIXELS_PER_BLOCK; i++)
         {
-            const size_t uNumBits = IsFixUpOffset(ms_aInfo[uMode].uPartitions, uShape, i) ? uIndexPrec - 1u : uIndexPrec;
-            if (uStartBit + uNumBits > 128)
+            // Unused fix-up slots are 0, which is always an anchor anyway
+            const size_t uNumBits = (i == pFixUp[0] || i == pFixUp[1] || i == pFixUp[2]) ? uIndexPrec - 1u : uIndexPrec;
+            w1[i] = uint8_t(uBits & ((1u << uNumBits) - 1u));
+            uBits >>= uNumBits;
+        }
+        uStartBit += uColorIndexBits;
+
+        // read alpha indices
+        if (uIndexPrec2)
+        {
+            const size_t uAlphaIndexBits = NUM_PIXELS_PER_BLOCK * uIndexPrec2 - 1u;
+            if (uStartBit + uAlphaIndexBits > 128)
             {
             #if defined(_WIN32) && defined(_DEBUG)
                 OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
@@ -2698,46 +2889,51 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
                 FillWithErrorColors(pOut);
                 return;
             }
-            w1[i] = GetBits(uStartBit, uNumBits);
-        }
 
-        // read alpha indices
-        if (uIndexPrec2)
-        {
+            uBits = GetBits64(uStartBit);
             for (i = 0; i < NUM_PIXELS_PER_BLOCK; i++)
             {
                 const size_t uNumBits = i ? uIndexPrec2 : uIndexPrec2 - 1u;
-                if (uStartBit + uNumBits > 128)
-                {
-                #if defined(_WIN32) && defined(_DEBUG)
-                    OutputDebugStringA("BC7: Invalid block encountered during decoding\n");
-                #endif
-                    FillWithErrorColors(pOut);
-                    return;
-                }
-                w2[i] = GetBits(uStartBit, uNumBits);
+                w2[i] = uint8_t(uBits & ((1u << uNumBits) - 1u));
+                uBits >>= uNumBits;
             }
         }
 
-        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        // Pick the index set and weight table for each channel group once for the block
+        const uint8_t* pColorIndices = w1;
+        const uint8_t* pAlphaIndices = w1;
+        size_t uColorPrec = uIndexPrec;
+        size_t uAlphaPrec = uIndexPrec;
+        if (uIndexPrec2)
         {
-            const uint8_t uRegion = g_aPartitionTable[uPartitions][uShape][i];
-            LDRColorA outPixel;
-            if (uIndexPrec2 == 0)
+            if (uIndexMode == 0)
             {
-                LDRColorA::Interpolate(c[uRegion << 1], c[(uRegion << 1) + 1], w1[i], w1[i], uIndexPrec, uIndexPrec, outPixel);
+                pAlphaIndices = w2;
+                uAlphaPrec = uIndexPrec2;
             }
             else
             {
-                if (uIndexMode == 0)
-                {
-                    LDRColorA::Interpolate(c[uRegion << 1], c[(uRegion << 1) + 1], w1[i], w2[i], uIndexPrec, uIndexPrec2, outPixel);
-                }
-                else
-                {
-                    LDRColorA::Interpolate(c[uRegion << 1], c[(uRegion << 1) + 1], w2[i], w1[i], uIndexPrec2, uIndexPrec, outPixel);
-                }
+                pColorIndices = w2;
+                uColorPrec = uIndexPrec2;
             }
+        }
+
+        const int* const aColorWeights = (uColorPrec == 2) ? g_aWeights2 : ((uColorPrec == 3) ? g_aWeights3 : g_aWeights4);
+        const int* const aAlphaWeights = (uAlphaPrec == 2) ? g_aWeights2 : ((uAlphaPrec == 3) ? g_aWeights3 : g_aWeights4);
+        const uint8_t* const pPartition = g_aPartitionTable[uPartitions][uShape];
+
+        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const LDRColorA& c0 = c[pPartition[i] << 1];
+            const LDRColorA& c1 = c[(pPartition[i] << 1) + 1];
+            const uint32_t wc = uint32_t(aColorWeights[pColorIndices[i]]);
+            const uint32_t wa = uint32_t(aAlphaWeights[pAlphaIndices[i]]);
+
+            LDRColorA outPixel;
+            outPixel.r = uint8_t((uint32_t(c0.r) * (BC67_WEIGHT_MAX - wc) + uint32_t(c1.r) * wc + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT);
+            outPixel.g = uint8_t((uint32_t(c0.g) * (BC67_WEIGHT_MAX - wc) + uint32_t(c1.g) * wc + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT);
+            outPixel.b = uint8_t((uint32_t(c0.b) * (BC67_WEIGHT_MAX - wc) + uint32_t(c1.b) * wc + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT);
+            outPixel.a = uint8_t((uint32_t(c0.a) * (BC67_WEIGHT_MAX - wa) + uint32_t(c1.a) * wa + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT);
 
             switch (uRotation)
             {
@@ -2746,7 +2942,7 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
             case 3: std::swap(outPixel.b, outPixel.a); break;
             }
 
-            pOut[i] = HDRColorA(outPixel);
+            pOut[i] = outPixel;
         }
     }
     else
@@ -2755,7 +2951,7 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
         OutputDebugStringA("BC7: Reserved mode 8 encountered during decoding\n");
     #endif
         // Per the BC7 format spec, we must return transparent black
-        memset(pOut, 0, sizeof(HDRColorA) * NUM_PIXELS_PER_BLOCK);
+        memset(pOut, 0, sizeof(LDRColorA) * NUM_PIXELS_PER_BLOCK);
     }
 }
 
@@ -2764,9 +2960,7 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
 {
     assert(pIn);
 
-    D3DX_BC7 final = *this;
     EncodeParams EP(pIn);
-    float fMSEBest = FLT_MAX;
     uint32_t alphaMask = 0xFF;
 
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
@@ -2780,6 +2974,27 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
 
     const bool bHasAlpha = (alphaMask != 0xFF);
 
+    if ((flags & BC_FLAGS_BC7_QUALITY_MASK) == BC_FLAGS_BC7_QUALITY_SLOW)
+    {
+        EncodeExhaustive(flags, &EP, bHasAlpha);
+    }
+    else
+    {
+        EncodeClassified(flags, &EP, bHasAlpha);
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// Tries every mode, rotation and index mode, refining the best quarter of the partitions by rough estimate
+_Use_decl_annotations_
+void D3DX_BC7::EncodeExhaustive(uint32_t flags, EncodeParams* pEP, bool bHasAlpha) noexcept
+{
+    assert(pEP);
+
+    D3DX_BC7 final = *this;
+    EncodeParams& EP = *pEP;
+    float fMSEBest = FLT_MAX;
+
     for (EP.uMode = 0; EP.uMode < 8 && fMSEBest > 0; ++EP.uMode)
     {
         if (!(flags & BC_FLAGS_USE_3SUBSETS) && (EP.uMode == 0 || EP.uMode == 2))
@@ -2788,12 +3003,6 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
             continue;
         }
 
-        if ((flags & TEX_COMPRESS_BC7_QUICK) && (EP.uMode != 6))
-        {
-            // Use only mode 6
-            continue;
-        }
-
         if ((!bHasAlpha) && (EP.uMode == 7))
         {
             // There is no value in using mode 7 for completely opaque blocks (the other 2 subset modes handle this case for opaque blocks), so skip it for a small perf win.
@@ -2866,6 +3075,241 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
     *this = final;
 }
 
+//-------------------------------------------------------------------------------------
+// Classifies the block and refines a small set of candidates in order of their estimated
+// error, stopping as soon as one is good enough for the quality level
+_Use_decl_annotations_
+void D3DX_BC7::EncodeClassified(uint32_t flags, EncodeParams* pEP, bool bHasAlpha) noexcept
+{
+    assert(pEP);
+
+    const bool bFast = (flags & BC_FLAGS_BC7_QUALITY_FAST) != 0;
+    const BC7Quality& quality = bFast ? c_BC7QualityFast : c_BC7QualityNormal;
+    const BC7_BLOCK_CLASS blockClass = ClassifyBC7Block(pEP->aLDRPixels, bHasAlpha, quality.fGradientError);
+
+    D3DX_BC7 best = *this;
+    float fMSEBest = FLT_MAX;
+
+    if (blockClass == BC7_BLOCK_SOLID)
+    {
+        const float fMSE = EncodeSolid(pEP);
+        if (fMSE < fMSEBest)
+        {
+            best = *this;
+            fMSEBest = fMSE;
+        }
+    }
+
+    // Single subset modes first; mode 6 handles most smooth blocks on its own
+    if (fMSEBest > quality.fTargetError)
+        RefineCandidate(pEP, 6, 0, 0, best, fMSEBest);
+
+    if (blockClass == BC7_BLOCK_ALPHA && fMSEBest > quality.fTargetError)
+    {
+        // Separate alpha endpoints (8-bit alpha)
+        RefineCandidate(pEP, 5, 0, 0, best, fMSEBest);
+    }
+
+    if (blockClass == BC7_BLOCK_ALPHA && !bFast)
+    {
+        for (size_t im = 0; im < 2 && fMSEBest > quality.fTargetError; ++im)
+            RefineCandidate(pEP, 4, 0, im, best, fMSEBest);
+    }
+
+    // Partitioned modes; a solid block can't benefit, and in fast mode neither does a gradient
+    const bool bTryPartitions = (blockClass == BC7_BLOCK_ALPHA || blockClass == BC7_BLOCK_HIGH_VARIANCE)
+        || (blockClass == BC7_BLOCK_GRADIENT && !bFast);
+    if (bTryPartitions && fMSEBest > quality.fTargetError)
+    {
+        static const uint8_t s_aAlphaModes[] = { 7 };
+        static const uint8_t s_aOpaqueModes[] = { 1, 3 };
+        if (bHasAlpha)
+        {
+            RefinePartitioned(pEP, s_aAlphaModes, 1, quality.uShapes, quality.uRefines, quality.fTargetError, true, best, fMSEBest);
+        }
+        else
+        {
+            RefinePartitioned(pEP, s_aOpaqueModes, bFast ? 1 : 2, quality.uShapes, quality.uRefines, quality.fTargetError, false, best, fMSEBest);
+        }
+    }
+
+    // 3 subset modes are rarely worth their cost, so they stay opt-in
+    if ((flags & BC_FLAGS_USE_3SUBSETS) && blockClass == BC7_BLOCK_HIGH_VARIANCE && fMSEBest > quality.fTargetError)
+    {
+        static const uint8_t s_a3SubsetModes[] = { 0, 2 };
+        RefinePartitioned(pEP, s_a3SubsetModes, 2, quality.uShapes, quality.uRefines, quality.fTargetError, false, best, fMSEBest);
+    }
+
+    *this = best;
+}
+
+//-------------------------------------------------------------------------------------
+// Encodes a single color block with mode 5, picking 7-bit endpoints whose 1/3 interpolant is
+// closest to each color channel (alpha has 8-bit endpoints, so it is exact)
+_Use_decl_annotations_
+float D3DX_BC7::EncodeSolid(EncodeParams* pEP) noexcept
+{
+    assert(pEP);
+
+    pEP->uMode = 5;
+    const LDRColorA& color = pEP->aLDRPixels[0];
+    const LDRColorA& RGBAPrec = ms_aInfo[5].RGBAPrec;
+
+    LDREndPntPair aEndPts[BC7_MAX_REGIONS] = {};
+    float fError = 0.0f;
+    for (size_t ch = 0; ch < 3; ++ch)
+    {
+        const int target = color[ch];
+        int bestError = 256;
+        for (int q0 = 0; q0 < 128 && bestError > 0; ++q0)
+        {
+            const int e0 = Unquantize(uint8_t(q0), RGBAPrec[ch]);
+
+            // Solve for the second endpoint, then check the neighbouring quantized values
+            const int e1 = (target * 64 - e0 * 43) / 21;
+            for (int q1 = std::max<int>(0, (e1 >> 1) - 1); q1 <= std::min<int>(127, (e1 >> 1) + 1); ++q1)
+            {
+                const int value = (e0 * (64 - g_aWeights2[1]) + Unquantize(uint8_t(q1), RGBAPrec[ch]) * g_aWeights2[1] + 32) >> 6;
+                const int error = abs(value - target);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    aEndPts[0].A[ch] = uint8_t(q0);
+                    aEndPts[0].B[ch] = uint8_t(q1);
+                }
+            }
+        }
+        fError += float(bestError * bestError);
+    }
+    aEndPts[0].A.a = aEndPts[0].B.a = color.a;
+
+    size_t aIndex[NUM_PIXELS_PER_BLOCK];
+    size_t aIndex2[NUM_PIXELS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        aIndex[i] = 1;
+        aIndex2[i] = 0;
+    }
+
+    EmitBlock(pEP, 0, 0, 0, aEndPts, aIndex, aIndex2);
+    return fError * float(NUM_PIXELS_PER_BLOCK);
+}
+
+_Use_decl_annotations_
+void D3DX_BC7::RefineCandidate(EncodeParams* pEP, uint8_t uMode, size_t uShape, size_t uIndexMode, D3DX_BC7& best, float& fMSEBest) noexcept
+{
+    assert(pEP);
+    assert(uMode < c_NumModes);
+    _Analysis_assume_(uMode < c_NumModes);
+
+    if (fMSEBest <= 0)
+        return;
+
+    // RoughMSE fills in the starting endpoints that Refine works from
+    pEP->uMode = uMode;
+    RoughMSE(pEP, uShape, uIndexMode);
+
+    const float fMSE = Refine(pEP, uShape, 0, uIndexMode);
+    if (fMSE < fMSEBest)
+    {
+        best = *this;
+        fMSEBest = fMSE;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// Ranks the partitions of modes that share a subset count by line fit, takes rough estimates
+// for the best few of each mode, and refines the best candidates overall
+_Use_decl_annotations_
+void D3DX_BC7::RefinePartitioned(
+    EncodeParams* pEP,
+    const uint8_t aModes[],
+    size_t uNumModes,
+    size_t uShapes,
+    size_t uRefines,
+    float fTargetError,
+    bool bAlpha,
+    D3DX_BC7& best,
+    float& fMSEBest) noexcept
+{
+    assert(pEP && aModes && uNumModes > 0 && uNumModes <= 2);
+    assert(uShapes > 0 && uShapes <= 16);
+
+    const size_t uPartitions = ms_aInfo[aModes[0]].uPartitions;
+    assert(uPartitions > 0 && uPartitions < BC7_MAX_REGIONS);
+    _Analysis_assume_(uPartitions > 0 && uPartitions < BC7_MAX_REGIONS);
+
+    float afEstimate[BC7_MAX_SHAPES];
+    for (size_t s = 0; s < BC7_MAX_SHAPES; ++s)
+        afEstimate[s] = EstimatePartitionError(pEP->aLDRPixels, uPartitions, s, bAlpha);
+
+    struct Candidate
+    {
+        float fError;
+        uint8_t uMode;
+        uint8_t uShape;
+    };
+    Candidate aCandidates[2 * 16];
+    size_t uNumCandidates = 0;
+
+    for (size_t m = 0; m < uNumModes; ++m)
+    {
+        const uint8_t uMode = aModes[m];
+        assert(ms_aInfo[uMode].uPartitions == uPartitions);
+        const size_t uModeShapes = size_t(1) << ms_aInfo[uMode].uPartitionBits;
+        const size_t uItems = std::min<size_t>(uShapes, uModeShapes);
+
+        float afError[BC7_MAX_SHAPES];
+        size_t auShape[BC7_MAX_SHAPES];
+        for (size_t s = 0; s < uModeShapes; ++s)
+        {
+            afError[s] = afEstimate[s];
+            auShape[s] = s;
+        }
+
+        // Bubble up the first uItems items
+        for (size_t i = 0; i < uItems; i++)
+        {
+            for (size_t j = i + 1; j < uModeShapes; j++)
+            {
+                if (afError[i] > afError[j])
+                {
+                    std::swap(afError[i], afError[j]);
+                    std::swap(auShape[i], auShape[j]);
+                }
+            }
+        }
+
+        pEP->uMode = uMode;
+        for (size_t i = 0; i < uItems; ++i)
+        {
+            Candidate& candidate = aCandidates[uNumCandidates++];
+            candidate.fError = RoughMSE(pEP, auShape[i], 0);
+            candidate.uMode = uMode;
+            candidate.uShape = static_cast<uint8_t>(auShape[i]);
+        }
+    }
+
+    // Insertion sort by rough error
+    for (size_t i = 1; i < uNumCandidates; ++i)
+    {
+        const Candidate candidate = aCandidates[i];
+        size_t j = i;
+        for (; j > 0 && aCandidates[j - 1].fError > candidate.fError; --j)
+            aCandidates[j] = aCandidates[j - 1];
+        aCandidates[j] = candidate;
+    }
+
+    for (size_t i = 0; i < uNumCandidates && i < uRefines && fMSEBest > fTargetError; ++i)
+    {
+        // Refinement rarely beats the rough estimate by much, so a candidate already worse than the best is skipped
+        if (aCandidates[i].fError >= fMSEBest)
+            break;
+
+        RefineCandidate(pEP, aCandidates[i].uMode, aCandidates[i].uShape, 0, best, fMSEBest);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
@@ -3621,6 +4065,26 @@ void DirectX::D3DXDecodeBC7(XMVECTOR *pColor, const uint8_t *pBC) noexcept
     reinterpret_cast<const D3DX_BC7*>(pBC)->Decode(reinterpret_cast<HDRColorA*>(pColor));
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC7FastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    static_assert(sizeof(LDRColorA) == 4, "LDRColorA should be 4 bytes");
+
+    // The 8-bit endpoints and interpolants are already what a UNORM8 store would produce
+    LDRColorA aPixels[NUM_PIXELS_PER_BLOCK];
+    for (size_t x = 0; x < width; x += 4, pBC += 16, pDest += 16)
+    {
+        reinterpret_cast<const D3DX_BC7*>(pBC)->Decode(aPixels);
+
+        const size_t pw = std::min<size_t>(4, width - x);
+        for (size_t y = 0; y < height; ++y)
+        {
+            memcpy(pDest + rowPitch * y, &aPixels[y * 4], pw * sizeof(LDRColorA));
+        }
+    }
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC7(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
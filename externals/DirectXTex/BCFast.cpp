@@ -0,0 +1,535 @@
+//-------------------------------------------------------------------------------------
+// BCFast.cpp
+//
+// Block-compression (BC1-BC5) fast paths for 8-bit RGBA pixels
+//
+// Used by Compress with TEX_COMPRESS_BC_FAST. Endpoints come from the principal axis
+// of the block's colors followed by a single least squares refinement, which is much
+// cheaper than the iterative search in EncodeBC1. Several blocks are encoded at once,
+// one per SIMD lane (8 with AVX2, 4 with SSE2, 1 otherwise).
+//
+// Used by Decompress for R8G8B8A8 results. Blocks are decoded with integer math straight
+// into the destination rows, two blocks per iteration with AVX2 for BC1-BC3.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include "BC.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BCFAST_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define BCFAST_X86 0
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    //---------------------------------------------------------------------------------
+    // Portable version, one block at a time
+    namespace Scalar
+    {
+        constexpr size_t LANES = 1;
+        using VF = float;
+        using VI = uint32_t;
+        using MF = bool;
+        using MI = bool;
+
+        inline VF SetF(float v) noexcept { return v; }
+        inline VI SetI(uint32_t v) noexcept { return v; }
+        inline VF Add(VF a, VF b) noexcept { return a + b; }
+        inline VF Sub(VF a, VF b) noexcept { return a - b; }
+        inline VF Mul(VF a, VF b) noexcept { return a * b; }
+        inline VF Div(VF a, VF b) noexcept { return a / b; }
+        inline VF Min(VF a, VF b) noexcept { return (b < a) ? b : a; }
+        inline VF Max(VF a, VF b) noexcept { return (a < b) ? b : a; }
+        inline VF Abs(VF a) noexcept { return (a < 0.f) ? -a : a; }
+        inline MF CmpGt(VF a, VF b) noexcept { return a > b; }
+        inline MF CmpLt(VF a, VF b) noexcept { return a < b; }
+        inline VF SelectF(MF m, VF a, VF b) noexcept { return m ? a : b; }
+        inline VI ToInt(VF a) noexcept { return static_cast<uint32_t>(static_cast<int32_t>(a)); }
+        inline VF ToFloat(VI a) noexcept { return static_cast<float>(static_cast<int32_t>(a)); }
+        inline VI AndI(VI a, VI b) noexcept { return a & b; }
+        inline VI OrI(VI a, VI b) noexcept { return a | b; }
+        inline VI XorI(VI a, VI b) noexcept { return a ^ b; }
+        inline VI SubI(VI a, VI b) noexcept { return a - b; }
+        inline VI ShlI(VI a, int n) noexcept { return a << n; }
+        inline VI ShrI(VI a, int n) noexcept { return a >> n; }
+        inline MI CmpEqI(VI a, VI b) noexcept { return a == b; }
+        inline MI CmpGtI(VI a, VI b) noexcept { return static_cast<int32_t>(a) > static_cast<int32_t>(b); }
+        inline VI SelectI(MI m, VI a, VI b) noexcept { return m ? a : b; }
+        inline VI LoadI(const uint32_t* p) noexcept { return *p; }
+        inline void StoreI(uint32_t* p, VI v) noexcept { *p = v; }
+
+    #include "BCFastKernel.inl"
+    }
+
+#if BCFAST_X86
+    //---------------------------------------------------------------------------------
+    // SSE2, four blocks at a time (always available on x64)
+    namespace SSE2
+    {
+        constexpr size_t LANES = 4;
+        using VF = __m128;
+        using VI = __m128i;
+        using MF = __m128;
+        using MI = __m128i;
+
+        inline VF SetF(float v) noexcept { return _mm_set1_ps(v); }
+        inline VI SetI(uint32_t v) noexcept { return _mm_set1_epi32(static_cast<int>(v)); }
+        inline VF Add(VF a, VF b) noexcept { return _mm_add_ps(a, b); }
+        inline VF Sub(VF a, VF b) noexcept { return _mm_sub_ps(a, b); }
+        inline VF Mul(VF a, VF b) noexcept { return _mm_mul_ps(a, b); }
+        inline VF Div(VF a, VF b) noexcept { return _mm_div_ps(a, b); }
+        inline VF Min(VF a, VF b) noexcept { return _mm_min_ps(a, b); }
+        inline VF Max(VF a, VF b) noexcept { return _mm_max_ps(a, b); }
+        inline VF Abs(VF a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+        inline MF CmpGt(VF a, VF b) noexcept { return _mm_cmpgt_ps(a, b); }
+        inline MF CmpLt(VF a, VF b) noexcept { return _mm_cmplt_ps(a, b); }
+        inline VF SelectF(MF m, VF a, VF b) noexcept { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        inline VI ToInt(VF a) noexcept { return _mm_cvttps_epi32(a); }
+        inline VF ToFloat(VI a) noexcept { return _mm_cvtepi32_ps(a); }
+        inline VI AndI(VI a, VI b) noexcept { return _mm_and_si128(a, b); }
+        inline VI OrI(VI a, VI b) noexcept { return _mm_or_si128(a, b); }
+        inline VI XorI(VI a, VI b) noexcept { return _mm_xor_si128(a, b); }
+        inline VI SubI(VI a, VI b) noexcept { return _mm_sub_epi32(a, b); }
+        inline VI ShlI(VI a, int n) noexcept { return _mm_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+        inline VI ShrI(VI a, int n) noexcept { return _mm_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+        inline MI CmpEqI(VI a, VI b) noexcept { return _mm_cmpeq_epi32(a, b); }
+        inline MI CmpGtI(VI a, VI b) noexcept { return _mm_cmpgt_epi32(a, b); }
+        inline VI SelectI(MI m, VI a, VI b) noexcept { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+        inline VI LoadI(const uint32_t* p) noexcept { return _mm_load_si128(reinterpret_cast<const __m128i*>(p)); }
+        inline void StoreI(uint32_t* p, VI v) noexcept { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    #include "BCFastKernel.inl"
+    }
+
+    //---------------------------------------------------------------------------------
+    // AVX2, eight blocks at a time (selected at runtime)
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+    namespace AVX2
+    {
+        constexpr size_t LANES = 8;
+        using VF = __m256;
+        using VI = __m256i;
+        using MF = __m256;
+        using MI = __m256i;
+
+        inline VF SetF(float v) noexcept { return _mm256_set1_ps(v); }
+        inline VI SetI(uint32_t v) noexcept { return _mm256_set1_epi32(static_cast<int>(v)); }
+        inline VF Add(VF a, VF b) noexcept { return _mm256_add_ps(a, b); }
+        inline VF Sub(VF a, VF b) noexcept { return _mm256_sub_ps(a, b); }
+        inline VF Mul(VF a, VF b) noexcept { return _mm256_mul_ps(a, b); }
+        inline VF Div(VF a, VF b) noexcept { return _mm256_div_ps(a, b); }
+        inline VF Min(VF a, VF b) noexcept { return _mm256_min_ps(a, b); }
+        inline VF Max(VF a, VF b) noexcept { return _mm256_max_ps(a, b); }
+        inline VF Abs(VF a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+        inline MF CmpGt(VF a, VF b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        inline MF CmpLt(VF a, VF b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        inline VF SelectF(MF m, VF a, VF b) noexcept { return _mm256_blendv_ps(b, a, m); }
+        inline VI ToInt(VF a) noexcept { return _mm256_cvttps_epi32(a); }
+        inline VF ToFloat(VI a) noexcept { return _mm256_cvtepi32_ps(a); }
+        inline VI AndI(VI a, VI b) noexcept { return _mm256_and_si256(a, b); }
+        inline VI OrI(VI a, VI b) noexcept { return _mm256_or_si256(a, b); }
+        inline VI XorI(VI a, VI b) noexcept { return _mm256_xor_si256(a, b); }
+        inline VI SubI(VI a, VI b) noexcept { return _mm256_sub_epi32(a, b); }
+        inline VI ShlI(VI a, int n) noexcept { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+        inline VI ShrI(VI a, int n) noexcept { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+        inline MI CmpEqI(VI a, VI b) noexcept { return _mm256_cmpeq_epi32(a, b); }
+        inline MI CmpGtI(VI a, VI b) noexcept { return _mm256_cmpgt_epi32(a, b); }
+        inline VI SelectI(MI m, VI a, VI b) noexcept { return _mm256_blendv_epi8(b, a, m); }
+        inline VI LoadI(const uint32_t* p) noexcept { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+        inline void StoreI(uint32_t* p, VI v) noexcept { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+
+    #include "BCFastKernel.inl"
+    }
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+    bool HasAVX2() noexcept
+    {
+    #ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // AVX with OS support for the YMM state, then the AVX2 feature bit
+        __cpuid(info, 1);
+        if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & 0x20) != 0;
+    #else
+        return __builtin_cpu_supports("avx2") != 0;
+    #endif
+    }
+
+#endif // BCFAST_X86
+
+    inline bool UseAVX2() noexcept
+    {
+    #if BCFAST_X86
+        static const bool s_avx2 = HasAVX2();
+        return s_avx2;
+    #else
+        return false;
+    #endif
+    }
+
+    void EncodeRowFast(
+        uint8_t* pBC, const uint8_t* pSource, size_t rowPitch, size_t width, size_t height,
+        bool alpha, float threshold, uint32_t flags) noexcept
+    {
+    #if BCFAST_X86
+        if (UseAVX2())
+        {
+            AVX2::EncodeRow(pBC, pSource, rowPitch, width, height, alpha, threshold, flags);
+        }
+        else
+        {
+            SSE2::EncodeRow(pBC, pSource, rowPitch, width, height, alpha, threshold, flags);
+        }
+    #else
+        Scalar::EncodeRow(pBC, pSource, rowPitch, width, height, alpha, threshold, flags);
+    #endif
+    }
+
+
+    //---------------------------------------------------------------------------------
+    // Decoding to R8G8B8A8
+    //
+    // Palette entries are the exact interpolants rounded to nearest, which is what the
+    // float decoders give once StoreScanline writes them as UNORM8. The one exception is
+    // a BC1 3-color midpoint exactly halfway between two 8-bit values (red or blue
+    // endpoints summing to 31): this rounds up, while the float result depends on
+    // rounding error and can be one lower.
+    enum class DecodeFormat
+    {
+        BC1,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+    };
+
+    constexpr size_t GetBlockSize(DecodeFormat format) noexcept
+    {
+        return (format == DecodeFormat::BC1 || format == DecodeFormat::BC4) ? 8 : 16;
+    }
+
+    // Rounds numerator / denominator (a value in [0, 1]) to 8 bits
+    constexpr uint32_t ToUnorm8(uint32_t numerator, uint32_t denominator) noexcept
+    {
+        return (numerator * 510u + denominator) / (denominator * 2u);
+    }
+
+    constexpr uint32_t PackRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a) noexcept
+    {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    }
+
+    void DecodeColorPalette(_In_ const D3DX_BC1* pBC, bool isbc1, _Out_writes_(4) uint32_t* pPalette) noexcept
+    {
+        const uint32_t c0 = pBC->rgb[0];
+        const uint32_t c1 = pBC->rgb[1];
+        const uint32_t r0 = c0 >> 11, g0 = (c0 >> 5) & 63, b0 = c0 & 31;
+        const uint32_t r1 = c1 >> 11, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+
+        pPalette[0] = PackRGBA(ToUnorm8(r0, 31), ToUnorm8(g0, 63), ToUnorm8(b0, 31), 255);
+        pPalette[1] = PackRGBA(ToUnorm8(r1, 31), ToUnorm8(g1, 63), ToUnorm8(b1, 31), 255);
+
+        if (isbc1 && (c0 <= c1))
+        {
+            pPalette[2] = PackRGBA(ToUnorm8(r0 + r1, 62), ToUnorm8(g0 + g1, 126), ToUnorm8(b0 + b1, 62), 255);
+            pPalette[3] = 0;
+        }
+        else
+        {
+            pPalette[2] = PackRGBA(ToUnorm8(r0 * 2 + r1, 93), ToUnorm8(g0 * 2 + g1, 189), ToUnorm8(b0 * 2 + b1, 93), 255);
+            pPalette[3] = PackRGBA(ToUnorm8(r0 + r1 * 2, 93), ToUnorm8(g0 + g1 * 2, 189), ToUnorm8(b0 + b1 * 2, 93), 255);
+        }
+    }
+
+    // BC3 alpha and BC4/BC5 channels: two 8-bit endpoints and sixteen 3-bit indices
+    void DecodeChannel(_In_reads_(8) const uint8_t* pBC, _Out_writes_(NUM_PIXELS_PER_BLOCK) uint8_t* pValues) noexcept
+    {
+        const uint32_t v0 = pBC[0];
+        const uint32_t v1 = pBC[1];
+
+        uint8_t palette[8];
+        palette[0] = uint8_t(v0);
+        palette[1] = uint8_t(v1);
+        if (v0 > v1)
+        {
+            for (uint32_t i = 1; i < 7; ++i)
+                palette[i + 1] = uint8_t(ToUnorm8(v0 * (7 - i) + v1 * i, 7 * 255));
+        }
+        else
+        {
+            for (uint32_t i = 1; i < 5; ++i)
+                palette[i + 1] = uint8_t(ToUnorm8(v0 * (5 - i) + v1 * i, 5 * 255));
+
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t bits = 0;
+        for (size_t i = 0; i < 6; ++i)
+            bits |= uint64_t(pBC[i + 2]) << (8 * i);
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, bits >>= 3)
+            pValues[i] = palette[bits & 7];
+    }
+
+    void DecodeAlpha(DecodeFormat format, _In_reads_(8) const uint8_t* pBC, _Out_writes_(NUM_PIXELS_PER_BLOCK) uint8_t* pAlpha) noexcept
+    {
+        if (format == DecodeFormat::BC2)
+        {
+            // 4-bit alpha, low nibble first
+            for (size_t i = 0; i < 8; ++i)
+            {
+                pAlpha[i * 2] = uint8_t((pBC[i] & 0xf) * 17);
+                pAlpha[i * 2 + 1] = uint8_t((pBC[i] >> 4) * 17);
+            }
+        }
+        else
+        {
+            DecodeChannel(pBC, pAlpha);
+        }
+    }
+
+    template<DecodeFormat F>
+    void DecodeBlock(_In_ const uint8_t* pBC, _Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t* pPixels) noexcept
+    {
+        if (F == DecodeFormat::BC4 || F == DecodeFormat::BC5)
+        {
+            uint8_t red[NUM_PIXELS_PER_BLOCK];
+            uint8_t green[NUM_PIXELS_PER_BLOCK];
+            DecodeChannel(pBC, red);
+            if (F == DecodeFormat::BC5)
+            {
+                DecodeChannel(pBC + 8, green);
+                for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                    pPixels[i] = PackRGBA(red[i], green[i], 0, 255);
+            }
+            else
+            {
+                for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                    pPixels[i] = PackRGBA(red[i], red[i], red[i], 255);
+            }
+            return;
+        }
+
+        auto pColor = reinterpret_cast<const D3DX_BC1*>((F == DecodeFormat::BC1) ? pBC : pBC + 8);
+
+        uint32_t palette[4];
+        DecodeColorPalette(pColor, F == DecodeFormat::BC1, palette);
+
+        uint32_t dw = pColor->bitmap;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 2)
+            pPixels[i] = palette[dw & 3];
+
+        if (F != DecodeFormat::BC1)
+        {
+            uint8_t alpha[NUM_PIXELS_PER_BLOCK];
+            DecodeAlpha(F, pBC, alpha);
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                pPixels[i] = (pPixels[i] & 0x00ffffff) | (uint32_t(alpha[i]) << 24);
+        }
+    }
+
+#if BCFAST_X86
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+    namespace AVX2
+    {
+        // Decodes pairs of whole BC1-BC3 blocks, one per 128-bit lane. The palette lookup is a byte
+        // shuffle, and each row of the pair is a single 32 byte store.
+        template<DecodeFormat F>
+        void DecodeBlockPairs(uint8_t* pDest, size_t rowPitch, const uint8_t* pBC, size_t pairs) noexcept
+        {
+            constexpr size_t blockSize = GetBlockSize(F);
+
+            const __m256i indexMask = _mm256_set1_epi32(3);
+            const __m256i indexScale = _mm256_set1_epi32(0x04040404);
+            const __m256i byteOffsets = _mm256_set1_epi32(0x03020100);
+            const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xff000000));
+
+            for (size_t pair = 0; pair < pairs; ++pair, pBC += blockSize * 2, pDest += 32)
+            {
+                auto pColor0 = reinterpret_cast<const D3DX_BC1*>((F == DecodeFormat::BC1) ? pBC : pBC + 8);
+                auto pColor1 = reinterpret_cast<const D3DX_BC1*>(reinterpret_cast<const uint8_t*>(pColor0) + blockSize);
+
+                alignas(32) uint32_t palette[8];
+                DecodeColorPalette(pColor0, F == DecodeFormat::BC1, palette);
+                DecodeColorPalette(pColor1, F == DecodeFormat::BC1, palette + 4);
+
+                const __m256i vPalette = _mm256_load_si256(reinterpret_cast<const __m256i*>(palette));
+                const __m256i vBits = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_set1_epi32(static_cast<int>(pColor0->bitmap))),
+                    _mm_set1_epi32(static_cast<int>(pColor1->bitmap)), 1);
+
+                __m256i vAlpha = _mm256_setzero_si256();
+                if (F != DecodeFormat::BC1)
+                {
+                    alignas(32) uint8_t alpha[NUM_PIXELS_PER_BLOCK * 2];
+                    DecodeAlpha(F, pBC, alpha);
+                    DecodeAlpha(F, pBC + blockSize, alpha + NUM_PIXELS_PER_BLOCK);
+                    vAlpha = _mm256_load_si256(reinterpret_cast<const __m256i*>(alpha));
+                }
+
+                for (int y = 0; y < 4; ++y)
+                {
+                    // 2-bit index of each pixel in the row, as byte offsets of its palette entry
+                    const __m256i vShift = _mm256_setr_epi32(y * 8, y * 8 + 2, y * 8 + 4, y * 8 + 6, y * 8, y * 8 + 2, y * 8 + 4, y * 8 + 6);
+                    const __m256i vIndex = _mm256_and_si256(_mm256_srlv_epi32(vBits, vShift), indexMask);
+                    __m256i vColor = _mm256_shuffle_epi8(vPalette, _mm256_add_epi32(_mm256_mullo_epi32(vIndex, indexScale), byteOffsets));
+
+                    if (F != DecodeFormat::BC1)
+                    {
+                        // Alpha of pixel (x, y) goes to the top byte of output pixel x; 0x80 selects zero
+                        const int a = y * 4;
+                        const __m256i vSelect = _mm256_setr_epi32(
+                            int(0x808080u | (uint32_t(a) << 24)), int(0x808080u | (uint32_t(a + 1) << 24)),
+                            int(0x808080u | (uint32_t(a + 2) << 24)), int(0x808080u | (uint32_t(a + 3) << 24)),
+                            int(0x808080u | (uint32_t(a) << 24)), int(0x808080u | (uint32_t(a + 1) << 24)),
+                            int(0x808080u | (uint32_t(a + 2) << 24)), int(0x808080u | (uint32_t(a + 3) << 24)));
+                        vColor = _mm256_or_si256(_mm256_andnot_si256(alphaMask, vColor), _mm256_shuffle_epi8(vAlpha, vSelect));
+                    }
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDest + rowPitch * size_t(y)), vColor);
+                }
+            }
+        }
+    }
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif // BCFAST_X86
+
+    template<DecodeFormat F>
+    void DecodeRowFast(uint8_t* pDest, size_t rowPitch, const uint8_t* pBC, size_t width, size_t height) noexcept
+    {
+        constexpr size_t blockSize = GetBlockSize(F);
+
+        size_t x = 0;
+    #if BCFAST_X86
+        if ((F == DecodeFormat::BC1 || F == DecodeFormat::BC2 || F == DecodeFormat::BC3) && height == 4 && UseAVX2())
+        {
+            const size_t pairs = width / 8;
+            AVX2::DecodeBlockPairs<F>(pDest, rowPitch, pBC, pairs);
+            x = pairs * 8;
+        }
+    #endif
+
+        uint32_t pixels[NUM_PIXELS_PER_BLOCK];
+        for (; x < width; x += 4)
+        {
+            DecodeBlock<F>(pBC + (x / 4) * blockSize, pixels);
+
+            const size_t pw = std::min<size_t>(4, width - x);
+            for (size_t y = 0; y < height; ++y)
+            {
+                memcpy(pDest + rowPitch * y + x * 4, &pixels[y * 4], pw * sizeof(uint32_t));
+            }
+        }
+    }
+}
+
+
+//=====================================================================================
+// Entry points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// BC1 / BC3 fast compression of one row of blocks
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1FastRow(
+    uint8_t* pBC,
+    const uint8_t* pSource,
+    size_t rowPitch,
+    size_t width,
+    size_t height,
+    float threshold,
+    uint32_t flags) noexcept
+{
+    assert(pBC && pSource && width > 0 && height > 0 && height <= 4);
+    EncodeRowFast(pBC, pSource, rowPitch, width, height, false, threshold, flags);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3FastRow(
+    uint8_t* pBC,
+    const uint8_t* pSource,
+    size_t rowPitch,
+    size_t width,
+    size_t height,
+    uint32_t flags) noexcept
+{
+    assert(pBC && pSource && width > 0 && height > 0 && height <= 4);
+    EncodeRowFast(pBC, pSource, rowPitch, width, height, true, 0.f, flags);
+}
+
+
+//-------------------------------------------------------------------------------------
+// BC1-BC5 decoding of one row of blocks to R8G8B8A8
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC1FastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    DecodeRowFast<DecodeFormat::BC1>(pDest, rowPitch, pBC, width, height);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC2FastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    DecodeRowFast<DecodeFormat::BC2>(pDest, rowPitch, pBC, width, height);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC3FastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    DecodeRowFast<DecodeFormat::BC3>(pDest, rowPitch, pBC, width, height);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC4UFastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    DecodeRowFast<DecodeFormat::BC4>(pDest, rowPitch, pBC, width, height);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC5UFastRow(uint8_t *pDest, size_t rowPitch, const uint8_t *pBC, size_t width, size_t height) noexcept
+{
+    assert(pDest && pBC && width > 0 && height > 0 && height <= 4);
+    DecodeRowFast<DecodeFormat::BC5>(pDest, rowPitch, pBC, width, height);
+}
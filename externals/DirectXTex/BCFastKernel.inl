@@ -0,0 +1,338 @@
+//-------------------------------------------------------------------------------------
+// BCFastKernel.inl
+//
+// Lane-parallel BC1/BC3 encoder kernel (TEX_COMPRESS_BC_FAST)
+//
+// Included once per instruction set by BCFast.cpp. The includer defines LANES, the
+// vector types VF / VI, the mask types MF / MI and the inline operations used below.
+// Each lane encodes a different 4x4 block.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+// Pixels of LANES blocks in structure-of-arrays order: pixels[p][lane] is pixel p (row major) of lane's block
+struct BlockGroup
+{
+    alignas(32) uint32_t pixels[NUM_PIXELS_PER_BLOCK][LANES];
+};
+
+// Encoded fields of LANES blocks
+struct EncodedGroup
+{
+    alignas(32) uint32_t color0[LANES];
+    alignas(32) uint32_t color1[LANES];
+    alignas(32) uint32_t bitmap[LANES];
+    alignas(32) uint32_t alphaMin[LANES];
+    alignas(32) uint32_t alphaMax[LANES];
+    alignas(32) uint32_t alphaBitmap[2][LANES];
+};
+
+//-------------------------------------------------------------------------------------
+// Rounds endpoints to 565 and returns the packed color; r, g and b are replaced by the
+// 8-bit values the decoder will reconstruct
+inline VI Quantize565(VF& r, VF& g, VF& b) noexcept
+{
+    const VI r5 = ToInt(Add(Mul(r, SetF(31.f / 255.f)), SetF(0.5f)));
+    const VI g6 = ToInt(Add(Mul(g, SetF(63.f / 255.f)), SetF(0.5f)));
+    const VI b5 = ToInt(Add(Mul(b, SetF(31.f / 255.f)), SetF(0.5f)));
+    r = Mul(ToFloat(r5), SetF(255.f / 31.f));
+    g = Mul(ToFloat(g6), SetF(255.f / 63.f));
+    b = Mul(ToFloat(b5), SetF(255.f / 31.f));
+    return OrI(OrI(ShlI(r5, 11), ShlI(g6, 5)), b5);
+}
+
+//-------------------------------------------------------------------------------------
+// Projects every pixel onto the segment between the endpoints and picks the nearest of the
+// four palette entries. weight[p] receives the share of endpoint 0 (0, 1/3, 2/3 or 1).
+inline VI AssignIndices(
+    const VF* r, const VF* g, const VF* b,
+    VF r0, VF g0, VF b0,
+    VF r1, VF g1, VF b1,
+    VF* weight) noexcept
+{
+    const VF dr = Sub(r0, r1);
+    const VF dg = Sub(g0, g1);
+    const VF db = Sub(b0, b1);
+    const VF dd = Add(Add(Mul(dr, dr), Mul(dg, dg)), Mul(db, db));
+    const VF scale = SelectF(CmpGt(dd, SetF(0.f)), Div(SetF(3.f), Max(dd, SetF(1.f))), SetF(0.f));
+
+    VI bitmap = SetI(0);
+    for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        VF t = Add(Add(Mul(Sub(r[p], r1), dr), Mul(Sub(g[p], g1), dg)), Mul(Sub(b[p], b1), db));
+        t = Min(Max(Mul(t, scale), SetF(0.f)), SetF(3.f));
+        const VI k = ToInt(Add(t, SetF(0.5f)));
+        weight[p] = Mul(ToFloat(k), SetF(1.f / 3.f));
+
+        // j = 3 - k counts steps away from endpoint 0; BC1 orders the palette 0, 1, 2/3, 1/3
+        const VI j = SubI(SetI(3), k);
+        const VI hi = ShrI(j, 1);
+        const VI index = OrI(ShlI(XorI(hi, AndI(j, SetI(1))), 1), hi);
+        bitmap = OrI(bitmap, ShlI(index, int(p * 2)));
+    }
+    return bitmap;
+}
+
+//-------------------------------------------------------------------------------------
+// Least squares fit of both endpoints to the pixels for the given palette weights
+inline void RefineEndpoints(
+    const VF* r, const VF* g, const VF* b, const VF* weight,
+    VF& r0, VF& g0, VF& b0,
+    VF& r1, VF& g1, VF& b1) noexcept
+{
+    VF aa = SetF(0.f), bb = SetF(0.f), ab = SetF(0.f);
+    VF axr = SetF(0.f), axg = SetF(0.f), axb = SetF(0.f);
+    VF bxr = SetF(0.f), bxg = SetF(0.f), bxb = SetF(0.f);
+    for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        const VF alpha = weight[p];
+        const VF beta = Sub(SetF(1.f), alpha);
+        aa = Add(aa, Mul(alpha, alpha));
+        bb = Add(bb, Mul(beta, beta));
+        ab = Add(ab, Mul(alpha, beta));
+        axr = Add(axr, Mul(alpha, r[p]));
+        axg = Add(axg, Mul(alpha, g[p]));
+        axb = Add(axb, Mul(alpha, b[p]));
+        bxr = Add(bxr, Mul(beta, r[p]));
+        bxg = Add(bxg, Mul(beta, g[p]));
+        bxb = Add(bxb, Mul(beta, b[p]));
+    }
+
+    // All pixels on one palette entry leave the system singular; keep the old endpoints then
+    const VF det = Sub(Mul(aa, bb), Mul(ab, ab));
+    const MF valid = CmpGt(det, SetF(1.f / 64.f));
+    const VF inv = Div(SetF(1.f), Max(det, SetF(1.f / 64.f)));
+
+    const VF lo = SetF(0.f);
+    const VF hi = SetF(255.f);
+    r0 = SelectF(valid, Min(Max(Mul(Sub(Mul(axr, bb), Mul(bxr, ab)), inv), lo), hi), r0);
+    g0 = SelectF(valid, Min(Max(Mul(Sub(Mul(axg, bb), Mul(bxg, ab)), inv), lo), hi), g0);
+    b0 = SelectF(valid, Min(Max(Mul(Sub(Mul(axb, bb), Mul(bxb, ab)), inv), lo), hi), b0);
+    r1 = SelectF(valid, Min(Max(Mul(Sub(Mul(bxr, aa), Mul(axr, ab)), inv), lo), hi), r1);
+    g1 = SelectF(valid, Min(Max(Mul(Sub(Mul(bxg, aa), Mul(axg, ab)), inv), lo), hi), g1);
+    b1 = SelectF(valid, Min(Max(Mul(Sub(Mul(bxb, aa), Mul(axb, ab)), inv), lo), hi), b1);
+}
+
+//-------------------------------------------------------------------------------------
+// Encodes the color (always four-color mode) and alpha range of LANES blocks
+inline void EncodeGroup(const BlockGroup& group, bool alpha, EncodedGroup& out) noexcept
+{
+    VF r[NUM_PIXELS_PER_BLOCK];
+    VF g[NUM_PIXELS_PER_BLOCK];
+    VF b[NUM_PIXELS_PER_BLOCK];
+    VF weight[NUM_PIXELS_PER_BLOCK];
+
+    const VI byteMask = SetI(0xFF);
+    VF sumR = SetF(0.f), sumG = SetF(0.f), sumB = SetF(0.f);
+    VF minA = SetF(255.f), maxA = SetF(0.f);
+    for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        const VI v = LoadI(group.pixels[p]);
+        r[p] = ToFloat(AndI(v, byteMask));
+        g[p] = ToFloat(AndI(ShrI(v, 8), byteMask));
+        b[p] = ToFloat(AndI(ShrI(v, 16), byteMask));
+        const VF a = ToFloat(ShrI(v, 24));
+        minA = Min(minA, a);
+        maxA = Max(maxA, a);
+        sumR = Add(sumR, r[p]);
+        sumG = Add(sumG, g[p]);
+        sumB = Add(sumB, b[p]);
+    }
+
+    // Principal axis of the colors: covariance, started from its largest row, then three power iterations
+    const VF meanR = Mul(sumR, SetF(1.f / 16.f));
+    const VF meanG = Mul(sumG, SetF(1.f / 16.f));
+    const VF meanB = Mul(sumB, SetF(1.f / 16.f));
+    VF crr = SetF(0.f), crg = SetF(0.f), crb = SetF(0.f), cgg = SetF(0.f), cgb = SetF(0.f), cbb = SetF(0.f);
+    for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        const VF dr = Sub(r[p], meanR);
+        const VF dg = Sub(g[p], meanG);
+        const VF db = Sub(b[p], meanB);
+        crr = Add(crr, Mul(dr, dr));
+        crg = Add(crg, Mul(dr, dg));
+        crb = Add(crb, Mul(dr, db));
+        cgg = Add(cgg, Mul(dg, dg));
+        cgb = Add(cgb, Mul(dg, db));
+        cbb = Add(cbb, Mul(db, db));
+    }
+    crr = Mul(crr, SetF(1.f / 16.f));
+    crg = Mul(crg, SetF(1.f / 16.f));
+    crb = Mul(crb, SetF(1.f / 16.f));
+    cgg = Mul(cgg, SetF(1.f / 16.f));
+    cgb = Mul(cgb, SetF(1.f / 16.f));
+    cbb = Mul(cbb, SetF(1.f / 16.f));
+
+    const MF useG = CmpGt(cgg, crr);
+    VF axisR = SelectF(useG, crg, crr);
+    VF axisG = SelectF(useG, cgg, crg);
+    VF axisB = SelectF(useG, cgb, crb);
+    const MF useB = CmpGt(cbb, Max(crr, cgg));
+    axisR = SelectF(useB, crb, axisR);
+    axisG = SelectF(useB, cgb, axisG);
+    axisB = SelectF(useB, cbb, axisB);
+    for (int iteration = 0; iteration < 3; ++iteration)
+    {
+        const VF nr = Add(Add(Mul(crr, axisR), Mul(crg, axisG)), Mul(crb, axisB));
+        const VF ng = Add(Add(Mul(crg, axisR), Mul(cgg, axisG)), Mul(cgb, axisB));
+        const VF nb = Add(Add(Mul(crb, axisR), Mul(cgb, axisG)), Mul(cbb, axisB));
+
+        // Rescale so the iteration cannot overflow
+        const VF scale = Div(SetF(1.f), Max(Max(Max(Abs(nr), Abs(ng)), Abs(nb)), SetF(1e-20f)));
+        axisR = Mul(nr, scale);
+        axisG = Mul(ng, scale);
+        axisB = Mul(nb, scale);
+    }
+
+    // Initial endpoints are the pixels furthest along the axis in each direction
+    VF r0 = r[0], g0 = g[0], b0 = b[0];
+    VF r1 = r[0], g1 = g[0], b1 = b[0];
+    VF maxDot = Add(Add(Mul(r[0], axisR), Mul(g[0], axisG)), Mul(b[0], axisB));
+    VF minDot = maxDot;
+    for (size_t p = 1; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        const VF dot = Add(Add(Mul(r[p], axisR), Mul(g[p], axisG)), Mul(b[p], axisB));
+        const MF isMax = CmpGt(dot, maxDot);
+        const MF isMin = CmpLt(dot, minDot);
+        maxDot = SelectF(isMax, dot, maxDot);
+        minDot = SelectF(isMin, dot, minDot);
+        r0 = SelectF(isMax, r[p], r0);
+        g0 = SelectF(isMax, g[p], g0);
+        b0 = SelectF(isMax, b[p], b0);
+        r1 = SelectF(isMin, r[p], r1);
+        g1 = SelectF(isMin, g[p], g1);
+        b1 = SelectF(isMin, b[p], b1);
+    }
+
+    // One refinement pass: fit the endpoints to the first assignment, then assign again
+    {
+        VF qr0 = r0, qg0 = g0, qb0 = b0;
+        VF qr1 = r1, qg1 = g1, qb1 = b1;
+        Quantize565(qr0, qg0, qb0);
+        Quantize565(qr1, qg1, qb1);
+        AssignIndices(r, g, b, qr0, qg0, qb0, qr1, qg1, qb1, weight);
+        RefineEndpoints(r, g, b, weight, r0, g0, b0, r1, g1, b1);
+    }
+    VI color0 = Quantize565(r0, g0, b0);
+    VI color1 = Quantize565(r1, g1, b1);
+    VI bitmap = AssignIndices(r, g, b, r0, g0, b0, r1, g1, b1, weight);
+
+    // Four-color mode needs color0 > color1; swapping the endpoints swaps palette entries 0/1 and 2/3
+    const MI swap = CmpGtI(color1, color0);
+    const VI swapped0 = SelectI(swap, color1, color0);
+    color1 = SelectI(swap, color0, color1);
+    color0 = swapped0;
+    bitmap = SelectI(swap, XorI(bitmap, SetI(0x55555555)), bitmap);
+    bitmap = SelectI(CmpEqI(color0, color1), SetI(0), bitmap);
+
+    StoreI(out.color0, color0);
+    StoreI(out.color1, color1);
+    StoreI(out.bitmap, bitmap);
+    StoreI(out.alphaMin, ToInt(minA));
+    StoreI(out.alphaMax, ToInt(maxA));
+
+    if (!alpha)
+        return;
+
+    // BC3 alpha: eight-value mode between the block's min and max
+    const VF range = Sub(maxA, minA);
+    const VF alphaScale = SelectF(CmpGt(range, SetF(0.f)), Div(SetF(7.f), Max(range, SetF(1.f))), SetF(0.f));
+    VI alphaBits[2] = { SetI(0), SetI(0) };
+    for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+    {
+        const VF a = ToFloat(ShrI(LoadI(group.pixels[p]), 24));
+        const VI k = ToInt(Add(Mul(Sub(a, minA), alphaScale), SetF(0.5f)));
+
+        // k is the share of alpha0 in sevenths; the palette is alpha0, alpha1, then 6/7 down to 1/7
+        VI index = SubI(SetI(8), k);
+        index = SelectI(CmpEqI(k, SetI(7)), SetI(0), index);
+        index = SelectI(CmpEqI(k, SetI(0)), SetI(1), index);
+        alphaBits[p / 8] = OrI(alphaBits[p / 8], ShlI(index, int((p % 8) * 3)));
+    }
+    StoreI(out.alphaBitmap[0], alphaBits[0]);
+    StoreI(out.alphaBitmap[1], alphaBits[1]);
+}
+
+//-------------------------------------------------------------------------------------
+// Copies up to LANES blocks of one block row into a group, replicating edge pixels of
+// partial blocks the same way CompressBC does
+inline void GatherGroup(
+    const uint8_t* pSource, size_t rowPitch, size_t width, size_t height,
+    size_t firstBlock, size_t blockCount, BlockGroup& group) noexcept
+{
+    static const size_t uSrc[] = { 0, 0, 0, 1 };
+    for (size_t lane = 0; lane < LANES; ++lane)
+    {
+        // Unused lanes repeat the last block
+        const size_t x0 = (firstBlock + std::min(lane, blockCount - 1)) * 4;
+        const size_t pw = std::min<size_t>(4, width - x0);
+        for (size_t y = 0; y < 4; ++y)
+        {
+            size_t sy = y;
+            while (sy >= height)
+                sy = uSrc[sy];
+            const uint8_t* row = pSource + sy * rowPitch + x0 * 4;
+            for (size_t x = 0; x < 4; ++x)
+            {
+                size_t sx = x;
+                while (sx >= pw)
+                    sx = uSrc[sx];
+                memcpy(&group.pixels[y * 4 + x][lane], row + sx * 4, sizeof(uint32_t));
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// Encodes one row of blocks. BC1 blocks with any alpha below the threshold need the
+// transparent three-color mode and go to the reference encoder instead.
+inline void EncodeRow(
+    uint8_t* pBC, const uint8_t* pSource, size_t rowPitch, size_t width, size_t height,
+    bool alpha, float threshold, uint32_t flags) noexcept
+{
+    const size_t blockSize = alpha ? 16 : 8;
+    const size_t blocks = (width + 3) / 4;
+    const float alphaThreshold = alpha ? 0.f : threshold * 255.f;
+
+    BlockGroup group;
+    EncodedGroup encoded;
+    for (size_t first = 0; first < blocks; first += LANES)
+    {
+        const size_t count = std::min<size_t>(LANES, blocks - first);
+        GatherGroup(pSource, rowPitch, width, height, first, count, group);
+        EncodeGroup(group, alpha, encoded);
+
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            uint8_t* pBlock = pBC + (first + lane) * blockSize;
+            if (alpha)
+            {
+                pBlock[0] = uint8_t(encoded.alphaMax[lane]);
+                pBlock[1] = uint8_t(encoded.alphaMin[lane]);
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    pBlock[2 + i] = uint8_t(encoded.alphaBitmap[0][lane] >> (i * 8));
+                    pBlock[5 + i] = uint8_t(encoded.alphaBitmap[1][lane] >> (i * 8));
+                }
+                pBlock += 8;
+            }
+            else if (float(encoded.alphaMin[lane]) < alphaThreshold)
+            {
+                XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+                for (size_t p = 0; p < NUM_PIXELS_PER_BLOCK; ++p)
+                {
+                    const uint32_t v = group.pixels[p][lane];
+                    temp[p] = XMVectorSet(float(v & 0xFF) / 255.f, float((v >> 8) & 0xFF) / 255.f,
+                        float((v >> 16) & 0xFF) / 255.f, float(v >> 24) / 255.f);
+                }
+                D3DXEncodeBC1(pBlock, temp, threshold, flags);
+                continue;
+            }
+
+            const uint16_t colors[2] = { uint16_t(encoded.color0[lane]), uint16_t(encoded.color1[lane]) };
+            memcpy(pBlock, colors, sizeof(colors));
+            memcpy(pBlock + 4, &encoded.bitmap[lane], sizeof(uint32_t));
+        }
+    }
+}
@@ -701,9 +701,26 @@ namespace DirectX
         TEX_COMPRESS_BC7_USE_3SUBSETS = 0x80000,
         // Enables exhaustive search for BC7 compress for mode 0 and 2; by default skips trying these modes
 
-        TEX_COMPRESS_BC7_QUICK = 0x100000,
+        TEX_COMPRESS_BC7_QUALITY_NORMAL = 0,
+        // BC7 classifies each block (solid, gradient, alpha, high variance) and refines a few candidate modes
+        // and partitions ranked by estimated error, stopping once the error is low enough
+
+        TEX_COMPRESS_BC7_QUALITY_FAST = 0x100000,
         // Minimal modes (usually mode 6) for BC7 compression
 
+        TEX_COMPRESS_BC7_QUICK = TEX_COMPRESS_BC7_QUALITY_FAST,
+        // Older name for TEX_COMPRESS_BC7_QUALITY_FAST
+
+        TEX_COMPRESS_BC7_QUALITY_SLOW = 0x400000,
+        // Exhaustive search of BC7 modes, rotations and index modes (slowest, highest quality)
+
+        TEX_COMPRESS_BC7_QUALITY_MASK = 0x500000,
+        // FAST and SLOW are mutually exclusive; Compress returns E_INVALIDARG if both are set
+
+        TEX_COMPRESS_BC_FAST = 0x200000,
+        // Faster, lower quality SIMD encoder for BC1 and BC3 from R8G8B8A8 sources (ignores dithering and perceptual weighting)
+        // Other source formats and conversions that need sRGB handling use the default encoder
+
         TEX_COMPRESS_SRGB_IN = 0x1000000,
         TEX_COMPRESS_SRGB_OUT = 0x2000000,
         TEX_COMPRESS_SRGB = (TEX_COMPRESS_SRGB_IN | TEX_COMPRESS_SRGB_OUT),
@@ -722,6 +739,9 @@ namespace DirectX
         _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages) noexcept;
         // Note that threshold is only used by BC1. TEX_THRESHOLD_DEFAULT is a typical value to use
 
+    void __cdecl SetParallelThreadLimit(_In_ size_t threads) noexcept;
+        // Maximum threads used by TEX_COMPRESS_PARALLEL and TEX_DECOMPRESS_PARALLEL, including the calling thread (0 uses all hardware threads)
+
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     HRESULT __cdecl Compress(
         _In_ ID3D11Device* pDevice, _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress,
@@ -732,10 +752,22 @@ namespace DirectX
         // DirectCompute-based compression (alphaWeight is only used by BC7. 1.0 is the typical value to use)
 #endif
 
-    HRESULT __cdecl Decompress(_In_ const Image& cImage, _In_ DXGI_FORMAT format, _Out_ ScratchImage& image) noexcept;
+    enum TEX_DECOMPRESS_FLAGS : unsigned long
+    {
+        TEX_DECOMPRESS_DEFAULT = 0,
+
+        TEX_DECOMPRESS_PARALLEL = 0x10000000,
+        // Decompress is free to use multithreading to improve performance (by default it does not use multithreading)
+    };
+
+    HRESULT __cdecl Decompress(
+        _In_ const Image& cImage, _In_ DXGI_FORMAT format, _Out_ ScratchImage& image,
+        _In_ TEX_DECOMPRESS_FLAGS flags = TEX_DECOMPRESS_DEFAULT) noexcept;
     HRESULT __cdecl Decompress(
         _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
-        _In_ DXGI_FORMAT format, _Out_ ScratchImage& images) noexcept;
+        _In_ DXGI_FORMAT format, _Out_ ScratchImage& images, _In_ TEX_DECOMPRESS_FLAGS flags = TEX_DECOMPRESS_DEFAULT) noexcept;
+        // BC1-BC5 and BC7 to R8G8B8A8 decode without floats. Other DirectXTex functions call Decompress
+        // internally without TEX_DECOMPRESS_PARALLEL, so they never start threads of their own
 
     //---------------------------------------------------------------------------------
     // Normal map operations
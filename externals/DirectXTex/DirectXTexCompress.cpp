@@ -11,12 +11,8 @@
 
 #include "DirectXTexP.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#pragma warning(disable : 4616 6993)
-#endif
-
 #include "BC.h"
+#include "parallel.h"
 
 using namespace DirectX;
 using namespace DirectX::Internal;
@@ -30,8 +26,11 @@ namespace
         static_assert(static_cast<int>(TEX_COMPRESS_DITHER) == static_cast<int>(BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_UNIFORM) == static_cast<int>(BC_FLAGS_UNIFORM), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_USE_3SUBSETS) == static_cast<int>(BC_FLAGS_USE_3SUBSETS), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC7_MODE6), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6));
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUALITY_FAST) == static_cast<int>(BC_FLAGS_BC7_QUALITY_FAST), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUALITY_SLOW) == static_cast<int>(BC_FLAGS_BC7_QUALITY_SLOW), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUALITY_MASK) == static_cast<int>(BC_FLAGS_BC7_QUALITY_MASK), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC_FAST) == static_cast<int>(BC_FLAGS_FAST), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_BC7_QUALITY_MASK | BC_FLAGS_FAST));
     }
 
     constexpr TEX_FILTER_FLAGS GetSRGBFlags(_In_ TEX_COMPRESS_FLAGS compress) noexcept
@@ -67,14 +66,40 @@ namespace
         return true;
     }
 
+    // The fast encoders read 8-bit RGBA directly, so they only apply when ConvertScanline would not change the pixels
+    inline bool UseFastEncoder(_In_ DXGI_FORMAT srcFormat, _In_ DXGI_FORMAT destFormat, _In_ TEX_FILTER_FLAGS srgb) noexcept
+    {
+        switch (destFormat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            break;
+
+        default:
+            return false;
+        }
+
+        if (srcFormat != DXGI_FORMAT_R8G8B8A8_UNORM && srcFormat != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+            return false;
+
+        const bool srgbIn = IsSRGB(srcFormat) || (srgb & TEX_FILTER_SRGB_IN);
+        const bool srgbOut = IsSRGB(destFormat) || (srgb & TEX_FILTER_SRGB_OUT);
+        return srgbIn == srgbOut;
+    }
+
 
     //-------------------------------------------------------------------------------------
+    // Compresses the rows of 4x4 blocks in [blockRowBegin, blockRowEnd)
     HRESULT CompressBC(
         const Image& image,
         const Image& result,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
-        float threshold) noexcept
+        float threshold,
+        size_t blockRowBegin,
+        size_t blockRowEnd) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -96,7 +121,7 @@ namespace
         // Round to bytes
         sbpp = (sbpp + 7) / 8;
 
-        uint8_t *pDest = result.pixels;
+        uint8_t *pDest = result.pixels + result.rowPitch * blockRowBegin;
 
         // Determine BC format encoder
         BC_ENCODE pfEncode;
@@ -106,10 +131,29 @@ namespace
             return HRESULT_E_NOT_SUPPORTED;
 
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = image.pixels;
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
         const size_t rowPitch = image.rowPitch;
-        for (size_t h = 0; h < image.height; h += 4)
+        const uint8_t *pSrc = image.pixels + rowPitch * 4 * blockRowBegin;
+        const uint8_t *pEnd = image.pixels + image.slicePitch;
+        const size_t hEnd = std::min<size_t>(image.height, blockRowEnd * 4);
+
+        if ((bcflags & BC_FLAGS_FAST) && UseFastEncoder(format, result.format, srgb))
+        {
+            const bool isBC1 = (blocksize == 8);
+            for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
+            {
+                const size_t ph = std::min<size_t>(4, image.height - h);
+                if (isBC1)
+                    D3DXEncodeBC1FastRow(pDest, pSrc, rowPitch, image.width, ph, threshold, bcflags);
+                else
+                    D3DXEncodeBC3FastRow(pDest, pSrc, rowPitch, image.width, ph, bcflags);
+
+                pSrc += rowPitch * 4;
+                pDest += result.rowPitch;
+            }
+
+            return S_OK;
+        }
+        for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
         {
             const uint8_t *sptr = pSrc;
             uint8_t* dptr = pDest;
@@ -196,138 +240,67 @@ namespace
     }
 
 
-    //-------------------------------------------------------------------------------------
-#ifdef _OPENMP
-    HRESULT CompressBC_Parallel(
+    HRESULT CompressBC(
         const Image& image,
         const Image& result,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
         float threshold) noexcept
     {
-        if (!image.pixels || !result.pixels)
-            return E_POINTER;
-
-        assert(image.width == result.width);
-        assert(image.height == result.height);
-
-        const DXGI_FORMAT format = image.format;
-        size_t sbpp = BitsPerPixel(format);
-        if (!sbpp)
-            return E_FAIL;
-
-        if (sbpp < 8)
-        {
-            // We don't support compressing from monochrome (DXGI_FORMAT_R1_UNORM)
-            return HRESULT_E_NOT_SUPPORTED;
-        }
-
-        // Round to bytes
-        sbpp = (sbpp + 7) / 8;
+        return CompressBC(image, result, bcflags, srgb, threshold, 0, (image.height + 3) / 4);
+    }
 
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
 
-        // Determine BC format encoder
-        BC_ENCODE pfEncode;
-        size_t blocksize;
-        TEX_FILTER_FLAGS cflags;
-        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
-            return HRESULT_E_NOT_SUPPORTED;
+    //-------------------------------------------------------------------------------------
+    // Work is handed out in tiles of whole block rows, so neighbouring blocks share the
+    // source cache lines, with about this many blocks per tile to amortize scheduling.
+    constexpr size_t TILE_BLOCKS = 256;
 
-        // Refactored version of loop to support parallel independance
-        const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+    inline size_t GetTileBlockRows(const Image& image) noexcept
+    {
+        const size_t blockColumns = std::max<size_t>(1, (image.width + 3) / 4);
+        return std::max<size_t>(1, TILE_BLOCKS / blockColumns);
+    }
 
-        bool fail = false;
+    // Compresses several images at once. The tiles of every image (mip levels and array
+    // slices) go into one work list so small mips run alongside the large ones.
+    HRESULT CompressBC_Parallel(
+        const Image* images,
+        const Image* results,
+        size_t nimages,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold) noexcept
+    {
+        std::unique_ptr<size_t[]> firstTile(new (std::nothrow) size_t[nimages + 1]);
+        if (!firstTile)
+            return E_OUTOFMEMORY;
 
-    #pragma omp parallel for
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+        firstTile[0] = 0;
+        for (size_t index = 0; index < nimages; ++index)
         {
-            const int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
-
-            int y = nb / nbWidth;
-            const int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
-
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
-
-            const size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
-
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
-
-            const size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            const size_t pw = std::min<size_t>(4, image.width - size_t(x));
-            assert(pw > 0 && ph > 0);
-
-            const ptrdiff_t bytesLeft = pEnd - pSrc;
-            assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
-
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
-
-            if (ph > 1)
-            {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
-                    fail = true;
-
-                if (ph > 2)
-                {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
-                        fail = true;
-
-                    if (ph > 3)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
-                            fail = true;
-                    }
-                }
-            }
+            const size_t blockRows = (images[index].height + 3) / 4;
+            const size_t tileRows = GetTileBlockRows(images[index]);
+            firstTile[index + 1] = firstTile[index] + (blockRows + tileRows - 1) / tileRows;
+        }
 
-            if (pw != 4 || ph != 4)
+        std::atomic<HRESULT> status(S_OK);
+        auto compressTile = [&](size_t tile) noexcept
+        {
+            const size_t index = size_t(std::upper_bound(firstTile.get(), firstTile.get() + nimages + 1, tile) - firstTile.get()) - 1;
+            const size_t tileRows = GetTileBlockRows(images[index]);
+            const size_t blockRowBegin = (tile - firstTile[index]) * tileRows;
+            const HRESULT hr = CompressBC(images[index], results[index], bcflags, srgb, threshold, blockRowBegin, blockRowBegin + tileRows);
+            if (FAILED(hr))
             {
-                // Replicate pixels for partial block
-                static const size_t uSrc[] = { 0, 0, 0, 1 };
-
-                if (pw < 4)
-                {
-                    for (size_t t = 0; t < ph && t < 4; ++t)
-                    {
-                        for (size_t s = pw; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                        }
-                    }
-                }
-
-                if (ph < 4)
-                {
-                    for (size_t t = ph; t < 4; ++t)
-                    {
-                        for (size_t s = 0; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                        }
-                    }
-                }
+                HRESULT expected = S_OK;
+                status.compare_exchange_strong(expected, hr);
             }
+        };
+        ParallelFor(firstTile[nimages], compressTile);
 
-            ConvertScanline(temp, 16, result.format, format, cflags | srgb);
-
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
-        }
-
-        return (fail) ? E_FAIL : S_OK;
+        return status.load();
     }
-#endif // _OPENMP
 
 
     //-------------------------------------------------------------------------------------
@@ -378,8 +351,39 @@ namespace
     }
 
 
+    // The integer decoders write R8G8B8A8 directly, so they only apply when ConvertScanline would not change the pixels
+    inline BC_DECODE_ROW GetFastDecoder(_In_ DXGI_FORMAT cformat, _In_ DXGI_FORMAT format) noexcept
+    {
+        if (format != DXGI_FORMAT_R8G8B8A8_UNORM && format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+            return nullptr;
+
+        if (IsSRGB(cformat) != IsSRGB(format))
+            return nullptr;
+
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    return D3DXDecodeBC1FastRow;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    return D3DXDecodeBC2FastRow;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    return D3DXDecodeBC3FastRow;
+        case DXGI_FORMAT_BC4_UNORM:         return D3DXDecodeBC4UFastRow;
+        case DXGI_FORMAT_BC5_UNORM:         return D3DXDecodeBC5UFastRow;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    return D3DXDecodeBC7FastRow;
+        default:                            return nullptr;
+        }
+    }
+
+
     //-------------------------------------------------------------------------------------
-    HRESULT DecompressBC(_In_ const Image& cImage, _In_ const Image& result) noexcept
+    // Decompresses the rows of 4x4 blocks in [blockRowBegin, blockRowEnd)
+    HRESULT DecompressBC(
+        _In_ const Image& cImage,
+        _In_ const Image& result,
+        size_t blockRowBegin,
+        size_t blockRowEnd) noexcept
     {
         if (!cImage.pixels || !result.pixels)
             return E_POINTER;
@@ -442,10 +446,30 @@ namespace
             return HRESULT_E_NOT_SUPPORTED;
         }
 
-        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = cImage.pixels;
+        const uint8_t *pSrc = cImage.pixels + cImage.rowPitch * blockRowBegin;
         const size_t rowPitch = result.rowPitch;
-        for (size_t h = 0; h < cImage.height; h += 4)
+        pDest += rowPitch * 4 * blockRowBegin;
+        const size_t hEnd = std::min<size_t>(cImage.height, blockRowEnd * 4);
+
+        const BC_DECODE_ROW pfDecodeRow = GetFastDecoder(cformat, format);
+        if (pfDecodeRow)
+        {
+            if (cImage.rowPitch < ((cImage.width + 3) / 4) * sbpp)
+                return E_FAIL;
+
+            for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
+            {
+                pfDecodeRow(pDest, rowPitch, pSrc, cImage.width, std::min<size_t>(4, cImage.height - h));
+
+                pSrc += cImage.rowPitch;
+                pDest += rowPitch * 4;
+            }
+
+            return S_OK;
+        }
+
+        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+        for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
         {
             const uint8_t *sptr = pSrc;
             uint8_t* dptr = pDest;
@@ -490,6 +514,58 @@ namespace
 
         return S_OK;
     }
+
+    // Decompresses each image in turn on the calling thread
+    HRESULT DecompressBC_Serial(
+        _In_reads_(nimages) const Image* cImages,
+        _In_reads_(nimages) const Image* results,
+        size_t nimages) noexcept
+    {
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const HRESULT hr = DecompressBC(cImages[index], results[index], 0, (cImages[index].height + 3) / 4);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    // Decompresses several images at once, sharing one work list of block row tiles like CompressBC_Parallel
+    HRESULT DecompressBC_Parallel(
+        _In_reads_(nimages) const Image* cImages,
+        _In_reads_(nimages) const Image* results,
+        size_t nimages) noexcept
+    {
+        std::unique_ptr<size_t[]> firstTile(new (std::nothrow) size_t[nimages + 1]);
+        if (!firstTile)
+            return E_OUTOFMEMORY;
+
+        firstTile[0] = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const size_t blockRows = (cImages[index].height + 3) / 4;
+            const size_t tileRows = GetTileBlockRows(cImages[index]);
+            firstTile[index + 1] = firstTile[index] + (blockRows + tileRows - 1) / tileRows;
+        }
+
+        std::atomic<HRESULT> status(S_OK);
+        auto decompressTile = [&](size_t tile) noexcept
+        {
+            const size_t index = size_t(std::upper_bound(firstTile.get(), firstTile.get() + nimages + 1, tile) - firstTile.get()) - 1;
+            const size_t tileRows = GetTileBlockRows(cImages[index]);
+            const size_t blockRowBegin = (tile - firstTile[index]) * tileRows;
+            const HRESULT hr = DecompressBC(cImages[index], results[index], blockRowBegin, blockRowBegin + tileRows);
+            if (FAILED(hr))
+            {
+                HRESULT expected = S_OK;
+                status.compare_exchange_strong(expected, hr);
+            }
+        };
+        ParallelFor(firstTile[nimages], decompressTile);
+
+        return status.load();
+    }
 }
 
 //-------------------------------------------------------------------------------------
@@ -596,6 +672,9 @@ HRESULT DirectX::Compress(
     if (IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
 
+    if ((compress & TEX_COMPRESS_BC7_QUALITY_MASK) == TEX_COMPRESS_BC7_QUALITY_MASK)
+        return E_INVALIDARG;
+
     if (IsTypeless(format)
         || IsTypeless(srcImage.format) || IsPlanar(srcImage.format) || IsPalettized(srcImage.format))
         return HRESULT_E_NOT_SUPPORTED;
@@ -615,11 +694,7 @@ HRESULT DirectX::Compress(
     // Compress single image
     if (compress & TEX_COMPRESS_PARALLEL)
     {
-    #ifndef _OPENMP
-        return E_NOTIMPL;
-    #else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-    #endif // _OPENMP
+        hr = CompressBC_Parallel(&srcImage, img, 1, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
     }
     else
     {
@@ -648,6 +723,9 @@ HRESULT DirectX::Compress(
     if (IsCompressed(metadata.format) || !IsCompressed(format))
         return E_INVALIDARG;
 
+    if ((compress & TEX_COMPRESS_BC7_QUALITY_MASK) == TEX_COMPRESS_BC7_QUALITY_MASK)
+        return E_INVALIDARG;
+
     if (IsTypeless(format)
         || IsTypeless(metadata.format) || IsPlanar(metadata.format) || IsPalettized(metadata.format))
         return HRESULT_E_NOT_SUPPORTED;
@@ -684,26 +762,22 @@ HRESULT DirectX::Compress(
             cImages.Release();
             return E_FAIL;
         }
+    }
 
-        if ((compress & TEX_COMPRESS_PARALLEL))
+    if (compress & TEX_COMPRESS_PARALLEL)
+    {
+        hr = CompressBC_Parallel(srcImages, dest, nimages, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+        if (FAILED(hr))
         {
-        #ifndef _OPENMP
-            return E_NOTIMPL;
-        #else
-            if (compress & TEX_COMPRESS_PARALLEL)
-            {
-                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-                if (FAILED(hr))
-                {
-                    cImages.Release();
-                    return  hr;
-                }
-            }
-        #endif // _OPENMP
+            cImages.Release();
+            return hr;
         }
-        else
+    }
+    else
+    {
+        for (size_t index = 0; index < nimages; ++index)
         {
-            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
+            hr = CompressBC(srcImages[index], dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
             if (FAILED(hr))
             {
                 cImages.Release();
@@ -716,6 +790,16 @@ HRESULT DirectX::Compress(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Thread limit for TEX_COMPRESS_PARALLEL and TEX_DECOMPRESS_PARALLEL
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::SetParallelThreadLimit(size_t threads) noexcept
+{
+    ParallelPool::Get().SetThreadLimit(threads);
+}
+
+
 //-------------------------------------------------------------------------------------
 // Decompression
 //-------------------------------------------------------------------------------------
@@ -723,7 +807,8 @@ _Use_decl_annotations_
 HRESULT DirectX::Decompress(
     const Image& cImage,
     DXGI_FORMAT format,
-    ScratchImage& image) noexcept
+    ScratchImage& image,
+    TEX_DECOMPRESS_FLAGS flags) noexcept
 {
     if (!IsCompressed(cImage.format) || IsCompressed(format))
         return E_INVALIDARG;
@@ -760,7 +845,10 @@ HRESULT DirectX::Decompress(
     }
 
     // Decompress single image
-    hr = DecompressBC(cImage, *img);
+    if (flags & TEX_DECOMPRESS_PARALLEL)
+        hr = DecompressBC_Parallel(&cImage, img, 1);
+    else
+        hr = DecompressBC_Serial(&cImage, img, 1);
     if (FAILED(hr))
         image.Release();
 
@@ -773,7 +861,8 @@ HRESULT DirectX::Decompress(
     size_t nimages,
     const TexMetadata& metadata,
     DXGI_FORMAT format,
-    ScratchImage& images) noexcept
+    ScratchImage& images,
+    TEX_DECOMPRESS_FLAGS flags) noexcept
 {
     if (!cImages || !nimages)
         return E_INVALIDARG;
@@ -837,13 +926,17 @@ HRESULT DirectX::Decompress(
             images.Release();
             return E_FAIL;
         }
+    }
 
-        hr = DecompressBC(src, dest[index]);
-        if (FAILED(hr))
-        {
-            images.Release();
-            return hr;
-        }
+    // With TEX_DECOMPRESS_PARALLEL, mips and array slices are decoded together on the thread pool
+    if (flags & TEX_DECOMPRESS_PARALLEL)
+        hr = DecompressBC_Parallel(cImages, dest, nimages);
+    else
+        hr = DecompressBC_Serial(cImages, dest, nimages);
+    if (FAILED(hr))
+    {
+        images.Release();
+        return hr;
     }
 
     return S_OK;
@@ -0,0 +1,257 @@
+//-------------------------------------------------------------------------------------
+// parallel.h
+//
+// Utility header with a work-stealing thread pool for the CPU texture codecs
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace DirectX
+{
+    namespace Internal
+    {
+        //---------------------------------------------------------------------------------
+        // Persistent pool used by the TEX_COMPRESS_PARALLEL paths (no OpenMP required)
+        //
+        // For() splits [0, count) into one contiguous range per participating thread.
+        // Each thread takes items from the front of its own range, and once that is empty
+        // steals the back half of another thread's range. Items should be coarse (a tile
+        // of block rows, not a single block) so the per-item atomic is negligible.
+        class ParallelPool
+        {
+        public:
+            using Function = void(*)(void* context, size_t index) noexcept;
+
+            static ParallelPool& Get() noexcept
+            {
+                static ParallelPool s_pool;
+                return s_pool;
+            }
+
+            ParallelPool(const ParallelPool&) = delete;
+            ParallelPool& operator=(const ParallelPool&) = delete;
+
+            ~ParallelPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wake.notify_all();
+                for (size_t i = 0; i < m_workerCount; ++i)
+                {
+                    m_workers[i].join();
+                }
+            }
+
+            // Maximum number of threads (including the caller) used by For; 0 means all hardware threads
+            void SetThreadLimit(size_t limit) noexcept { m_threadLimit.store(limit, std::memory_order_relaxed); }
+
+            size_t GetThreadCount() const noexcept
+            {
+                const size_t limit = m_threadLimit.load(std::memory_order_relaxed);
+                return (limit > 0) ? std::min(limit, m_workerCount + 1) : (m_workerCount + 1);
+            }
+
+            // Calls function(context, i) for every i in [0, count) and returns when all have completed.
+            // Runs serially if called from inside the pool or while another thread is using it.
+            void For(size_t count, Function function, void* context) noexcept
+            {
+                const size_t threads = std::min(GetThreadCount(), count);
+                if (threads <= 1 || count > UINT32_MAX || s_insidePool)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                        function(context, i);
+                    return;
+                }
+
+                std::unique_lock<std::mutex> jobLock(m_jobMutex, std::try_to_lock);
+                if (!jobLock.owns_lock())
+                {
+                    for (size_t i = 0; i < count; ++i)
+                        function(context, i);
+                    return;
+                }
+
+                for (size_t slot = 0; slot < threads; ++slot)
+                {
+                    m_ranges[slot].value.store(Pack(count * slot / threads, count * (slot + 1) / threads), std::memory_order_relaxed);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_function = function;
+                    m_context = context;
+                    m_jobThreads = threads;
+                    m_finished = 0;
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+
+                s_insidePool = true;
+                Run(0, threads);
+                s_insidePool = false;
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_done.wait(lock, [&]() { return m_finished == threads - 1; });
+            }
+
+        private:
+            struct alignas(64) Range
+            {
+                std::atomic<uint64_t> value;
+            };
+
+            static constexpr uint64_t Pack(size_t begin, size_t end) noexcept { return (uint64_t(end) << 32) | uint64_t(begin); }
+            static constexpr size_t Begin(uint64_t value) noexcept { return size_t(value & UINT32_MAX); }
+            static constexpr size_t End(uint64_t value) noexcept { return size_t(value >> 32); }
+
+            static inline thread_local bool s_insidePool = false;
+
+            ParallelPool() noexcept :
+                m_workerCount(0),
+                m_threadLimit(0),
+                m_function(nullptr),
+                m_context(nullptr),
+                m_generation(0),
+                m_jobThreads(0),
+                m_finished(0),
+                m_stopping(false)
+            {
+                const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+                const size_t workerCount = (hardwareThreads > 1) ? (hardwareThreads - 1) : 0;
+
+                m_ranges.reset(new (std::nothrow) Range[workerCount + 1]);
+                m_workers.reset(new (std::nothrow) std::thread[workerCount]);
+                if (!m_ranges || !m_workers)
+                {
+                    m_ranges.reset(new (std::nothrow) Range[1]);
+                    return;
+                }
+
+                // If thread creation fails part way, run with the workers we have
+                try
+                {
+                    for (; m_workerCount < workerCount; ++m_workerCount)
+                    {
+                        m_workers[m_workerCount] = std::thread(&ParallelPool::WorkerMain, this, m_workerCount + 1);
+                    }
+                }
+                catch (...)
+                {
+                }
+            }
+
+            void WorkerMain(size_t slot) noexcept
+            {
+                s_insidePool = true;
+                uint64_t seenGeneration = 0;
+                for (;;)
+                {
+                    size_t threads;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wake.wait(lock, [&]() { return m_stopping || m_generation != seenGeneration; });
+                        if (m_stopping)
+                            return;
+                        seenGeneration = m_generation;
+                        threads = m_jobThreads;
+                    }
+
+                    if (slot >= threads)
+                        continue;
+
+                    Run(slot, threads);
+
+                    bool isLast;
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        isLast = (++m_finished == threads - 1);
+                    }
+                    if (isLast)
+                        m_done.notify_one();
+                }
+            }
+
+            void Run(size_t slot, size_t threads) noexcept
+            {
+                std::atomic<uint64_t>& own = m_ranges[slot].value;
+                for (;;)
+                {
+                    // Take the next item from the front of our own range
+                    uint64_t value = own.load(std::memory_order_relaxed);
+                    while (Begin(value) < End(value))
+                    {
+                        if (own.compare_exchange_weak(value, Pack(Begin(value) + 1, End(value)), std::memory_order_relaxed))
+                        {
+                            m_function(m_context, Begin(value));
+                            value = own.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    // Steal the back half of the first non-empty range, starting after our own slot
+                    bool stolen = false;
+                    for (size_t offset = 1; offset < threads && !stolen; ++offset)
+                    {
+                        std::atomic<uint64_t>& victim = m_ranges[(slot + offset) % threads].value;
+                        uint64_t victimValue = victim.load(std::memory_order_relaxed);
+                        while (Begin(victimValue) < End(victimValue))
+                        {
+                            const size_t begin = Begin(victimValue);
+                            const size_t end = End(victimValue);
+                            const size_t middle = begin + (end - begin) / 2;
+                            if (victim.compare_exchange_weak(victimValue, Pack(begin, middle), std::memory_order_relaxed))
+                            {
+                                // Nobody steals from an empty range, so a plain store is safe
+                                own.store(Pack(middle, end), std::memory_order_relaxed);
+                                stolen = true;
+                                break;
+                            }
+                        }
+                    }
+
+                    if (!stolen)
+                        return;
+                }
+            }
+
+            size_t                          m_workerCount;
+            std::unique_ptr<Range[]>        m_ranges;
+            std::unique_ptr<std::thread[]>  m_workers;
+            std::atomic<size_t>             m_threadLimit;
+
+            std::mutex                      m_jobMutex;
+            std::mutex                      m_mutex;
+            std::condition_variable         m_wake;
+            std::condition_variable         m_done;
+            Function                        m_function;
+            void*                           m_context;
+            uint64_t                        m_generation;
+            size_t                          m_jobThreads;
+            size_t                          m_finished;
+            bool                            m_stopping;
+        };
+
+        // Runs body(i) for i in [0, count) on the shared pool
+        template<typename Body>
+        void ParallelFor(size_t count, Body& body) noexcept
+        {
+            ParallelPool::Get().For(count,
+                [](void* context, size_t index) noexcept { (*static_cast<Body*>(context))(index); },
+                &body);
+        }
+    }
+}
@@ -13,6 +13,9 @@
 #include <filesystem>
 #include <fstream>
 #include <chrono>
+#include <cstring>
+#include <vector>
+#include <memory>
 #include "VertexData.h"
 #include "Vector4.h"
 #include "Matrix4x4.h"
@@ -20,6 +23,27 @@
 #include "Material.h"
 #include "TransformationMatrix.h"
 #include "DirectionalLight.h"
+#include "MatrixMath.h"
+#include "FrustumCulling.h"
+#include "BoundingVolumeHierarchy.h"
+#include "InstanceBatch.h"
+#include "SceneGraph.h"
+#include "MeshGenerator.h"
+#include "VertexCache.h"
+#include "VertexCompression.h"
+#include "ObjLoader.h"
+#include "ThreadPool.h"
+#include "MeshLod.h"
+#include "Meshlet.h"
+#include "FrameRing.h"
+#include "D3D12GpuTimeline.h"
+#include "D3D12UploadPageSource.h"
+#include "D3D12ResourceAllocator.h"
+#include "D3D12TextureUploader.h"
+#include "D3D12TextureStreamSink.h"
+#include "DescriptorAllocator.h"
+#include "TextureStreamer.h"
+#include "TextureDecoder.h"
 #include "externals/imgui/imgui.h"
 #include "externals/imgui/imgui_impl_dx12.h"
 #include "externals/imgui/imgui_impl_win32.h"
@@ -44,25 +68,13 @@ IDxcBlob* CompileShader(
 	IDxcCompiler3* dxcCompiler,
 	IDxcIncludeHandler* includeHandler);
 
-ID3D12Resource* CreateBufferResource(ID3D12Device* device, size_t sizeInBytes);
+ID3D12Resource* CreateBufferResource(D3D12ResourceAllocator& allocator, size_t sizeInBytes);
 ID3D12DescriptorHeap* CreateDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE heapType, UINT numDescriptors, bool shaderVisible);
-ID3D12Resource* CreateTextureResource(ID3D12Device* device, const DirectX::TexMetadata& metadata);
-ID3D12Resource* CreateDepthStencilTextureResource(ID3D12Device* device, int32_t width, int32_t height);
+ID3D12Resource* CreateTextureResource(D3D12ResourceAllocator& allocator, const DirectX::TexMetadata& metadata);
+ID3D12Resource* CreateDepthStencilTextureResource(D3D12ResourceAllocator& allocator, int32_t width, int32_t height);
 D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptorHandle(ID3D12DescriptorHeap* descriptorHeap, uint32_t descriptorSize, uint32_t index);
 D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandle(ID3D12DescriptorHeap* descriptorHeap, uint32_t descriptorSize, uint32_t index);
 
-Matrix4x4 MakeIdentityMatrix4x4();
-Matrix4x4 MakeScaleMatrix(Vector3 scale);
-Matrix4x4 MakeAffineMatrix(Vector3 scale, Vector3 theta, Vector3 translate);
-Matrix4x4 MakeRotateZMatrix(float rotateZ);
-Matrix4x4 MakeTranslateMatrix(Vector3 translate);
-Matrix4x4 Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2);
-Matrix4x4 MakePerspectiveFovMatirx(float fovY, float aspectRaito, float nearClip, float farClip);
-Matrix4x4 Inverse(Matrix4x4 matrix);
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip);
-float Determinant3x3(Matrix4x4 matrix, int row, int col);
-DirectX::ScratchImage LoadTexture(const std::string& filePath);
-void UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages);
 
 // ウィンドウプロシージャ
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
@@ -84,6 +96,8 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 
 // Windousアプリでのエントリーポイント(main関数)
 int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
+	// 最初のフレームまでの時間を測る
+	const std::chrono::steady_clock::time_point appStartTime = std::chrono::steady_clock::now();
 
 	//===============================================
 	// ログの初期化
@@ -277,11 +291,14 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	//===============================================
 	Log(logStream, "コマンドアロケータを生成");
 
-	// コマンドアロケータを生成する
-	ID3D12CommandAllocator* commandAllocator = nullptr;
-	hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator));
-	// コマンドアロケータの生成がうまくいかなかった場合
-	assert(SUCCEEDED(hr));
+	// コマンドアロケータを生成する(GPUが使っている間はリセットできないので、同時に送るフレームごとに1つ)
+	const uint32_t kMaxFramesInFlight = FrameRing::kMaxFrameCount;
+	ID3D12CommandAllocator* commandAllocators[kMaxFramesInFlight] = {};
+	for (uint32_t i = 0; i < kMaxFramesInFlight; ++i) {
+		hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocators[i]));
+		// コマンドアロケータの生成がうまくいかなかった場合
+		assert(SUCCEEDED(hr));
+	}
 
 	//===============================================
 	// コマンドリストの生成
@@ -290,9 +307,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	// コマンドリストを生成する
 	ID3D12GraphicsCommandList* commandList = nullptr;
-	hr = device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr, IID_PPV_ARGS(&commandList));
+	hr = device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators[0], nullptr, IID_PPV_ARGS(&commandList));
 	// コマンドリストの生成がうまくいかなかった場合
 	assert(SUCCEEDED(hr));
+	// 記録はフレームの始めにそのフレームのアロケータでResetしてから行う
+	hr = commandList->Close();
+	assert(SUCCEEDED(hr));
 
 	//===============================================
 	// スワップチェーンの生成
@@ -320,7 +340,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	// ディスクリプタヒープの生成
 	ID3D12DescriptorHeap* rtvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 2, false);
-	ID3D12DescriptorHeap* srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 128, true);
+	// SRVのヒープは先頭をImGuiが使い、残りを番号で管理する(シェーダーは番号でテクスチャを選ぶ)
+	const uint32_t kSrvDescriptorCount = 1024;
+	const uint32_t kImGuiSrvCount = 1;
+	const uint32_t kTransientSrvCount = 256;
+	ID3D12DescriptorHeap* srvDescriptorHeap = CreateDescriptorHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, kSrvDescriptorCount, true);
+	DescriptorAllocator srvDescriptorAllocator(kSrvDescriptorCount, kImGuiSrvCount, kTransientSrvCount);
 
 	// SwapChainからResourceを引っ張ってくる
 	ID3D12Resource* swapChainResources[2] = { nullptr };
@@ -356,20 +381,37 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	//===============================================
 	Log(logStream, "Fenceを設定");
 
-	// Fence
-	ID3D12Fence* fence = nullptr;
-	uint64_t fenceValue = 0;
-	hr = device->CreateFence(fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
-	assert(SUCCEEDED(hr));
-
-	//===============================================
-	// Eventを設定
-	//===============================================
-	Log(logStream, "Eventを設定");
+	// FenceとEvent(キューにシグナルを積み、たどり着くのを待つ)
+	std::unique_ptr<D3D12GpuTimeline> gpuTimeline = std::make_unique<D3D12GpuTimeline>(device, commandQueue);
+	// 同時にGPUへ送るフレーム数(CPUは一周して追いついたときだけ待つ)
+	int framesInFlight = 2;
+	std::unique_ptr<FrameRing> frameRing = std::make_unique<FrameRing>(*gpuTimeline, uint32_t(framesInFlight));
+
+	// フレームごとの定数バッファ用のアップロードメモリ(GPUが読み終わるまで書き換えない)
+	// 大きなページから256byte境界で切り出し、フレームの資源が空いたらまとめて戻す
+	const size_t kUploadPageSize = 64 * 1024;
+	D3D12UploadPageSource uploadPageSource(device);
+	std::unique_ptr<LinearUploadAllocator> frameUploadAllocators[kMaxFramesInFlight];
+	for (uint32_t i = 0; i < kMaxFramesInFlight; ++i) {
+		frameUploadAllocators[i] = std::make_unique<LinearUploadAllocator>(uploadPageSource, kUploadPageSize);
+	}
+	// インスタンスのStructuredBuffer用(10万個が1ページに収まる大きさにし、毎フレーム専用のページを作らない)
+	const size_t kInstanceUploadPageSize = 16 * 1024 * 1024;
+	std::unique_ptr<LinearUploadAllocator> frameInstanceAllocators[kMaxFramesInFlight];
+	for (uint32_t i = 0; i < kMaxFramesInFlight; ++i) {
+		frameInstanceAllocators[i] = std::make_unique<LinearUploadAllocator>(uploadPageSource, kInstanceUploadPageSize);
+	}
 
-	// Event
-	HANDLE fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-	assert(fenceEvent != nullptr);
+	// 長く使うバッファとテクスチャは用途ごとの大きなヒープに配置する(リソースごとにヒープを作らない)
+	std::unique_ptr<D3D12ResourceAllocator> resourceAllocator = std::make_unique<D3D12ResourceAllocator>(device);
+	// テクスチャはDEFAULTヒープに置き、ステージングのリングバッファからコピーで書き込む
+	const size_t kTextureStagingSize = 8 * 1024 * 1024;
+	std::unique_ptr<D3D12TextureUploader> textureUploader = std::make_unique<D3D12TextureUploader>(device, commandQueue, *gpuTimeline, kTextureStagingSize);
+	if (!textureUploader->IsValid()) {
+		// 作れなければ小さくしてやり直す(入らないサブリソースは行に分けて送られる)
+		Log(logStream, "テクスチャのステージングを作れないので小さくする");
+		textureUploader = std::make_unique<D3D12TextureUploader>(device, commandQueue, *gpuTimeline, kTextureStagingSize / 8);
+	}
 
 	//===============================================
 	// dxcCompilerを初期化
@@ -407,14 +449,15 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// descriptorRangeの設定
 	//===============================================
 	Log(logStream, "descriptorRangeを設定");
+	// ヒープ全体を1つのテーブルにし、シェーダーはルート定数の番号でテクスチャを選ぶ
 	D3D12_DESCRIPTOR_RANGE descriptorRange[1] = {};
 	descriptorRange[0].BaseShaderRegister = 0;
-	descriptorRange[0].NumDescriptors = 1;
+	descriptorRange[0].NumDescriptors = UINT_MAX;
 	descriptorRange[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-	descriptorRange[0].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+	descriptorRange[0].OffsetInDescriptorsFromTableStart = 0;
 
 	// RootParameterを作成(複数可)
-	D3D12_ROOT_PARAMETER rootParameters[4] = {};
+	D3D12_ROOT_PARAMETER rootParameters[7] = {};
 	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
 	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
 	rootParameters[0].Descriptor.ShaderRegister = 0;
@@ -428,6 +471,19 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	rootParameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
 	rootParameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
 	rootParameters[3].Descriptor.ShaderRegister = 1;
+	rootParameters[4].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParameters[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+	rootParameters[4].Constants.ShaderRegister = 2;
+	rootParameters[4].Constants.Num32BitValues = 1;
+	// インスタンス描画用のStructuredBuffer(インスタンスとマテリアル)
+	rootParameters[5].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[5].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+	rootParameters[5].Descriptor.ShaderRegister = 0;
+	rootParameters[5].Descriptor.RegisterSpace = 1;
+	rootParameters[6].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[6].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+	rootParameters[6].Descriptor.ShaderRegister = 1;
+	rootParameters[6].Descriptor.RegisterSpace = 1;
 	descriptionRootSignature.pParameters = rootParameters;
 	descriptionRootSignature.NumParameters = _countof(rootParameters);
 
@@ -483,6 +539,24 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	inputLayoutDesc.pInputElementDescs = inputElementDescs;
 	inputLayoutDesc.NumElements = _countof(inputElementDescs);
 
+	// 圧縮頂点(PackedVertexData)用のInputLayout
+	D3D12_INPUT_ELEMENT_DESC inputElementDescsPacked[3] = {};
+	inputElementDescsPacked[0].SemanticName = "POSITION";
+	inputElementDescsPacked[0].SemanticIndex = 0;
+	inputElementDescsPacked[0].Format = DXGI_FORMAT_R16G16B16A16_SNORM;
+	inputElementDescsPacked[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	inputElementDescsPacked[1].SemanticName = "NORMAL";
+	inputElementDescsPacked[1].SemanticIndex = 0;
+	inputElementDescsPacked[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	inputElementDescsPacked[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	inputElementDescsPacked[2].SemanticName = "TEXCOORD";
+	inputElementDescsPacked[2].SemanticIndex = 0;
+	inputElementDescsPacked[2].Format = DXGI_FORMAT_R16G16_FLOAT;
+	inputElementDescsPacked[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	D3D12_INPUT_LAYOUT_DESC inputLayoutDescPacked{};
+	inputLayoutDescPacked.pInputElementDescs = inputElementDescsPacked;
+	inputLayoutDescPacked.NumElements = _countof(inputElementDescsPacked);
+
 	// BlendStateの設定
 	D3D12_BLEND_DESC blendDesc{};
 	// すべての色要素を書き込む
@@ -503,6 +577,13 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	);
 	assert(vertexShaderBlob != nullptr);
 
+	IDxcBlob* vertexShaderBlobPacked = CompileShader(
+		L"Object3dPacked.VS.hlsl",
+		L"vs_6_0",
+		dxcUtils, dxcCompiler, includeHandler
+	);
+	assert(vertexShaderBlobPacked != nullptr);
+
 	IDxcBlob* pixelShaderBlob = CompileShader(
 		L"object3d.PS.hlsl",
 		L"ps_6_0",
@@ -510,11 +591,25 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	);
 	assert(pixelShaderBlob != nullptr);
 
+	IDxcBlob* vertexShaderBlobInstanced = CompileShader(
+		L"Object3dInstanced.VS.hlsl",
+		L"vs_6_0",
+		dxcUtils, dxcCompiler, includeHandler
+	);
+	assert(vertexShaderBlobInstanced != nullptr);
+
+	IDxcBlob* pixelShaderBlobInstanced = CompileShader(
+		L"Object3dInstanced.PS.hlsl",
+		L"ps_6_0",
+		dxcUtils, dxcCompiler, includeHandler
+	);
+	assert(pixelShaderBlobInstanced != nullptr);
+
 	//===============================================
 	// depthStencilResource生成
 	//===============================================
 	Log(logStream, "depthStencilResource生成");
-	ID3D12Resource* depthStencilResource = CreateDepthStencilTextureResource(device, kClientWidth, kClientHeight);
+	ID3D12Resource* depthStencilResource = CreateDepthStencilTextureResource(*resourceAllocator, kClientWidth, kClientHeight);
 
 	//===============================================
 	// dsvDescriptorHeap生成
@@ -568,21 +663,61 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&graphicsPipelineState));
 	assert(SUCCEEDED(hr));
 
+	// 圧縮頂点用のPSO(InputLayoutとVSだけ違う)
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDescPacked = graphicsPipelineStateDesc;
+	graphicsPipelineStateDescPacked.InputLayout = inputLayoutDescPacked;
+	graphicsPipelineStateDescPacked.VS = {
+		vertexShaderBlobPacked->GetBufferPointer(),
+		vertexShaderBlobPacked->GetBufferSize()
+	};
+	ID3D12PipelineState* graphicsPipelineStatePacked = nullptr;
+	hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDescPacked, IID_PPV_ARGS(&graphicsPipelineStatePacked));
+	assert(SUCCEEDED(hr));
+
+	// インスタンス描画用のPSO(行列とマテリアルはSV_InstanceIDでStructuredBufferから読む)
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDescInstanced = graphicsPipelineStateDesc;
+	graphicsPipelineStateDescInstanced.VS = {
+		vertexShaderBlobInstanced->GetBufferPointer(),
+		vertexShaderBlobInstanced->GetBufferSize()
+	};
+	graphicsPipelineStateDescInstanced.PS = {
+		pixelShaderBlobInstanced->GetBufferPointer(),
+		pixelShaderBlobInstanced->GetBufferSize()
+	};
+	ID3D12PipelineState* graphicsPipelineStateInstanced = nullptr;
+	hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDescInstanced, IID_PPV_ARGS(&graphicsPipelineStateInstanced));
+	assert(SUCCEEDED(hr));
+
 	//===============================================
 	// vertexResourceを作成
 	//===============================================
 	Log(logStream, "vertexResourceを作成");
 	const uint32_t kSubdivision = 16;
-	const float kLonEvery = 180.0f * 2.0f / float(kSubdivision);
-	const float kLatEvery = 180.0f / float(kSubdivision);
-	ID3D12Resource* vertexResource = CreateBufferResource(device, sizeof(VertexData) * (kSubdivision * kSubdivision * 6));
+	// 共有頂点の球を作成し、頂点キャッシュに合わせて三角形と頂点を並べ替える
+	MeshData sphereMesh = GenerateSphereMesh(kSubdivision);
+	const float sphereACMRBefore = ComputeACMR(sphereMesh.indices, sphereMesh.vertices.size(), 16);
+	OptimizeVertexCache(sphereMesh.indices, sphereMesh.vertices.size());
+	OptimizeVertexFetch(sphereMesh);
+	const float sphereACMRAfter = ComputeACMR(sphereMesh.indices, sphereMesh.vertices.size(), 16);
+	Log(logStream, std::format("sphere: vertices {} -> {}, triangles {}, ACMR(FIFO16) 3.000 -> {:.3f} -> {:.3f}",
+		kSubdivision * kSubdivision * 6, sphereMesh.vertices.size(), sphereMesh.indices.size() / 3, sphereACMRBefore, sphereACMRAfter));
+	// LODの列を作成する(インデックスバッファには全段階をつなげて入れる)
+	const MeshLodChain sphereLodChain = GenerateLodChain(sphereMesh, 4, 0.5f, 0.5f);
+	for (size_t level = 0; level < sphereLodChain.lods.size(); ++level) {
+		const MeshLod& lod = sphereLodChain.lods[level];
+		Log(logStream, std::format("sphere LOD{}: triangles {} ({:.1f}%), error {:.5f}",
+			level, lod.indexCount / 3, 100.0f * float(lod.indexCount) / float(sphereMesh.indices.size()), lod.error));
+	}
+	const UINT sphereVertexCount = UINT(sphereMesh.vertices.size());
+	const UINT sphereIndexCount = UINT(sphereLodChain.indices.size());
+	ID3D12Resource* vertexResource = CreateBufferResource(*resourceAllocator, sizeof(VertexData) * sphereVertexCount);
 
 	// 頂点バッファビューを作成
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
 	// リソースの先頭データから使う
 	vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
 	// 使用するリソースのサイズ
-	vertexBufferView.SizeInBytes = sizeof(VertexData) * (kSubdivision * kSubdivision * 6);
+	vertexBufferView.SizeInBytes = sizeof(VertexData) * sphereVertexCount;
 	// 1頂点当たりのサイズ
 	vertexBufferView.StrideInBytes = sizeof(VertexData);
 	
@@ -590,124 +725,151 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	VertexData* vertexData = nullptr;
 	// アドレスを取得
 	vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
-
-	for (uint32_t latIndex = 0; latIndex < kSubdivision; ++latIndex) {
-		float lat = (latIndex * kLatEvery - 90.0f) * (float(M_PI) / 180.0f);
-		for (uint32_t lonIndex = 0; lonIndex < kSubdivision; ++lonIndex) {
-			uint32_t start = (latIndex * kSubdivision + lonIndex) * 6;
-			float lon = lonIndex * kLonEvery * (float(M_PI) / 180.0f);
-
-			// 頂点1
-			vertexData[start].position.x = cosf(lat) * cosf(lon);
-			vertexData[start].position.y = sinf(lat);
-			vertexData[start].position.z = cosf(lat) * sinf(lon);
-			vertexData[start].position.w = 1.0f;
-			vertexData[start].texcoord.x = float(lonIndex) / float(kSubdivision);
-			vertexData[start].texcoord.y = 1.0f - float(latIndex) / float(kSubdivision);
-			vertexData[start].normal.x = vertexData[start].position.x;
-			vertexData[start].normal.y = vertexData[start].position.y;
-			vertexData[start].normal.z = vertexData[start].position.z;
-
-			// 頂点2
-			vertexData[start + 1].position.x = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * cosf(lon);
-			vertexData[start + 1].position.y = sinf(lat + kLatEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 1].position.z = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * sinf(lon);
-			vertexData[start + 1].position.w = 1.0f;
-			vertexData[start + 1].texcoord.x = float(lonIndex) / float(kSubdivision);
-			vertexData[start + 1].texcoord.y = 1.0f - float(latIndex + 1) / float(kSubdivision);
-			vertexData[start + 1].normal.x = vertexData[start + 1].position.x;
-			vertexData[start + 1].normal.y = vertexData[start + 1].position.y;
-			vertexData[start + 1].normal.z = vertexData[start + 1].position.z;
-
-			// 頂点3
-			vertexData[start + 2].position.x = cosf(lat) * cosf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 2].position.y = sinf(lat);
-			vertexData[start + 2].position.z = cosf(lat) * sinf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 2].position.w = 1.0f;
-			vertexData[start + 2].texcoord.x = float(lonIndex + 1) / float(kSubdivision);
-			vertexData[start + 2].texcoord.y = 1.0f - float(latIndex) / float(kSubdivision);
-			vertexData[start + 2].normal.x = vertexData[start + 2].position.x;
-			vertexData[start + 2].normal.y = vertexData[start + 2].position.y;
-			vertexData[start + 2].normal.z = vertexData[start + 2].position.z;
-
-			// 頂点4
-			vertexData[start + 3].position.x = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * cosf(lon);
-			vertexData[start + 3].position.y = sinf(lat + kLatEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 3].position.z = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * sinf(lon);
-			vertexData[start + 3].position.w = 1.0f;
-			vertexData[start + 3].texcoord.x = float(lonIndex) / float(kSubdivision);
-			vertexData[start + 3].texcoord.y = 1.0f - float(latIndex + 1) / float(kSubdivision);
-			vertexData[start + 3].normal.x = vertexData[start + 3].position.x;
-			vertexData[start + 3].normal.y = vertexData[start + 3].position.y;
-			vertexData[start + 3].normal.z = vertexData[start + 3].position.z;
-
-			// 頂点5
-			vertexData[start + 4].position.x = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * cosf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 4].position.y = sinf(lat + kLatEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 4].position.z = cosf(lat + kLatEvery * (float(M_PI) / 180.0f)) * sinf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 4].position.w = 1.0f;
-			vertexData[start + 4].texcoord.x = float(lonIndex + 1) / float(kSubdivision);
-			vertexData[start + 4].texcoord.y = 1.0f - float(latIndex + 1) / float(kSubdivision);
-			vertexData[start + 4].normal.x = vertexData[start + 4].position.x;
-			vertexData[start + 4].normal.y = vertexData[start + 4].position.y;
-			vertexData[start + 4].normal.z = vertexData[start + 4].position.z;
-
-			// 頂点6
-			vertexData[start + 5].position.x = cosf(lat) * cosf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 5].position.y = sinf(lat);
-			vertexData[start + 5].position.z = cosf(lat) * sinf(lon + kLonEvery * (float(M_PI) / 180.0f));
-			vertexData[start + 5].position.w = 1.0f;
-			vertexData[start + 5].texcoord.x = float(lonIndex + 1) / float(kSubdivision);
-			vertexData[start + 5].texcoord.y = 1.0f - float(latIndex) / float(kSubdivision);
-			vertexData[start + 5].normal.x = vertexData[start + 5].position.x;
-			vertexData[start + 5].normal.y = vertexData[start + 5].position.y;
-			vertexData[start + 5].normal.z = vertexData[start + 5].position.z;
-		}
+	std::memcpy(vertexData, sphereMesh.vertices.data(), sizeof(VertexData) * sphereVertexCount);
+
+	// 圧縮頂点版(位置の展開はWVPに含める)
+	const VertexQuantization sphereQuantization = ComputeVertexQuantization(sphereMesh.vertices.data(), sphereVertexCount);
+	const Matrix4x4 sphereDequantizeMatrix = MakeDequantizeMatrix(sphereQuantization);
+	ID3D12Resource* vertexResourcePacked = CreateBufferResource(*resourceAllocator, sizeof(PackedVertexData) * sphereVertexCount);
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferViewPacked{};
+	vertexBufferViewPacked.BufferLocation = vertexResourcePacked->GetGPUVirtualAddress();
+	vertexBufferViewPacked.SizeInBytes = sizeof(PackedVertexData) * sphereVertexCount;
+	vertexBufferViewPacked.StrideInBytes = sizeof(PackedVertexData);
+	PackedVertexData* vertexDataPacked = nullptr;
+	vertexResourcePacked->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataPacked));
+	PackVertices(sphereMesh.vertices.data(), sphereVertexCount, sphereQuantization, vertexDataPacked);
+	Log(logStream, std::format("sphere: vertex buffer {} bytes -> {} bytes (packed)",
+		sizeof(VertexData) * sphereVertexCount, sizeof(PackedVertexData) * sphereVertexCount));
+
+	// インデックスは頂点数が収まるなら16bitにする
+	const bool useSphereIndex16 = CanUseIndex16(sphereMesh);
+	const UINT sphereIndexSize = useSphereIndex16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	ID3D12Resource* indexResource = CreateBufferResource(*resourceAllocator, sphereIndexSize * sphereIndexCount);
+	D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+	indexBufferView.BufferLocation = indexResource->GetGPUVirtualAddress();
+	indexBufferView.SizeInBytes = sphereIndexSize * sphereIndexCount;
+	indexBufferView.Format = useSphereIndex16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+	void* indexData = nullptr;
+	indexResource->Map(0, nullptr, &indexData);
+	if (useSphereIndex16) {
+		std::vector<uint16_t> indices16 = MakeIndices16(sphereLodChain.indices);
+		std::memcpy(indexData, indices16.data(), sizeof(uint16_t) * sphereIndexCount);
+	} else {
+		std::memcpy(indexData, sphereLodChain.indices.data(), sizeof(uint32_t) * sphereIndexCount);
 	}
 
-	// マテリアル用のリソース
-	ID3D12Resource* materialResource = CreateBufferResource(device, sizeof(Material));
-	// マテリアルにデータを書き込む
-	Material* materialData = nullptr;
-	// 書き込むアドレスを取得
-	materialResource->Map(0, nullptr, reinterpret_cast<void**>(&materialData));
+	// マテリアル(定数はCPU側に持ち、描画のたびにフレームのアップロードメモリに書き込む)
+	Material materialData{};
 	// 単位行列で初期化
-	materialData->uvTransform = MakeIdentityMatrix4x4();
+	materialData.uvTransform = MakeIdentityMatrix4x4();
 	// 白色を書き込む
-	materialData->color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	materialData.color = { 1.0f, 1.0f, 1.0f, 1.0f };
 	// lighting
-	materialData->enableLighting = true;
+	materialData.enableLighting = true;
 	// lightingの切り替え
 	bool isEnableLighting = true;
 
-	// Sprite用のマテリアルリソース
-	ID3D12Resource* materialResourceSprite = CreateBufferResource(device, sizeof(Material));
-	Material* materialDataSprite = nullptr;
-	materialResourceSprite->Map(0, nullptr, reinterpret_cast<void**>(&materialDataSprite));
-	materialDataSprite->uvTransform = MakeIdentityMatrix4x4();
-	materialDataSprite->color = { 1.0f, 1.0f, 1.0f, 1.0f };
-	materialDataSprite->enableLighting = false;
-
-	// directionalLightResource
-	ID3D12Resource* directionalLightResource = CreateBufferResource(device, sizeof(DirectionalLight));
-	DirectionalLight* directionalLightData = nullptr;
-	directionalLightResource->Map(0, nullptr, reinterpret_cast<void**>(&directionalLightData));
-	directionalLightData->color = { 1.0f, 1.0f, 1.0f, 1.0f };
-	directionalLightData->direction = { 0.0f, -1.0f, 0.0f };
-	directionalLightData->intensity = 1.0f;
+	// Sprite用のマテリアル
+	Material materialDataSprite{};
+	materialDataSprite.uvTransform = MakeIdentityMatrix4x4();
+	materialDataSprite.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	materialDataSprite.enableLighting = false;
+
+	// directionalLight
+	DirectionalLight directionalLightData{};
+	directionalLightData.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	directionalLightData.direction = { 0.0f, -1.0f, 0.0f };
+	directionalLightData.intensity = 1.0f;
 
 	// transformationMatrix
-	ID3D12Resource* transformationMatrixResource = CreateBufferResource(device, sizeof(TransformationMatrix));
-	TransformationMatrix* transformationMatrixData = nullptr;
-	transformationMatrixResource->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixData));
-	transformationMatrixData->WVP = MakeIdentityMatrix4x4();
-	transformationMatrixData->world = MakeIdentityMatrix4x4();
+	TransformationMatrix transformationMatrixData{};
+	transformationMatrixData.WVP = MakeIdentityMatrix4x4();
+	transformationMatrixData.world = MakeIdentityMatrix4x4();
+
+	//===============================================
+	// モデルの読み込み
+	//===============================================
+	Log(logStream, "モデルを読み込み");
+	// 読み込みなどに使うワーカースレッド
+	ThreadPool threadPool;
+	ModelData modelData;
+	{
+		auto loadStart = std::chrono::steady_clock::now();
+		bool isModelLoaded = LoadModelFile("resources", "plane.obj", modelData, &threadPool);
+		assert(isModelLoaded);
+		auto loadEnd = std::chrono::steady_clock::now();
+		Log(logStream, std::format("plane.obj: vertices {}, triangles {}, subsets {}, {:.3f}ms",
+			modelData.mesh.vertices.size(), modelData.mesh.indices.size() / 3, modelData.subsets.size(),
+			std::chrono::duration<double, std::milli>(loadEnd - loadStart).count()));
+	}
+
+	//===============================================
+	// メッシュレットを作成
+	//===============================================
+	// 球はLOD0、モデルはマテリアルが混ざらないようにサブセットごとに分ける
+	MeshletData sphereMeshlets;
+	BuildMeshlets(sphereMesh.vertices, sphereMesh.indices.data(), sphereMesh.indices.size(), sphereMeshlets);
+	MeshletData modelMeshlets;
+	for (const ModelSubset& subset : modelData.subsets) {
+		BuildMeshlets(modelData.mesh.vertices, modelData.mesh.indices.data() + subset.indexStart, subset.indexCount, modelMeshlets);
+	}
+	std::vector<uint32_t> visibleMeshlets;
+	// 物体の周り(距離5、水平8方向と斜め上8方向)から見たときに裏向きで除ける三角形の割合
+	auto logMeshletCulling = [&](const char* name, const MeshletData& meshlets, uint32_t triangleCount) {
+		Log(logStream, std::format("{}: meshlets {}, triangles {}", name, meshlets.meshlets.size(), triangleCount));
+		for (float pitch : { 0.0f, 0.785398f }) {
+			std::string line = std::format("{}: pitch {:.0f} culled", name, pitch * 57.29578f);
+			for (uint32_t i = 0; i < 8; ++i) {
+				const float yaw = 0.785398f * float(i);
+				const Vector3 eye = { 5.0f * std::sin(yaw) * std::cos(pitch), 5.0f * std::sin(pitch), -5.0f * std::cos(yaw) * std::cos(pitch) };
+				const uint32_t visibleTriangleCount = CullMeshlets(meshlets, eye, visibleMeshlets);
+				line += std::format(" {:.1f}%", 100.0f * float(triangleCount - visibleTriangleCount) / float(triangleCount));
+			}
+			Log(logStream, line);
+		}
+	};
+	logMeshletCulling("sphere", sphereMeshlets, uint32_t(sphereMesh.indices.size() / 3));
+	logMeshletCulling("plane.obj", modelMeshlets, uint32_t(modelData.mesh.indices.size() / 3));
+	uint32_t sphereVisibleTriangleCount = 0;
+	uint32_t modelVisibleTriangleCount = 0;
+
+	const UINT modelVertexCount = UINT(modelData.mesh.vertices.size());
+	const UINT modelIndexCount = UINT(modelData.mesh.indices.size());
+	ID3D12Resource* vertexResourceModel = CreateBufferResource(*resourceAllocator, sizeof(VertexData) * modelVertexCount);
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferViewModel{};
+	vertexBufferViewModel.BufferLocation = vertexResourceModel->GetGPUVirtualAddress();
+	vertexBufferViewModel.SizeInBytes = sizeof(VertexData) * modelVertexCount;
+	vertexBufferViewModel.StrideInBytes = sizeof(VertexData);
+	VertexData* vertexDataModel = nullptr;
+	vertexResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&vertexDataModel));
+	std::memcpy(vertexDataModel, modelData.mesh.vertices.data(), sizeof(VertexData) * modelVertexCount);
+
+	ID3D12Resource* indexResourceModel = CreateBufferResource(*resourceAllocator, sizeof(uint32_t) * modelIndexCount);
+	D3D12_INDEX_BUFFER_VIEW indexBufferViewModel{};
+	indexBufferViewModel.BufferLocation = indexResourceModel->GetGPUVirtualAddress();
+	indexBufferViewModel.SizeInBytes = sizeof(uint32_t) * modelIndexCount;
+	indexBufferViewModel.Format = DXGI_FORMAT_R32_UINT;
+	uint32_t* indexDataModel = nullptr;
+	indexResourceModel->Map(0, nullptr, reinterpret_cast<void**>(&indexDataModel));
+	std::memcpy(indexDataModel, modelData.mesh.indices.data(), sizeof(uint32_t) * modelIndexCount);
+
+	// モデル用のマテリアル(最初のマテリアルの色を使う)
+	Material materialDataModel{};
+	materialDataModel.uvTransform = MakeIdentityMatrix4x4();
+	materialDataModel.color = modelData.materials.empty() ? Vector4{ 1.0f, 1.0f, 1.0f, 1.0f } : modelData.materials[0].diffuseColor;
+	materialDataModel.enableLighting = true;
+
+	// モデル用のTransformationMatrix
+	TransformationMatrix transformationMatrixDataModel{};
+	transformationMatrixDataModel.WVP = MakeIdentityMatrix4x4();
+	transformationMatrixDataModel.world = MakeIdentityMatrix4x4();
 
 	//===============================================
 	// vertexResourceSpriteの設定
 	//===============================================
 	Log(logStream, "vertexResourceSpriteを設定");
-	ID3D12Resource* vertexResourceSprite = CreateBufferResource(device, sizeof(VertexData) * 6);
+	ID3D12Resource* vertexResourceSprite = CreateBufferResource(*resourceAllocator, sizeof(VertexData) * 6);
 
 	// VertexBufferrView
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferViewSprite{};
@@ -745,7 +907,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	vertexDataSprite[5].texcoord = { 1.0f, 1.0f };
 	vertexDataSprite[5].normal = { 0.0f, 0.0f, -1.0f };
 
-	ID3D12Resource* indexResourceSprite = CreateBufferResource(device, sizeof(uint32_t) * 6);
+	ID3D12Resource* indexResourceSprite = CreateBufferResource(*resourceAllocator, sizeof(uint32_t) * 6);
 	D3D12_INDEX_BUFFER_VIEW indexBufferViewSprite{};
 	indexBufferViewSprite.BufferLocation = indexResourceSprite->GetGPUVirtualAddress();
 	indexBufferViewSprite.SizeInBytes = sizeof(uint32_t) * 6;
@@ -761,22 +923,37 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	indexDataSprite[5] = 2;
 
 	// sprite用TransformationMatrix用リソース
-	ID3D12Resource* transformationMatrixResourceSprite = CreateBufferResource(device, sizeof(TransformationMatrix));
-	TransformationMatrix* transformationMatrixDataSprite = nullptr;
-	transformationMatrixResourceSprite->Map(0, nullptr, reinterpret_cast<void**>(&transformationMatrixDataSprite));
-	transformationMatrixDataSprite->WVP = MakeIdentityMatrix4x4();
-	transformationMatrixDataSprite->world = MakeIdentityMatrix4x4();
+	TransformationMatrix transformationMatrixDataSprite{};
+	transformationMatrixDataSprite.WVP = MakeIdentityMatrix4x4();
+	transformationMatrixDataSprite.world = MakeIdentityMatrix4x4();
 
 	// Transformの変数
 	Transform transfrom{ {1.0f, 1.0f, 1.0f},{0.0f, 0.0f, 0.0f},{0.0f, 0.0f,0.0f} };
 	Transform camaraTransform{ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -5.0f} };
 	Transform transformSprite{ {1.0f, 1.0f, 1.0f},{0.0f, 0.0f, 0.0f},{0.0f, 0.0f, 0.0f} };
+	Transform transformModel{ {1.0f, 1.0f, 1.0f},{0.0f, 0.0f, 0.0f},{2.5f, 0.0f, 0.0f} };
 	Transform uvTransformSprite = {
 		{1.0f, 1.0f, 1.0f},
 		{0.0f, 0.0f, 0.0f},
 		{0.0f, 0.0f, 0.0f}
 	};
 
+	// 親子関係とワールド行列はシーングラフで持つ(変更のあったノードと子孫だけ計算し直す)
+	SceneGraph sceneGraph;
+	const SceneGraph::NodeHandle cameraNode = sceneGraph.AddNode(SceneGraph::kNoParent, camaraTransform);
+	const SceneGraph::NodeHandle sphereNode = sceneGraph.AddNode(SceneGraph::kNoParent, transfrom);
+	const SceneGraph::NodeHandle modelNode = sceneGraph.AddNode(SceneGraph::kNoParent, transformModel);
+	const SceneGraph::NodeHandle spriteNode = sceneGraph.AddNode(SceneGraph::kNoParent, transformSprite);
+	// モデルを球の子にする(球と一緒に回る)
+	bool isModelAttachedToSphere = false;
+	size_t sceneUpdatedNodeCount = 0;
+	// ImGuiなどで書き換えたTransformをノードに反映する(変わっていなければ何もしない)
+	auto syncSceneNode = [&](SceneGraph::NodeHandle node, const Transform& local) {
+		if (std::memcmp(&sceneGraph.GetLocal(node), &local, sizeof(Transform)) != 0) {
+			sceneGraph.SetLocal(node, local);
+		}
+	};
+
 	// ビューポート
 	D3D12_VIEWPORT viewport{};
 	viewport.Width = kClientWidth;
@@ -803,7 +980,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	ImGui_ImplWin32_Init(hwnd);
 	ImGui_ImplDX12_Init(
 		device,
-		swapChainDesc.BufferCount,
+		kMaxFramesInFlight,
 		rtvDesc.Format,
 		srvDescriptorHeap,
 		srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
@@ -811,56 +988,130 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	);
 
 	//===============================================
-	// Textureを読んで転送
+	// Textureの読み込みを開始
 	//===============================================
-	Log(logStream, "Textureを読んで転送");
-	// uvChecker
-	DirectX::ScratchImage mipImages = LoadTexture("resources/uvChecker.png");
-	const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
-	ID3D12Resource* textureResource = CreateTextureResource(device, metadata);
-	UploadTextureData(textureResource, mipImages);
-
-	// monsterBall
-	DirectX::ScratchImage mipImages2 = LoadTexture("resources/monsterBall.png");
-	const DirectX::TexMetadata& metadata2 = mipImages2.GetMetadata();
-	ID3D12Resource* textureResource2 = CreateTextureResource(device, metadata2);
-	UploadTextureData(textureResource2, mipImages2);
+	Log(logStream, "Textureの読み込みを開始");
+	// ワーカーで読み込みとmipの作成を行い、できたものから粗いmipを先に転送する
+	D3D12TextureStreamSink textureStreamSink(*resourceAllocator, *textureUploader, *gpuTimeline);
+	// 1フレームで転送するバイト数の目安
+	const uint64_t kTextureUploadBytesPerFrame = 4 * 1024 * 1024;
+	std::unique_ptr<TextureStreamer> textureStreamer = std::make_unique<TextureStreamer>(textureStreamSink, DecodeTextureFile, 0, kTextureUploadBytesPerFrame);
+	const TextureStreamer::TextureHandle uvCheckerTexture = textureStreamer->Request("resources/uvChecker.png");
+	const TextureStreamer::TextureHandle monsterBallTexture = textureStreamer->Request("resources/monsterBall.png");
+	bool isTextureLoadLogged = false;
+	// 読み込みの計測用(ImGuiから多数のテクスチャを読み込む)
+	const uint32_t kBenchmarkTextureCount = 128;
+	std::unique_ptr<TextureStreamer> benchmarkStreamer;
+	bool isBenchmarkLogged = false;
+
+	// 届くまで使う代わりのテクスチャ(白1x1)
+	DirectX::ScratchImage placeholderImage{};
+	hr = placeholderImage.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1, 1, 1, 1);
+	assert(SUCCEEDED(hr));
+	std::memset(placeholderImage.GetPixels(), 0xFF, placeholderImage.GetPixelsSize());
+	ID3D12Resource* placeholderTexture = CreateTextureResource(*resourceAllocator, placeholderImage.GetMetadata());
+	bool isUploaded = textureUploader->Upload(placeholderTexture, placeholderImage);
+	assert(isUploaded);
+	// コピーを送る(描画は同じキューの後ろに積むので待たなくてよい)
+	textureUploader->Flush();
 
 	// spriteの描画を有効
 	bool isDrawSprite = true;
+	// 球を圧縮頂点で描画する
+	bool usePackedVertex = true;
+	// モデルの描画を有効
+	bool isDrawModel = true;
+	// 球のLOD(forceSphereLodが0以上ならその段階に固定する)
+	int forceSphereLod = -1;
+	float lodPixelThreshold = 1.0f;
+	uint32_t sphereLodLevel = 0;
+
+	// 球をインスタンス描画でたくさん並べる(1回のDrawIndexedInstancedで描く)
+	bool isDrawInstances = false;
+	int instanceCount = 10000;
+	const int kMaxInstanceCount = 100000;
+	std::vector<SceneInstance> sceneInstances;
+	InstanceBatchBuilder instanceBatchBuilder;
+	// テクスチャと色の組み合わせ(テクスチャの番号は読み込みが進むと変わるので毎フレーム詰める)
+	const uint32_t kInstanceMaterialCount = 4;
+	InstanceMaterial instanceMaterials[kInstanceMaterialCount] = {};
+	// CPUでインスタンスを並べて書き込む時間(直近の平均)
+	double instanceBuildMilliseconds = 0.0;
+	// 視錐台カリング(境界球で判定し、見えているインスタンスだけを並べる)
+	bool isCullInstances = true;
+	std::vector<BoundingSphere> instanceBounds;
+	std::vector<uint32_t> visibleInstanceIndices;
+	std::vector<SceneInstance> visibleInstances;
+	double instanceCullMilliseconds = 0.0;
+	// インスタンスの境界箱のBVH(並べ直したら作り直し、動かしたらRefitする)
+	bool useInstanceBvh = true;
+	BoundingVolumeHierarchy instanceBvh;
+	std::vector<BoundingBox> instanceBoxes;
+	bool isInstanceBvhStale = true;
+	bool isInstanceBvhMoved = false;
+	double instanceBvhBuildMilliseconds = 0.0;
+	// 左クリックで選んだインスタンス(-1なら選んでいない)
+	int pickedInstance = -1;
+	float pickedDistance = 0.0f;
+	std::vector<uint32_t> pickedNeighborIndices;
+	size_t pickedNeighborCount = 0;
 
 	//===============================================
 	// ShaderResourceViewの作成
 	//===============================================
 	Log(logStream, "ShaderResourceViewを作成");
 	// srvの設定
-	// uvChacker
+	// 代わりのテクスチャ
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-	srvDesc.Format = metadata.format;
+	srvDesc.Format = placeholderImage.GetMetadata().format;
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
+	srvDesc.Texture2D.MipLevels = 1;
 
 	// descriptorHeapの場所
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
+	const uint32_t placeholderSrvIndex = srvDescriptorAllocator.Allocate();
+	assert(placeholderSrvIndex != DescriptorAllocator::kInvalidIndex);
 
 	// srvの作成
-	device->CreateShaderResourceView(textureResource, &srvDesc, textureSrvHandleCPU);
-
-	// monsterBall
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc2{};
-	srvDesc2.Format = metadata2.format;
-	srvDesc2.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc2.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc2.Texture2D.MipLevels = UINT(metadata2.mipLevels);
-
-	// descriptorHeapの場所
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU2 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU2 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-
-	// srvの作成
-	device->CreateShaderResourceView(textureResource2, &srvDesc2, textureSrvHandleCPU2);
+	device->CreateShaderResourceView(placeholderTexture, &srvDesc, GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, placeholderSrvIndex));
+
+	// 読み込むテクスチャは使えるmipが増えるたびに新しい番号へSRVを作り、前の番号を解放する
+	// (GPUが前のフレームで読んでいるかもしれないSRVは書き換えない。すべてのmipが届いた後は番号が変わらない)
+	struct StreamedTextureView {
+		TextureStreamer::TextureHandle handle;
+		uint32_t shownMip;
+		uint32_t srvIndex;
+	};
+	StreamedTextureView streamedTextureViews[] = {
+		{ uvCheckerTexture, TextureStreamer::kNoResidentMip, placeholderSrvIndex },
+		{ monsterBallTexture, TextureStreamer::kNoResidentMip, placeholderSrvIndex },
+	};
+	auto updateStreamedTextureView = [&](StreamedTextureView& view) {
+		const uint32_t residentMip = textureStreamer->GetResidentMip(view.handle);
+		if (residentMip >= view.shownMip) {
+			return;
+		}
+		const uint32_t srvIndex = srvDescriptorAllocator.Allocate();
+		if (srvIndex == DescriptorAllocator::kInvalidIndex) {
+			// 空きがなければ今のSRVを使い続ける
+			return;
+		}
+		// 使えるmipだけを見るSRV(シェーダーから見たmip 0がresidentMipになる)
+		const uint32_t mipLevels = textureStreamer->GetMipLevels(view.handle);
+		D3D12_SHADER_RESOURCE_VIEW_DESC streamedSrvDesc{};
+		streamedSrvDesc.Format = textureStreamer->GetFormat(view.handle);
+		streamedSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		streamedSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		streamedSrvDesc.Texture2D.MostDetailedMip = residentMip;
+		streamedSrvDesc.Texture2D.MipLevels = mipLevels - residentMip;
+		device->CreateShaderResourceView(static_cast<ID3D12Resource*>(textureStreamer->GetTexture(view.handle)), &streamedSrvDesc,
+			GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, srvIndex));
+		if (view.srvIndex != placeholderSrvIndex) {
+			srvDescriptorAllocator.Free(view.srvIndex);
+		}
+		view.srvIndex = srvIndex;
+		view.shownMip = residentMip;
+	};
 
 	// srvの切り替え
 	bool useMonsterBall = true;
@@ -900,11 +1151,30 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			}
 
 			if (ImGui::TreeNode("Material Setting")) {
-				ImGui::DragFloat3("directionLight.direction", &directionalLightData->direction.x);
-				ImGui::DragFloat("directionLight.intensity", &directionalLightData->intensity);
-				ImGui::SliderFloat4("material.color", &materialData->color.x, 0.0f, 1.0f);
+				ImGui::DragFloat3("directionLight.direction", &directionalLightData.direction.x);
+				ImGui::DragFloat("directionLight.intensity", &directionalLightData.intensity);
+				ImGui::SliderFloat4("material.color", &materialData.color.x, 0.0f, 1.0f);
 				ImGui::Checkbox("useMonsterBall", &useMonsterBall);
 				ImGui::Checkbox("enableLighting", &isEnableLighting);
+				ImGui::Checkbox("usePackedVertex", &usePackedVertex);
+				ImGui::SliderInt("forceSphereLod", &forceSphereLod, -1, int(sphereLodChain.lods.size()) - 1);
+				ImGui::DragFloat("lodPixelThreshold", &lodPixelThreshold, 0.1f, 0.1f, 16.0f);
+				ImGui::Text("sphere LOD%u: triangles %u", sphereLodLevel, sphereLodChain.lods[sphereLodLevel].indexCount / 3);
+				ImGui::Text("sphere meshlets: %zu, visible triangles %u / %zu",
+					sphereMeshlets.meshlets.size(), sphereVisibleTriangleCount, sphereMesh.indices.size() / 3);
+				ImGui::TreePop();
+			}
+
+			if (ImGui::TreeNode("Model Setting")) {
+				ImGui::DragFloat3("transformModel.translate", &transformModel.translate.x, 0.01f);
+				ImGui::DragFloat3("transformModel.rotate", &transformModel.rotate.x, 0.01f);
+				ImGui::Checkbox("isDrawModel", &isDrawModel);
+				if (ImGui::Checkbox("attachToSphere", &isModelAttachedToSphere)) {
+					sceneGraph.SetParent(modelNode, isModelAttachedToSphere ? sphereNode : SceneGraph::kNoParent);
+				}
+				ImGui::Text("scene nodes %zu, updated %zu", sceneGraph.GetNodeCount(), sceneUpdatedNodeCount);
+				ImGui::Text("model meshlets: %zu, visible triangles %u / %u",
+					modelMeshlets.meshlets.size(), modelVisibleTriangleCount, modelIndexCount / 3);
 				ImGui::TreePop();
 			}
 
@@ -917,32 +1187,343 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 				ImGui::TreePop();
 			}
 
+			if (ImGui::TreeNode("Instancing")) {
+				ImGui::Checkbox("isDrawInstances", &isDrawInstances);
+				ImGui::SliderInt("instanceCount", &instanceCount, 1, kMaxInstanceCount);
+				ImGui::Checkbox("isCullInstances", &isCullInstances);
+				ImGui::Text("instances %zu, materials %zu, build %.3fms", sceneInstances.size(),
+					instanceBatchBuilder.GetRanges().size(), instanceBuildMilliseconds);
+				ImGui::Checkbox("useInstanceBvh", &useInstanceBvh);
+				ImGui::Text("visible %zu / %zu, cull %.3fms (%s)", visibleInstances.size(), sceneInstances.size(),
+					instanceCullMilliseconds, GetSimdLevelName(GetSimdLevel()));
+				ImGui::Text("bvh nodes %zu, depth %u, build %.3fms", instanceBvh.GetNodeCount(), instanceBvh.GetDepth(),
+					instanceBvhBuildMilliseconds);
+				// 選んだインスタンスは動かせる(BVHはRefitで追従する)
+				if (pickedInstance >= 0 && size_t(pickedInstance) < sceneInstances.size()) {
+					ImGui::Text("picked %d (distance %.2f, neighbors %zu)", pickedInstance, pickedDistance, pickedNeighborCount);
+					if (ImGui::DragFloat3("picked.translate", &sceneInstances[pickedInstance].transform.translate.x, 0.01f)) {
+						isInstanceBvhMoved = true;
+					}
+				} else {
+					ImGui::Text("left click to pick an instance");
+				}
+				ImGui::TreePop();
+			}
+
+			if (ImGui::TreeNode("Frame Setting")) {
+				ImGui::SliderInt("framesInFlight", &framesInFlight, 1, int(kMaxFramesInFlight));
+				// CPUとGPUの重なり具合
+				const FrameRingStats& frameStats = frameRing->GetStats();
+				const double frameCount = double(std::max<uint64_t>(frameStats.frameCount, 1));
+				ImGui::Text("overlap %.1f%%, in flight %.2f", 100.0 * double(frameStats.overlapFrameCount) / frameCount, double(frameStats.inFlightSum) / frameCount);
+				ImGui::Text("stall %.1f%% (%.3fms / frame)", 100.0 * double(frameStats.stallCount) / frameCount, 1000.0 * frameStats.stallSeconds / frameCount);
+				ImGui::Text("cpu busy %.1f%%", frameStats.frameSeconds > 0.0 ? 100.0 * (1.0 - frameStats.stallSeconds / frameStats.frameSeconds) : 0.0);
+				const LinearUploadAllocator& lastUploadAllocator = *frameUploadAllocators[frameRing->GetFrameIndex()];
+				ImGui::Text("upload %zu bytes (peak %zu), pages %zu", lastUploadAllocator.GetUsedSize(), lastUploadAllocator.GetPeakUsedSize(), lastUploadAllocator.GetPageCount());
+				// 配置したリソースのヒープの使用量
+				const char* heapPoolNames[] = { "UploadBuffer", "Texture", "RenderTarget" };
+				for (size_t i = 0; i < size_t(D3D12HeapPoolType::Count); ++i) {
+					const HeapPoolStats heapStats = resourceAllocator->GetStats(D3D12HeapPoolType(i));
+					ImGui::Text("%s: heaps %u, %.1f / %.1f MB, frag %.3f", heapPoolNames[i], heapStats.heapCount,
+						double(heapStats.allocatedSize) / (1024.0 * 1024.0), double(heapStats.reservedSize) / (1024.0 * 1024.0), heapStats.fragmentation);
+				}
+				// テクスチャの転送
+				const TextureUploadStats& uploadStats = textureUploader->GetStats();
+				ImGui::Text("texture upload: %llu textures, %llu copies, %.1f MB, stall %llu", uploadStats.textureCount, uploadStats.copyCount,
+					double(uploadStats.uploadedBytes) / (1024.0 * 1024.0), uploadStats.stallCount);
+				ImGui::Text("staging %.1f / %.1f MB", double(textureUploader->GetStagingUsedSize()) / (1024.0 * 1024.0), double(textureUploader->GetStagingSize()) / (1024.0 * 1024.0));
+				if (ImGui::Button("ResetStats")) {
+					frameRing->ResetStats();
+				}
+				ImGui::TreePop();
+			}
+
+			if (ImGui::TreeNode("Descriptors")) {
+				const DescriptorAllocatorStats& descriptorStats = srvDescriptorAllocator.GetStats();
+				ImGui::Text("srv persistent: %u / %u used (peak %u), %u waiting for GPU", descriptorStats.persistentUsedCount,
+					descriptorStats.persistentCount, descriptorStats.peakPersistentUsedCount, descriptorStats.pendingFreeCount);
+				ImGui::Text("srv transient: %u / %u used, failed %u", descriptorStats.transientUsedCount, descriptorStats.transientCount, descriptorStats.failedCount);
+				ImGui::Text("uvChecker index %u, monsterBall index %u", streamedTextureViews[0].srvIndex, streamedTextureViews[1].srvIndex);
+				ImGui::TreePop();
+			}
+			if (ImGui::TreeNode("Texture Streaming")) {
+				const TextureStreamingStats& streamingStats = textureStreamer->GetStats();
+				ImGui::Text("scene: resident %u / %u, first visible %.1fms, all %.1fms", streamingStats.residentCount, streamingStats.requestedCount,
+					streamingStats.firstVisibleSeconds * 1000.0, streamingStats.allResidentSeconds * 1000.0);
+				ImGui::Text("uvChecker mip %d, monsterBall mip %d", int(streamedTextureViews[0].shownMip), int(streamedTextureViews[1].shownMip));
+				ImGui::Text("scene: %.2f MB, format %d / %d", double(streamingStats.uploadedBytes) / (1024.0 * 1024.0),
+					int(textureStreamer->GetFormat(streamedTextureViews[0].handle)), int(textureStreamer->GetFormat(streamedTextureViews[1].handle)));
+				// 多数のテクスチャを読み込んで時間を測る(同じ画像を別のテクスチャとして読む)
+				if (!benchmarkStreamer) {
+					if (ImGui::Button("Stream 128 textures")) {
+						benchmarkStreamer = std::make_unique<TextureStreamer>(textureStreamSink, DecodeTextureFile, 0, kTextureUploadBytesPerFrame);
+						for (uint32_t i = 0; i < kBenchmarkTextureCount; ++i) {
+							benchmarkStreamer->Request(i % 2 == 0 ? "resources/uvChecker.png" : "resources/monsterBall.png");
+						}
+						isBenchmarkLogged = false;
+					}
+				} else {
+					const TextureStreamingStats& benchmarkStats = benchmarkStreamer->GetStats();
+					ImGui::Text("benchmark: resident %u / %u, failed %u", benchmarkStats.residentCount, benchmarkStats.requestedCount, benchmarkStats.failedCount);
+					ImGui::Text("first visible %.1fms, first resident %.1fms, all %.1fms", benchmarkStats.firstVisibleSeconds * 1000.0,
+						benchmarkStats.firstResidentSeconds * 1000.0, benchmarkStats.allResidentSeconds * 1000.0);
+					ImGui::Text("decode %.1fms (sum of workers), %.1f MB", benchmarkStats.decodeSeconds * 1000.0, double(benchmarkStats.uploadedBytes) / (1024.0 * 1024.0));
+					if (benchmarkStreamer->IsIdle() && ImGui::Button("Release")) {
+						// 描画には使っていないので、コピーが終わっていれば解放できる
+						textureUploader->WaitForIdle();
+						benchmarkStreamer.reset();
+					}
+				}
+				ImGui::TreePop();
+			}
+
 			ImGui::End();
+			frameRing->SetFrameCount(uint32_t(framesInFlight));
 
 			//======================================
 			// WVPMatrix
 			//======================================
 			// material用
 			transfrom.rotate.y += 0.03f;
-			Matrix4x4 worldMatrix = MakeAffineMatrix(transfrom.scale, transfrom.rotate, transfrom.translate);
-			Matrix4x4 cameraMatrix = MakeAffineMatrix(camaraTransform.scale, camaraTransform.rotate, camaraTransform.translate);
-			Matrix4x4 viewMatrix = Inverse(cameraMatrix);
+			syncSceneNode(cameraNode, camaraTransform);
+			syncSceneNode(sphereNode, transfrom);
+			syncSceneNode(modelNode, transformModel);
+			syncSceneNode(spriteNode, transformSprite);
+			sceneUpdatedNodeCount = sceneGraph.UpdateWorld();
+			const Matrix4x4& cameraMatrix = sceneGraph.GetWorld(cameraNode);
+			const Vector3 cameraPosition = { cameraMatrix.m[3][0], cameraMatrix.m[3][1], cameraMatrix.m[3][2] };
+			Matrix4x4 viewMatrix = InverseAffine(cameraMatrix);
 			Matrix4x4 projectionMatrix = MakePerspectiveFovMatirx(0.45f, float(kClientWidth) / float(kClientHeight), 0.1f, 100.0f);
-			Matrix4x4 worldViewProjectionMatrix = Multiply(worldMatrix, Multiply(viewMatrix, projectionMatrix));
-			transformationMatrixData->WVP = worldViewProjectionMatrix;
+			Matrix4x4 viewProjectionMatrix = Multiply(viewMatrix, projectionMatrix);
+			// 球のLODを画面上の誤差から選ぶ
+			if (forceSphereLod >= 0) {
+				sphereLodLevel = uint32_t(forceSphereLod);
+			} else {
+				const Matrix4x4& sphereWorld = sceneGraph.GetWorld(sphereNode);
+				const Vector3 toSphere = {
+					sphereWorld.m[3][0] - cameraPosition.x,
+					sphereWorld.m[3][1] - cameraPosition.y,
+					sphereWorld.m[3][2] - cameraPosition.z };
+				const float sphereDistance = std::sqrt(toSphere.x * toSphere.x + toSphere.y * toSphere.y + toSphere.z * toSphere.z);
+				const float sphereScale = std::fmax(transfrom.scale.x, std::fmax(transfrom.scale.y, transfrom.scale.z));
+				sphereLodLevel = SelectLod(sphereLodChain, sphereScale, sphereDistance, 0.45f, float(kClientHeight), lodPixelThreshold);
+			}
+			// ワールド行列はシーングラフのものを使い、WVPだけ計算する
+			transformationMatrixData.world = sceneGraph.GetWorld(sphereNode);
+			transformationMatrixData.WVP = Multiply(transformationMatrixData.world, viewProjectionMatrix);
+			if (usePackedVertex) {
+				// 量子化した位置を戻す行列をWVPの前に掛ける(法線はworldのまま)
+				transformationMatrixData.WVP = Multiply(sphereDequantizeMatrix, transformationMatrixData.WVP);
+			}
+
+			// model用
+			transformationMatrixDataModel.world = sceneGraph.GetWorld(modelNode);
+			transformationMatrixDataModel.WVP = Multiply(transformationMatrixDataModel.world, viewProjectionMatrix);
+
+			// 視点を物体のローカル座標に戻して、裏向きのメッシュレットを数える(LOD0基準)
+			sphereVisibleTriangleCount = CullMeshlets(sphereMeshlets,
+				TransformPoint(cameraPosition, InverseAffine(transformationMatrixData.world)), visibleMeshlets);
+			modelVisibleTriangleCount = CullMeshlets(modelMeshlets,
+				TransformPoint(cameraPosition, InverseAffine(transformationMatrixDataModel.world)), visibleMeshlets);
 
 			// sprite用
-			Matrix4x4 worldMatrixSprite = MakeAffineMatrix(transformSprite.scale, transformSprite.rotate, transformSprite.translate);
 			Matrix4x4 viewMatrixSprite = MakeIdentityMatrix4x4();
 			Matrix4x4 projectionMatrixSprite = MakeOrthographicMatrix(0.0f, 0.0f, float(kClientWidth), float(kClientHeight), 0.0f, 100.0f);
-			Matrix4x4 worldViewProjectionMatrixSprite = Multiply(worldMatrixSprite, Multiply(viewMatrixSprite, projectionMatrixSprite));
-			transformationMatrixDataSprite->WVP = worldViewProjectionMatrixSprite;
+			Matrix4x4 viewProjectionMatrixSprite = Multiply(viewMatrixSprite, projectionMatrixSprite);
+			transformationMatrixDataSprite.world = sceneGraph.GetWorld(spriteNode);
+			transformationMatrixDataSprite.WVP = Multiply(transformationMatrixDataSprite.world, viewProjectionMatrixSprite);
 
 			// UVTransform用
 			Matrix4x4 uvTransformMatrix = MakeScaleMatrix(uvTransformSprite.scale);
 			uvTransformMatrix = Multiply(uvTransformMatrix, MakeRotateZMatrix(uvTransformSprite.rotate.z));
 			uvTransformMatrix = Multiply(uvTransformMatrix, MakeTranslateMatrix(uvTransformSprite.translate));
-			materialDataSprite->uvTransform = uvTransformMatrix;
+			materialDataSprite.uvTransform = uvTransformMatrix;
+
+			//======================================
+			// フレームの開始
+			//======================================
+			// このフレームの資源が空くまで待ち(GPUに一周追いついたときだけ)、そのアロケータで記録を始める
+			const uint32_t frameIndex = frameRing->BeginFrame();
+			hr = commandAllocators[frameIndex]->Reset();
+			assert(SUCCEEDED(hr));
+			hr = commandList->Reset(commandAllocators[frameIndex], nullptr);
+			assert(SUCCEEDED(hr));
+
+			// GPUが使い終わったディスクリプタを戻す
+			srvDescriptorAllocator.Retire(gpuTimeline->GetCompletedValue());
+
+			// 読み込みの済んだテクスチャを転送し、使えるようになったmipのSRVを作る
+			textureStreamer->Update();
+			for (StreamedTextureView& view : streamedTextureViews) {
+				updateStreamedTextureView(view);
+			}
+			const uint32_t textureSrvIndex = streamedTextureViews[0].srvIndex;
+			const uint32_t textureSrvIndex2 = streamedTextureViews[1].srvIndex;
+			if (!isTextureLoadLogged && textureStreamer->IsIdle()) {
+				const TextureStreamingStats& streamingStats = textureStreamer->GetStats();
+				// 焼き込み済みのDDSを使っているかは転送量(BC1なら1/8、BC3/BC7なら1/4)で分かる
+				Log(logStream, std::format("textures: {} resident, {} failed, first visible {:.1f}ms, all {:.1f}ms, decode {:.1f}ms, {:.2f} MB",
+					streamingStats.residentCount, streamingStats.failedCount, streamingStats.firstVisibleSeconds * 1000.0,
+					streamingStats.allResidentSeconds * 1000.0, streamingStats.decodeSeconds * 1000.0,
+					double(streamingStats.uploadedBytes) / (1024.0 * 1024.0)));
+				isTextureLoadLogged = true;
+			}
+			if (benchmarkStreamer) {
+				benchmarkStreamer->Update();
+				if (!isBenchmarkLogged && benchmarkStreamer->IsIdle()) {
+					const TextureStreamingStats& benchmarkStats = benchmarkStreamer->GetStats();
+					Log(logStream, std::format("texture benchmark: {} textures, first visible {:.1f}ms, first resident {:.1f}ms, all {:.1f}ms, decode {:.1f}ms",
+						benchmarkStats.requestedCount, benchmarkStats.firstVisibleSeconds * 1000.0, benchmarkStats.firstResidentSeconds * 1000.0,
+						benchmarkStats.allResidentSeconds * 1000.0, benchmarkStats.decodeSeconds * 1000.0));
+					isBenchmarkLogged = true;
+				}
+			}
+
+			// lightingの有効化
+			materialData.enableLighting = isEnableLighting;
+			materialDataModel.enableLighting = isEnableLighting;
+
+			// 定数をこのフレームのアップロードメモリに書き込む(GPUは前のフレームの値を読んでいる可能性がある)
+			LinearUploadAllocator& uploadAllocator = *frameUploadAllocators[frameIndex];
+			uploadAllocator.Reset();
+			auto uploadFrameConstant = [&](const auto& value) {
+				UploadAllocation allocation{};
+				bool isAllocated = uploadAllocator.AllocateConstant(value, allocation);
+				assert(isAllocated);
+				return D3D12_GPU_VIRTUAL_ADDRESS(allocation.gpuAddress);
+			};
+			const D3D12_GPU_VIRTUAL_ADDRESS materialAddress = uploadFrameConstant(materialData);
+			const D3D12_GPU_VIRTUAL_ADDRESS transformationMatrixAddress = uploadFrameConstant(transformationMatrixData);
+			const D3D12_GPU_VIRTUAL_ADDRESS directionalLightAddress = uploadFrameConstant(directionalLightData);
+			const D3D12_GPU_VIRTUAL_ADDRESS materialAddressModel = uploadFrameConstant(materialDataModel);
+			const D3D12_GPU_VIRTUAL_ADDRESS transformationMatrixAddressModel = uploadFrameConstant(transformationMatrixDataModel);
+			const D3D12_GPU_VIRTUAL_ADDRESS materialAddressSprite = uploadFrameConstant(materialDataSprite);
+			const D3D12_GPU_VIRTUAL_ADDRESS transformationMatrixAddressSprite = uploadFrameConstant(transformationMatrixDataSprite);
+
+			// インスタンスをマテリアル順に並べ、行列をStructuredBufferへ書き込む
+			D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = 0;
+			D3D12_GPU_VIRTUAL_ADDRESS instanceMaterialAddress = 0;
+			LinearUploadAllocator& instanceAllocator = *frameInstanceAllocators[frameIndex];
+			instanceAllocator.Reset();
+			if (isDrawInstances) {
+				// 数が変わったら格子状に並べ直す(マテリアルはばらばらに割り当てる)
+				if (sceneInstances.size() != size_t(instanceCount)) {
+					sceneInstances.resize(size_t(instanceCount));
+					const uint32_t side = uint32_t(std::ceil(std::cbrt(double(instanceCount))));
+					for (uint32_t i = 0; i < uint32_t(instanceCount); ++i) {
+						SceneInstance& instance = sceneInstances[i];
+						instance.transform.scale = { 0.4f, 0.4f, 0.4f };
+						instance.transform.rotate = { 0.0f, float(i) * 0.1f, 0.0f };
+						instance.transform.translate = {
+							(float(i % side) - float(side) * 0.5f) * 1.0f,
+							(float(i / side % side) - float(side) * 0.5f) * 1.0f,
+							float(i / (side * side)) * 1.0f + 5.0f };
+						instance.materialIndex = uint32_t((i * 2654435761u) >> 30) % kInstanceMaterialCount;
+					}
+					isInstanceBvhStale = true;
+					pickedInstance = -1;
+				}
+				for (uint32_t material = 0; material < kInstanceMaterialCount; ++material) {
+					InstanceMaterial& instanceMaterial = instanceMaterials[material];
+					instanceMaterial.color = material < 2 ? Vector4{ 1.0f, 1.0f, 1.0f, 1.0f } : Vector4{ 1.0f, 0.6f, 0.6f, 1.0f };
+					instanceMaterial.textureIndex = material % 2 == 0 ? textureSrvIndex : textureSrvIndex2;
+					instanceMaterial.enableLighting = isEnableLighting;
+				}
+
+				for (SceneInstance& instance : sceneInstances) {
+					instance.transform.rotate.y += 0.02f;
+				}
+
+				// 球の半径は1なので、一番大きい拡大率を境界球の半径にする
+				const std::chrono::steady_clock::time_point cullStart = std::chrono::steady_clock::now();
+				instanceBounds.resize(sceneInstances.size());
+				visibleInstanceIndices.resize(sceneInstances.size());
+				for (size_t i = 0; i < sceneInstances.size(); ++i) {
+					const Transform& transform = sceneInstances[i].transform;
+					instanceBounds[i] = { transform.translate,
+						std::fmax(std::fmax(std::fabs(transform.scale.x), std::fabs(transform.scale.y)), std::fabs(transform.scale.z)) };
+				}
+				// BVHは回転では変わらない境界箱で作る。数が変わったら作り直し、動かしたら箱だけ直す
+				if (isInstanceBvhStale || isInstanceBvhMoved) {
+					instanceBoxes.resize(instanceBounds.size());
+					for (size_t i = 0; i < instanceBounds.size(); ++i) {
+						const BoundingSphere& sphere = instanceBounds[i];
+						instanceBoxes[i] = {
+							{ sphere.center.x - sphere.radius, sphere.center.y - sphere.radius, sphere.center.z - sphere.radius },
+							{ sphere.center.x + sphere.radius, sphere.center.y + sphere.radius, sphere.center.z + sphere.radius } };
+					}
+					const std::chrono::steady_clock::time_point bvhStart = std::chrono::steady_clock::now();
+					if (isInstanceBvhStale) {
+						instanceBvh.Build(instanceBoxes.data(), instanceBoxes.size());
+					} else {
+						instanceBvh.Refit(instanceBoxes.data());
+					}
+					instanceBvhBuildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bvhStart).count();
+					isInstanceBvhStale = false;
+					isInstanceBvhMoved = false;
+				}
+				size_t visibleCount = sceneInstances.size();
+				if (isCullInstances && useInstanceBvh) {
+					visibleCount = instanceBvh.QueryFrustum(MakeFrustum(viewProjectionMatrix), visibleInstanceIndices.data());
+				} else if (isCullInstances) {
+					visibleCount = CullSpheres(MakeFrustum(viewProjectionMatrix), instanceBounds.data(), instanceBounds.size(), visibleInstanceIndices.data());
+				} else {
+					for (size_t i = 0; i < visibleCount; ++i) {
+						visibleInstanceIndices[i] = uint32_t(i);
+					}
+				}
+				visibleInstances.resize(visibleCount);
+				for (size_t i = 0; i < visibleCount; ++i) {
+					visibleInstances[i] = sceneInstances[visibleInstanceIndices[i]];
+				}
+				const double cullMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+				instanceCullMilliseconds += (cullMilliseconds - instanceCullMilliseconds) * 0.05;
+
+				// 画面をクリックしたら、カーソルの位置から奥へ伸ばした半直線で一番手前のインスタンスを選ぶ
+				if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !ImGui::GetIO().WantCaptureMouse) {
+					const ImVec2 mousePosition = ImGui::GetIO().MousePos;
+					const float ndcX = mousePosition.x / float(kClientWidth) * 2.0f - 1.0f;
+					const float ndcY = 1.0f - mousePosition.y / float(kClientHeight) * 2.0f;
+					const Matrix4x4 inverseViewProjection = Inverse(viewProjectionMatrix);
+					const Vector3 nearPoint = TransformPoint({ ndcX, ndcY, 0.0f }, inverseViewProjection);
+					const Vector3 farPoint = TransformPoint({ ndcX, ndcY, 1.0f }, inverseViewProjection);
+					const Ray ray = { nearPoint, { farPoint.x - nearPoint.x, farPoint.y - nearPoint.y, farPoint.z - nearPoint.z } };
+					RayHit hit{};
+					// directionは近平面から遠平面までなので、距離1までを調べる
+					if (instanceBvh.Raycast(ray, 1.0f, hit)) {
+						pickedInstance = int(hit.index);
+						const float rayLength = std::sqrt(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y + ray.direction.z * ray.direction.z);
+						pickedDistance = hit.distance * rayLength;
+					} else {
+						pickedInstance = -1;
+					}
+				}
+				// 選んだインスタンスの近く(境界箱を1広げた範囲)にあるインスタンスを数える
+				pickedNeighborCount = 0;
+				if (pickedInstance >= 0) {
+					BoundingBox neighborhood = instanceBoxes[pickedInstance];
+					neighborhood.min = { neighborhood.min.x - 1.0f, neighborhood.min.y - 1.0f, neighborhood.min.z - 1.0f };
+					neighborhood.max = { neighborhood.max.x + 1.0f, neighborhood.max.y + 1.0f, neighborhood.max.z + 1.0f };
+					pickedNeighborIndices.resize(instanceBoxes.size());
+					pickedNeighborCount = instanceBvh.QueryOverlap(neighborhood, pickedNeighborIndices.data()) - 1;
+				}
+
+				const std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+				UploadAllocation instanceAllocation{};
+				bool isAllocated = instanceAllocator.Allocate(sizeof(InstanceData) * std::max<size_t>(visibleInstances.size(), 1), LinearUploadAllocator::kConstantBufferAlignment, instanceAllocation);
+				assert(isAllocated);
+				instanceBatchBuilder.Build(visibleInstances.data(), visibleInstances.size(), kInstanceMaterialCount, viewProjectionMatrix,
+					static_cast<InstanceData*>(instanceAllocation.cpuAddress));
+				const double buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+				instanceBuildMilliseconds += (buildMilliseconds - instanceBuildMilliseconds) * 0.05;
+				instanceAddress = instanceAllocation.gpuAddress;
+
+				UploadAllocation materialAllocation{};
+				isAllocated = uploadAllocator.Allocate(sizeof(instanceMaterials), LinearUploadAllocator::kConstantBufferAlignment, materialAllocation);
+				assert(isAllocated);
+				std::memcpy(materialAllocation.cpuAddress, instanceMaterials, sizeof(instanceMaterials));
+				instanceMaterialAddress = materialAllocation.gpuAddress;
+			}
 
 			// これから書き込むバックバッファのインデックスを取得
 			UINT backBufferIndex = swapChain->GetCurrentBackBufferIndex();
@@ -979,27 +1560,45 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			commandList->RSSetViewports(1, &viewport);
 			commandList->RSSetScissorRects(1, &scissorRect);
 			commandList->SetGraphicsRootSignature(rootSignature);
-			commandList->SetPipelineState(graphicsPipelineState);
-			commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+			// テーブルはヒープの先頭に固定し、描画ごとにルート定数でテクスチャの番号を渡す
+			commandList->SetGraphicsRootDescriptorTable(2, srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+			commandList->SetPipelineState(usePackedVertex ? graphicsPipelineStatePacked : graphicsPipelineState);
+			commandList->IASetVertexBuffers(0, 1, usePackedVertex ? &vertexBufferViewPacked : &vertexBufferView);
+			commandList->IASetIndexBuffer(&indexBufferView);
 			commandList->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 			// マテリアルCBufferの場所を設定
-			commandList->SetGraphicsRootConstantBufferView(0, materialResource->GetGPUVirtualAddress());
-			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResource->GetGPUVirtualAddress());
-			commandList->SetGraphicsRootDescriptorTable(2, useMonsterBall ? textureSrvHandleGPU2 : textureSrvHandleGPU);
-			commandList->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
-			// lightingの有効化
-			if (isEnableLighting) {
-				materialData->enableLighting = true;
-			} else {
-				materialData->enableLighting = false;
+			commandList->SetGraphicsRootConstantBufferView(0, materialAddress);
+			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixAddress);
+			commandList->SetGraphicsRoot32BitConstant(4, useMonsterBall ? textureSrvIndex2 : textureSrvIndex, 0);
+			commandList->SetGraphicsRootConstantBufferView(3, directionalLightAddress);
+			const MeshLod& sphereLod = sphereLodChain.lods[sphereLodLevel];
+			commandList->DrawIndexedInstanced(sphereLod.indexCount, 1, sphereLod.indexStart, 0, 0);
+			// インスタンス(LODは1つの球と同じ段階を使う)
+			if (isDrawInstances && !visibleInstances.empty()) {
+				commandList->SetPipelineState(graphicsPipelineStateInstanced);
+				commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+				commandList->SetGraphicsRootShaderResourceView(5, instanceAddress);
+				commandList->SetGraphicsRootShaderResourceView(6, instanceMaterialAddress);
+				commandList->DrawIndexedInstanced(sphereLod.indexCount, UINT(visibleInstances.size()), sphereLod.indexStart, 0, 0);
+			}
+			// model
+			commandList->SetPipelineState(graphicsPipelineState);
+			if (isDrawModel) {
+				commandList->IASetVertexBuffers(0, 1, &vertexBufferViewModel);
+				commandList->IASetIndexBuffer(&indexBufferViewModel);
+				commandList->SetGraphicsRootConstantBufferView(0, materialAddressModel);
+				commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixAddressModel);
+				commandList->SetGraphicsRoot32BitConstant(4, textureSrvIndex, 0);
+				for (const ModelSubset& subset : modelData.subsets) {
+					commandList->DrawIndexedInstanced(subset.indexCount, 1, subset.indexStart, 0, 0);
+				}
 			}
-			commandList->DrawInstanced(kSubdivision * kSubdivision * 6, 1, 0, 0);
 			// 2d
-			commandList->SetGraphicsRootConstantBufferView(0, materialResourceSprite->GetGPUVirtualAddress());
+			commandList->SetGraphicsRootConstantBufferView(0, materialAddressSprite);
 			commandList->IASetVertexBuffers(0, 1, &vertexBufferViewSprite);
 			commandList->IASetIndexBuffer(&indexBufferViewSprite);
-			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixResourceSprite->GetGPUVirtualAddress());
-			commandList->SetGraphicsRootDescriptorTable(2, textureSrvHandleGPU);
+			commandList->SetGraphicsRootConstantBufferView(1, transformationMatrixAddressSprite);
+			commandList->SetGraphicsRoot32BitConstant(4, textureSrvIndex, 0);
 			if (isDrawSprite) {
 				commandList->DrawIndexedInstanced(6, 1, 0, 0, 0);
 			}
@@ -1015,27 +1614,28 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			ID3D12CommandList* commandLists[] = { commandList };
 			commandQueue->ExecuteCommandLists(1, commandLists);
 			swapChain->Present(1, 0);
-			// fenceの値を更新
-			fenceValue++;
-			// signalを送る
-			commandQueue->Signal(fence, fenceValue);
-			// signalにたどり着いたかを確認
-			if (fence->GetCompletedValue() < fenceValue) {
-				// たどり着くまで待つように設定
-				fence->SetEventOnCompletion(fenceValue, fenceEvent);
-				// イベントを待つ
-				WaitForSingleObject(fenceEvent, INFINITE);
+			// signalを送る(このフレームの資源はGPUがたどり着くまで再利用しない)
+			// このフレームまでに解放したディスクリプタは、このシグナルを過ぎたら使い回す
+			srvDescriptorAllocator.Submit(frameRing->EndFrame());
+			if (frameRing->GetStats().frameCount == 1) {
+				Log(logStream, std::format("time to first frame: {:.1f}ms",
+					std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - appStartTime).count()));
 			}
 
-			hr = commandAllocator->Reset();
-			assert(SUCCEEDED(hr));
-			hr = commandList->Reset(commandAllocator, nullptr);
-			assert(SUCCEEDED(hr));
-
 
 		}
 	}
 
+	// GPUがすべてのフレームを処理し終えてから解放する
+	frameRing->WaitForIdle();
+	textureUploader->WaitForIdle();
+	// 読み込みのワーカーを止め、読み込んだテクスチャを解放する
+	benchmarkStreamer.reset();
+	textureStreamer.reset();
+	const FrameRingStats& frameStats = frameRing->GetStats();
+	Log(logStream, std::format("frames {}, in flight {}: overlap {} frames, stall {} frames ({:.3f}ms)",
+		frameStats.frameCount, frameRing->GetFrameCount(), frameStats.overlapFrameCount, frameStats.stallCount, frameStats.stallSeconds * 1000.0));
+
 	// COMの終了処理
 	CoUninitialize();
 
@@ -1045,15 +1645,20 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	ImGui::DestroyContext();
 
 	// 解放処理
-	CloseHandle(fenceEvent);
-	fence->Release();
+	textureUploader.reset();
+	frameRing.reset();
+	gpuTimeline.reset();
+	for (uint32_t i = 0; i < kMaxFramesInFlight; ++i) {
+		frameUploadAllocators[i].reset();
+		frameInstanceAllocators[i].reset();
+		commandAllocators[i]->Release();
+	}
 	rtvDescriptorHeap->Release();
 	srvDescriptorHeap->Release();
 	swapChainResources[0]->Release();
 	swapChainResources[1]->Release();
 	swapChain->Release();
 	commandList->Release();
-	commandAllocator->Release();
 	commandQueue->Release();
 	device->Release();
 	useAdapter->Release();
@@ -1061,8 +1666,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 #ifdef _DEBUG
 	debugController->Release();
 #endif // _DEBUG
-	vertexResource->Release();
+	resourceAllocator->ReleaseResource(vertexResource);
+	resourceAllocator->ReleaseResource(vertexResourcePacked);
+	resourceAllocator->ReleaseResource(indexResource);
 	graphicsPipelineState->Release();
+	graphicsPipelineStatePacked->Release();
+	graphicsPipelineStateInstanced->Release();
 	signatureBlob->Release();
 	if (errorBlob) {
 		errorBlob->Release();
@@ -1070,17 +1679,17 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	rootSignature->Release();
 	pixelShaderBlob->Release();
 	vertexShaderBlob->Release();
-	materialResource->Release();
-	materialResourceSprite->Release();
-	directionalLightResource->Release();
-	textureResource->Release();
-	textureResource2->Release();
-	transformationMatrixResource->Release();
-	depthStencilResource->Release();
+	vertexShaderBlobPacked->Release();
+	vertexShaderBlobInstanced->Release();
+	pixelShaderBlobInstanced->Release();
+	resourceAllocator->ReleaseResource(placeholderTexture);
+	resourceAllocator->ReleaseResource(vertexResourceModel);
+	resourceAllocator->ReleaseResource(indexResourceModel);
+	resourceAllocator->ReleaseResource(depthStencilResource);
 	dsvDescriptorHeap->Release();
-	vertexResourceSprite->Release();
-	transformationMatrixResourceSprite->Release();
-	indexResourceSprite->Release();
+	resourceAllocator->ReleaseResource(vertexResourceSprite);
+	resourceAllocator->ReleaseResource(indexResourceSprite);
+	resourceAllocator.reset();
 	CloseWindow(hwnd);
 
 	// リソースチェック
@@ -1233,13 +1842,10 @@ IDxcBlob* CompileShader(
 /// <summary>
 /// CreateBufferResource関数
 /// </summary>
-/// <param name="device">device</param>
+/// <param name="allocator">リソースを置くヒープのアロケータ</param>
 /// <param name="sizeInBytes">sizeInBytes</param>
 /// <returns>BufferResource</returns>
-ID3D12Resource* CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
-	// 頂点リソース用のヒープを設定
-	D3D12_HEAP_PROPERTIES uploadHeapProperties{};
-	uploadHeapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+ID3D12Resource* CreateBufferResource(D3D12ResourceAllocator& allocator, size_t sizeInBytes) {
 	// 頂点リソースの設定
 	D3D12_RESOURCE_DESC BufferResourceDesc{};
 	// バッファリソース
@@ -1250,295 +1856,15 @@ ID3D12Resource* CreateBufferResource(ID3D12Device* device, size_t sizeInBytes) {
 	BufferResourceDesc.MipLevels = 1;
 	BufferResourceDesc.SampleDesc.Count = 1;
 	BufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	// 実際に頂点リソースを作る
-	ID3D12Resource* BufferResource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(&uploadHeapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&BufferResourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&BufferResource)
+	// 実際に頂点リソースを作る(UPLOADヒープに配置する)
+	ID3D12Resource* BufferResource = allocator.CreateResource(D3D12HeapPoolType::UploadBuffer,
+		BufferResourceDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ
 	);
-	assert(SUCCEEDED(hr));
+	assert(BufferResource != nullptr);
 	return BufferResource;
 }
 
-/// <summary>
-/// 4x4の単位行列の作成
-/// </summary>
-/// <returns>4x4の単位行列</returns>
-Matrix4x4 MakeIdentityMatrix4x4() {
-	Matrix4x4 identityMatrix;
-
-	identityMatrix.m[0][0] = 1.0f;
-	identityMatrix.m[0][1] = 0.0f;
-	identityMatrix.m[0][2] = 0.0f;
-	identityMatrix.m[0][3] = 0.0f;
-
-	identityMatrix.m[1][0] = 0.0f;
-	identityMatrix.m[1][1] = 1.0f;
-	identityMatrix.m[1][2] = 0.0f;
-	identityMatrix.m[1][3] = 0.0f;
-
-	identityMatrix.m[2][0] = 0.0f;
-	identityMatrix.m[2][1] = 0.0f;
-	identityMatrix.m[2][2] = 1.0f;
-	identityMatrix.m[2][3] = 0.0f;
-
-	identityMatrix.m[3][0] = 0.0f;
-	identityMatrix.m[3][1] = 0.0f;
-	identityMatrix.m[3][2] = 0.0f;
-	identityMatrix.m[3][3] = 1.0f;
-
-	return identityMatrix;
-}
-
-/// <summary>
-/// 4x4の拡縮行列を作成
-/// </summary>
-/// <param name="scale">scaleの変数</param>
-/// <returns>4x4の拡縮行列</returns>
-Matrix4x4 MakeScaleMatrix(Vector3 scale) {
-	Matrix4x4 scaleMatirx;
-
-	scaleMatirx.m[0][0] = scale.x;
-	scaleMatirx.m[0][1] = 0.0f;
-	scaleMatirx.m[0][2] = 0.0f;
-	scaleMatirx.m[0][3] = 0.0f;
-
-	scaleMatirx.m[1][0] = 0.0f;
-	scaleMatirx.m[1][1] = scale.y;
-	scaleMatirx.m[1][2] = 0.0f;
-	scaleMatirx.m[1][3] = 0.0f;
-
-	scaleMatirx.m[2][0] = 0.0f;
-	scaleMatirx.m[2][1] = 0.0f;
-	scaleMatirx.m[2][2] = scale.z;
-	scaleMatirx.m[2][3] = 0.0f;
-
-	scaleMatirx.m[3][0] = 0.0f;
-	scaleMatirx.m[3][1] = 0.0f;
-	scaleMatirx.m[3][2] = 0.0f;
-	scaleMatirx.m[3][3] = 1.0f;
-
-	return scaleMatirx;
-}
-
-/// <summary>
-/// z軸の回転行列を作成
-/// </summary>
-/// <param name="rotateZ">rotateZの変数</param>
-/// <returns>z軸の回転行列</returns>
-Matrix4x4 MakeRotateZMatrix(float rotateZ) {
-	Matrix4x4 rotateZMatrix;
-
-	rotateZMatrix = {
-		cosf(rotateZ), sinf(rotateZ), 0.0f, 0.0f,
-		-sinf(rotateZ), cosf(rotateZ), 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
-	};
-
-	return rotateZMatrix;
-}
-
-/// <summary>
-/// MakeAffineMatrix関数
-/// </summary>
-/// <param name="scale">拡縮</param>
-/// <param name="rotate">回転</param>
-/// <param name="translate">移動</param>
-/// <returns>4x4アフィン行列</returns>
-Matrix4x4 MakeAffineMatrix(Vector3 scale, Vector3 rotate, Vector3 translate) {
-	Matrix4x4 affineMatrix;
-
-	// 回転行列を作成（Euler角を使用）
-	float cosX = cosf(rotate.x);
-	float sinX = sinf(rotate.x);
-	float cosY = cosf(rotate.y);
-	float sinY = sinf(rotate.y);
-	float cosZ = cosf(rotate.z);
-	float sinZ = sinf(rotate.z);
-
-	// 回転行列（X軸回転）
-	Matrix4x4 rotateX = {
-		1.0f,  0.0f, 0.0f, 0.0f,
-		0.0f, cosX, sinX, 0.0f,
-		0.0f, -sinX,  cosX, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
-	};
-
-	// 回転行列（Y軸回転）
-	Matrix4x4 rotateY = {
-		cosY, 0.0f, -sinY, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		sinY, 0.0f, cosY, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
-	};
-
-	// 回転行列（Z軸回転）
-	Matrix4x4 rotateZ = {
-		cosZ, sinZ, 0.0f, 0.0f,
-		-sinZ, cosZ, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
-	};
-
-	// 回転行列を合成
-	Matrix4x4 rotationMatrix = Multiply(rotateX, Multiply(rotateY, rotateZ));
-
-	// スケーリング行列
-	Matrix4x4 scaleMatrix = {
-		scale.x, 0.0f, 0.0f, 0.0f,
-		0.0f, scale.y, 0.0f, 0.0f,
-		0.0f, 0.0f, scale.z, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
-	};
-
-	// 平行移動行列
-	Matrix4x4 translateMatrix = {
-		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		translate.x, translate.y, translate.z, 1.0f
-	};
-
-	affineMatrix = Multiply(translateMatrix, Multiply(scaleMatrix, rotationMatrix));
-
-	return affineMatrix;
-}
-
-/// <summary>
-/// 平行移動行列の作成
-/// </summary>
-/// <param name="translate"></param>
-/// <returns></returns>
-Matrix4x4 MakeTranslateMatrix(Vector3 translate) {
-	Matrix4x4 translateMatrix;
-
-	translateMatrix = {
-		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		translate.x, translate.y, translate.z, 1.0f
-	};
-
-	return translateMatrix;
-}
-
-/// <summary>
-/// 4x4行列の乗算
-/// </summary>
-/// <param name="matrix1">4x4行列 1</param>
-/// <param name="matrix2">4x4行列 2</param>
-/// <returns>4x4行列の乗算</returns>
-Matrix4x4 Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2) {
-	Matrix4x4 multiplyMatrix;
-	float multiply[4];  // 4x4行列に合わせてサイズを変更
-
-	for (int row = 0; row < 4; row++) {
-		for (int column = 0; column < 4; column++) {
-			for (int i = 0; i < 4; i++) {
-				multiply[i] = matrix1.m[row][i] * matrix2.m[i][column];
-			}
-			multiplyMatrix.m[row][column] = multiply[0] + multiply[1] + multiply[2] + multiply[3];
-		}
-	}
-
-	return multiplyMatrix;
-}
-
-/// <summary>
-/// MakePerspectiveFovMatirx関数
-/// </summary>
-/// <param name="fovY">画角</param>
-/// <param name="aspectRaito">アスペクト比</param>
-/// <param name="nearClip">近平面への距離</param>
-/// <param name="farClip">遠平面への距離</param>
-/// <returns>透視射影行列</returns>
-Matrix4x4 MakePerspectiveFovMatirx(float fovY, float aspectRaito, float nearClip, float farClip) {
-	Matrix4x4 perspectiveFovMatirx;
-
-	perspectiveFovMatirx = {
-		1.0f / aspectRaito * (cosf(fovY / 2.0f) / sinf(fovY / 2.0f)), 0.0f, 0.0f, 0.0f,
-		0.0f, (cosf(fovY / 2.0f) / sinf(fovY / 2.0f)), 0.0f, 0.0f,
-		0.0f, 0.0f, farClip / farClip - nearClip, 1.0f,
-		0.0f, 0.0f, -nearClip * farClip / (farClip - nearClip), 0.0f
-	};
-
-	return perspectiveFovMatirx;
-}
-
-/// <summary>
-/// 4x4の逆行列の作成
-/// </summary>
-/// <param name="matrix">元の行列</param>
-/// <returns>逆行列</returns>
-Matrix4x4 Inverse(Matrix4x4 matrix) {
-	Matrix4x4 inverseMatrix;
-	float determinant;
-
-	// 4x4行列の行列式を計算
-	determinant = matrix.m[0][0] * Determinant3x3(matrix, 0, 0)
-		- matrix.m[0][1] * Determinant3x3(matrix, 0, 1)
-		+ matrix.m[0][2] * Determinant3x3(matrix, 0, 2)
-		- matrix.m[0][3] * Determinant3x3(matrix, 0, 3);
-
-	// 余因子行列を求める
-	Matrix4x4 cofactorMatrix;
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			cofactorMatrix.m[i][j] = ((i + j) % 2 == 0 ? 1 : -1) * Determinant3x3(matrix, i, j);
-		}
-	}
-
-	// 余因子行列の転置を求める（余因子行列の転置は共役行列に相当）
-	Matrix4x4 adjugateMatrix;
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			adjugateMatrix.m[i][j] = cofactorMatrix.m[j][i];
-		}
-	}
-
-	// 逆行列 = (1 / 行列式) * 共役行列
-	float invDet = 1.0f / determinant;
-	for (int i = 0; i < 4; i++) {
-		for (int j = 0; j < 4; j++) {
-			inverseMatrix.m[i][j] = adjugateMatrix.m[i][j] * invDet;
-		}
-	}
-
-	return inverseMatrix;
-}
-
-/// <summary>
-/// 3x3の行列式を計算する関数
-/// </summary>
-/// <param name="matrix">元の4x4行列</param>
-/// <param name="row">対象の行</param>
-/// <param name="col">対象の列</param>
-/// <returns>3x3行列の行列式</returns>
-float Determinant3x3(Matrix4x4 matrix, int row, int col) {
-	// 3x3の部分行列を取得
-	float m[3][3];
-	int mRow = 0;
-	for (int i = 0; i < 4; i++) {
-		if (i == row) continue;
-		int mCol = 0;
-		for (int j = 0; j < 4; j++) {
-			if (j == col) continue;
-			m[mRow][mCol] = matrix.m[i][j];
-			mCol++;
-		}
-		mRow++;
-	}
-
-	// 3x3の行列式を計算
-	return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
-		- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
-		+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
-}
-
 /// <summary>
 /// CreateDescriptorHeap関数
 /// </summary>
@@ -1560,30 +1886,13 @@ ID3D12DescriptorHeap* CreateDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTO
 	return descriptorHeap;
 }
 
-/// <summary>
-/// LoadTexture関数
-/// </summary>
-/// <param name="filePath">filePath</param>
-/// <returns>mipImages</returns>
-DirectX::ScratchImage LoadTexture(const std::string& filePath) {
-	DirectX::ScratchImage image{};
-	std::wstring filePathW = ConvertString(filePath);
-	HRESULT hr = DirectX::LoadFromWICFile(filePathW.c_str(), DirectX::WIC_FLAGS_FORCE_SRGB, nullptr, image);
-	assert(SUCCEEDED(hr));
-
-	DirectX::ScratchImage mipImages{};
-	hr = DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, mipImages);
-	assert(SUCCEEDED(hr));
-	return mipImages;
-}
-
 /// <summary>
 /// CreateTextureResource関数
 /// </summary>
-/// <param name="device">device</param>
+/// <param name="allocator">リソースを置くヒープのアロケータ</param>
 /// <param name="metadata">metadata</param>
 /// <returns>resource</returns>
-ID3D12Resource* CreateTextureResource(ID3D12Device* device, const DirectX::TexMetadata& metadata) {
+ID3D12Resource* CreateTextureResource(D3D12ResourceAllocator& allocator, const DirectX::TexMetadata& metadata) {
 	// metadataをもとにresourceを設定
 	D3D12_RESOURCE_DESC resourceDesc{};
 	resourceDesc.Width = UINT(metadata.width);
@@ -1594,59 +1903,24 @@ ID3D12Resource* CreateTextureResource(ID3D12Device* device, const DirectX::TexMe
 	resourceDesc.SampleDesc.Count = 1;
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION(metadata.dimension);
 
-	// 利用するheapの設定
-	D3D12_HEAP_PROPERTIES heapProperties{};
-	heapProperties.Type = D3D12_HEAP_TYPE_CUSTOM;
-	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK;
-	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
-
-	// Resourceの作成
-	ID3D12Resource* resource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(
-		&heapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&resourceDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&resource)
+	// Resourceの作成(テクスチャ用のDEFAULTヒープに配置し、コピーで書き込む)
+	ID3D12Resource* resource = allocator.CreateResource(D3D12HeapPoolType::Texture,
+		resourceDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST
 	);
-	assert(SUCCEEDED(hr));
+	assert(resource != nullptr);
 
 	return resource;
 }
 
-/// <summary>
-/// UploadTextureData関数
-/// </summary>
-/// <param name="texture">texture</param>
-/// <param name="mipImages">mipImages</param>
-void UploadTextureData(ID3D12Resource* texture, const DirectX::ScratchImage& mipImages) {
-	// Meta情報を取得
-	const DirectX::TexMetadata& metadata = mipImages.GetMetadata();
-	// 全MipMapについて
-	for (size_t mipLevel = 0; mipLevel < metadata.mipLevels; ++mipLevel) {
-		// mipLevelを指定して各Imageを取得
-		const DirectX::Image* img = mipImages.GetImage(mipLevel, 0, 0);
-		// Textureに転送
-		HRESULT hr = texture->WriteToSubresource(
-			UINT(mipLevel),
-			nullptr,
-			img->pixels,
-			UINT(img->rowPitch),
-			UINT(img->slicePitch)
-		);
-		assert(SUCCEEDED(hr));
-	}
-}
-
 /// <summary>
 /// CreateDepthStencilTextureResource関数
 /// </summary>
-/// <param name="device">device</param>
+/// <param name="allocator">リソースを置くヒープのアロケータ</param>
 /// <param name="width">width</param>
 /// <param name="height">height</param>
 /// <returns>depthStencilResource</returns>
-ID3D12Resource* CreateDepthStencilTextureResource(ID3D12Device* device, int32_t width, int32_t height) {
+ID3D12Resource* CreateDepthStencilTextureResource(D3D12ResourceAllocator& allocator, int32_t width, int32_t height) {
 	// 生成するresourceの設定
 	D3D12_RESOURCE_DESC resourceDesc{};
 	resourceDesc.Width = width;
@@ -1658,65 +1932,21 @@ ID3D12Resource* CreateDepthStencilTextureResource(ID3D12Device* device, int32_t
 	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 	resourceDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
 
-	// 利用するheapの設定
-	D3D12_HEAP_PROPERTIES heapProperties{};
-	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-
 	// 深度値のクリア設定
 	D3D12_CLEAR_VALUE depthClearValue{};
 	depthClearValue.DepthStencil.Depth = 1.0f;
 	depthClearValue.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
 
-	// resourceの生成
-	ID3D12Resource* resource = nullptr;
-	HRESULT hr = device->CreateCommittedResource(
-		&heapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&resourceDesc,
+	// resourceの生成(レンダーターゲット用のヒープに配置する)
+	ID3D12Resource* resource = allocator.CreateResource(D3D12HeapPoolType::RenderTarget,
+		resourceDesc,
 		D3D12_RESOURCE_STATE_DEPTH_WRITE,
-		&depthClearValue,
-		IID_PPV_ARGS(&resource)
+		&depthClearValue
 	);
-	assert(SUCCEEDED(hr));
+	assert(resource != nullptr);
 	return resource;
 }
 
-/// <summary>
-/// MakeOrthographicMatrix関数
-/// </summary>
-/// <param name="left">left</param>
-/// <param name="top">top</param>
-/// <param name="right">right</param>
-/// <param name="bottom">bottom</param>
-/// <param name="nearClip">nearClip</param>
-/// <param name="farClip">farClip</param>
-/// <returns>3次元正射影行列</returns>
-Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
-	Matrix4x4 orthographicMatrix;
-
-	orthographicMatrix.m[0][0] = 2.0f / (right - left);
-	orthographicMatrix.m[0][1] = 0.0f;
-	orthographicMatrix.m[0][2] = 0.0f;
-	orthographicMatrix.m[0][3] = 0.0f;
-
-	orthographicMatrix.m[1][0] = 0.0f;
-	orthographicMatrix.m[1][1] = 2.0f / (top - bottom);
-	orthographicMatrix.m[1][2] = 0.0f;
-	orthographicMatrix.m[1][3] = 0.0f;
-
-	orthographicMatrix.m[2][0] = 0.0f;
-	orthographicMatrix.m[2][1] = 0.0f;
-	orthographicMatrix.m[2][2] = 1.0f / (farClip - nearClip);
-	orthographicMatrix.m[2][3] = 0.0f;
-
-	orthographicMatrix.m[3][0] = (left + right) / (left - right);
-	orthographicMatrix.m[3][1] = (top + bottom) / bottom - top;
-	orthographicMatrix.m[3][2] = (nearClip) / (nearClip - farClip);
-	orthographicMatrix.m[3][3] = 1.0f;
-
-	return orthographicMatrix;
-}
-
 /// <summary>
 /// GetCPUDescriptorHandle関数
 /// </summary>
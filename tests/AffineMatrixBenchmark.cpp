@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "AffineMatrixReference.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+// アフィン行列の作り方ごとの速さ(百万行列/秒)
+// 使い方: AffineMatrixBenchmark [Transformの数(既定は100万)]
+int main(int argc, char** argv) {
+	const size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+	std::vector<Transform> transforms(count);
+	std::vector<Quaternion> quaternions(count);
+	for (size_t i = 0; i < count; i++) {
+		transforms[i] = { { value(random), value(random), value(random) }, { value(random), value(random), value(random) },
+			{ value(random), value(random), value(random) } };
+		quaternions[i] = MakeRotateQuaternion(transforms[i].rotate);
+	}
+	const Matrix4x4 viewProjection = MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 100.0f);
+	std::vector<TransformationMatrix> outputs(count);
+
+	// bodyをcount回呼んだときの百万回/秒
+	auto measure = [&](auto&& body) {
+		BenchmarkTimer timer;
+		for (size_t i = 0; i < count; i++) {
+			body(i);
+		}
+		return count / timer.GetElapsedMilliseconds() / 1000.0;
+	};
+
+	std::printf("%zu transforms, Mmatrices/s\n", count);
+	std::printf("level  4-multiply  closed  euler->quat  quaternion  world+WVP(old)  world+WVP(fused)\n");
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		SetMatrixMathLevel(level);
+		if (GetMatrixMathLevel() != level) {
+			continue;
+		}
+		const double byMultiply = measure([&](size_t i) {
+			const Transform& t = transforms[i];
+			outputs[i].world = MakeAffineMatrixByMultiply(t.scale, t.rotate, t.translate);
+		});
+		const double closed = measure([&](size_t i) {
+			const Transform& t = transforms[i];
+			outputs[i].world = MakeAffineMatrix(t.scale, t.rotate, t.translate);
+		});
+		const double eulerQuaternion = measure([&](size_t i) {
+			const Transform& t = transforms[i];
+			outputs[i].world = MakeAffineMatrix(t.scale, MakeRotateQuaternion(t.rotate), t.translate);
+		});
+		const double quaternion = measure([&](size_t i) {
+			const Transform& t = transforms[i];
+			outputs[i].world = MakeAffineMatrix(t.scale, quaternions[i], t.translate);
+		});
+		const double separate = measure([&](size_t i) {
+			const Transform& t = transforms[i];
+			outputs[i].world = MakeAffineMatrixByMultiply(t.scale, t.rotate, t.translate);
+			outputs[i].WVP = Multiply(outputs[i].world, viewProjection);
+		});
+		const double fused = measure([&](size_t i) {
+			outputs[i] = MakeTransformationMatrix(transforms[i], viewProjection);
+		});
+		std::printf("%-6s %10.1f %7.1f %12.1f %11.1f %15.1f %17.1f\n",
+			GetSimdLevelName(level), byMultiply, closed, eulerQuaternion, quaternion, separate, fused);
+	}
+
+	// 最適化で計算が消されないように結果を使う
+	double checksum = 0.0;
+	for (const TransformationMatrix& output : outputs) {
+		checksum += output.world.m[3][0] + output.WVP.m[3][3];
+	}
+	std::printf("checksum %g\n", checksum);
+	return 0;
+}
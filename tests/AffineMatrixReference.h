@@ -0,0 +1,63 @@
+#pragma once
+#include <cmath>
+#include "MatrixMath.h"
+
+/// <summary>
+/// 閉じた式にする前のMakeAffineMatrix(回転・拡縮・移動の行列を4回掛ける)
+/// テストとベンチマークの比較用に元の実装をそのまま残す
+/// </summary>
+inline Matrix4x4 MakeAffineMatrixByMultiply(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	const float cosX = std::cos(rotate.x);
+	const float sinX = std::sin(rotate.x);
+	const float cosY = std::cos(rotate.y);
+	const float sinY = std::sin(rotate.y);
+	const float cosZ = std::cos(rotate.z);
+	const float sinZ = std::sin(rotate.z);
+
+	const Matrix4x4 rotateX = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, cosX, sinX, 0.0f,
+		0.0f, -sinX, cosX, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const Matrix4x4 rotateY = {
+		cosY, 0.0f, -sinY, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		sinY, 0.0f, cosY, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const Matrix4x4 rotateZ = {
+		cosZ, sinZ, 0.0f, 0.0f,
+		-sinZ, cosZ, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const Matrix4x4 rotationMatrix = Multiply(rotateX, Multiply(rotateY, rotateZ));
+	const Matrix4x4 scaleMatrix = {
+		scale.x, 0.0f, 0.0f, 0.0f,
+		0.0f, scale.y, 0.0f, 0.0f,
+		0.0f, 0.0f, scale.z, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const Matrix4x4 translateMatrix = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		translate.x, translate.y, translate.z, 1.0f
+	};
+	return Multiply(translateMatrix, Multiply(scaleMatrix, rotationMatrix));
+}
+
+/// <summary>
+/// 要素ごとの相対誤差の最大(絶対値が1未満の要素は絶対誤差)
+/// </summary>
+inline float MaxRelativeDifference(const Matrix4x4& actual, const Matrix4x4& expected) {
+	float difference = 0.0f;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			const float scale = std::fmax(1.0f, std::fabs(expected.m[row][column]));
+			difference = std::fmax(difference, std::fabs(actual.m[row][column] - expected.m[row][column]) / scale);
+		}
+	}
+	return difference;
+}
@@ -0,0 +1,38 @@
+#include <random>
+#include "AffineMatrixReference.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+// 閉じた式のMakeAffineMatrix、クォータニオン版、MakeTransformationMatrixを
+// 4回掛ける元の実装と命令セットごとに比べる
+int main() {
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		SetMatrixMathLevel(level);
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+		const Matrix4x4 viewProjection = MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 100.0f);
+		float closedError = 0.0f;
+		float quaternionError = 0.0f;
+		float fusedError = 0.0f;
+		for (int n = 0; n < 100000; n++) {
+			const Vector3 scale{ value(random), value(random), value(random) };
+			const Vector3 rotate{ value(random), value(random), value(random) };
+			const Vector3 translate{ value(random), value(random), value(random) };
+			const Matrix4x4 expected = MakeAffineMatrixByMultiply(scale, rotate, translate);
+
+			closedError = std::fmax(closedError, MaxRelativeDifference(MakeAffineMatrix(scale, rotate, translate), expected));
+			quaternionError = std::fmax(quaternionError,
+				MaxRelativeDifference(MakeAffineMatrix(scale, MakeRotateQuaternion(rotate), translate), expected));
+
+			const TransformationMatrix fused = MakeTransformationMatrix({ scale, rotate, translate }, viewProjection);
+			fusedError = std::fmax(fusedError, MaxRelativeDifference(fused.world, expected));
+			fusedError = std::fmax(fusedError, MaxRelativeDifference(fused.WVP, Multiply(expected, viewProjection)));
+		}
+		std::printf("%-6s closed %.2g quaternion %.2g fused %.2g\n", GetSimdLevelName(GetMatrixMathLevel()), closedError, quaternionError, fusedError);
+		TEST_CHECK(closedError < 4e-6f);
+		TEST_CHECK(quaternionError < 1e-5f);
+		TEST_CHECK(fusedError < 1e-5f);
+	}
+	SetMatrixMathLevel(GetSimdLevel());
+	return FinishTest();
+}
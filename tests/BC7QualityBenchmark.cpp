@@ -0,0 +1,102 @@
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "DirectXTex.h"
+#include "TestCommon.h"
+#include "TestImage.h"
+
+namespace {
+
+/// <summary>
+/// 比べる品質
+/// </summary>
+struct QualityLevel {
+	const char* name;
+	DirectX::TEX_COMPRESS_FLAGS flags;
+	bool isSlow;
+};
+
+/// <summary>
+/// 品質ごとの合計
+/// </summary>
+struct LevelTotal {
+	double milliseconds = 0.0;
+	double squaredError = 0.0;
+	double sampleCount = 0.0;
+	double blockCount = 0.0;
+};
+
+} // namespace
+
+// BC7の品質(fast/normal/slowと3サブセット)ごとの圧縮時間とPSNR(RGBA)
+// 1スレッドで圧縮する(TEX_COMPRESS_PARALLELは付けない)
+// 使い方: BC7QualityBenchmark [--no-slow] [PNGファイル...](PNGはlibpngがあるときだけ読める)
+int main(int argc, char** argv) {
+	bool isSlowSkipped = false;
+	std::vector<const char*> paths;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--no-slow") == 0) {
+			isSlowSkipped = true;
+		} else {
+			paths.push_back(argv[i]);
+		}
+	}
+	// slowは1ブロックに数msかかるので小さめにする
+	std::vector<TestCorpusImage> corpus;
+	if (!MakeTestCorpus(paths, { { TestImageKind::Albedo, 256, 256 }, { TestImageKind::Gradient, 256, 256 }, { TestImageKind::Noise, 128, 128 },
+		{ TestImageKind::WavesAlpha, 254, 191 }, { TestImageKind::CheckerAlpha, 151, 129 }, { TestImageKind::FlatTiles, 256, 256 } }, corpus)) {
+		return 1;
+	}
+
+	const QualityLevel kLevels[] = {
+		{ "fast", DirectX::TEX_COMPRESS_BC7_QUALITY_FAST, false },
+		{ "normal", DirectX::TEX_COMPRESS_BC7_QUALITY_NORMAL, false },
+		{ "slow", DirectX::TEX_COMPRESS_BC7_QUALITY_SLOW, true },
+		{ "normal+3sub", DirectX::TEX_COMPRESS_BC7_USE_3SUBSETS, false },
+		{ "slow+3sub", DirectX::TEX_COMPRESS_BC7_QUALITY_SLOW | DirectX::TEX_COMPRESS_BC7_USE_3SUBSETS, true },
+	};
+	LevelTotal totals[std::size(kLevels)];
+	std::printf("%-16s %-12s %10s %9s %12s\n", "image", "level", "ms", "PSNR dB", "blocks/s");
+	for (const TestCorpusImage& entry : corpus) {
+		const DirectX::Image& source = *entry.image.GetImage(0, 0, 0);
+		const double blockCount = double((source.width + 3) / 4) * double((source.height + 3) / 4);
+		for (size_t level = 0; level < std::size(kLevels); level++) {
+			if (isSlowSkipped && kLevels[level].isSlow) {
+				continue;
+			}
+			DirectX::ScratchImage compressed;
+			BenchmarkTimer timer;
+			if (FAILED(DirectX::Compress(source, DXGI_FORMAT_BC7_UNORM, kLevels[level].flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed))) {
+				std::printf("%s: compression failed\n", entry.name.c_str());
+				return 1;
+			}
+			const double milliseconds = timer.GetElapsedMilliseconds();
+			DirectX::ScratchImage decompressed;
+			if (FAILED(DirectX::Decompress(*compressed.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, decompressed))) {
+				std::printf("%s: decompression failed\n", entry.name.c_str());
+				return 1;
+			}
+			double rgbError = 0.0;
+			double alphaError = 0.0;
+			ComputeImageSquaredError(source, *decompressed.GetImage(0, 0, 0), rgbError, alphaError);
+			const double sampleCount = 4.0 * double(source.width) * double(source.height);
+			std::printf("%-16s %-12s %10.1f %9.2f %12.0f\n", entry.name.c_str(), kLevels[level].name, milliseconds,
+				ComputePsnr(rgbError + alphaError, sampleCount), blockCount / milliseconds * 1000.0);
+			LevelTotal& total = totals[level];
+			total.milliseconds += milliseconds;
+			total.squaredError += rgbError + alphaError;
+			total.sampleCount += sampleCount;
+			total.blockCount += blockCount;
+		}
+	}
+	std::printf("total:\n");
+	for (size_t level = 0; level < std::size(kLevels); level++) {
+		const LevelTotal& total = totals[level];
+		if (total.blockCount == 0.0) {
+			continue;
+		}
+		std::printf("  %-12s %9.1f ms %8.0f blocks/s  PSNR %6.2f dB\n", kLevels[level].name, total.milliseconds,
+			total.blockCount / total.milliseconds * 1000.0, ComputePsnr(total.squaredError, total.sampleCount));
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <vector>
+#include "DirectXTex.h"
+#include "TestCommon.h"
+#include "TestImage.h"
+
+namespace {
+
+/// <summary>
+/// アルファがすべて255か
+/// </summary>
+bool IsOpaque(const DirectX::Image& image) {
+	for (size_t y = 0; y < image.height; y++) {
+		const uint8_t* row = image.pixels + y * image.rowPitch;
+		for (size_t x = 0; x < image.width; x++) {
+			if (row[x * 4 + 3] != 255) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// 3回圧縮して一番速かったミリ秒を返す
+/// </summary>
+double CompressBest(const DirectX::Image& source, DXGI_FORMAT format, DirectX::TEX_COMPRESS_FLAGS flags, DirectX::ScratchImage& compressed) {
+	double best = 1e30;
+	for (int i = 0; i < 3; i++) {
+		BenchmarkTimer timer;
+		if (FAILED(DirectX::Compress(source, format, flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed))) {
+			return 0.0;
+		}
+		best = std::min(best, timer.GetElapsedMilliseconds());
+	}
+	return best;
+}
+
+/// <summary>
+/// 圧縮したものを戻して元の画像とのPSNRを求める
+/// </summary>
+void MeasurePsnr(const DirectX::Image& source, const DirectX::ScratchImage& compressed, double& rgbPsnr, double& alphaPsnr) {
+	DirectX::ScratchImage decompressed;
+	if (FAILED(DirectX::Decompress(*compressed.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, decompressed))) {
+		rgbPsnr = alphaPsnr = 0.0;
+		return;
+	}
+	ComputeImagePsnr(source, *decompressed.GetImage(0, 0, 0), rgbPsnr, alphaPsnr);
+}
+
+} // namespace
+
+// TEX_COMPRESS_BC_FASTと元のBC1/BC3の圧縮を(不透明な画像はBC1、アルファがあればBC3で)、品質(PSNR)と速さ(blocks/s)で比べる
+// どちらも一様な重み(TEX_COMPRESS_UNIFORM)で、fastは実行時に選ばれたSIMD(AVX2かSSE2)を使う
+// 使い方: BCFastBenchmark [PNGファイル...](libpngがあるときだけ読める。合成した画像はいつも入る)
+int main(int argc, char** argv) {
+	std::vector<TestCorpusImage> corpus;
+	const std::vector<const char*> paths(argv + 1, argv + argc);
+	if (!MakeTestCorpus(paths, { { TestImageKind::Albedo, 512, 512 }, { TestImageKind::Gradient, 512, 512 }, { TestImageKind::Noise, 256, 256 },
+		{ TestImageKind::WavesAlpha, 510, 383 }, { TestImageKind::CheckerAlpha, 301, 257 } }, corpus)) {
+		return 1;
+	}
+
+	double totalReferenceMilliseconds = 0.0;
+	double totalFastMilliseconds = 0.0;
+	double totalBlockCount = 0.0;
+	for (const TestCorpusImage& entry : corpus) {
+		const DirectX::Image& source = *entry.image.GetImage(0, 0, 0);
+		const double blockCount = double((source.width + 3) / 4) * double((source.height + 3) / 4);
+		// 不透明ならBC1、アルファがあればBC3(BC1の1ビットのアルファでは比べられない)
+		const bool isBC3 = !IsOpaque(source);
+		const DXGI_FORMAT format = isBC3 ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+		DirectX::ScratchImage reference;
+		DirectX::ScratchImage fast;
+		const double referenceMilliseconds = CompressBest(source, format, DirectX::TEX_COMPRESS_UNIFORM, reference);
+		const double fastMilliseconds = CompressBest(source, format, DirectX::TEX_COMPRESS_UNIFORM | DirectX::TEX_COMPRESS_BC_FAST, fast);
+		if (referenceMilliseconds <= 0.0 || fastMilliseconds <= 0.0) {
+			std::printf("%s: compression failed\n", entry.name.c_str());
+			return 1;
+		}
+		double referenceRgb = 0.0;
+		double referenceAlpha = 0.0;
+		double fastRgb = 0.0;
+		double fastAlpha = 0.0;
+		MeasurePsnr(source, reference, referenceRgb, referenceAlpha);
+		MeasurePsnr(source, fast, fastRgb, fastAlpha);
+		std::printf("%-20s %s  PSNR ref %6.2f dB", entry.name.c_str(), isBC3 ? "BC3" : "BC1", referenceRgb);
+		if (isBC3) {
+			std::printf(" (a %6.2f)", referenceAlpha);
+		}
+		std::printf("  fast %6.2f dB", fastRgb);
+		if (isBC3) {
+			std::printf(" (a %6.2f)", fastAlpha);
+		}
+		std::printf("  ref %9.0f  fast %9.0f blocks/s\n", blockCount / referenceMilliseconds * 1000.0, blockCount / fastMilliseconds * 1000.0);
+		totalReferenceMilliseconds += referenceMilliseconds;
+		totalFastMilliseconds += fastMilliseconds;
+		totalBlockCount += blockCount;
+	}
+	std::printf("total: ref %.0f, fast %.0f blocks/s (x%.1f)\n", totalBlockCount / totalReferenceMilliseconds * 1000.0,
+		totalBlockCount / totalFastMilliseconds * 1000.0, totalReferenceMilliseconds / totalFastMilliseconds);
+	return 0;
+}
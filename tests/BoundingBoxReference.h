@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BoundingVolumeHierarchy.h"
+
+/// <summary>
+/// ランダムな境界箱(clusteredなら1000個ずつ同じ場所の近くに集める)
+/// </summary>
+inline std::vector<BoundingBox> MakeRandomBoxes(size_t count, std::mt19937& random, bool clustered) {
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> extent(0.05f, 1.0f);
+	std::uniform_real_distribution<float> offset(-3.0f, 3.0f);
+	std::vector<BoundingBox> boxes(count);
+	Vector3 cluster{ 0.0f, 0.0f, 0.0f };
+	for (size_t i = 0; i < count; i++) {
+		if (clustered && i % 1000 == 0) {
+			cluster = { position(random), position(random), position(random) };
+		}
+		const Vector3 center = clustered ? Vector3{ cluster.x + offset(random), cluster.y + offset(random), cluster.z + offset(random) } :
+			Vector3{ position(random), position(random), position(random) };
+		const float e = extent(random);
+		boxes[i] = { { center.x - e, center.y - e * 0.5f, center.z - e }, { center.x + e, center.y + e * 0.5f, center.z + e } };
+	}
+	return boxes;
+}
+
+/// <summary>
+/// 半直線と箱のスラブ判定(BVHを使わない比較用)
+/// </summary>
+inline bool IntersectRayBox(const Ray& ray, const BoundingBox& box, float maxDistance, float& distance) {
+	const float origin[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+	const float direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+	const float minimum[3] = { box.min.x, box.min.y, box.min.z };
+	const float maximum[3] = { box.max.x, box.max.y, box.max.z };
+	float nearDistance = 0.0f;
+	float farDistance = maxDistance;
+	for (int axis = 0; axis < 3; axis++) {
+		if (std::fabs(direction[axis]) < 1e-20f) {
+			if (origin[axis] < minimum[axis] || origin[axis] > maximum[axis]) {
+				return false;
+			}
+			continue;
+		}
+		float t1 = (minimum[axis] - origin[axis]) / direction[axis];
+		float t2 = (maximum[axis] - origin[axis]) / direction[axis];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+		nearDistance = std::max(nearDistance, t1);
+		farDistance = std::min(farDistance, t2);
+	}
+	distance = nearDistance;
+	return nearDistance <= farDistance;
+}
+
+/// <summary>
+/// 2つの箱が重なるか(境界が接するのも重なりとする)
+/// </summary>
+inline bool IsOverlapping(const BoundingBox& a, const BoundingBox& b) {
+	return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
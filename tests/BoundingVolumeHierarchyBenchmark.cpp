@@ -0,0 +1,109 @@
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "BoundingBoxReference.h"
+#include "BoundingVolumeHierarchy.h"
+#include "FrustumCulling.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// count個の一様な箱でBuild、Refit、各クエリの時間を測る
+/// </summary>
+void Measure(size_t count, const Frustum& frustum, std::mt19937& random) {
+	const std::vector<BoundingBox> boxes = MakeRandomBoxes(count, random, false);
+	BoundingVolumeHierarchy bvh;
+	BenchmarkTimer timer;
+	bvh.Build(boxes.data(), count);
+	const double buildMilliseconds = timer.GetElapsedMilliseconds();
+
+	timer.Restart();
+	for (int i = 0; i < 10; i++) {
+		bvh.Refit(boxes.data());
+	}
+	const double refitMilliseconds = timer.GetElapsedMilliseconds() / 10;
+
+	// 視錐台: BVHと平らなCullBoxes
+	std::vector<uint32_t> results(count);
+	const int frustumRepeatCount = 50;
+	size_t visibleCount = 0;
+	timer.Restart();
+	for (int i = 0; i < frustumRepeatCount; i++) {
+		visibleCount = bvh.QueryFrustum(frustum, results.data());
+	}
+	const double frustumMilliseconds = timer.GetElapsedMilliseconds() / frustumRepeatCount;
+	timer.Restart();
+	for (int i = 0; i < frustumRepeatCount; i++) {
+		CullBoxes(frustum, boxes.data(), count, results.data());
+	}
+	const double flatMilliseconds = timer.GetElapsedMilliseconds() / frustumRepeatCount;
+
+	// 半直線: BVHと総当たり(総当たりは少しだけ)
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	std::vector<Ray> rays(20000);
+	for (Ray& ray : rays) {
+		ray = { { distribution(random) * 100.0f, distribution(random) * 100.0f, -150.0f },
+			{ distribution(random) * 0.3f, distribution(random) * 0.3f, 1.0f } };
+	}
+	size_t hitCount = 0;
+	timer.Restart();
+	for (const Ray& ray : rays) {
+		RayHit hit{};
+		hitCount += bvh.Raycast(ray, 1000.0f, hit);
+	}
+	const double rayMilliseconds = timer.GetElapsedMilliseconds();
+	const int bruteRayCount = 20;
+	timer.Restart();
+	for (int i = 0; i < bruteRayCount; i++) {
+		float bestDistance = INFINITY;
+		for (const BoundingBox& box : boxes) {
+			float distance = 0.0f;
+			if (IntersectRayBox(rays[i], box, 1000.0f, distance) && distance < bestDistance) {
+				bestDistance = distance;
+			}
+		}
+		hitCount += bestDistance != INFINITY;
+	}
+	const double bruteRayMilliseconds = timer.GetElapsedMilliseconds() / bruteRayCount;
+
+	// 箱の重なり
+	const int overlapQueryCount = 20000;
+	size_t overlapCount = 0;
+	timer.Restart();
+	for (int i = 0; i < overlapQueryCount; i++) {
+		BoundingBox box = boxes[random() % count];
+		box.min.x -= 2.0f;
+		box.max.x += 2.0f;
+		overlapCount += bvh.QueryOverlap(box, results.data());
+	}
+	const double overlapMilliseconds = timer.GetElapsedMilliseconds();
+
+	std::printf("%zu boxes: %zu nodes, depth %u\n", count, bvh.GetNodeCount(), bvh.GetDepth());
+	std::printf("  build   %8.1f ms (%.0f ms per million), refit %.2f ms\n", buildMilliseconds, buildMilliseconds * 1e6 / count, refitMilliseconds);
+	std::printf("  frustum %8.3f ms (flat CullBoxes %.3f ms), %zu visible\n", frustumMilliseconds, flatMilliseconds, visibleCount);
+	std::printf("  ray     %8.2f Mrays/s (brute force %.3f ms per ray)\n", rays.size() / rayMilliseconds / 1000.0, bruteRayMilliseconds);
+	std::printf("  overlap %8.2f Mqueries/s (%.1f results per query)\n", overlapQueryCount / overlapMilliseconds / 1000.0,
+		double(overlapCount) / overlapQueryCount);
+	std::printf("  (checksum %zu)\n", hitCount);
+}
+
+} // namespace
+
+// BVHの構築、Refit、クエリの速さ
+// 使い方: BoundingVolumeHierarchyBenchmark [箱の数(既定は100000と1000000)]
+int main(int argc, char** argv) {
+	std::mt19937 random(20);
+	const Matrix4x4 camera = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.3f, 0.5f, 0.0f }, Vector3{ 0.0f, 0.0f, -120.0f });
+	const Frustum frustum = MakeFrustum(Multiply(Inverse(camera), MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 200.0f)));
+	if (argc > 1) {
+		Measure(std::strtoull(argv[1], nullptr, 10), frustum, random);
+		return 0;
+	}
+	for (size_t count : { size_t(100000), size_t(1000000) }) {
+		Measure(count, frustum, random);
+	}
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "BoundingBoxReference.h"
+#include "BoundingVolumeHierarchy.h"
+#include "FrustumCulling.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// クエリの結果を総当たりと比べたときの食い違いの数
+/// </summary>
+struct QueryMismatches {
+	size_t frustum = 0;
+	size_t overlap = 0;
+	size_t ray = 0;
+};
+
+/// <summary>
+/// 視錐台、箱の重なり、半直線の3つのクエリを総当たりと比べる
+/// </summary>
+void CompareWithBruteForce(const BoundingVolumeHierarchy& bvh, const std::vector<BoundingBox>& boxes, const Frustum& frustum,
+	std::mt19937& random, QueryMismatches& mismatches) {
+	const size_t count = boxes.size();
+
+	// 視錐台: 順は違うが集合はCullBoxesと同じ
+	std::vector<uint32_t> results(count + 1);
+	std::vector<uint32_t> expected(count + 1);
+	results.resize(bvh.QueryFrustum(frustum, results.data()));
+	expected.resize(CullBoxes(frustum, boxes.data(), count, expected.data(), SimdLevel::Scalar));
+	std::sort(results.begin(), results.end());
+	mismatches.frustum += results != expected;
+
+	// 箱の重なり
+	for (int query = 0; query < 50 && count > 0; query++) {
+		BoundingBox box = boxes[random() % count];
+		box.min.x -= 5.0f;
+		box.max.x += 5.0f;
+		box.max.y += 3.0f;
+		std::vector<uint32_t> overlaps(count);
+		overlaps.resize(bvh.QueryOverlap(box, overlaps.data()));
+		std::sort(overlaps.begin(), overlaps.end());
+		std::vector<uint32_t> expectedOverlaps;
+		for (size_t i = 0; i < count; i++) {
+			if (IsOverlapping(boxes[i], box)) {
+				expectedOverlaps.push_back(uint32_t(i));
+			}
+		}
+		mismatches.overlap += overlaps != expectedOverlaps;
+	}
+
+	// 半直線: 当たるかどうかと一番近い距離(軸に平行な向きを混ぜる)
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	for (int query = 0; query < 200; query++) {
+		const Ray ray{ { distribution(random) * 150.0f, distribution(random) * 150.0f, distribution(random) * 150.0f },
+			{ distribution(random), distribution(random), (query % 10 == 0) ? 0.0f : distribution(random) } };
+		RayHit hit{};
+		const bool isHit = bvh.Raycast(ray, 1000.0f, hit);
+		float bestDistance = INFINITY;
+		for (size_t i = 0; i < count; i++) {
+			float distance = 0.0f;
+			if (IntersectRayBox(ray, boxes[i], 1000.0f, distance) && distance < bestDistance) {
+				bestDistance = distance;
+			}
+		}
+		const bool isExpectedHit = bestDistance != INFINITY;
+		if (isHit != isExpectedHit) {
+			++mismatches.ray;
+		} else if (isHit) {
+			// 同じ距離の箱が複数あればどれを返してもよいので、番号ではなく当たった箱までの距離を見る
+			float distance = 0.0f;
+			const bool isHitBoxValid = hit.index < count && IntersectRayBox(ray, boxes[hit.index], 1000.0f, distance);
+			mismatches.ray += !isHitBoxValid || std::fabs(hit.distance - bestDistance) > 1e-3f * std::max(1.0f, bestDistance) ||
+				std::fabs(distance - hit.distance) > 1e-3f * std::max(1.0f, distance);
+		}
+	}
+}
+
+/// <summary>
+/// 大きさと分布を変えて、Buildの直後と物体を動かしてRefitした後を調べる
+/// </summary>
+void TestQueries() {
+	std::mt19937 random(20);
+	const Matrix4x4 camera = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.3f, 0.5f, 0.0f }, Vector3{ 0.0f, 0.0f, -120.0f });
+	const Frustum frustum = MakeFrustum(Multiply(Inverse(camera), MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 200.0f)));
+	for (bool clustered : { false, true }) {
+		for (size_t count : { size_t(0), size_t(1), size_t(3), size_t(5), size_t(100), size_t(4097), size_t(100000) }) {
+			std::vector<BoundingBox> boxes = MakeRandomBoxes(count, random, clustered);
+			BoundingVolumeHierarchy bvh;
+			bvh.Build(boxes.data(), count);
+			TEST_CHECK(bvh.GetPrimitiveCount() == count);
+
+			QueryMismatches built;
+			CompareWithBruteForce(bvh, boxes, frustum, random, built);
+
+			std::uniform_real_distribution<float> move(-2.0f, 2.0f);
+			for (BoundingBox& box : boxes) {
+				const float dx = move(random);
+				const float dy = move(random);
+				box.min.x += dx;
+				box.max.x += dx;
+				box.min.y += dy;
+				box.max.y += dy;
+			}
+			bvh.Refit(boxes.data());
+			QueryMismatches refitted;
+			CompareWithBruteForce(bvh, boxes, frustum, random, refitted);
+
+			TEST_CHECK(built.frustum == 0 && built.overlap == 0 && built.ray == 0);
+			TEST_CHECK(refitted.frustum == 0 && refitted.overlap == 0 && refitted.ray == 0);
+			if (count >= 4097) {
+				std::printf("%s %zu: %zu nodes, depth %u, mismatches built %zu/%zu/%zu refitted %zu/%zu/%zu\n",
+					clustered ? "clustered" : "uniform", count, bvh.GetNodeCount(), bvh.GetDepth(),
+					built.frustum, built.overlap, built.ray, refitted.frustum, refitted.overlap, refitted.ray);
+			}
+		}
+	}
+}
+
+} // namespace
+
+int main() {
+	TestQueries();
+	return FinishTest();
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "DescriptorAllocator.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// 解放した番号は、次のSubmitのフェンスをRetireするまで使い回されない
+/// </summary>
+void TestPersistentFreeWaitsForFence() {
+	DescriptorAllocator allocator(8, 2, 0);
+	std::vector<uint32_t> indices;
+	for (uint32_t index; (index = allocator.Allocate()) != DescriptorAllocator::kInvalidIndex;) {
+		indices.push_back(index);
+	}
+	TEST_CHECK(indices.size() == 6);
+	TEST_CHECK(*std::min_element(indices.begin(), indices.end()) == 2);
+
+	allocator.Free(indices[3]);
+	TEST_CHECK(allocator.GetStats().pendingFreeCount == 1 && allocator.GetStats().persistentUsedCount == 6);
+	// Submitする前のRetireでは戻らない
+	allocator.Retire(100);
+	TEST_CHECK(allocator.Allocate() == DescriptorAllocator::kInvalidIndex);
+	allocator.Submit(1);
+	TEST_CHECK(allocator.Allocate() == DescriptorAllocator::kInvalidIndex);
+	allocator.Retire(0);
+	TEST_CHECK(allocator.Allocate() == DescriptorAllocator::kInvalidIndex);
+	allocator.Retire(1);
+	TEST_CHECK(allocator.GetStats().pendingFreeCount == 0 && allocator.GetStats().persistentUsedCount == 5);
+	TEST_CHECK(allocator.Allocate() == indices[3]);
+	TEST_CHECK(allocator.GetStats().failedCount == 4);
+}
+
+/// <summary>
+/// リングは後ろに入らなければ末尾を捨てて折り返し、捨てた末尾も戻った後は使い回す
+/// </summary>
+void TestTransientWrap() {
+	const uint32_t base = 4;
+	DescriptorAllocator allocator(base + 16, 0, 16);
+	TEST_CHECK(allocator.AllocateTransient(10) == base + 0);
+	allocator.Submit(1);
+	TEST_CHECK(allocator.AllocateTransient(4) == base + 10);
+	allocator.Submit(2);
+	allocator.Retire(1);
+	TEST_CHECK(allocator.GetStats().transientUsedCount == 4);
+
+	// 末尾に2つしか残っていないので先頭へ折り返す(捨てた2つも使用中に数える)
+	TEST_CHECK(allocator.AllocateTransient(5) == base + 0);
+	TEST_CHECK(allocator.GetStats().transientUsedCount == 11);
+	// 折り返した後は使用中の先頭(10)までしか使えない
+	TEST_CHECK(allocator.AllocateTransient(6) == DescriptorAllocator::kInvalidIndex);
+	TEST_CHECK(allocator.AllocateTransient(5) == base + 5);
+	TEST_CHECK(allocator.AllocateTransient(1) == DescriptorAllocator::kInvalidIndex);
+	allocator.Submit(3);
+
+	allocator.Retire(2);
+	TEST_CHECK(allocator.AllocateTransient(4) == base + 10);
+	allocator.Retire(3);
+	// 捨てていた末尾の2つが使える
+	TEST_CHECK(allocator.AllocateTransient(2) == base + 14);
+	TEST_CHECK(allocator.AllocateTransient(3) == base + 0);
+	allocator.Submit(4);
+	allocator.Retire(4);
+
+	// すべて戻れば全体を1つで取れる
+	TEST_CHECK(allocator.GetStats().transientUsedCount == 0);
+	TEST_CHECK(allocator.AllocateTransient(16) == base + 0);
+	TEST_CHECK(allocator.AllocateTransient(0) == DescriptorAllocator::kInvalidIndex);
+	TEST_CHECK(allocator.AllocateTransient(17) == DescriptorAllocator::kInvalidIndex);
+}
+
+/// <summary>
+/// 使用中の範囲
+/// </summary>
+struct TransientRange {
+	uint32_t begin;
+	uint32_t count;
+	uint64_t fenceValue; // 0ならまだSubmitしていない
+};
+
+/// <summary>
+/// ランダムな操作を番号と範囲の写しと比べる
+/// </summary>
+void TestRandom(uint32_t trialCount) {
+	std::mt19937 random(16);
+	size_t errorCount = 0;
+	size_t wrapCount = 0;
+	for (uint32_t trial = 0; trial < trialCount; trial++) {
+		const uint32_t capacity = 64 + random() % 512;
+		const uint32_t reservedCount = random() % 4;
+		const uint32_t transientCount = random() % (capacity / 2);
+		const uint32_t transientBegin = capacity - transientCount;
+		const uint32_t persistentCount = transientBegin - reservedCount;
+		DescriptorAllocator allocator(capacity, reservedCount, transientCount);
+
+		std::set<uint32_t> live;
+		std::set<uint32_t> pendingFree;
+		std::vector<uint32_t> unsubmittedFrees;
+		std::map<uint64_t, std::vector<uint32_t>> submittedFrees;
+		std::vector<TransientRange> ranges;
+		uint64_t fenceValue = 0;
+		uint64_t completedValue = 0;
+		uint32_t lastTransient = 0;
+		for (int step = 0; step < 20000; step++) {
+			switch (random() % 6) {
+			case 0:
+			case 1: {
+				const uint32_t index = allocator.Allocate();
+				if (index == DescriptorAllocator::kInvalidIndex) {
+					errorCount += live.size() + pendingFree.size() != persistentCount;
+					break;
+				}
+				errorCount += index < reservedCount || index >= transientBegin || live.count(index) || pendingFree.count(index);
+				live.insert(index);
+				break;
+			}
+			case 2:
+				if (!live.empty()) {
+					auto it = live.begin();
+					std::advance(it, random() % live.size());
+					allocator.Free(*it);
+					pendingFree.insert(*it);
+					unsubmittedFrees.push_back(*it);
+					live.erase(it);
+				}
+				break;
+			case 3:
+				if (transientCount > 0) {
+					const uint32_t count = 1 + random() % std::max(1u, transientCount / 4);
+					const uint32_t begin = allocator.AllocateTransient(count);
+					if (begin == DescriptorAllocator::kInvalidIndex) {
+						// 空なら必ず入る
+						errorCount += ranges.empty();
+						break;
+					}
+					errorCount += begin < transientBegin || begin + count > capacity;
+					for (const TransientRange& range : ranges) {
+						errorCount += begin < range.begin + range.count && range.begin < begin + count;
+					}
+					wrapCount += begin < lastTransient;
+					lastTransient = begin;
+					ranges.push_back({ begin, count, 0 });
+				}
+				break;
+			case 4:
+				allocator.Submit(++fenceValue);
+				submittedFrees[fenceValue] = std::move(unsubmittedFrees);
+				unsubmittedFrees.clear();
+				for (TransientRange& range : ranges) {
+					if (range.fenceValue == 0) {
+						range.fenceValue = fenceValue;
+					}
+				}
+				break;
+			default:
+				if (completedValue < fenceValue) {
+					completedValue += 1 + random() % (fenceValue - completedValue);
+					allocator.Retire(completedValue);
+					for (auto it = submittedFrees.begin(); it != submittedFrees.end() && it->first <= completedValue; it = submittedFrees.erase(it)) {
+						for (uint32_t index : it->second) {
+							pendingFree.erase(index);
+						}
+					}
+					std::erase_if(ranges, [&](const TransientRange& range) { return range.fenceValue != 0 && range.fenceValue <= completedValue; });
+				}
+				break;
+			}
+			const DescriptorAllocatorStats& stats = allocator.GetStats();
+			errorCount += stats.persistentUsedCount != live.size() + pendingFree.size();
+			errorCount += stats.pendingFreeCount != pendingFree.size();
+			uint32_t transientUsedCount = 0;
+			for (const TransientRange& range : ranges) {
+				transientUsedCount += range.count;
+			}
+			errorCount += stats.transientUsedCount < transientUsedCount || stats.transientUsedCount > transientCount;
+		}
+
+		// GPUが追いついてすべて解放すると、最初と同じだけ取れる
+		allocator.Submit(++fenceValue);
+		allocator.Retire(fenceValue);
+		for (uint32_t index : live) {
+			allocator.Free(index);
+		}
+		allocator.Submit(++fenceValue);
+		allocator.Retire(fenceValue);
+		const DescriptorAllocatorStats& stats = allocator.GetStats();
+		errorCount += stats.persistentUsedCount != 0 || stats.pendingFreeCount != 0 || stats.transientUsedCount != 0;
+		std::set<uint32_t> recovered;
+		for (uint32_t index; (index = allocator.Allocate()) != DescriptorAllocator::kInvalidIndex;) {
+			recovered.insert(index);
+		}
+		errorCount += recovered.size() != persistentCount;
+		errorCount += !recovered.empty() && (*recovered.begin() != reservedCount || *recovered.rbegin() != transientBegin - 1);
+		if (transientCount > 0) {
+			errorCount += allocator.AllocateTransient(transientCount) != transientBegin;
+		}
+	}
+	std::printf("random: %u trials, %zu ring wraps, %zu errors\n", trialCount, wrapCount, errorCount);
+	TEST_CHECK(errorCount == 0);
+	TEST_CHECK(wrapCount > 0);
+}
+
+} // namespace
+
+int main() {
+	TestPersistentFreeWaitsForFence();
+	TestTransientWrap();
+	TestRandom(200);
+	return FinishTest();
+}
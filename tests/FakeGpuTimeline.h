@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "FrameRing.h"
+
+/// <summary>
+/// GPUの代わりのスレッド(シグナルを積んだ順に、1つにつき決まった時間をかけて処理する)
+/// D3D12なしでFrameRingの待ち方と統計を調べるために使う
+/// </summary>
+class FakeGpuTimeline : public GpuTimeline {
+public:
+	explicit FakeGpuTimeline(double gpuMilliseconds)
+		: gpuTime_(std::chrono::microseconds(int64_t(gpuMilliseconds * 1000.0))), thread_([this] { Run(); }) {
+	}
+
+	~FakeGpuTimeline() override {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			isStopping_ = true;
+		}
+		condition_.notify_all();
+		thread_.join();
+	}
+
+	uint64_t Signal() override {
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(++signaledValue_);
+		condition_.notify_all();
+		return signaledValue_;
+	}
+
+	uint64_t GetCompletedValue() override {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return completedValue_;
+	}
+
+	void Wait(uint64_t value) override {
+		std::unique_lock<std::mutex> lock(mutex_);
+		++waitCount_;
+		condition_.wait(lock, [&] { return completedValue_ >= value; });
+	}
+
+	// 最後に積んだシグナルの値
+	uint64_t GetSignaledValue() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return signaledValue_;
+	}
+
+	// Waitが呼ばれた回数
+	uint64_t GetWaitCount() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return waitCount_;
+	}
+
+	// 1つのシグナルにかける時間を変える(次に処理するものから)
+	void SetGpuMilliseconds(double gpuMilliseconds) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		gpuTime_ = std::chrono::microseconds(int64_t(gpuMilliseconds * 1000.0));
+	}
+
+private:
+	void Run() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true) {
+			condition_.wait(lock, [&] { return isStopping_ || !queue_.empty(); });
+			if (queue_.empty()) {
+				return;
+			}
+			const uint64_t value = queue_.front();
+			const std::chrono::microseconds gpuTime = gpuTime_;
+			lock.unlock();
+			std::this_thread::sleep_for(gpuTime);
+			lock.lock();
+			queue_.pop_front();
+			completedValue_ = value;
+			condition_.notify_all();
+		}
+	}
+
+	std::chrono::microseconds gpuTime_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<uint64_t> queue_;
+	uint64_t signaledValue_ = 0;
+	uint64_t completedValue_ = 0;
+	uint64_t waitCount_ = 0;
+	bool isStopping_ = false;
+	// メンバーがすべて初期化されてから動かすので最後に置く
+	std::thread thread_;
+};
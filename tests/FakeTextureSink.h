@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TextureStreamer.h"
+
+/// <summary>
+/// WICとGenerateMipMapsの代わり: パスから決まる画素のRGBA8を作り、2x2の平均でmipを作る
+/// パスに"missing"を含むと失敗し、"empty"を含むとmipのないテクスチャを返す
+/// </summary>
+inline bool FakeDecodeTexture(const std::string& path, DecodedTexture& texture, uint32_t size, std::chrono::microseconds decodeTime) {
+	if (path.find("missing") != std::string::npos) {
+		return false;
+	}
+	texture.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	texture.width = size;
+	texture.height = size;
+	if (path.find("empty") != std::string::npos) {
+		return true;
+	}
+
+	size_t totalSize = 0;
+	for (uint32_t mipSize = size;; mipSize = std::max(mipSize / 2, 1u)) {
+		totalSize += size_t(mipSize) * mipSize * 4;
+		if (mipSize == 1) {
+			break;
+		}
+	}
+	auto storage = std::make_shared<std::vector<uint8_t>>(totalSize);
+	uint8_t* pixels = storage->data();
+	uint32_t seed = uint32_t(std::hash<std::string>()(path));
+	for (size_t i = 0; i < size_t(size) * size * 4; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		pixels[i] = uint8_t(seed >> 24);
+	}
+	for (uint32_t mipSize = size;; mipSize /= 2) {
+		texture.mips.push_back({ pixels, size_t(mipSize) * 4, size_t(mipSize) * mipSize * 4, mipSize, mipSize });
+		if (mipSize == 1) {
+			break;
+		}
+		const uint32_t nextSize = mipSize / 2;
+		uint8_t* next = pixels + size_t(mipSize) * mipSize * 4;
+		for (uint32_t y = 0; y < nextSize; y++) {
+			for (uint32_t x = 0; x < nextSize; x++) {
+				for (uint32_t c = 0; c < 4; c++) {
+					const uint8_t* source = pixels + (size_t(y) * 2 * mipSize + x * 2) * 4 + c;
+					const uint32_t sum = source[0] + source[4] + source[mipSize * 4] + source[mipSize * 4 + 4];
+					next[(size_t(y) * nextSize + x) * 4 + c] = uint8_t((sum + 2) / 4);
+				}
+			}
+		}
+		pixels = next;
+	}
+	texture.storage = storage;
+	std::this_thread::sleep_for(decodeTime);
+	return true;
+}
+
+/// <summary>
+/// GPUの代わりのコピー先: 送られたmipの順番を記録し、フェンスはTickで進める
+/// </summary>
+class FakeTextureSink : public TextureUploadSink {
+public:
+	struct Texture {
+		uint32_t mipLevels;
+		std::vector<uint32_t> uploadOrder;
+		bool isCoarseFirst = true; // 最も粗いmipから1つずつ細かくなる順で送られたか
+		bool isDestroyed = false;
+	};
+
+	void* CreateTexture(const DecodedTexture& texture) override {
+		if (texture.width == failCreateSize) {
+			return nullptr;
+		}
+		textures.push_back(std::make_unique<Texture>(Texture{ uint32_t(texture.mips.size()), {} }));
+		return textures.back().get();
+	}
+
+	bool UploadMip(void* handle, uint32_t mipLevel, const DecodedMip& mip) override {
+		Texture& texture = *static_cast<Texture*>(handle);
+		if (texture.isDestroyed) {
+			++uploadAfterDestroyCount;
+		}
+		const uint32_t expected = texture.uploadOrder.empty() ? texture.mipLevels - 1 : texture.uploadOrder.back() - 1;
+		texture.isCoarseFirst = texture.isCoarseFirst && mipLevel == expected;
+		texture.uploadOrder.push_back(mipLevel);
+		// 画素が読めること
+		uint32_t sum = 0;
+		for (size_t i = 0; i < mip.slicePitch; i += 64) {
+			sum += mip.pixels[i];
+		}
+		checksum += sum;
+		return mip.width != failUploadWidth;
+	}
+
+	uint64_t Submit() override {
+		++submitCount;
+		return ++fenceValue;
+	}
+
+	uint64_t GetCompletedValue() override {
+		return completedValue;
+	}
+
+	void DestroyTexture(void* handle) override {
+		Texture& texture = *static_cast<Texture*>(handle);
+		if (texture.isDestroyed) {
+			++doubleDestroyCount;
+		}
+		texture.isDestroyed = true;
+		++destroyedCount;
+	}
+
+	// 1フレーム進める(GPUは2フレーム遅れて追いつく)
+	void Tick() {
+		if (completedValue + 2 < fenceValue) {
+			completedValue = fenceValue - 2;
+		} else if (completedValue < fenceValue) {
+			++completedValue;
+		}
+	}
+
+	std::vector<std::unique_ptr<Texture>> textures;
+	uint64_t fenceValue = 0;
+	uint64_t completedValue = 0;
+	uint32_t submitCount = 0;
+	uint32_t destroyedCount = 0;
+	uint32_t doubleDestroyCount = 0;
+	uint32_t uploadAfterDestroyCount = 0;
+	uint32_t checksum = 0;
+	uint32_t failCreateSize = 0;  // この幅のテクスチャは作れない
+	uint32_t failUploadWidth = 0; // この幅のmipは送れない
+};
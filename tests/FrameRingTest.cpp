@@ -0,0 +1,113 @@
+#include <thread>
+#include "FakeGpuTimeline.h"
+#include "FrameRing.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// 1回の計測結果
+/// </summary>
+struct FrameRingRun {
+	FrameRingStats stats;
+	double milliseconds;
+	uint64_t waitCount;
+};
+
+/// <summary>
+/// CPUとGPUにそれぞれ決まった時間がかかるフレームをframeCount回送る
+/// </summary>
+FrameRingRun RunFrames(uint32_t ringSize, double cpuMilliseconds, double gpuMilliseconds, int frameCount) {
+	FakeGpuTimeline timeline(gpuMilliseconds);
+	FrameRing ring(timeline, ringSize);
+	uint64_t lastSignals[FrameRing::kMaxFrameCount] = {};
+	BenchmarkTimer timer;
+	for (int frame = 0; frame < frameCount; frame++) {
+		const uint32_t index = ring.BeginFrame();
+		TEST_CHECK(index == uint32_t(frame) % ringSize);
+		// 同じ番号の前回のフレームは終わっていて、その資源を使ってよい
+		const uint64_t completed = timeline.GetCompletedValue();
+		TEST_CHECK(completed >= lastSignals[index]);
+		// 一周分より多くは先に進まない
+		TEST_CHECK(timeline.GetSignaledValue() - completed <= ringSize - 1);
+		std::this_thread::sleep_for(std::chrono::microseconds(int64_t(cpuMilliseconds * 1000.0)));
+		lastSignals[index] = ring.EndFrame();
+		TEST_CHECK(lastSignals[index] == uint64_t(frame) + 1);
+	}
+	FrameRingRun run{ ring.GetStats(), timer.GetElapsedMilliseconds(), timeline.GetWaitCount() };
+	ring.WaitForIdle();
+	TEST_CHECK(timeline.GetCompletedValue() == uint64_t(frameCount));
+
+	// 待ったときだけWaitを呼ぶ
+	TEST_CHECK(run.waitCount == run.stats.stallCount);
+	TEST_CHECK(run.stats.frameCount == uint64_t(frameCount));
+	TEST_CHECK(run.stats.overlapFrameCount <= run.stats.frameCount);
+	TEST_CHECK(run.stats.inFlightSum <= run.stats.frameCount * (ringSize - 1));
+	std::printf("ring %u, cpu %.0f ms, gpu %.0f ms: %.2f ms/frame, stall %llu (%.1f ms), overlap %llu/%llu, in flight %.2f\n",
+		ringSize, cpuMilliseconds, gpuMilliseconds, run.milliseconds / frameCount,
+		(unsigned long long)run.stats.stallCount, run.stats.stallSeconds * 1000.0,
+		(unsigned long long)run.stats.overlapFrameCount, (unsigned long long)run.stats.frameCount,
+		double(run.stats.inFlightSum) / double(run.stats.frameCount));
+	return run;
+}
+
+/// <summary>
+/// GPUが遅いとき: 一周して追いついたフレームだけを待ち、2つ以上ならCPUとGPUが重なる
+/// </summary>
+void TestGpuBound() {
+	const int frameCount = 60;
+	FrameRingRun runs[FrameRing::kMaxFrameCount + 1];
+	for (uint32_t ringSize = 1; ringSize <= FrameRing::kMaxFrameCount; ringSize++) {
+		runs[ringSize] = RunFrames(ringSize, 3.0, 4.0, frameCount);
+	}
+	// 1つなら毎回前のフレームを待ち、待ち終わったときには何も処理中でない
+	TEST_CHECK(runs[1].stats.stallCount == uint64_t(frameCount - 1));
+	TEST_CHECK(runs[1].stats.overlapFrameCount == 0);
+	TEST_CHECK(runs[1].stats.inFlightSum == 0);
+	for (uint32_t ringSize = 2; ringSize <= FrameRing::kMaxFrameCount; ringSize++) {
+		// 最初の一周は待たない
+		TEST_CHECK(runs[ringSize].stats.stallCount <= uint64_t(frameCount) - ringSize);
+		TEST_CHECK(runs[ringSize].stats.overlapFrameCount >= uint64_t(frameCount) * 9 / 10);
+		// 1フレーム7msが、重なるとGPUの4msに近づく
+		TEST_CHECK(runs[ringSize].milliseconds < runs[1].milliseconds * 0.8);
+	}
+}
+
+/// <summary>
+/// CPUが遅いとき: GPUは先に終わっているのでほとんど待たない
+/// </summary>
+void TestCpuBound() {
+	const int frameCount = 40;
+	const FrameRingRun run = RunFrames(2, 4.0, 1.0, frameCount);
+	TEST_CHECK(run.stats.stallCount <= uint64_t(frameCount) / 10);
+}
+
+/// <summary>
+/// フレーム数を変えるとGPUが空くまで待ち、統計と番号が最初からになる
+/// </summary>
+void TestSetFrameCount() {
+	FakeGpuTimeline timeline(1.0);
+	FrameRing ring(timeline, 3);
+	for (int frame = 0; frame < 10; frame++) {
+		ring.BeginFrame();
+		ring.EndFrame();
+	}
+	ring.SetFrameCount(1);
+	TEST_CHECK(timeline.GetCompletedValue() == 10);
+	TEST_CHECK(ring.GetFrameCount() == 1);
+	TEST_CHECK(ring.GetStats().frameCount == 0);
+	TEST_CHECK(ring.BeginFrame() == 0);
+	TEST_CHECK(ring.EndFrame() == 11);
+	// 範囲外は丸める
+	ring.SetFrameCount(100);
+	TEST_CHECK(ring.GetFrameCount() == FrameRing::kMaxFrameCount);
+}
+
+} // namespace
+
+int main() {
+	TestGpuBound();
+	TestCpuBound();
+	TestSetFrameCount();
+	return FinishTest();
+}
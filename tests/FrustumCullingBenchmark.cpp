@@ -0,0 +1,43 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "FrustumCulling.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+// CullSpheres/CullBoxesのレベルごとの速さ(百万物体/秒)
+// 使い方: FrustumCullingBenchmark [物体の数(既定は100000)]
+int main(int argc, char** argv) {
+	const size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	const Matrix4x4 camera = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.3f, 0.5f, 0.0f }, Vector3{ 0.0f, 0.0f, -10.0f });
+	const Frustum frustum = MakeFrustum(Multiply(Inverse(camera), MakePerspectiveFovMatirx(0.45f, 1280.0f / 720.0f, 0.1f, 100.0f)));
+	std::mt19937 random(19);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> radius(0.01f, 3.0f);
+	std::vector<BoundingSphere> spheres(count);
+	std::vector<BoundingBox> boxes(count);
+	for (size_t i = 0; i < count; i++) {
+		const Vector3 center{ position(random), position(random), position(random) };
+		const float r = radius(random);
+		spheres[i] = { center, r };
+		boxes[i] = { { center.x - r, center.y - r * 0.5f, center.z - r }, { center.x + r, center.y + r * 0.5f, center.z + r * 2.0f } };
+	}
+	std::vector<uint32_t> visible(count);
+
+	const int repeatCount = 200;
+	std::printf("%zu objects (best level %s)\n", count, GetSimdLevelName(GetSimdLevel()));
+	for (bool isBox : { false, true }) {
+		for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+			size_t visibleCount = 0;
+			BenchmarkTimer timer;
+			for (int i = 0; i < repeatCount; i++) {
+				visibleCount = isBox ? CullBoxes(frustum, boxes.data(), count, visible.data(), level) :
+					CullSpheres(frustum, spheres.data(), count, visible.data(), level);
+			}
+			const double milliseconds = timer.GetElapsedMilliseconds() / repeatCount;
+			std::printf("%-7s %-6s %7.3f ms, %7.1f Mobjects/s, %zu visible\n", isBox ? "boxes" : "spheres", GetSimdLevelName(level),
+				milliseconds, count / milliseconds / 1000.0, visibleCount);
+		}
+	}
+	return 0;
+}
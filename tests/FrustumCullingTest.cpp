@@ -0,0 +1,196 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "FrustumCulling.h"
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+namespace {
+
+constexpr SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+// 出力の後ろに置く番兵
+constexpr uint32_t kGuard = 0xDEADBEEF;
+constexpr size_t kGuardCount = 16;
+
+/// <summary>
+/// 点がクリップ空間の範囲(深度0～1)に入るか
+/// </summary>
+bool IsPointInside(const Matrix4x4& viewProjection, const Vector3& point) {
+	float clip[4];
+	for (int j = 0; j < 4; j++) {
+		clip[j] = point.x * viewProjection.m[0][j] + point.y * viewProjection.m[1][j] + point.z * viewProjection.m[2][j] + viewProjection.m[3][j];
+	}
+	return clip[3] > 0.0f && -clip[3] <= clip[0] && clip[0] <= clip[3] && -clip[3] <= clip[1] && clip[1] <= clip[3] &&
+		0.0f <= clip[2] && clip[2] <= clip[3];
+}
+
+/// <summary>
+/// カメラの前にある物体の視錐台
+/// </summary>
+struct CullingScene {
+	Matrix4x4 viewProjection;
+	Frustum frustum;
+	std::vector<BoundingSphere> spheres;
+	std::vector<BoundingBox> boxes;
+};
+
+CullingScene MakeScene(size_t count) {
+	CullingScene scene;
+	const Matrix4x4 camera = MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.3f, 0.5f, 0.0f }, Vector3{ 0.0f, 0.0f, -10.0f });
+	scene.viewProjection = Multiply(Inverse(camera), MakePerspectiveFovMatirx(0.45f, 1280.0f / 720.0f, 0.1f, 100.0f));
+	scene.frustum = MakeFrustum(scene.viewProjection);
+	std::mt19937 random(19);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> radius(0.01f, 3.0f);
+	for (size_t i = 0; i < count; i++) {
+		const Vector3 center{ position(random), position(random), position(random) };
+		const float r = radius(random);
+		scene.spheres.push_back({ center, r });
+		scene.boxes.push_back({ { center.x - r, center.y - r * 0.5f, center.z - r }, { center.x + r, center.y + r * 0.5f, center.z + r * 2.0f } });
+	}
+	return scene;
+}
+
+/// <summary>
+/// 球か箱をlevelでカリングする(出力の後ろに番兵を置く)
+/// </summary>
+std::vector<uint32_t> Cull(const CullingScene& scene, bool isBox, size_t count, SimdLevel level, bool& isGuardIntact) {
+	std::vector<uint32_t> visible(count + kGuardCount, kGuard);
+	// 入力もちょうどcount個の領域に写して、後ろを読まないようにする(ASanで見つかる)
+	size_t visibleCount = 0;
+	if (isBox) {
+		const std::vector<BoundingBox> boxes(scene.boxes.begin(), scene.boxes.begin() + count);
+		visibleCount = CullBoxes(scene.frustum, boxes.data(), count, visible.data(), level);
+	} else {
+		const std::vector<BoundingSphere> spheres(scene.spheres.begin(), scene.spheres.begin() + count);
+		visibleCount = CullSpheres(scene.frustum, spheres.data(), count, visible.data(), level);
+	}
+	isGuardIntact = true;
+	for (size_t i = count; i < visible.size(); i++) {
+		isGuardIntact = isGuardIntact && visible[i] == kGuard;
+	}
+	visible.resize(visibleCount);
+	return visible;
+}
+
+/// <summary>
+/// 大きさ0の球はクリップ空間の判定と一致する
+/// </summary>
+void TestPointsMatchClipSpace(const CullingScene& scene) {
+	const size_t count = scene.spheres.size();
+	std::vector<BoundingSphere> points(count);
+	for (size_t i = 0; i < count; i++) {
+		points[i] = { scene.spheres[i].center, 0.0f };
+	}
+	std::vector<uint32_t> visible(count);
+	const size_t visibleCount = CullSpheres(scene.frustum, points.data(), count, visible.data(), SimdLevel::Scalar);
+	std::vector<bool> isVisible(count, false);
+	for (size_t k = 0; k < visibleCount; k++) {
+		isVisible[visible[k]] = true;
+	}
+	size_t insideCount = 0;
+	size_t mismatchCount = 0;
+	for (size_t i = 0; i < count; i++) {
+		const bool isInside = IsPointInside(scene.viewProjection, points[i].center);
+		insideCount += isInside;
+		mismatchCount += isInside != isVisible[i];
+	}
+	std::printf("points: %zu visible, %zu inside clip space, %zu mismatches\n", visibleCount, insideCount, mismatchCount);
+	// 平面の正規化の丸めで境界ちょうどの点がずれることがある
+	TEST_CHECK(mismatchCount <= 5);
+	TEST_CHECK(insideCount > 1000);
+}
+
+/// <summary>
+/// どのレベルでも同じ番号の列になり、端数で出力の後ろに書かず、中心が中にある物体は残す
+/// </summary>
+void TestLevelsAndTails(const CullingScene& scene) {
+	const size_t count = scene.spheres.size();
+	for (bool isBox : { false, true }) {
+		std::vector<uint32_t> reference;
+		for (SimdLevel level : kLevels) {
+			bool isGuardIntact = false;
+			const std::vector<uint32_t> visible = Cull(scene, isBox, count, level, isGuardIntact);
+			TEST_CHECK(isGuardIntact);
+			if (level == SimdLevel::Scalar) {
+				reference = visible;
+			}
+			TEST_CHECK(visible == reference);
+
+			// 端数(AVX2は8個、SSE2は4個ずつ)だけの数と、まとまりの後に端数が残る数
+			for (size_t tail : { size_t(0), size_t(1), size_t(7), size_t(13) }) {
+				for (size_t tailCount : { tail, 64 + tail }) {
+					const std::vector<uint32_t> partial = Cull(scene, isBox, tailCount, level, isGuardIntact);
+					TEST_CHECK(isGuardIntact);
+					// 全体の結果のうちtailCount未満の番号と一致する
+					std::vector<uint32_t> expected;
+					for (uint32_t index : reference) {
+						if (index < tailCount) {
+							expected.push_back(index);
+						}
+					}
+					TEST_CHECK(partial == expected);
+				}
+			}
+		}
+
+		bool isAscending = true;
+		for (size_t k = 1; k < reference.size(); k++) {
+			isAscending = isAscending && reference[k - 1] < reference[k];
+		}
+		TEST_CHECK(isAscending);
+		std::vector<bool> isVisible(count, false);
+		for (uint32_t index : reference) {
+			isVisible[index] = true;
+		}
+		size_t missingCount = 0;
+		for (size_t i = 0; i < count; i++) {
+			const Vector3 center = isBox ?
+				Vector3{ (scene.boxes[i].min.x + scene.boxes[i].max.x) * 0.5f, (scene.boxes[i].min.y + scene.boxes[i].max.y) * 0.5f,
+					(scene.boxes[i].min.z + scene.boxes[i].max.z) * 0.5f } :
+				scene.spheres[i].center;
+			missingCount += IsPointInside(scene.viewProjection, center) && !isVisible[i];
+		}
+		std::printf("%s: %zu / %zu visible, inside but culled %zu\n", isBox ? "boxes" : "spheres", reference.size(), count, missingCount);
+		TEST_CHECK(missingCount == 0);
+	}
+}
+
+/// <summary>
+/// MakePerspectiveFovMatirxの深度は近平面で0、遠平面で1になる(遠平面の項の括弧の修正)
+/// </summary>
+void TestPerspectiveFarTerm() {
+	const float nearClip = 0.1f;
+	const float farClip = 100.0f;
+	const Matrix4x4 projection = MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, nearClip, farClip);
+	TEST_CHECK(std::fabs(projection.m[2][2] - farClip / (farClip - nearClip)) < 1e-6f);
+	TEST_CHECK(std::fabs(projection.m[3][2] + nearClip * farClip / (farClip - nearClip)) < 1e-6f);
+	TEST_CHECK(projection.m[2][3] == 1.0f);
+	for (float z : { nearClip, 1.0f, 50.0f, farClip }) {
+		const float depth = (z * projection.m[2][2] + projection.m[3][2]) / z;
+		const float expected = (z == nearClip) ? 0.0f : (z == farClip) ? 1.0f : farClip * (z - nearClip) / (z * (farClip - nearClip));
+		TEST_CHECK(std::fabs(depth - expected) < 1e-5f);
+	}
+
+	// 取り出した遠平面は z = far にあり、その手前の球は残り、奥の球は消える
+	const Frustum frustum = MakeFrustum(projection);
+	const Plane& farPlane = frustum.planes[5];
+	TEST_CHECK(std::fabs(farPlane.normal.z + 1.0f) < 1e-5f);
+	TEST_CHECK(std::fabs(farPlane.distance - farClip) < 1e-2f);
+	const BoundingSphere spheres[] = { { { 0.0f, 0.0f, farClip - 0.5f }, 0.1f }, { { 0.0f, 0.0f, farClip + 0.5f }, 0.1f },
+		{ { 0.0f, 0.0f, farClip + 0.5f }, 1.0f } };
+	uint32_t visible[3];
+	TEST_CHECK(CullSpheres(frustum, spheres, 3, visible, SimdLevel::Scalar) == 2);
+	TEST_CHECK(visible[0] == 0 && visible[1] == 2);
+}
+
+} // namespace
+
+int main() {
+	std::printf("simd level %s\n", GetSimdLevelName(GetSimdLevel()));
+	const CullingScene scene = MakeScene(100003);
+	TestPointsMatchClipSpace(scene);
+	TestLevelsAndTails(scene);
+	TestPerspectiveFarTerm();
+	return FinishTest();
+}
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "InstanceBatch.h"
+#include "MatrixMath.h"
+#include "SimdSupport.h"
+#include "TestCommon.h"
+#include "TransformBatch.h"
+#include "TransformationMatrix.h"
+
+namespace {
+
+/// <summary>
+/// count個のインスタンスでBuildにかかる時間を測る
+/// </summary>
+void Measure(size_t count, uint32_t materialCount, int repeatCount) {
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> distribution(-3.0f, 3.0f);
+	Matrix4x4 viewProjection{};
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			viewProjection.m[i][j] = distribution(random);
+		}
+	}
+	std::vector<SceneInstance> instances(count);
+	for (SceneInstance& instance : instances) {
+		instance.transform = { { 1.0f + distribution(random) * 0.1f, 1.0f, 1.0f },
+			{ distribution(random), distribution(random), distribution(random) },
+			{ distribution(random) * 10.0f, distribution(random) * 10.0f, distribution(random) * 10.0f } };
+		instance.materialIndex = uint32_t(random() % materialCount);
+	}
+	std::vector<InstanceData> outputs(count);
+
+	// 最初の1回は作業領域の確保を含むので別に測る
+	InstanceBatchBuilder builder;
+	BenchmarkTimer timer;
+	builder.Build(instances.data(), count, materialCount, viewProjection, outputs.data());
+	const double firstMilliseconds = timer.GetElapsedMilliseconds();
+	timer.Restart();
+	for (int i = 0; i < repeatCount; i++) {
+		builder.Build(instances.data(), count, materialCount, viewProjection, outputs.data());
+	}
+	const double buildMilliseconds = timer.GetElapsedMilliseconds() / repeatCount;
+
+	// 比較: 並べ替えずに1つずつ行列を計算する
+	std::vector<TransformationMatrix> matrices(count);
+	timer.Restart();
+	for (int i = 0; i < repeatCount; i++) {
+		for (size_t k = 0; k < count; k++) {
+			ComputeTransformationMatrices(&instances[k].transform, 1, viewProjection, &matrices[k]);
+		}
+	}
+	const double perObjectMilliseconds = timer.GetElapsedMilliseconds() / repeatCount;
+
+	std::printf("%8zu instances, %u materials: Build %8.3f ms (first %8.3f ms, %6.1f M/s), one call per instance %8.3f ms, %zu ranges\n",
+		count, materialCount, buildMilliseconds, firstMilliseconds, count / buildMilliseconds / 1000.0, perObjectMilliseconds,
+		builder.GetRanges().size());
+}
+
+} // namespace
+
+// InstanceBatchBuilder::Buildの時間(GPUなしで、書き込み先は普通のメモリ)
+// 使い方: InstanceBatchBenchmark [インスタンス数(既定は1000, 10000, 100000, 1000000)]
+int main(int argc, char** argv) {
+	std::printf("matrix math level %s\n", GetSimdLevelName(GetMatrixMathLevel()));
+	if (argc > 1) {
+		Measure(std::strtoull(argv[1], nullptr, 10), 4, 20);
+		return 0;
+	}
+	for (size_t count : { size_t(1000), size_t(10000), size_t(100000), size_t(1000000) }) {
+		Measure(count, 4, count >= 1000000 ? 5 : 50);
+	}
+	Measure(100000, 64, 50);
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+// 行列演算の命令セットごとの速さ(百万行列/秒)
+// 使い方: MatrixMathBenchmark [行列の数(既定は100万)]
+int main(int argc, char** argv) {
+	const size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+	std::vector<Matrix4x4> matrices(count);
+	std::vector<Matrix4x4> affines(count);
+	for (size_t i = 0; i < count; i++) {
+		for (auto& row : matrices[i].m) {
+			for (float& element : row) {
+				element = value(random);
+			}
+		}
+		affines[i] = MakeAffineMatrix({ value(random) + 3.0f, value(random) + 3.0f, value(random) + 3.0f },
+			Vector3{ value(random), value(random), value(random) }, { value(random), value(random), value(random) });
+	}
+	std::vector<Matrix4x4> outputs(count);
+	const Matrix4x4 viewProjection = MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+	std::printf("%zu matrices, Mmatrices/s\n", count);
+	std::printf("level   Multiply   Inverse  InverseAffine  Transform  MultiplyArray\n");
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		SetMatrixMathLevel(level);
+		if (GetMatrixMathLevel() != level) {
+			continue;
+		}
+		double rates[5];
+		BenchmarkTimer timer;
+		for (size_t i = 0; i < count; i++) {
+			outputs[i] = Multiply(matrices[i], viewProjection);
+		}
+		rates[0] = count / timer.GetElapsedMilliseconds() / 1000.0;
+
+		timer.Restart();
+		for (size_t i = 0; i < count; i++) {
+			outputs[i] = Inverse(matrices[i]);
+		}
+		rates[1] = count / timer.GetElapsedMilliseconds() / 1000.0;
+
+		timer.Restart();
+		for (size_t i = 0; i < count; i++) {
+			outputs[i] = InverseAffine(affines[i]);
+		}
+		rates[2] = count / timer.GetElapsedMilliseconds() / 1000.0;
+
+		timer.Restart();
+		float sum = 0.0f;
+		for (size_t i = 0; i < count; i++) {
+			const Vector4 transformed = Multiply(Vector4{ matrices[i].m[0][0], 1.0f, 2.0f, 1.0f }, viewProjection);
+			sum += transformed.w;
+		}
+		rates[3] = count / timer.GetElapsedMilliseconds() / 1000.0;
+		outputs[0].m[0][0] += sum;
+
+		timer.Restart();
+		MultiplyArray(matrices.data(), viewProjection, outputs.data(), count);
+		rates[4] = count / timer.GetElapsedMilliseconds() / 1000.0;
+
+		std::printf("%-6s %9.1f %9.1f %14.1f %10.1f %14.1f\n", GetSimdLevelName(level), rates[0], rates[1], rates[2], rates[3], rates[4]);
+	}
+
+	// 最適化で計算が消されないように結果を使う
+	double checksum = 0.0;
+	for (const Matrix4x4& output : outputs) {
+		checksum += output.m[3][3];
+	}
+	std::printf("checksum %g\n", checksum);
+	return 0;
+}
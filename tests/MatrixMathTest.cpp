@@ -0,0 +1,167 @@
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include "MatrixMath.h"
+#include "TestCommon.h"
+
+namespace {
+
+// 比べる命令セット(CPUが対応していなければ丸められる)
+constexpr SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+/// <summary>
+/// 要素ごとの最大の差
+/// </summary>
+float MaxDifference(const Matrix4x4& a, const Matrix4x4& b) {
+	float difference = 0.0f;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			difference = std::fmax(difference, std::fabs(a.m[row][column] - b.m[row][column]));
+		}
+	}
+	return difference;
+}
+
+/// <summary>
+/// 定義どおりの乗算(doubleで計算)
+/// </summary>
+Matrix4x4 ReferenceMultiply(const Matrix4x4& a, const Matrix4x4& b) {
+	Matrix4x4 result;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			double sum = 0.0;
+			for (int k = 0; k < 4; k++) {
+				sum += double(a.m[row][k]) * b.m[k][column];
+			}
+			result.m[row][column] = float(sum);
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// 単位行列との最大の差
+/// </summary>
+float MaxIdentityDifference(const Matrix4x4& matrix) {
+	return MaxDifference(matrix, MakeIdentityMatrix4x4());
+}
+
+/// <summary>
+/// 要素が-2から2の乱数の行列
+/// </summary>
+Matrix4x4 MakeRandomMatrix(std::mt19937& random) {
+	std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+	Matrix4x4 matrix;
+	for (auto& row : matrix.m) {
+		for (float& element : row) {
+			element = value(random);
+		}
+	}
+	return matrix;
+}
+
+/// <summary>
+/// 各命令セットの結果を定義どおりの計算と比べる
+/// </summary>
+void TestKernels() {
+	for (SimdLevel level : kLevels) {
+		SetMatrixMathLevel(level);
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+		float multiplyError = 0.0f;
+		float inverseError = 0.0f;
+		float inverseAffineError = 0.0f;
+		float transformError = 0.0f;
+		float arrayError = 0.0f;
+		for (int n = 0; n < 10000; n++) {
+			const Matrix4x4 a = MakeRandomMatrix(random);
+			const Matrix4x4 b = MakeRandomMatrix(random);
+			multiplyError = std::fmax(multiplyError, MaxDifference(Multiply(a, b), ReferenceMultiply(a, b)));
+
+			// 条件数の悪い行列は誤差が大きくなるので、逆行列の要素が小さいものだけ調べる
+			const Matrix4x4 inverse = Inverse(a);
+			float inverseMax = 0.0f;
+			for (auto& row : inverse.m) {
+				for (float element : row) {
+					inverseMax = std::fmax(inverseMax, std::fabs(element));
+				}
+			}
+			if (inverseMax < 50.0f) {
+				inverseError = std::fmax(inverseError, MaxIdentityDifference(ReferenceMultiply(a, inverse)) / inverseMax);
+			}
+
+			const Matrix4x4 affine = MakeAffineMatrix({ value(random) + 3.0f, value(random) + 3.0f, value(random) + 3.0f },
+				Vector3{ value(random), value(random), value(random) }, { value(random), value(random), value(random) });
+			inverseAffineError = std::fmax(inverseAffineError, MaxIdentityDifference(ReferenceMultiply(affine, InverseAffine(affine))));
+
+			const Vector4 vector{ value(random), value(random), value(random), value(random) };
+			const Vector4 transformed = Multiply(vector, a);
+			const float expected[4] = {
+				vector.x * a.m[0][0] + vector.y * a.m[1][0] + vector.z * a.m[2][0] + vector.w * a.m[3][0],
+				vector.x * a.m[0][1] + vector.y * a.m[1][1] + vector.z * a.m[2][1] + vector.w * a.m[3][1],
+				vector.x * a.m[0][2] + vector.y * a.m[1][2] + vector.z * a.m[2][2] + vector.w * a.m[3][2],
+				vector.x * a.m[0][3] + vector.y * a.m[1][3] + vector.z * a.m[2][3] + vector.w * a.m[3][3],
+			};
+			transformError = std::fmax(transformError, std::fabs(transformed.x - expected[0]));
+			transformError = std::fmax(transformError, std::fabs(transformed.y - expected[1]));
+			transformError = std::fmax(transformError, std::fabs(transformed.z - expected[2]));
+			transformError = std::fmax(transformError, std::fabs(transformed.w - expected[3]));
+
+			// 入力と出力が同じ配列でもよい
+			Matrix4x4 matrices[3] = { a, b, a };
+			MultiplyArray(matrices, b, matrices, 3);
+			arrayError = std::fmax(arrayError, MaxDifference(matrices[0], ReferenceMultiply(a, b)));
+			arrayError = std::fmax(arrayError, MaxDifference(matrices[1], ReferenceMultiply(b, b)));
+		}
+		std::printf("%-6s multiply %.2g inverse %.2g inverseAffine %.2g transform %.2g array %.2g\n",
+			GetSimdLevelName(GetMatrixMathLevel()), multiplyError, inverseError, inverseAffineError, transformError, arrayError);
+		TEST_CHECK(multiplyError < 1e-5f);
+		TEST_CHECK(inverseError < 1e-4f);
+		TEST_CHECK(inverseAffineError < 1e-5f);
+		TEST_CHECK(transformError < 1e-5f);
+		TEST_CHECK(arrayError < 1e-5f);
+	}
+	SetMatrixMathLevel(GetSimdLevel());
+}
+
+/// <summary>
+/// 別スレッドが計算している間に命令セットを切り替えても結果が壊れない
+/// </summary>
+void TestConcurrentLevelChange() {
+	std::mt19937 random(2);
+	const Matrix4x4 a = MakeRandomMatrix(random);
+	const Matrix4x4 b = MakeRandomMatrix(random);
+	const Matrix4x4 expected = ReferenceMultiply(a, b);
+
+	std::atomic<bool> isDone{ false };
+	std::atomic<int> badCount{ 0 };
+	std::vector<std::thread> workers;
+	for (int i = 0; i < 2; i++) {
+		workers.emplace_back([&] {
+			while (!isDone.load(std::memory_order_relaxed)) {
+				if (MaxDifference(Multiply(a, b), expected) > 1e-5f) {
+					badCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+	}
+	for (int n = 0; n < 20000; n++) {
+		SetMatrixMathLevel(kLevels[n % 3]);
+	}
+	isDone = true;
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	TEST_CHECK(badCount.load() == 0);
+	SetMatrixMathLevel(GetSimdLevel());
+}
+
+} // namespace
+
+int main() {
+	TestKernels();
+	TestConcurrentLevelChange();
+	return FinishTest();
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include "MeshGenerator.h"
+#include "MeshLod.h"
+#include "MeshSimplifier.h"
+#include "TestCommon.h"
+#include "VertexCache.h"
+
+namespace {
+
+/// <summary>
+/// 三角形リストの形のチェック(範囲内、縮退なし、同じ向きの辺を2つの三角形が持たない)
+/// </summary>
+bool IsWellFormed(const std::vector<uint32_t>& indices, size_t begin, size_t count, size_t vertexCount) {
+	std::set<std::pair<uint32_t, uint32_t>> edges;
+	for (size_t i = begin; i < begin + count; i += 3) {
+		const uint32_t corners[3] = { indices[i], indices[i + 1], indices[i + 2] };
+		for (int k = 0; k < 3; k++) {
+			if (corners[k] >= vertexCount || corners[k] == corners[(k + 1) % 3]) {
+				return false;
+			}
+			if (!edges.insert({ corners[k], corners[(k + 1) % 3] }).second) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// 位置を共有する頂点(UVの継ぎ目と極)の番号
+/// </summary>
+std::vector<uint32_t> FindSharedPositionVertices(const MeshData& mesh) {
+	std::map<std::tuple<float, float, float>, std::vector<uint32_t>> positions;
+	for (uint32_t i = 0; i < mesh.vertices.size(); i++) {
+		const Vector4& position = mesh.vertices[i].position;
+		positions[{ position.x, position.y, position.z }].push_back(i);
+	}
+	std::vector<uint32_t> shared;
+	for (const auto& [position, vertices] : positions) {
+		if (vertices.size() > 1) {
+			shared.insert(shared.end(), vertices.begin(), vertices.end());
+		}
+	}
+	return shared;
+}
+
+/// <summary>
+/// 球のLODの列
+/// </summary>
+void TestSphereLodChain(uint32_t subdivision) {
+	MeshData mesh = GenerateSphereMesh(subdivision);
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+	const float maxError = 0.5f;
+	BenchmarkTimer timer;
+	const MeshLodChain chain = GenerateLodChain(mesh, 6, 0.5f, maxError);
+	const double milliseconds = timer.GetElapsedMilliseconds();
+
+	TEST_CHECK(!chain.lods.empty());
+	TEST_CHECK(chain.lods[0].indexCount == mesh.indices.size());
+	const std::vector<uint32_t> sharedVertices = FindSharedPositionVertices(mesh);
+	std::printf("sphere %u (%.0f ms):", subdivision, milliseconds);
+	double baseDeviation = 0.0;
+	for (size_t level = 0; level < chain.lods.size(); level++) {
+		const MeshLod& lod = chain.lods[level];
+		std::printf(" %u/%.4f", lod.indexCount / 3, lod.error);
+		TEST_CHECK(lod.indexCount % 3 == 0 && lod.indexCount > 0);
+		TEST_CHECK(size_t(lod.indexStart) + lod.indexCount <= chain.indices.size());
+		TEST_CHECK(IsWellFormed(chain.indices, lod.indexStart, lod.indexCount, mesh.vertices.size()));
+		TEST_CHECK(lod.error <= maxError);
+		if (level > 0) {
+			TEST_CHECK(lod.indexCount < chain.lods[level - 1].indexCount);
+			TEST_CHECK(lod.error >= chain.lods[level - 1].error);
+		}
+
+		// 継ぎ目と極の頂点は動かさないので、どの段階でも使われ続ける
+		std::vector<bool> isUsed(mesh.vertices.size(), false);
+		for (uint32_t i = lod.indexStart; i < lod.indexStart + lod.indexCount; i++) {
+			isUsed[chain.indices[i]] = true;
+		}
+		TEST_CHECK(std::all_of(sharedVertices.begin(), sharedVertices.end(), [&](uint32_t vertex) { return isUsed[vertex]; }));
+
+		// 頂点は単位球の上にあるので、三角形の重心が球から離れる量は元のメッシュの分と誤差の2倍までに収まる
+		double maxDeviation = 0.0;
+		for (uint32_t i = lod.indexStart; i < lod.indexStart + lod.indexCount; i += 3) {
+			double centroid[3] = {};
+			for (int k = 0; k < 3; k++) {
+				const Vector4& position = mesh.vertices[chain.indices[i + k]].position;
+				centroid[0] += position.x / 3.0;
+				centroid[1] += position.y / 3.0;
+				centroid[2] += position.z / 3.0;
+			}
+			maxDeviation = std::max(maxDeviation, 1.0 - std::sqrt(centroid[0] * centroid[0] + centroid[1] * centroid[1] + centroid[2] * centroid[2]));
+		}
+		if (level == 0) {
+			baseDeviation = maxDeviation;
+		}
+		TEST_CHECK(maxDeviation <= baseDeviation + 2.0 * lod.error);
+	}
+	std::printf(" (triangles/error)\n");
+
+	// 遠いほど粗いLODを選ぶ
+	uint32_t previous = 0;
+	for (float distance : { 1.0f, 2.0f, 5.0f, 20.0f, 80.0f, 1000.0f }) {
+		const uint32_t level = SelectLod(chain, 1.0f, distance, 0.45f, 720.0f, 1.0f);
+		TEST_CHECK(level < chain.lods.size());
+		TEST_CHECK(level >= previous);
+		previous = level;
+	}
+	TEST_CHECK(SelectLod(chain, 1.0f, 1e6f, 0.45f, 720.0f, 1.0f) == chain.lods.size() - 1);
+}
+
+/// <summary>
+/// 平らな格子は誤差なしで減らせて、開いた境界の頂点は残る
+/// </summary>
+void TestFlatGrid() {
+	const uint32_t size = 32;
+	MeshData mesh;
+	for (uint32_t y = 0; y <= size; y++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			VertexData vertex{};
+			vertex.position = { float(x), float(y), 0.0f, 1.0f };
+			vertex.normal = { 0.0f, 0.0f, -1.0f };
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			const uint32_t v = y * (size + 1) + x;
+			mesh.indices.insert(mesh.indices.end(), { v, v + 1, v + size + 1, v + 1, v + size + 2, v + size + 1 });
+		}
+	}
+
+	float error = -1.0f;
+	const std::vector<uint32_t> simplified = SimplifyMesh(mesh, mesh.indices, 0, 1e-4f, &error);
+	TEST_CHECK(IsWellFormed(simplified, 0, simplified.size(), mesh.vertices.size()));
+	TEST_CHECK(simplified.size() < mesh.indices.size() / 4);
+	TEST_CHECK(error >= 0.0f && error <= 1e-4f);
+
+	// 面積と向きが変わらない(裏返った三角形があれば符号付き面積の和が減る)
+	double area = 0.0;
+	std::vector<bool> isUsed(mesh.vertices.size(), false);
+	for (size_t i = 0; i < simplified.size(); i += 3) {
+		const Vector4& p0 = mesh.vertices[simplified[i]].position;
+		const Vector4& p1 = mesh.vertices[simplified[i + 1]].position;
+		const Vector4& p2 = mesh.vertices[simplified[i + 2]].position;
+		const double signedArea = 0.5 * ((p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x));
+		TEST_CHECK(signedArea > 0.0);
+		area += signedArea;
+		isUsed[simplified[i]] = isUsed[simplified[i + 1]] = isUsed[simplified[i + 2]] = true;
+	}
+	TEST_CHECK(std::fabs(area - double(size) * size) < 1e-6);
+	bool isBorderKept = true;
+	for (uint32_t i = 0; i <= size; i++) {
+		isBorderKept = isBorderKept && isUsed[i] && isUsed[size * (size + 1) + i] && isUsed[i * (size + 1)] && isUsed[i * (size + 1) + size];
+	}
+	TEST_CHECK(isBorderKept);
+	std::printf("flat grid: %zu -> %zu triangles, error %g\n", mesh.indices.size() / 3, simplified.size() / 3, error);
+}
+
+} // namespace
+
+int main() {
+	TestSphereLodChain(16);
+	TestSphereLodChain(64);
+	TestFlatGrid();
+	return FinishTest();
+}
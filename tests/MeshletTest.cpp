@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include "MeshGenerator.h"
+#include "Meshlet.h"
+#include "TestCommon.h"
+#include "VertexCache.h"
+
+namespace {
+
+/// <summary>
+/// 回転しても同じになるように最小の番号から並べた三角形
+/// </summary>
+std::array<uint32_t, 3> MakeTriangleKey(uint32_t i0, uint32_t i1, uint32_t i2) {
+	std::array<uint32_t, 3> key{ i0, i1, i2 };
+	while (key[0] > key[1] || key[0] > key[2]) {
+		std::rotate(key.begin(), key.begin() + 1, key.end());
+	}
+	return key;
+}
+
+/// <summary>
+/// メッシュレットの三角形の元の頂点番号
+/// </summary>
+std::array<uint32_t, 3> GetMeshletTriangle(const MeshletData& data, const Meshlet& meshlet, uint32_t triangle) {
+	const uint8_t* corners = &data.triangles[meshlet.triangleOffset + triangle * 3];
+	return { data.vertices[meshlet.vertexOffset + corners[0]], data.vertices[meshlet.vertexOffset + corners[1]],
+		data.vertices[meshlet.vertexOffset + corners[2]] };
+}
+
+/// <summary>
+/// 分割と、ランダムな視点からのカリングが表向きの三角形を捨てないこと
+/// </summary>
+void TestSphere(uint32_t subdivision) {
+	MeshData mesh = GenerateSphereMesh(subdivision);
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+	MeshletData data;
+	BenchmarkTimer timer;
+	BuildMeshlets(mesh.vertices, mesh.indices.data(), mesh.indices.size(), data);
+	const double milliseconds = timer.GetElapsedMilliseconds();
+	TEST_CHECK(data.bounds.size() == data.meshlets.size());
+
+	// 上限を守り、元と同じ三角形(向きを含む)をちょうど1回ずつ持つ
+	std::vector<std::array<uint32_t, 3>> expected, actual;
+	for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+		expected.push_back(MakeTriangleKey(mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]));
+	}
+	bool isInLimit = true;
+	bool isInRange = true;
+	uint32_t triangleCount = 0;
+	for (const Meshlet& meshlet : data.meshlets) {
+		isInLimit = isInLimit && meshlet.vertexCount <= kMeshletMaxVertices && meshlet.triangleCount <= kMeshletMaxTriangles;
+		isInRange = isInRange && meshlet.vertexOffset + meshlet.vertexCount <= data.vertices.size() &&
+			meshlet.triangleOffset + meshlet.triangleCount * 3 <= data.triangles.size();
+		for (uint32_t t = 0; t < meshlet.triangleCount * 3; t++) {
+			isInRange = isInRange && data.triangles[meshlet.triangleOffset + t] < meshlet.vertexCount;
+		}
+		if (!isInRange) {
+			break;
+		}
+		for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+			const std::array<uint32_t, 3> triangle = GetMeshletTriangle(data, meshlet, t);
+			actual.push_back(MakeTriangleKey(triangle[0], triangle[1], triangle[2]));
+		}
+		triangleCount += meshlet.triangleCount;
+	}
+	TEST_CHECK(isInLimit);
+	TEST_CHECK(isInRange);
+	std::sort(expected.begin(), expected.end());
+	std::sort(actual.begin(), actual.end());
+	TEST_CHECK(actual == expected);
+
+	// カリングされたメッシュレットに表向き(視点が三角形の表側にある)の三角形があってはいけない
+	std::mt19937 random(10);
+	std::uniform_real_distribution<float> distribution(-6.0f, 6.0f);
+	const int eyeCount = 200;
+	size_t frontFacingCulledCount = 0;
+	double culledRatio = 0.0;
+	std::vector<uint32_t> visibleMeshlets;
+	for (int i = 0; i < eyeCount; i++) {
+		const Vector3 eye{ distribution(random), distribution(random), distribution(random) };
+		visibleMeshlets.clear();
+		const uint32_t remaining = CullMeshlets(data, eye, visibleMeshlets);
+		culledRatio += 1.0 - double(remaining) / triangleCount;
+
+		std::vector<bool> isVisible(data.meshlets.size(), false);
+		uint32_t visibleTriangleCount = 0;
+		for (uint32_t index : visibleMeshlets) {
+			isVisible[index] = true;
+			visibleTriangleCount += data.meshlets[index].triangleCount;
+		}
+		TEST_CHECK(visibleTriangleCount == remaining);
+		for (size_t m = 0; m < data.meshlets.size(); m++) {
+			if (isVisible[m]) {
+				continue;
+			}
+			TEST_CHECK(IsMeshletBackfacing(data.bounds[m], eye));
+			for (uint32_t t = 0; t < data.meshlets[m].triangleCount; t++) {
+				const std::array<uint32_t, 3> triangle = GetMeshletTriangle(data, data.meshlets[m], t);
+				const Vector4& p0 = mesh.vertices[triangle[0]].position;
+				const Vector4& p1 = mesh.vertices[triangle[1]].position;
+				const Vector4& p2 = mesh.vertices[triangle[2]].position;
+				const float ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+				const float vx = p2.x - p0.x, vy = p2.y - p0.y, vz = p2.z - p0.z;
+				const float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+				if (nx * (eye.x - p0.x) + ny * (eye.y - p0.y) + nz * (eye.z - p0.z) > 1e-6f) {
+					frontFacingCulledCount++;
+				}
+			}
+		}
+	}
+	TEST_CHECK(frontFacingCulledCount == 0);
+	std::printf("sphere %u: %u triangles -> %zu meshlets (%.1f ms), culled %.1f%% on average, front-facing culled %zu\n",
+		subdivision, triangleCount, data.meshlets.size(), milliseconds, 100.0 * culledRatio / eyeCount, frontFacingCulledCount);
+}
+
+/// <summary>
+/// outputの後ろに追加され、前のメッシュレットを壊さない
+/// </summary>
+void TestAppend() {
+	const MeshData first = GenerateSphereMesh(8);
+	const MeshData second = GenerateSphereMesh(12);
+	MeshletData data;
+	BuildMeshlets(first.vertices, first.indices.data(), first.indices.size(), data);
+	const MeshletData firstOnly = data;
+	BuildMeshlets(second.vertices, second.indices.data(), second.indices.size(), data);
+	TEST_CHECK(data.meshlets.size() > firstOnly.meshlets.size());
+	TEST_CHECK(std::equal(firstOnly.vertices.begin(), firstOnly.vertices.end(), data.vertices.begin()));
+	TEST_CHECK(std::equal(firstOnly.triangles.begin(), firstOnly.triangles.end(), data.triangles.begin()));
+	const Meshlet& appended = data.meshlets[firstOnly.meshlets.size()];
+	TEST_CHECK(appended.vertexOffset == firstOnly.vertices.size());
+	TEST_CHECK(appended.triangleOffset == firstOnly.triangles.size());
+}
+
+/// <summary>
+/// 三角形がなければメッシュレットを作らない
+/// </summary>
+void TestEmpty() {
+	const MeshData mesh = GenerateSphereMesh(4);
+	MeshletData data;
+	BuildMeshlets(mesh.vertices, mesh.indices.data(), 0, data);
+	TEST_CHECK(data.meshlets.empty());
+	TEST_CHECK(data.bounds.empty());
+	std::vector<uint32_t> visibleMeshlets;
+	TEST_CHECK(CullMeshlets(data, { 0.0f, 0.0f, -10.0f }, visibleMeshlets) == 0);
+}
+
+} // namespace
+
+int main() {
+	for (uint32_t subdivision : { 16u, 64u, 256u }) {
+		TestSphere(subdivision);
+	}
+	TestAppend();
+	TestEmpty();
+	return FinishTest();
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include "ObjLoader.h"
+#include "ObjTestFile.h"
+#include "TestCommon.h"
+#include "ThreadPool.h"
+
+// 生成した大きなOBJの読み込みの速さ(MB/s、OBJのバイト数で割る)
+// 解析: キャッシュを使わずにLoadObjFile(1スレッドとスレッドプール)、キャッシュ: LoadModelFileで.meshcacheを読むとき
+// ファイルはOSのページキャッシュに載った状態で測る(ディスクの速さは含まない)
+// 使い方: ObjLoaderBenchmark [格子の大きさ(既定は1024で約210万三角形)]
+int main(int argc, char** argv) {
+	const size_t size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1024;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "CG2ObjLoaderBenchmark";
+	std::filesystem::create_directories(directory);
+	const std::string filename = "grid.obj";
+	const std::string objPath = (directory / filename).string();
+	const std::string cachePath = objPath + ".meshcache";
+
+	const size_t objSize = WriteGridObj(objPath, size);
+	if (objSize == 0) {
+		std::printf("failed to write %s\n", objPath.c_str());
+		return 1;
+	}
+	const double objMegabytes = double(objSize) / (1024.0 * 1024.0);
+	std::printf("%zu triangles, OBJ %.1f MB\n", 2 * size * size, objMegabytes);
+
+	ThreadPool pool;
+	const struct {
+		const char* name;
+		ThreadPool* pool;
+	} kRuns[] = { { "1 thread", nullptr }, { "pool", &pool } };
+	for (const auto& run : kRuns) {
+		double best = 1e30;
+		ModelData model;
+		for (int i = 0; i < 3; i++) {
+			BenchmarkTimer timer;
+			if (!LoadObjFile(directory.string(), filename, model, run.pool)) {
+				std::printf("failed to parse %s\n", objPath.c_str());
+				return 1;
+			}
+			best = std::min(best, timer.GetElapsedMilliseconds());
+		}
+		std::printf("parse (%s, %zu workers) %9.1f ms %8.1f MB/s  %zu vertices\n", run.name, run.pool ? pool.GetWorkerCount() : 0, best,
+			objMegabytes / (best / 1000.0), model.mesh.vertices.size());
+	}
+
+	// キャッシュを作ってから読む
+	std::filesystem::remove(cachePath);
+	ModelData model;
+	BenchmarkTimer timer;
+	if (!LoadModelFile(directory.string(), filename, model, &pool) || !std::filesystem::exists(cachePath)) {
+		std::printf("failed to write %s\n", cachePath.c_str());
+		return 1;
+	}
+	std::printf("parse and write cache  %9.1f ms\n", timer.GetElapsedMilliseconds());
+	const double cacheMegabytes = double(std::filesystem::file_size(cachePath)) / (1024.0 * 1024.0);
+	double best = 1e30;
+	for (int i = 0; i < 3; i++) {
+		timer.Restart();
+		if (!LoadModelFile(directory.string(), filename, model, &pool)) {
+			return 1;
+		}
+		best = std::min(best, timer.GetElapsedMilliseconds());
+	}
+	std::printf("cache hit              %9.1f ms %8.1f MB/s of OBJ (cache %.1f MB, %.1f MB/s)\n", best, objMegabytes / (best / 1000.0),
+		cacheMegabytes, cacheMegabytes / (best / 1000.0));
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
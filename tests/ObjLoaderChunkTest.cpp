@@ -0,0 +1,159 @@
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "ObjLoader.h"
+#include "TestCommon.h"
+#include "ThreadPool.h"
+
+namespace {
+
+/// <summary>
+/// 分け方で結果が変わりそうなものを混ぜたOBJのテキストを作る
+/// 改行はCRLFとLFが混ざり、面は負のインデックスで直前のv/vt/vnを指す(チャンクの先頭より前も指す)
+/// </summary>
+std::string MakeMixedObjText() {
+	std::mt19937 random(8);
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+	std::string text = "# chunk test\r\n\r\n";
+	char buffer[160];
+	size_t positionCount = 0, texcoordCount = 0, normalCount = 0;
+	auto newline = [&] { return (random() % 4 == 0) ? "\n" : "\r\n"; };
+	for (int i = 0; i < 12; i++) {
+		std::snprintf(buffer, sizeof(buffer), "v %.4f %.4f %.4f%s", coordinate(random), coordinate(random), coordinate(random), newline());
+		text += buffer;
+		positionCount++;
+	}
+	for (int face = 0; face < 400; face++) {
+		// 頂点を足す(vt、vnは時々)
+		const int addCount = int(random() % 3);
+		for (int i = 0; i < addCount; i++) {
+			std::snprintf(buffer, sizeof(buffer), "v %.4f %.4f %.4f%s", coordinate(random), coordinate(random), coordinate(random), newline());
+			text += buffer;
+			positionCount++;
+		}
+		if (random() % 3 == 0) {
+			std::snprintf(buffer, sizeof(buffer), "vt %.3f %.3f%s", coordinate(random) * 0.05f + 0.5f, coordinate(random) * 0.05f + 0.5f, newline());
+			text += buffer;
+			texcoordCount++;
+		}
+		if (random() % 5 == 0) {
+			std::snprintf(buffer, sizeof(buffer), "vn %.3f %.3f 1%s", coordinate(random) * 0.1f, coordinate(random) * 0.1f, newline());
+			text += buffer;
+			normalCount++;
+		}
+		if (random() % 40 == 0) {
+			std::snprintf(buffer, sizeof(buffer), "usemtl material%u%s", unsigned(random() % 3), newline());
+			text += buffer;
+		}
+		if (random() % 25 == 0) {
+			text += "# comment\r\ng group\r\n  \r\n";
+		}
+
+		// 3～5角形で、v、v/vt、v//vn、v/vt/vnのどれか(負と正のインデックスを混ぜる)
+		const int cornerCount = 3 + int(random() % 3);
+		const int form = int(random() % 4);
+		const bool useTexcoord = (form == 1 || form == 3) && texcoordCount > 0;
+		const bool useNormal = (form == 2 || form == 3) && normalCount > 0;
+		text += "f";
+		for (int c = 0; c < cornerCount; c++) {
+			const size_t back = 1 + random() % std::min<size_t>(positionCount, 30);
+			if (random() % 2 == 0) {
+				std::snprintf(buffer, sizeof(buffer), " -%zu", back);
+			} else {
+				std::snprintf(buffer, sizeof(buffer), " %zu", positionCount + 1 - back);
+			}
+			text += buffer;
+			if (useTexcoord) {
+				std::snprintf(buffer, sizeof(buffer), "/-%zu", size_t(1 + random() % std::min<size_t>(texcoordCount, 4)));
+				text += buffer;
+			} else if (useNormal) {
+				text += "/";
+			}
+			if (useNormal) {
+				std::snprintf(buffer, sizeof(buffer), "/%zu", size_t(normalCount - random() % std::min<size_t>(normalCount, 4)));
+				text += buffer;
+			}
+		}
+		text += newline();
+	}
+	// 最後の行は改行なし
+	text += "f -1 -2 -3";
+	return text;
+}
+
+/// <summary>
+/// 頂点とインデックスと範囲がバイト単位で同じか
+/// </summary>
+bool IsIdentical(const ModelData& a, const ModelData& b) {
+	if (a.mesh.vertices.size() != b.mesh.vertices.size() || a.mesh.indices != b.mesh.indices || a.subsets.size() != b.subsets.size() ||
+		a.materials.size() != b.materials.size()) {
+		return false;
+	}
+	if (!a.mesh.vertices.empty() && std::memcmp(a.mesh.vertices.data(), b.mesh.vertices.data(), sizeof(VertexData) * a.mesh.vertices.size()) != 0) {
+		return false;
+	}
+	if (!a.subsets.empty() && std::memcmp(a.subsets.data(), b.subsets.data(), sizeof(ModelSubset) * a.subsets.size()) != 0) {
+		return false;
+	}
+	for (size_t i = 0; i < a.materials.size(); i++) {
+		if (a.materials[i].name != b.materials[i].name) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+// チャンクの数とスレッド数を変えても、頂点とインデックスが1チャンクで読んだときとバイト単位で同じになること
+int main() {
+	const std::string text = MakeMixedObjText();
+	ModelData reference;
+	TEST_CHECK(LoadObjText(text.data(), text.size(), ".", reference, nullptr, 1));
+	TEST_CHECK(reference.mesh.indices.size() > 1000);
+	TEST_CHECK(reference.subsets.size() > 3);
+
+	// 行の途中やCRLFの間に仮の境目が来ることを確かめる
+	// (LoadObjTextはテキストを size / count * i の位置で仮に区切り、次の行の先頭まで進める)
+	size_t insideLineCount = 0;
+	size_t insideCrlfCount = 0;
+	const size_t maxChunkCount = 300;
+	for (size_t count = 2; count <= maxChunkCount; count++) {
+		for (size_t i = 1; i < count; i++) {
+			const size_t position = text.size() / count * i;
+			if (text[position - 1] == '\r' && text[position] == '\n') {
+				insideCrlfCount++;
+			} else if (text[position - 1] != '\n') {
+				insideLineCount++;
+			}
+		}
+	}
+	TEST_CHECK(insideLineCount > 0);
+	TEST_CHECK(insideCrlfCount > 0);
+
+	std::unique_ptr<ThreadPool> pools[] = { nullptr, std::make_unique<ThreadPool>(1), std::make_unique<ThreadPool>(3) };
+	size_t mismatchCount = 0;
+	for (const std::unique_ptr<ThreadPool>& pool : pools) {
+		// 行より多いチャンク数(空のチャンクは作らない)も試す
+		for (size_t count : { size_t(0), size_t(2), size_t(3), size_t(7), size_t(16), size_t(61), size_t(maxChunkCount), text.size() }) {
+			ModelData model;
+			TEST_CHECK(LoadObjText(text.data(), text.size(), ".", model, pool.get(), count));
+			if (!IsIdentical(reference, model)) {
+				mismatchCount++;
+			}
+		}
+	}
+	// 1スレッドですべてのチャンク数を試す
+	for (size_t count = 2; count <= maxChunkCount; count++) {
+		ModelData model;
+		LoadObjText(text.data(), text.size(), ".", model, nullptr, count);
+		if (!IsIdentical(reference, model)) {
+			std::printf("chunk count %zu differs\n", count);
+			mismatchCount++;
+		}
+	}
+	TEST_CHECK(mismatchCount == 0);
+	return FinishTest();
+}
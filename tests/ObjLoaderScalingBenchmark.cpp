@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include "ObjLoader.h"
+#include "ObjTestFile.h"
+#include "TestCommon.h"
+#include "ThreadPool.h"
+
+namespace {
+
+/// <summary>
+/// 3回読んで一番速かったミリ秒(失敗したら0)
+/// </summary>
+double ParseBest(const std::string& directory, const std::string& filename, ThreadPool* pool, ModelData& model) {
+	double best = 1e30;
+	for (int i = 0; i < 3; i++) {
+		BenchmarkTimer timer;
+		if (!LoadObjFile(directory, filename, model, pool)) {
+			return 0.0;
+		}
+		best = std::min(best, timer.GetElapsedMilliseconds());
+	}
+	return best;
+}
+
+} // namespace
+
+// 同じ大きなOBJを、ThreadPoolのワーカー数を1からNまで変えてLoadObjFileで読む速さ(MB/s)
+// 呼び出し側も処理に加わるので、スレッド数はワーカー数+1
+// 使い方: ObjLoaderScalingBenchmark [最大のワーカー数(既定はCPUのスレッド数、最低4)] [格子の大きさ(既定は1024)]
+int main(int argc, char** argv) {
+	const size_t hardwareThreads = std::thread::hardware_concurrency();
+	const size_t maxWorkerCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : std::max<size_t>(hardwareThreads, 4);
+	const size_t size = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1024;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "CG2ObjLoaderScalingBenchmark";
+	std::filesystem::create_directories(directory);
+	const std::string filename = "grid.obj";
+	const size_t objSize = WriteGridObj((directory / filename).string(), size);
+	if (objSize == 0) {
+		std::printf("failed to write the OBJ\n");
+		return 1;
+	}
+	const double objMegabytes = double(objSize) / (1024.0 * 1024.0);
+	std::printf("%zu triangles, OBJ %.1f MB, hardware threads %zu\n", 2 * size * size, objMegabytes, hardwareThreads);
+
+	ModelData model;
+	const double serial = ParseBest(directory.string(), filename, nullptr, model);
+	if (serial <= 0.0) {
+		std::printf("failed to parse the OBJ\n");
+		return 1;
+	}
+	std::printf("no pool      %9.1f ms %8.1f MB/s\n", serial, objMegabytes / (serial / 1000.0));
+	for (size_t workers = 1; workers <= maxWorkerCount; workers++) {
+		ThreadPool pool(workers);
+		const double milliseconds = ParseBest(directory.string(), filename, &pool, model);
+		if (milliseconds <= 0.0) {
+			return 1;
+		}
+		std::printf("%2zu worker(s) %9.1f ms %8.1f MB/s (x%.2f)%s\n", workers, milliseconds, objMegabytes / (milliseconds / 1000.0),
+			serial / milliseconds, workers + 1 > hardwareThreads ? " oversubscribed" : "");
+	}
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,241 @@
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "ModelCache.h"
+#include "ObjLoader.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// テスト用のファイルを置くディレクトリ
+/// </summary>
+std::string GetTestDirectory() {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "CG2ObjLoaderTest";
+	std::filesystem::create_directories(directory);
+	return directory.string();
+}
+
+/// <summary>
+/// テキストをそのまま(改行を変えずに)書き出す
+/// </summary>
+void WriteTextFile(const std::string& path, const std::string& text) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(text.data(), std::streamsize(text.size()));
+}
+
+bool IsNear(float a, float b) {
+	return std::fabs(a - b) < 1e-5f;
+}
+
+bool IsNear(const Vector3& a, const Vector3& b) {
+	return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z);
+}
+
+/// <summary>
+/// 2つのモデルのメッシュ、マテリアル、範囲が同じか
+/// </summary>
+bool IsSameModel(const ModelData& a, const ModelData& b) {
+	if (a.mesh.vertices.size() != b.mesh.vertices.size() || a.mesh.indices != b.mesh.indices || a.subsets.size() != b.subsets.size() ||
+		a.materials.size() != b.materials.size()) {
+		return false;
+	}
+	if (!a.mesh.vertices.empty() && std::memcmp(a.mesh.vertices.data(), b.mesh.vertices.data(), sizeof(VertexData) * a.mesh.vertices.size()) != 0) {
+		return false;
+	}
+	for (size_t i = 0; i < a.subsets.size(); i++) {
+		if (a.subsets[i].materialIndex != b.subsets[i].materialIndex || a.subsets[i].indexStart != b.subsets[i].indexStart ||
+			a.subsets[i].indexCount != b.subsets[i].indexCount) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < a.materials.size(); i++) {
+		const Vector4& ca = a.materials[i].diffuseColor;
+		const Vector4& cb = b.materials[i].diffuseColor;
+		if (a.materials[i].name != b.materials[i].name || a.materials[i].textureFilePath != b.materials[i].textureFilePath ||
+			ca.x != cb.x || ca.y != cb.y || ca.z != cb.z || ca.w != cb.w) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// 正と負のインデックスが同じ頂点になり、xと三角形の向きが反転されること
+/// </summary>
+void TestNegativeIndices(const std::string& directory) {
+	WriteTextFile(directory + "/absolute.obj",
+		"v 1 0 0\nv 2 0 0\nv 0 3 0\nvt 0 0.25\nvn 0 0 1\n"
+		"f 1/1/1 2/1/1 3/1/1\n");
+	// 同じ三角形を負のインデックス(直前までの数からの相対値)で書く。後ろに余分なvがあっても変わらない
+	WriteTextFile(directory + "/relative.obj",
+		"v 1 0 0\nv 2 0 0\nv 0 3 0\nvt 0 0.25\nvn 0 0 1\n"
+		"f -3/-1/-1 -2/-1/-1 -1/-1/-1\nv 9 9 9\n");
+	ModelData absolute, relative;
+	TEST_CHECK(LoadObjFile(directory, "absolute.obj", absolute));
+	TEST_CHECK(LoadObjFile(directory, "relative.obj", relative));
+	TEST_CHECK(IsSameModel(absolute, relative));
+
+	// 1, 3, 2 の順になり、xは反転、vは1-v
+	TEST_CHECK(absolute.mesh.vertices.size() == 3);
+	TEST_CHECK(absolute.mesh.indices.size() == 3);
+	if (absolute.mesh.vertices.size() == 3 && absolute.mesh.indices.size() == 3) {
+		const VertexData* v = absolute.mesh.vertices.data();
+		const uint32_t* i = absolute.mesh.indices.data();
+		TEST_CHECK(IsNear(v[i[0]].position.x, -1.0f) && IsNear(v[i[1]].position.y, 3.0f) && IsNear(v[i[2]].position.x, -2.0f));
+		TEST_CHECK(v[i[0]].position.w == 1.0f);
+		TEST_CHECK(IsNear(v[i[0]].texcoord.y, 0.75f));
+		TEST_CHECK(IsNear(v[i[0]].normal, { 0.0f, 0.0f, 1.0f }));
+	}
+
+	// 範囲外のインデックスは失敗になる
+	WriteTextFile(directory + "/outofrange.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\nf 1 2 4\n");
+	ModelData broken;
+	TEST_CHECK(!LoadObjFile(directory, "outofrange.obj", broken));
+}
+
+/// <summary>
+/// vt/vnのない面(v, v//vn, v/vt)と多角形の分割
+/// </summary>
+void TestMissingAttributes(const std::string& directory) {
+	// 正方形(右手系で+zを向く)を vだけ の四角形で書く
+	WriteTextFile(directory + "/plain.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n");
+	ModelData plain;
+	TEST_CHECK(LoadObjFile(directory, "plain.obj", plain));
+	TEST_CHECK(plain.mesh.vertices.size() == 4);
+	TEST_CHECK(plain.mesh.indices.size() == 6);
+	for (const VertexData& vertex : plain.mesh.vertices) {
+		// vtがなければ0、vnがなければ面の法線(xの反転後も+z)
+		TEST_CHECK(vertex.texcoord.x == 0.0f && vertex.texcoord.y == 0.0f);
+		TEST_CHECK(IsNear(vertex.normal, { 0.0f, 0.0f, 1.0f }));
+	}
+
+	// v//vn と v/vt が混ざっても読め、vnがあるものはそれを使う
+	WriteTextFile(directory + "/mixed.obj",
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.5 0.5\nvn 1 0 0\n"
+		"f 1//1 2//1 3//1\nf 1/1 2/1 3/1\n");
+	ModelData mixed;
+	TEST_CHECK(LoadObjFile(directory, "mixed.obj", mixed));
+	TEST_CHECK(mixed.mesh.vertices.size() == 6);
+	TEST_CHECK(mixed.mesh.indices.size() == 6);
+	if (mixed.mesh.indices.size() == 6 && mixed.mesh.vertices.size() == 6) {
+		const VertexData& withNormal = mixed.mesh.vertices[mixed.mesh.indices[0]];
+		const VertexData& withTexcoord = mixed.mesh.vertices[mixed.mesh.indices[3]];
+		TEST_CHECK(IsNear(withNormal.normal, { -1.0f, 0.0f, 0.0f }));
+		TEST_CHECK(IsNear(withTexcoord.texcoord.x, 0.5f) && IsNear(withTexcoord.texcoord.y, 0.5f));
+		TEST_CHECK(IsNear(withTexcoord.normal, { 0.0f, 0.0f, 1.0f }));
+	}
+}
+
+/// <summary>
+/// usemtlごとの範囲とMTLの読み込み
+/// </summary>
+void TestMaterialSubsets(const std::string& directory) {
+	WriteTextFile(directory + "/subsets.mtl",
+		"newmtl red\nKd 1 0 0\nmap_Kd -s 1 1 1 red.png\n"
+		"newmtl blue\r\nKd 0 0 1\r\nd 0.5\r\n");
+	// 面のないusemtlは範囲にならず、続けて同じマテリアルなら1つにまとめる
+	WriteTextFile(directory + "/subsets.obj",
+		"mtllib subsets.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+		"f 1 2 3\nusemtl red\nf 1 2 3\nf 2 4 3\nusemtl blue\nusemtl red\nf 1 3 4\nusemtl blue\nf 1 2 4\n");
+	ModelData model;
+	TEST_CHECK(LoadObjFile(directory, "subsets.obj", model));
+	// red, blueとusemtlの前の面のためのdefault
+	TEST_CHECK(model.materials.size() == 3);
+	TEST_CHECK(model.subsets.size() == 3);
+	if (model.materials.size() != 3 || model.subsets.size() != 3) {
+		return;
+	}
+	TEST_CHECK(model.materials[0].name == "red" && model.materials[1].name == "blue" && model.materials[2].name == "default");
+	TEST_CHECK(model.materials[0].textureFilePath == directory + "/red.png");
+	TEST_CHECK(model.materials[0].diffuseColor.x == 1.0f && model.materials[0].diffuseColor.z == 0.0f);
+	TEST_CHECK(model.materials[1].diffuseColor.z == 1.0f && model.materials[1].diffuseColor.w == 0.5f);
+
+	const ModelSubset expected[3] = { { 2, 0, 3 }, { 0, 3, 9 }, { 1, 12, 3 } };
+	for (size_t i = 0; i < 3; i++) {
+		TEST_CHECK(model.subsets[i].materialIndex == expected[i].materialIndex);
+		TEST_CHECK(model.subsets[i].indexStart == expected[i].indexStart);
+		TEST_CHECK(model.subsets[i].indexCount == expected[i].indexCount);
+	}
+}
+
+/// <summary>
+/// 同じv/vt/vnの組は1つの頂点になり、どれかが違えば別の頂点になる
+/// </summary>
+void TestVertexDedup(const std::string& directory) {
+	WriteTextFile(directory + "/dedup.obj",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 1\nvn 0 0 1\n"
+		"f 1/1/1 2/1/1 3/1/1\nf 1/1/1 3/1/1 4/1/1\n"
+		"f 1/2/1 2/1/1 3/1/1\n");
+	ModelData model;
+	TEST_CHECK(LoadObjFile(directory, "dedup.obj", model));
+	// 4つの頂点と、vtだけが違う1/2/1の5つ
+	TEST_CHECK(model.mesh.vertices.size() == 5);
+	TEST_CHECK(model.mesh.indices.size() == 9);
+	if (model.mesh.indices.size() == 9) {
+		// 最初の2つの三角形の1/1/1は同じ頂点
+		TEST_CHECK(model.mesh.indices[0] == model.mesh.indices[3]);
+		TEST_CHECK(model.mesh.indices[6] != model.mesh.indices[0]);
+	}
+}
+
+/// <summary>
+/// キャッシュに書いて読んだものが同じで、元ファイルが変われば使われないこと
+/// </summary>
+void TestCacheRoundTrip(const std::string& directory) {
+	const std::string objPath = directory + "/cached.obj";
+	const std::string cachePath = objPath + ".meshcache";
+	WriteTextFile(directory + "/cached.mtl", "newmtl stone\nKd 0.5 0.5 0.5\nmap_Kd stone.png\n");
+	WriteTextFile(objPath,
+		"mtllib cached.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 1 1\n"
+		"usemtl stone\nf 1/1 2/2 3/3\nusemtl other\nf 1/1 3/3 4/2\n");
+	std::filesystem::remove(cachePath);
+
+	ModelData parsed;
+	TEST_CHECK(LoadModelFile(directory, "cached.obj", parsed));
+	TEST_CHECK(std::filesystem::exists(cachePath));
+	ModelData cached;
+	TEST_CHECK(LoadModelFile(directory, "cached.obj", cached));
+	TEST_CHECK(IsSameModel(parsed, cached));
+
+	// 直接読んでも同じ
+	ModelSourceStamp stamp{};
+	TEST_CHECK(GetModelSourceStamp(objPath, stamp));
+	ModelData direct;
+	TEST_CHECK(ReadModelCache(cachePath, stamp, direct));
+	TEST_CHECK(IsSameModel(parsed, direct));
+
+	// サイズか時刻が違えば読まない
+	ModelSourceStamp changed = stamp;
+	changed.size++;
+	TEST_CHECK(!ReadModelCache(cachePath, changed, direct));
+	changed = stamp;
+	changed.lastWriteTime++;
+	TEST_CHECK(!ReadModelCache(cachePath, changed, direct));
+
+	// 壊れた(短い)キャッシュは読まない
+	WriteTextFile(directory + "/truncated.meshcache", "CGMC");
+	TEST_CHECK(!ReadModelCache(directory + "/truncated.meshcache", stamp, direct));
+
+	// 元ファイルを書き換えたら読み直す
+	WriteTextFile(objPath, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	ModelData reloaded;
+	TEST_CHECK(LoadModelFile(directory, "cached.obj", reloaded));
+	TEST_CHECK(reloaded.mesh.indices.size() == 3);
+	TEST_CHECK(reloaded.materials.size() == 1 && reloaded.materials[0].name == "default");
+}
+
+} // namespace
+
+int main() {
+	const std::string directory = GetTestDirectory();
+	TestNegativeIndices(directory);
+	TestMissingAttributes(directory);
+	TestMaterialSubsets(directory);
+	TestVertexDedup(directory);
+	TestCacheRoundTrip(directory);
+	std::filesystem::remove_all(directory);
+	return FinishTest();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/// <summary>
+/// (size+1)x(size+1)の格子を四角形の面で書いたOBJを作る(三角形は2*size*size個)
+/// </summary>
+/// <returns>書き出したバイト数(失敗したら0)</returns>
+inline size_t WriteGridObj(const std::string& path, size_t size) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	std::string line;
+	char buffer[128];
+	const size_t rowLength = size + 1;
+	for (size_t y = 0; y <= size; y++) {
+		for (size_t x = 0; x <= size; x++) {
+			const float u = float(x) / float(size);
+			const float v = float(y) / float(size);
+			std::snprintf(buffer, sizeof(buffer), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0 0 1\n", u * 100.0f, v * 100.0f, (u - v) * 3.0f, u, v);
+			line += buffer;
+		}
+		file.write(line.data(), std::streamsize(line.size()));
+		line.clear();
+	}
+	for (size_t y = 0; y < size; y++) {
+		for (size_t x = 0; x < size; x++) {
+			const size_t i0 = y * rowLength + x + 1;
+			const size_t i1 = i0 + 1;
+			const size_t i2 = i1 + rowLength;
+			const size_t i3 = i0 + rowLength;
+			// vnはすべて同じ1つを指すので、頂点は格子の点ごとに1つになる
+			std::snprintf(buffer, sizeof(buffer), "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", i0, i0, i1, i1, i2, i2, i3, i3);
+			line += buffer;
+		}
+		file.write(line.data(), std::streamsize(line.size()));
+		line.clear();
+	}
+	file.close();
+	return file ? size_t(std::filesystem::file_size(path)) : 0;
+}
+
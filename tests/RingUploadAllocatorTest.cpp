@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "TestCommon.h"
+#include "UploadAllocator.h"
+
+namespace {
+
+/// <summary>
+/// mallocで1ページだけを作るページの供給元
+/// </summary>
+class MallocPageSource : public UploadPageSource {
+public:
+	static constexpr uint64_t kGpuAddress = 0x10000000;
+
+	bool CreatePage(size_t size, UploadPage& page) override {
+		if (isFailing) {
+			return false;
+		}
+		void* memory = std::aligned_alloc(65536, (size + 65535) / 65536 * 65536);
+		page = { static_cast<uint8_t*>(memory), kGpuAddress, size, memory };
+		++liveCount;
+		return memory != nullptr;
+	}
+
+	void DestroyPage(const UploadPage& page) override {
+		std::free(page.handle);
+		--liveCount;
+	}
+
+	int liveCount = 0;
+	bool isFailing = false;
+};
+
+/// <summary>
+/// 使用中の領域
+/// </summary>
+struct LiveRange {
+	size_t offset;
+	size_t size;
+	uint64_t fenceValue; // 0ならまだSubmitしていない
+};
+
+/// <summary>
+/// ランダムな確保、Submit、Retireを使用中の領域の写しと比べる
+/// </summary>
+void TestFuzz(MallocPageSource& source) {
+	const size_t capacity = 1 << 20;
+	RingUploadAllocator ring(source, capacity);
+	std::mt19937 random(14);
+	std::vector<LiveRange> live;
+	uint64_t fenceValue = 0;
+	uint64_t completedValue = 0;
+	size_t allocationCount = 0;
+	size_t failedCount = 0;
+	size_t badCount = 0;
+	size_t overlapCount = 0;
+	size_t failedOnEmptyCount = 0;
+	size_t usedSizeMismatchCount = 0;
+	for (int op = 0; op < 300000; op++) {
+		const uint32_t kind = random() % 10;
+		if (kind < 6) {
+			const size_t size = 1 + ((random() % 3 == 0) ? random() % 300000 : random() % 5000);
+			const size_t alignment = size_t(1) << (random() % 10);
+			UploadAllocation allocation{};
+			if (!ring.Allocate(size, alignment, allocation)) {
+				++failedCount;
+				// 空なら必ず入る
+				failedOnEmptyCount += live.empty();
+				continue;
+			}
+			const size_t offset = size_t(allocation.gpuAddress - MallocPageSource::kGpuAddress);
+			badCount += offset % alignment != 0 || offset + size > capacity || allocation.size != size ||
+				static_cast<uint8_t*>(allocation.cpuAddress) != ring.GetPage().cpuAddress + offset;
+			for (const LiveRange& range : live) {
+				overlapCount += offset < range.offset + range.size && range.offset < offset + size;
+			}
+			live.push_back({ offset, size, 0 });
+			++allocationCount;
+		} else if (kind < 8) {
+			ring.Submit(++fenceValue);
+			for (LiveRange& range : live) {
+				if (range.fenceValue == 0) {
+					range.fenceValue = fenceValue;
+				}
+			}
+			TEST_CHECK(ring.GetOldestFenceValue() <= fenceValue);
+		} else {
+			if (completedValue < fenceValue) {
+				completedValue += 1 + random() % (fenceValue - completedValue);
+			}
+			ring.Retire(completedValue);
+			std::erase_if(live, [&](const LiveRange& range) { return range.fenceValue != 0 && range.fenceValue <= completedValue; });
+		}
+		size_t liveSize = 0;
+		for (const LiveRange& range : live) {
+			liveSize += range.size;
+		}
+		usedSizeMismatchCount += ring.GetUsedSize() < liveSize || ring.GetUsedSize() > capacity;
+	}
+	TEST_CHECK(badCount == 0);
+	TEST_CHECK(overlapCount == 0);
+	TEST_CHECK(failedOnEmptyCount == 0);
+	TEST_CHECK(usedSizeMismatchCount == 0);
+
+	// すべて戻すと空になり、全体を1つで切り出せる
+	ring.Submit(++fenceValue);
+	ring.Retire(fenceValue);
+	TEST_CHECK(ring.GetUsedSize() == 0);
+	TEST_CHECK(ring.GetOldestFenceValue() == 0);
+	UploadAllocation whole{};
+	TEST_CHECK(ring.Allocate(capacity, 1, whole));
+	std::printf("ring: %zu allocations, %zu waited for the GPU\n", allocationCount, failedCount);
+}
+
+/// <summary>
+/// ページを作れなければ無効になり、切り出しは失敗し、ページを解放しない
+/// </summary>
+void TestCreateFailure(MallocPageSource& source) {
+	source.isFailing = true;
+	{
+		RingUploadAllocator ring(source, 1 << 16);
+		TEST_CHECK(!ring.IsValid());
+		TEST_CHECK(ring.GetSize() == 0);
+		UploadAllocation allocation{};
+		TEST_CHECK(!ring.Allocate(0, 1, allocation));
+		TEST_CHECK(!ring.Allocate(256, 256, allocation));
+		ring.Submit(1);
+		ring.Retire(1);
+		TEST_CHECK(ring.GetOldestFenceValue() == 0);
+		TEST_CHECK(ring.GetUsedSize() == 0);
+	}
+	source.isFailing = false;
+
+	// 作れれば使える
+	RingUploadAllocator ring(source, 1 << 16);
+	TEST_CHECK(ring.IsValid());
+	UploadAllocation allocation{};
+	TEST_CHECK(ring.Allocate(256, 256, allocation));
+}
+
+} // namespace
+
+int main() {
+	MallocPageSource source;
+	TestFuzz(source);
+	TestCreateFailure(source);
+	TEST_CHECK(source.liveCount == 0);
+	return FinishTest();
+}
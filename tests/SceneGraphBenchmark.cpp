@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "SceneGraph.h"
+#include "TestCommon.h"
+
+// 1000本の木(深さ8まで)のSceneGraphで、変更したノードの割合ごとのUpdateWorldの時間
+// 使い方: SceneGraphBenchmark [ノード数(既定は100000)]
+int main(int argc, char** argv) {
+	const size_t nodeCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	std::mt19937 random(18);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	auto makeTransform = [&] {
+		return Transform{ { 1.0f + distribution(random) * 0.01f, 1.0f, 1.0f },
+			{ distribution(random), distribution(random), distribution(random) },
+			{ distribution(random), distribution(random), distribution(random) } };
+	};
+
+	// 親は直前の64個のどれか(同じ木の近くのノード)
+	SceneGraph graph;
+	std::vector<SceneGraph::NodeHandle> nodes;
+	std::vector<int> depths;
+	for (size_t i = 0; i < nodeCount; i++) {
+		SceneGraph::NodeHandle parent = SceneGraph::kNoParent;
+		int depth = 0;
+		if (i >= 1000) {
+			const size_t candidate = i - 1 - random() % std::min<size_t>(i, 64);
+			if (depths[candidate] < 8) {
+				parent = nodes[candidate];
+				depth = depths[candidate] + 1;
+			}
+		}
+		nodes.push_back(graph.AddNode(parent, makeTransform()));
+		depths.push_back(depth);
+	}
+	BenchmarkTimer timer;
+	graph.UpdateWorld();
+	std::printf("%zu nodes, first UpdateWorld %.3f ms\n", nodeCount, timer.GetElapsedMilliseconds());
+
+	const int repeatCount = 20;
+	for (double ratio : { 0.0, 0.01, 0.1, 1.0 }) {
+		const size_t changeCount = size_t(double(nodeCount) * ratio);
+		double milliseconds = 0.0;
+		size_t updatedCount = 0;
+		for (int repeat = 0; repeat < repeatCount; repeat++) {
+			for (size_t k = 0; k < changeCount; k++) {
+				const SceneGraph::NodeHandle node = (ratio == 1.0) ? nodes[k] : nodes[random() % nodeCount];
+				Transform local = graph.GetLocal(node);
+				local.rotate.y += 0.01f;
+				graph.SetLocal(node, local);
+			}
+			timer.Restart();
+			updatedCount = graph.UpdateWorld();
+			milliseconds += timer.GetElapsedMilliseconds();
+		}
+		std::printf("changed %5.1f%%: updated %6zu nodes (with descendants), %7.3f ms\n", ratio * 100.0, updatedCount, milliseconds / repeatCount);
+	}
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+#include "MatrixMath.h"
+#include "SceneGraph.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// 親をたどって掛け合わせたワールド行列(SceneGraphの並び順を使わない)
+/// </summary>
+Matrix4x4 ComputeWorldByRecursion(const SceneGraph& graph, SceneGraph::NodeHandle node) {
+	const Transform& local = graph.GetLocal(node);
+	const Matrix4x4 localMatrix = MakeAffineMatrix(local.scale, local.rotate, local.translate);
+	const SceneGraph::NodeHandle parent = graph.GetParent(node);
+	return (parent == SceneGraph::kNoParent) ? localMatrix : Multiply(localMatrix, ComputeWorldByRecursion(graph, parent));
+}
+
+double MaxDifference(const Matrix4x4& a, const Matrix4x4& b) {
+	double difference = 0.0;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			difference = std::max(difference, double(std::fabs(a.m[i][j] - b.m[i][j])));
+		}
+	}
+	return difference;
+}
+
+/// <summary>
+/// nodeがancestorの子孫(自分を含む)か
+/// </summary>
+bool IsDescendant(const SceneGraph& graph, SceneGraph::NodeHandle node, SceneGraph::NodeHandle ancestor) {
+	for (SceneGraph::NodeHandle current = node; current != SceneGraph::kNoParent; current = graph.GetParent(current)) {
+		if (current == ancestor) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// SetLocalとSetParent(後ろの親への付け替えで並べ直しが起きる)を混ぜ、
+/// 毎回すべてのワールド行列を親をたどった計算と比べる
+/// </summary>
+void TestAgainstRecursion() {
+	std::mt19937 random(18);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	auto makeTransform = [&] {
+		return Transform{ { 1.0f + distribution(random) * 0.01f, 1.0f, 1.0f },
+			{ distribution(random), distribution(random), distribution(random) },
+			{ distribution(random), distribution(random), distribution(random) } };
+	};
+
+	SceneGraph graph;
+	std::vector<SceneGraph::NodeHandle> nodes;
+	for (int i = 0; i < 2000; i++) {
+		const bool isRoot = i < 10 || random() % 8 == 0;
+		nodes.push_back(graph.AddNode(isRoot ? SceneGraph::kNoParent : nodes[random() % nodes.size()], makeTransform()));
+	}
+	TEST_CHECK(graph.UpdateWorld() == nodes.size());
+	TEST_CHECK(graph.UpdateWorld() == 0);
+
+	double maxDifference = 0.0;
+	size_t updateCountMismatch = 0;
+	for (int iteration = 0; iteration < 200; iteration++) {
+		std::vector<SceneGraph::NodeHandle> changed;
+		for (int k = 0; k < 20; k++) {
+			const SceneGraph::NodeHandle node = nodes[random() % nodes.size()];
+			graph.SetLocal(node, makeTransform());
+			changed.push_back(node);
+		}
+		for (int k = 0; k < 3; k++) {
+			const SceneGraph::NodeHandle node = nodes[random() % nodes.size()];
+			const SceneGraph::NodeHandle parent = (random() % 10 == 0) ? SceneGraph::kNoParent : nodes[random() % nodes.size()];
+			if (parent != SceneGraph::kNoParent && IsDescendant(graph, parent, node)) {
+				continue;
+			}
+			graph.SetParent(node, parent);
+			TEST_CHECK(graph.GetParent(node) == parent);
+			changed.push_back(node);
+		}
+		// 計算し直すのは変更したノードとその子孫だけ
+		size_t expectedUpdateCount = 0;
+		for (SceneGraph::NodeHandle node : nodes) {
+			expectedUpdateCount += std::any_of(changed.begin(), changed.end(),
+				[&](SceneGraph::NodeHandle ancestor) { return IsDescendant(graph, node, ancestor); });
+		}
+		updateCountMismatch += graph.UpdateWorld() != expectedUpdateCount;
+
+		for (SceneGraph::NodeHandle node : nodes) {
+			maxDifference = std::max(maxDifference, MaxDifference(graph.GetWorld(node), ComputeWorldByRecursion(graph, node)));
+		}
+	}
+	TEST_CHECK(graph.GetNodeCount() == nodes.size());
+	std::printf("recursion: %u reorders, max difference %g, %zu update count mismatches\n",
+		graph.GetReorderCount(), maxDifference, updateCountMismatch);
+	TEST_CHECK(graph.GetReorderCount() > 0);
+	TEST_CHECK(maxDifference < 1e-4);
+	TEST_CHECK(updateCountMismatch == 0);
+}
+
+/// <summary>
+/// 親を後ろのノードへ付け替えると並べ直され、ハンドルはそのまま使える
+/// </summary>
+void TestReorderKeepsHandles() {
+	SceneGraph graph;
+	const Transform moveX{ { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } };
+	const SceneGraph::NodeHandle child = graph.AddNode(SceneGraph::kNoParent, moveX);
+	const SceneGraph::NodeHandle grandchild = graph.AddNode(child, moveX);
+	const SceneGraph::NodeHandle parent = graph.AddNode(SceneGraph::kNoParent, moveX);
+	graph.UpdateWorld();
+	TEST_CHECK(graph.GetWorld(grandchild).m[3][0] == 2.0f);
+
+	const uint32_t reorderCount = graph.GetReorderCount();
+	graph.SetParent(child, parent);
+	TEST_CHECK(graph.GetReorderCount() == reorderCount + 1);
+	TEST_CHECK(graph.GetParent(child) == parent && graph.GetParent(grandchild) == child);
+	// SetParentだけではワールド行列は変わらない
+	TEST_CHECK(graph.GetWorld(grandchild).m[3][0] == 2.0f);
+	TEST_CHECK(graph.UpdateWorld() == 2);
+	TEST_CHECK(graph.GetWorld(child).m[3][0] == 2.0f && graph.GetWorld(grandchild).m[3][0] == 3.0f);
+	TEST_CHECK(graph.GetWorld(parent).m[3][0] == 1.0f);
+
+	graph.SetParent(child, SceneGraph::kNoParent);
+	graph.UpdateWorld();
+	TEST_CHECK(graph.GetWorld(grandchild).m[3][0] == 2.0f);
+}
+
+} // namespace
+
+int main() {
+	TestAgainstRecursion();
+	TestReorderKeepsHandles();
+	return FinishTest();
+}
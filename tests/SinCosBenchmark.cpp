@@ -0,0 +1,55 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "SinCos.h"
+#include "SimdSupport.h"
+#include "TestCommon.h"
+
+// SinCosとlibmのsinf/cosfの速さ(百万角度/秒)
+// 使い方: SinCosBenchmark [角度の数(既定は2^24)]
+int main(int argc, char** argv) {
+	const size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : (size_t(1) << 24);
+	std::vector<float> angles(count), sines(count), cosines(count);
+	for (size_t i = 0; i < count; i++) {
+		angles[i] = float(i % 100000) * 1e-4f - 5.0f;
+	}
+
+	// bodyを1回実行したときの百万角度/秒
+	auto measure = [&](auto&& body) {
+		BenchmarkTimer timer;
+		body();
+		return count / timer.GetElapsedMilliseconds() / 1000.0;
+	};
+
+	const double libm = measure([&] {
+		for (size_t i = 0; i < count; i++) {
+			sines[i] = std::sin(angles[i]);
+			cosines[i] = std::cos(angles[i]);
+		}
+	});
+	const double scalar = measure([&] {
+		for (size_t i = 0; i < count; i++) {
+			SinCos(angles[i], sines[i], cosines[i]);
+		}
+	});
+	const double array = measure([&] {
+		SinCosArray(angles.data(), sines.data(), cosines.data(), count);
+	});
+	const double sequence = measure([&] {
+		SinCosSequence(-5.0f, 1e-4f, sines.data(), cosines.data(), count);
+	});
+
+	std::printf("%zu angles, Mangles/s (SinCosArray uses %s)\n", count, GetSimdLevelName(GetSimdLevel()));
+	std::printf("libm sinf+cosf %8.1f\n", libm);
+	std::printf("SinCos         %8.1f (%.1fx)\n", scalar, scalar / libm);
+	std::printf("SinCosArray    %8.1f (%.1fx)\n", array, array / libm);
+	std::printf("SinCosSequence %8.1f (%.1fx)\n", sequence, sequence / libm);
+
+	// 最適化で計算が消されないように結果を使う
+	double checksum = 0.0;
+	for (size_t i = 0; i < count; i += 4096) {
+		checksum += sines[i] + cosines[i];
+	}
+	std::printf("checksum %g\n", checksum);
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "SinCos.h"
+#include "TestCommon.h"
+
+namespace {
+
+// これより絶対値が小さい値(零点のごく近く)はULPでなく絶対誤差で見る
+constexpr double kNearZero = 5.9604644775390625e-8; // 2^-24
+
+/// <summary>
+/// referenceの位置でのfloatの1 ULP
+/// </summary>
+double GetUlp(double reference) {
+	const float magnitude = std::fmax(float(std::fabs(reference)), 1.17549435e-38f);
+	return double(std::nextafter(magnitude, INFINITY)) - double(magnitude);
+}
+
+/// <summary>
+/// 区間の誤差
+/// </summary>
+struct SweepError {
+	double maxUlp;      // 参照値の絶対値が2^-24以上の点でのULP誤差の最大
+	double maxNearZero; // 参照値の絶対値が2^-24未満の点での絶対誤差の最大
+	double maxAbsolute; // 絶対誤差の最大
+	double maxScalar;   // SinCosArrayとSinCosの差の最大
+};
+
+/// <summary>
+/// [-range, range] を sampleCount 点に等分してSinCosArrayを倍精度のsin/cosと比べる
+/// </summary>
+SweepError Sweep(float range, size_t sampleCount) {
+	std::vector<float> angles(sampleCount), sines(sampleCount), cosines(sampleCount);
+	for (size_t i = 0; i < sampleCount; i++) {
+		angles[i] = -range + 2.0f * range * float(double(i) / double(sampleCount));
+	}
+	SinCosArray(angles.data(), sines.data(), cosines.data(), sampleCount);
+
+	SweepError error{};
+	for (size_t i = 0; i < sampleCount; i++) {
+		const double references[2] = { std::sin(double(angles[i])), std::cos(double(angles[i])) };
+		const float values[2] = { sines[i], cosines[i] };
+		for (int k = 0; k < 2; k++) {
+			const double difference = std::fabs(double(values[k]) - references[k]);
+			error.maxAbsolute = std::fmax(error.maxAbsolute, difference);
+			if (std::fabs(references[k]) >= kNearZero) {
+				error.maxUlp = std::fmax(error.maxUlp, difference / GetUlp(references[k]));
+			} else {
+				error.maxNearZero = std::fmax(error.maxNearZero, difference);
+			}
+		}
+		// スカラー版は一部だけ比べる
+		if (i % 61 == 0) {
+			float sine, cosine;
+			SinCos(angles[i], sine, cosine);
+			error.maxScalar = std::fmax(error.maxScalar, std::fabs(double(sine) - sines[i]) + std::fabs(double(cosine) - cosines[i]));
+		}
+	}
+	return error;
+}
+
+} // namespace
+
+// SinCos.hに書いた精度を確かめる
+// 使い方: SinCosTest [区間ごとの点の数の2の指数(既定は24)]
+int main(int argc, char** argv) {
+	const size_t sampleCount = size_t(1) << ((argc > 1) ? std::atoi(argv[1]) : 24);
+
+	// |angle| <= 2π : 最大 1.6 ULP
+	const SweepError small = Sweep(6.2831853f, sampleCount);
+	std::printf("|x| <= 2pi : %.3f ulp, near zero %.3g, abs %.3g, scalar vs array %.3g\n",
+		small.maxUlp, small.maxNearZero, small.maxAbsolute, small.maxScalar);
+	TEST_CHECK(small.maxUlp <= 1.6);
+	TEST_CHECK(small.maxNearZero <= 1e-13);
+	// AVX2版はFMAを使うので、スカラー版と最後の桁が違うことがある
+	TEST_CHECK(small.maxScalar <= 2e-7);
+
+	// |angle| <= 8192 : 絶対誤差 1e-7 以下
+	const SweepError large = Sweep(8192.0f, sampleCount);
+	std::printf("|x| <= 8192: abs %.3g, scalar vs array %.3g\n", large.maxAbsolute, large.maxScalar);
+	TEST_CHECK(large.maxAbsolute <= 1e-7);
+	TEST_CHECK(large.maxScalar <= 2e-7);
+
+	// 漸化式 : 角度が ±20 以内なら絶対誤差 3e-6 以下
+	for (float step : { 0.001f, 0.0196349541f, 0.1f }) {
+		const float start = -1.5707963f;
+		const size_t count = size_t((20.0f - start) / step);
+		std::vector<float> sines(count), cosines(count);
+		SinCosSequence(start, step, sines.data(), cosines.data(), count);
+		double maxError = 0.0;
+		for (size_t i = 0; i < count; i++) {
+			const double angle = double(start) + double(step) * double(i);
+			maxError = std::fmax(maxError, std::fabs(sines[i] - std::sin(angle)));
+			maxError = std::fmax(maxError, std::fabs(cosines[i] - std::cos(angle)));
+		}
+		std::printf("sequence step %g x %zu: abs %.3g\n", step, count, maxError);
+		TEST_CHECK(maxError <= 3e-6);
+	}
+
+	// 端数と、入力と出力が同じ領域の場合
+	for (size_t count = 0; count <= 19; count++) {
+		std::vector<float> angles(count + 1), sines(count + 1, -2.0f), cosines(count + 1, -2.0f);
+		for (size_t i = 0; i < count; i++) {
+			angles[i] = 0.37f * float(i) - 3.0f;
+		}
+		SinCosArray(angles.data(), sines.data(), cosines.data(), count);
+		std::vector<float> inPlace(angles);
+		std::vector<float> inPlaceCosines(count + 1);
+		SinCosArray(inPlace.data(), inPlace.data(), inPlaceCosines.data(), count);
+		for (size_t i = 0; i < count; i++) {
+			float sine, cosine;
+			SinCos(angles[i], sine, cosine);
+			TEST_CHECK(std::fabs(sine - sines[i]) <= 1e-7f && std::fabs(cosine - cosines[i]) <= 1e-7f);
+			TEST_CHECK(inPlace[i] == sines[i] && inPlaceCosines[i] == cosines[i]);
+		}
+		TEST_CHECK(sines[count] == -2.0f && cosines[count] == -2.0f);
+	}
+	return FinishTest();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+
+// 失敗したチェックの数
+inline int& GetTestFailureCount() {
+	static int count = 0;
+	return count;
+}
+
+// 条件が偽なら場所と式を出して失敗を数える(止めずに次を調べる)
+#define TEST_CHECK(condition)                                                          \
+	do {                                                                               \
+		if (!(condition)) {                                                            \
+			std::printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #condition);     \
+			++GetTestFailureCount();                                                   \
+		}                                                                              \
+	} while (0)
+
+// 失敗がなければ0、あれば1を返す(mainの最後に使う)
+inline int FinishTest() {
+	if (GetTestFailureCount() != 0) {
+		std::printf("%d check(s) failed\n", GetTestFailureCount());
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
+
+/// <summary>
+/// 経過時間の計測
+/// </summary>
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() : start_(std::chrono::steady_clock::now()) {}
+
+	// 計測を始め直す
+	void Restart() { start_ = std::chrono::steady_clock::now(); }
+
+	// 開始からのミリ秒
+	double GetElapsedMilliseconds() const {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
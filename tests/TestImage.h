@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "DirectXTex.h"
+#ifdef CG2_TESTS_HAVE_PNG
+#include <png.h>
+#endif
+
+/// <summary>
+/// 圧縮を試す画像の種類
+/// </summary>
+enum class TestImageKind {
+	Albedo, // なめらかなグラデーション、タイルの縁、細かいノイズを混ぜたアルベドのようなもの
+	Gradient, // 横と縦のグラデーション
+	Noise, // 一様なノイズ(一番圧縮しにくい)
+	WavesAlpha, // 色とアルファが波打つ
+	CheckerAlpha, // 細かい市松模様と縦のアルファのグラデーション
+	FlatTiles, // 32ピクセルごとの単色のタイル
+};
+
+/// <summary>
+/// 種類の名前
+/// </summary>
+inline const char* GetTestImageKindName(TestImageKind kind) {
+	switch (kind) {
+	case TestImageKind::Albedo: return "albedo";
+	case TestImageKind::Gradient: return "gradient";
+	case TestImageKind::Noise: return "noise";
+	case TestImageKind::WavesAlpha: return "waves+alpha";
+	case TestImageKind::CheckerAlpha: return "checker+alpha";
+	case TestImageKind::FlatTiles: return "flat-tiles";
+	}
+	return "unknown";
+}
+
+/// <summary>
+/// 圧縮を試すためのRGBA8の画像
+/// </summary>
+inline HRESULT MakeTestImage(size_t width, size_t height, DirectX::ScratchImage& image, TestImageKind kind = TestImageKind::Albedo) {
+	const HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+	if (FAILED(hr)) {
+		return hr;
+	}
+	const DirectX::Image* pixels = image.GetImage(0, 0, 0);
+	std::mt19937 random(22);
+	std::uniform_int_distribution<int> noise(-6, 6);
+	std::uniform_int_distribution<int> byte(0, 255);
+	const auto toByte = [](float value) { return uint8_t(std::clamp(int(value * 255.0f + 0.5f), 0, 255)); };
+	for (size_t y = 0; y < height; y++) {
+		uint8_t* row = pixels->pixels + y * pixels->rowPitch;
+		for (size_t x = 0; x < width; x++) {
+			uint8_t* pixel = row + x * 4;
+			const float u = float(x) / float(width);
+			const float v = float(y) / float(height);
+			switch (kind) {
+			case TestImageKind::Albedo: {
+				// 32ピクセルごとのタイルで色を変え、縁を暗くする
+				const bool isEdge = (x % 32) < 2 || (y % 32) < 2;
+				const float tile = float(((x / 32) * 7 + (y / 32) * 3) % 5) / 5.0f;
+				const float base[3] = { 0.3f + 0.5f * u + 0.2f * tile, 0.2f + 0.6f * v, 0.5f + 0.4f * std::sin(u * 6.0f + v * 3.0f) * tile };
+				for (int c = 0; c < 3; c++) {
+					const int value = int((isEdge ? base[c] * 0.3f : base[c]) * 255.0f) + noise(random);
+					pixel[c] = uint8_t(std::clamp(value, 0, 255));
+				}
+				pixel[3] = 255;
+				break;
+			}
+			case TestImageKind::Gradient:
+				pixel[0] = toByte(u);
+				pixel[1] = toByte(v);
+				pixel[2] = toByte(1.0f - u);
+				pixel[3] = 255;
+				break;
+			case TestImageKind::Noise:
+				pixel[0] = uint8_t(byte(random));
+				pixel[1] = uint8_t(byte(random));
+				pixel[2] = uint8_t(byte(random));
+				pixel[3] = 255;
+				break;
+			case TestImageKind::WavesAlpha:
+				pixel[0] = toByte(0.5f + 0.5f * std::sin(u * 23.0f + v * 7.0f));
+				pixel[1] = toByte(0.5f + 0.5f * std::sin(u * 5.0f - v * 17.0f + 1.0f));
+				pixel[2] = toByte(0.5f + 0.5f * std::sin((u + v) * 11.0f + 2.0f));
+				pixel[3] = toByte(0.5f + 0.5f * std::sin(u * 13.0f + v * 3.0f));
+				break;
+			case TestImageKind::CheckerAlpha: {
+				const bool isOn = (((x / 3) ^ (y / 5)) & 1) != 0;
+				pixel[0] = isOn ? 230 : 20;
+				pixel[1] = isOn ? 40 : 200;
+				pixel[2] = isOn ? 60 : 90;
+				pixel[3] = toByte(v);
+				break;
+			}
+			case TestImageKind::FlatTiles: {
+				const uint8_t value = (((x / 32) + (y / 32)) & 1) ? 200 : 30;
+				pixel[0] = pixel[1] = pixel[2] = value;
+				pixel[3] = 255;
+				break;
+			}
+			}
+		}
+	}
+	return S_OK;
+}
+
+#ifdef CG2_TESTS_HAVE_PNG
+/// <summary>
+/// PNGをRGBA8で読む(libpngがあるときだけ)
+/// </summary>
+inline bool LoadTestImagePng(const char* path, DirectX::ScratchImage& image) {
+	png_image png{};
+	png.version = PNG_IMAGE_VERSION;
+	if (!png_image_begin_read_from_file(&png, path)) {
+		return false;
+	}
+	png.format = PNG_FORMAT_RGBA;
+	if (FAILED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, png.width, png.height, 1, 1))) {
+		png_image_free(&png);
+		return false;
+	}
+	const DirectX::Image* pixels = image.GetImage(0, 0, 0);
+	return png_image_finish_read(&png, nullptr, pixels->pixels, png_int_32(pixels->rowPitch), nullptr) != 0;
+}
+#endif
+
+/// <summary>
+/// 比べる画像の1枚
+/// </summary>
+struct TestCorpusImage {
+	std::string name;
+	DirectX::ScratchImage image;
+};
+
+/// <summary>
+/// 合成する画像の種類と大きさ
+/// </summary>
+struct TestImageSize {
+	TestImageKind kind;
+	size_t width;
+	size_t height;
+};
+
+/// <summary>
+/// PNGファイル(libpngがないときは読まずに知らせる)と合成した画像を並べる
+/// </summary>
+inline bool MakeTestCorpus(const std::vector<const char*>& paths, const std::vector<TestImageSize>& sizes, std::vector<TestCorpusImage>& corpus) {
+#ifdef CG2_TESTS_HAVE_PNG
+	for (const char* path : paths) {
+		TestCorpusImage entry{ path, {} };
+		if (!LoadTestImagePng(path, entry.image)) {
+			std::printf("failed to load %s\n", path);
+			return false;
+		}
+		const size_t slash = entry.name.find_last_of("/\\");
+		entry.name = entry.name.substr(slash == std::string::npos ? 0 : slash + 1);
+		corpus.push_back(std::move(entry));
+	}
+#else
+	if (!paths.empty()) {
+		std::printf("built without libpng: PNG files are ignored\n");
+	}
+#endif
+	for (const TestImageSize& size : sizes) {
+		TestCorpusImage entry{ GetTestImageKindName(size.kind), {} };
+		if (FAILED(MakeTestImage(size.width, size.height, entry.image, size.kind))) {
+			return false;
+		}
+		corpus.push_back(std::move(entry));
+	}
+	return true;
+}
+
+/// <summary>
+/// 同じ大きさのRGBA8の画像2枚の差の二乗の和(RGBとアルファを別に)
+/// </summary>
+inline void ComputeImageSquaredError(const DirectX::Image& a, const DirectX::Image& b, double& rgbError, double& alphaError) {
+	rgbError = 0.0;
+	alphaError = 0.0;
+	for (size_t y = 0; y < a.height; y++) {
+		const uint8_t* rowA = a.pixels + y * a.rowPitch;
+		const uint8_t* rowB = b.pixels + y * b.rowPitch;
+		for (size_t x = 0; x < a.width * 4; x++) {
+			const double difference = double(rowA[x]) - double(rowB[x]);
+			((x % 4 == 3) ? alphaError : rgbError) += difference * difference;
+		}
+	}
+}
+
+/// <summary>
+/// 差の二乗の和とサンプル数からPSNRを求める(同じならとても大きな値)
+/// </summary>
+inline double ComputePsnr(double squaredError, double sampleCount) {
+	return 10.0 * std::log10(255.0 * 255.0 / std::max(squaredError / sampleCount, 1e-9));
+}
+
+/// <summary>
+/// 同じ大きさのRGBA8の画像2枚のPSNR(RGBとアルファを別に)
+/// </summary>
+inline void ComputeImagePsnr(const DirectX::Image& a, const DirectX::Image& b, double& rgbPsnr, double& alphaPsnr) {
+	double rgbError = 0.0;
+	double alphaError = 0.0;
+	ComputeImageSquaredError(a, b, rgbError, alphaError);
+	const double pixelCount = double(a.width) * double(a.height);
+	rgbPsnr = ComputePsnr(rgbError, 3.0 * pixelCount);
+	alphaPsnr = ComputePsnr(alphaError, pixelCount);
+}
@@ -0,0 +1,56 @@
+#include <cstdlib>
+#include <thread>
+#include "DirectXTex.h"
+#include "TestCommon.h"
+#include "TestImage.h"
+
+namespace {
+
+/// <summary>
+/// formatで圧縮し、1秒あたりのブロック数を返す(threadsが0ならTEX_COMPRESS_PARALLELを付けない)
+/// </summary>
+double MeasureBlocksPerSecond(const DirectX::ScratchImage& source, DXGI_FORMAT format, size_t threads) {
+	DirectX::TEX_COMPRESS_FLAGS flags = DirectX::TEX_COMPRESS_DEFAULT;
+	if (threads > 0) {
+		DirectX::SetParallelThreadLimit(threads);
+		flags = DirectX::TEX_COMPRESS_PARALLEL;
+	}
+	const DirectX::TexMetadata& metadata = source.GetMetadata();
+	const double blockCount = double((metadata.width + 3) / 4) * double((metadata.height + 3) / 4);
+	DirectX::ScratchImage compressed;
+	BenchmarkTimer timer;
+	if (FAILED(DirectX::Compress(*source.GetImage(0, 0, 0), format, flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed))) {
+		return 0.0;
+	}
+	return blockCount / (timer.GetElapsedMilliseconds() / 1000.0);
+}
+
+} // namespace
+
+// BC1とBC7の圧縮の速さ(blocks/s)がスレッド数でどう伸びるか
+// 使い方: TextureCompressBenchmark [BC1の画像の大きさ(既定は2048)] [BC7の画像の大きさ(既定は256)]
+int main(int argc, char** argv) {
+	const size_t bc1Size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2048;
+	const size_t bc7Size = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 256;
+	const size_t hardwareThreads = std::thread::hardware_concurrency();
+	std::printf("hardware threads %zu\n", hardwareThreads);
+
+	for (DXGI_FORMAT format : { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC7_UNORM }) {
+		const size_t size = (format == DXGI_FORMAT_BC1_UNORM) ? bc1Size : bc7Size;
+		DirectX::ScratchImage source;
+		if (FAILED(MakeTestImage(size, size, source))) {
+			std::printf("failed to make a %zux%zu image\n", size, size);
+			return 1;
+		}
+		const char* name = (format == DXGI_FORMAT_BC1_UNORM) ? "BC1" : "BC7";
+		const double serial = MeasureBlocksPerSecond(source, format, 0);
+		std::printf("%s %zux%zu serial     %10.0f blocks/s\n", name, size, size, serial);
+		for (size_t threads : { size_t(1), size_t(2), size_t(4), size_t(8) }) {
+			const double parallel = MeasureBlocksPerSecond(source, format, threads);
+			std::printf("%s %zux%zu %zu thread(s) %10.0f blocks/s (x%.2f)%s\n", name, size, size, threads, parallel, parallel / serial,
+				threads > hardwareThreads ? " oversubscribed" : "");
+		}
+	}
+	DirectX::SetParallelThreadLimit(0);
+	return 0;
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include "DirectXTex.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// 3回戻して一番速かったときの百万ピクセル/秒(threadsが0ならTEX_DECOMPRESS_PARALLELを付けない)
+/// </summary>
+double MeasureMegapixelsPerSecond(const DirectX::Image& compressed, DXGI_FORMAT format, size_t threads) {
+	DirectX::TEX_DECOMPRESS_FLAGS flags = DirectX::TEX_DECOMPRESS_DEFAULT;
+	if (threads > 0) {
+		DirectX::SetParallelThreadLimit(threads);
+		flags = DirectX::TEX_DECOMPRESS_PARALLEL;
+	}
+	double best = 1e30;
+	for (int i = 0; i < 3; i++) {
+		DirectX::ScratchImage image;
+		BenchmarkTimer timer;
+		if (FAILED(DirectX::Decompress(compressed, format, image, flags))) {
+			return 0.0;
+		}
+		best = std::min(best, timer.GetElapsedMilliseconds());
+	}
+	return double(compressed.width) * double(compressed.height) / best / 1000.0;
+}
+
+} // namespace
+
+// BC1-BC5とBC7をDecompressで戻す速さ(百万ピクセル/秒)
+// float: R32G32B32A32_FLOATへ(XMVECTORを通る元の道)、RGBA8: R8G8B8A8_UNORMへ(浮動小数点を使わない道)
+// ブロックは乱数なので、BC7はすべてのモードが混ざる
+// 使い方: TextureDecompressBenchmark [画像の大きさ(既定は2048)]
+int main(int argc, char** argv) {
+	const size_t size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2048;
+	std::printf("%zux%zu, hardware threads %u\n", size, size, std::thread::hardware_concurrency());
+	std::printf("%-5s %10s %10s %8s %30s\n", "fmt", "float", "RGBA8", "speedup", "RGBA8 parallel 1/2/4/8 threads");
+	const struct {
+		const char* name;
+		DXGI_FORMAT format;
+	} kFormats[] = {
+		{ "BC1", DXGI_FORMAT_BC1_UNORM },
+		{ "BC2", DXGI_FORMAT_BC2_UNORM },
+		{ "BC3", DXGI_FORMAT_BC3_UNORM },
+		{ "BC4U", DXGI_FORMAT_BC4_UNORM },
+		{ "BC5U", DXGI_FORMAT_BC5_UNORM },
+		{ "BC7", DXGI_FORMAT_BC7_UNORM },
+	};
+	std::mt19937 random(25);
+	for (const auto& entry : kFormats) {
+		DirectX::ScratchImage compressed;
+		if (FAILED(compressed.Initialize2D(entry.format, size, size, 1, 1))) {
+			return 1;
+		}
+		uint8_t* pixels = compressed.GetPixels();
+		for (size_t i = 0; i < compressed.GetPixelsSize(); i++) {
+			pixels[i] = uint8_t(random());
+		}
+		const DirectX::Image& image = *compressed.GetImage(0, 0, 0);
+		const double floatSpeed = MeasureMegapixelsPerSecond(image, DXGI_FORMAT_R32G32B32A32_FLOAT, 0);
+		const double byteSpeed = MeasureMegapixelsPerSecond(image, DXGI_FORMAT_R8G8B8A8_UNORM, 0);
+		std::printf("%-5s %10.1f %10.1f %7.1fx   ", entry.name, floatSpeed, byteSpeed, byteSpeed / floatSpeed);
+		for (size_t threads : { size_t(1), size_t(2), size_t(4), size_t(8) }) {
+			std::printf(" %7.1f", MeasureMegapixelsPerSecond(image, DXGI_FORMAT_R8G8B8A8_UNORM, threads));
+		}
+		std::printf("\n");
+	}
+	DirectX::SetParallelThreadLimit(0);
+	return 0;
+}
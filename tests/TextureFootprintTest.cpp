@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "DirectXTex.h"
+#include "TestCommon.h"
+#include "TextureFootprint.h"
+
+namespace {
+
+/// <summary>
+/// Xbox専用のフォーマット(TextureFootprintは扱わない)
+/// </summary>
+bool IsXboxFormat(int format) {
+	return (format >= 116 && format <= 120) || format == 189 || format == 190;
+}
+
+/// <summary>
+/// すべてのDXGIフォーマットと大きさで、詰めたピッチと行数がDirectXTexと一致する
+/// </summary>
+void TestPitchAgainstDirectXTex() {
+	std::vector<uint64_t> sizes;
+	for (uint64_t size = 0; size <= 70; size++) {
+		sizes.push_back(size);
+	}
+	for (uint32_t shift = 7; shift <= 16; shift++) {
+		const uint64_t power = uint64_t(1) << shift;
+		sizes.insert(sizes.end(), { power - 1, power, power + 1 });
+	}
+
+	size_t checkCount = 0;
+	size_t mismatchCount = 0;
+	int supportedCount = 0;
+	for (int format = 0; format < 256; format++) {
+		if (IsXboxFormat(format)) {
+			continue;
+		}
+		const DXGI_FORMAT dxgiFormat = DXGI_FORMAT(format);
+		bool isSupported = false;
+		for (uint64_t width : sizes) {
+			for (uint64_t height : sizes) {
+				size_t expectedRowPitch = 0;
+				size_t expectedSlicePitch = 0;
+				const bool isExpected = SUCCEEDED(DirectX::ComputePitch(dxgiFormat, size_t(width), size_t(height),
+					expectedRowPitch, expectedSlicePitch, DirectX::CP_FLAGS_NONE));
+				uint64_t rowPitch = 0;
+				uint64_t slicePitch = 0;
+				const bool isComputed = ComputeTexturePitch(dxgiFormat, width, height, rowPitch, slicePitch);
+				++checkCount;
+				if (isComputed != isExpected || (isExpected && (rowPitch != expectedRowPitch || slicePitch != expectedSlicePitch))) {
+					if (mismatchCount < 10) {
+						std::printf("format %d %llux%llu: DirectXTex %d %zu %zu, ours %d %llu %llu\n", format,
+							(unsigned long long)width, (unsigned long long)height, int(isExpected), expectedRowPitch, expectedSlicePitch,
+							int(isComputed), (unsigned long long)rowPitch, (unsigned long long)slicePitch);
+					}
+					++mismatchCount;
+					continue;
+				}
+				if (!isExpected) {
+					continue;
+				}
+				isSupported = true;
+				const size_t rowCount = DirectX::ComputeScanlines(dxgiFormat, size_t(height));
+				mismatchCount += ComputeTextureRowCount(dxgiFormat, height) != rowCount;
+
+				// 配置の1行の大きさと行数は詰めたピッチと同じで、行の間隔は256の倍数
+				TextureFootprint footprint{};
+				if (width > 0 && height > 0 && ComputeTextureFootprint(dxgiFormat, uint32_t(width), uint32_t(height), 1, 0, footprint)) {
+					mismatchCount += footprint.rowSize != expectedRowPitch || footprint.rowCount != rowCount ||
+						footprint.rowPitch % kTextureDataPitchAlignment != 0 || footprint.rowPitch < footprint.rowSize;
+				}
+			}
+		}
+		supportedCount += isSupported;
+	}
+	std::printf("pitch: %d formats, %zu checks, %zu mismatches\n", supportedCount, checkCount, mismatchCount);
+	TEST_CHECK(mismatchCount == 0);
+	TEST_CHECK(supportedCount > 100);
+}
+
+/// <summary>
+/// 全サブリソースの配置が512バイト境界で重ならずに並び、コピーで行が崩れない
+/// </summary>
+void TestSubresourceFootprints() {
+	const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC7_UNORM,
+		DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_YUY2, DXGI_FORMAT_R16_FLOAT };
+	std::mt19937 random(14);
+	size_t failureCount = 0;
+	size_t overlapCount = 0;
+	size_t copyMismatchCount = 0;
+	for (int iteration = 0; iteration < 2000; iteration++) {
+		const DXGI_FORMAT format = formats[random() % std::size(formats)];
+		const uint32_t width = 1 + random() % 300;
+		const uint32_t height = 1 + random() % 300;
+		const uint32_t depthOrArraySize = 1 + random() % 5;
+		const bool is3D = random() % 2 != 0;
+		uint32_t maxMipLevels = 1;
+		while ((std::max(width, height) >> maxMipLevels) > 0 && maxMipLevels < 10) {
+			++maxMipLevels;
+		}
+		const uint32_t mipLevels = 1 + random() % maxMipLevels;
+		const uint32_t arraySize = is3D ? 1 : depthOrArraySize;
+		std::vector<TextureFootprint> footprints(mipLevels * arraySize);
+		const uint64_t totalSize = ComputeTextureFootprints(format, width, height, depthOrArraySize, mipLevels, is3D, footprints.data());
+		if (totalSize == 0) {
+			++failureCount;
+			continue;
+		}
+
+		std::vector<uint8_t> buffer(totalSize, 0xCD);
+		uint64_t end = 0;
+		for (uint32_t arraySlice = 0; arraySlice < arraySize; arraySlice++) {
+			for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++) {
+				const TextureFootprint& footprint = footprints[mipLevel + arraySlice * mipLevels];
+				overlapCount += footprint.offset % kTextureDataPlacementAlignment != 0 || footprint.offset < end;
+				end = footprint.offset + GetTextureFootprintSize(footprint);
+
+				const uint32_t mipWidth = std::max(width >> mipLevel, 1u);
+				const uint32_t mipHeight = std::max(height >> mipLevel, 1u);
+				const uint32_t mipDepth = is3D ? std::max(depthOrArraySize >> mipLevel, 1u) : 1;
+				uint64_t rowPitch = 0;
+				uint64_t slicePitch = 0;
+				ComputeTexturePitch(format, mipWidth, mipHeight, rowPitch, slicePitch);
+				std::vector<uint8_t> source(slicePitch * mipDepth);
+				for (uint8_t& value : source) {
+					value = uint8_t(random());
+				}
+				CopyTextureRows(buffer.data() + footprint.offset, footprint, source.data(), size_t(rowPitch), size_t(slicePitch));
+				for (uint32_t z = 0; z < mipDepth; z++) {
+					for (uint32_t row = 0; row < footprint.rowCount; row++) {
+						const uint8_t* copied = buffer.data() + footprint.offset + (uint64_t(z) * footprint.rowCount + row) * footprint.rowPitch;
+						copyMismatchCount += std::memcmp(copied, source.data() + z * slicePitch + row * rowPitch, size_t(rowPitch)) != 0;
+					}
+				}
+			}
+		}
+		overlapCount += end != totalSize;
+	}
+	std::printf("footprints: %zu failures, %zu overlaps, %zu copy mismatches\n", failureCount, overlapCount, copyMismatchCount);
+	TEST_CHECK(failureCount == 0);
+	TEST_CHECK(overlapCount == 0);
+	TEST_CHECK(copyMismatchCount == 0);
+}
+
+} // namespace
+
+// TextureFootprintをDirectXTexのComputePitch/ComputeScanlinesと比べる
+int main() {
+	TestPitchAgainstDirectXTex();
+	TestSubresourceFootprints();
+	return FinishTest();
+}
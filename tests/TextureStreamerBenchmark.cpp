@@ -0,0 +1,59 @@
+#include <cstdlib>
+#include <string>
+#include "FakeTextureSink.h"
+#include "TestCommon.h"
+#include "TextureStreamer.h"
+
+namespace {
+
+// 1枚のデコードにかかる時間(512x512のPNGをWICで読むくらい)
+constexpr std::chrono::milliseconds kDecodeTime(4);
+
+bool Decode(const std::string& path, DecodedTexture& texture) {
+	return FakeDecodeTexture(path, texture, 512, kDecodeTime);
+}
+
+} // namespace
+
+// 512x512のテクスチャをまとめて読み込み、最初のフレームと全部が使えるまでの時間を
+// すべて読んでから始める場合とストリーミングで比べる(1フレームは1ms)
+// 使い方: TextureStreamerBenchmark [テクスチャ数(既定は128)]
+int main(int argc, char** argv) {
+	const int textureCount = (argc > 1) ? std::atoi(argv[1]) : 128;
+
+	// すべてデコードしてから最初のフレームを出す
+	{
+		BenchmarkTimer timer;
+		for (int i = 0; i < textureCount; i++) {
+			DecodedTexture texture;
+			Decode("texture" + std::to_string(i), texture);
+		}
+		const double milliseconds = timer.GetElapsedMilliseconds();
+		std::printf("%d textures\nblocking         : first frame %7.1f ms, all loaded %7.1f ms\n", textureCount, milliseconds, milliseconds);
+	}
+
+	for (size_t workerCount : { size_t(1), size_t(3), size_t(7) }) {
+		FakeTextureSink sink;
+		BenchmarkTimer timer;
+		double firstFrameMilliseconds = -1.0;
+		int frameCount = 0;
+		TextureStreamer streamer(sink, Decode, workerCount, 4 << 20);
+		for (int i = 0; i < textureCount; i++) {
+			streamer.Request("texture" + std::to_string(i));
+		}
+		while (!streamer.IsIdle()) {
+			streamer.Update();
+			if (firstFrameMilliseconds < 0.0) {
+				firstFrameMilliseconds = timer.GetElapsedMilliseconds();
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			sink.Tick();
+			++frameCount;
+		}
+		const TextureStreamingStats& stats = streamer.GetStats();
+		std::printf("stream %zu workers: first frame %7.2f ms, all loaded %7.1f ms (first visible %.1f ms, first resident %.1f ms, %d frames, %.1f MB)\n",
+			workerCount, firstFrameMilliseconds, stats.allResidentSeconds * 1000.0, stats.firstVisibleSeconds * 1000.0,
+			stats.firstResidentSeconds * 1000.0, frameCount, stats.uploadedBytes / 1048576.0);
+	}
+	return 0;
+}
@@ -0,0 +1,131 @@
+#include <atomic>
+#include <string>
+#include <vector>
+#include "FakeTextureSink.h"
+#include "TestCommon.h"
+#include "TextureStreamer.h"
+
+namespace {
+
+/// <summary>
+/// パスで大きさを変えるデコード("nocreate"は32、"noupload"は96、それ以外は128)
+/// </summary>
+bool DecodeBySize(const std::string& path, DecodedTexture& texture) {
+	uint32_t size = 128;
+	if (path.find("nocreate") != std::string::npos) {
+		size = 32;
+	} else if (path.find("noupload") != std::string::npos) {
+		size = 96;
+	}
+	return FakeDecodeTexture(path, texture, size, std::chrono::microseconds(500));
+}
+
+/// <summary>
+/// 粗いmipから送られ、使えるmipは細かくなる一方で、失敗は失敗のまま残る
+/// </summary>
+void TestStreaming(size_t workerCount) {
+	FakeTextureSink sink;
+	sink.failCreateSize = 32;
+	sink.failUploadWidth = 48;
+	std::vector<TextureStreamer::TextureHandle> handles;
+	std::vector<std::string> paths;
+	for (int i = 0; i < 40; i++) {
+		const char* kinds[] = { "missing", "empty", "nocreate", "noupload" };
+		paths.push_back((i % 10 == 9) ? std::string(kinds[(i / 10) % 4]) + std::to_string(i) : "texture" + std::to_string(i));
+	}
+	{
+		// 1回のUpdateで少しずつ送り、途中の状態を何度も見る
+		TextureStreamer streamer(sink, DecodeBySize, workerCount, 16 << 10);
+		for (const std::string& path : paths) {
+			handles.push_back(streamer.Request(path));
+		}
+		std::vector<uint32_t> previousMips(handles.size(), TextureStreamer::kNoResidentMip);
+		size_t increasedCount = 0;
+		size_t inconsistentCount = 0;
+		int frameCount = 0;
+		while (!streamer.IsIdle() && frameCount < 100000) {
+			streamer.Update();
+			for (size_t i = 0; i < handles.size(); i++) {
+				const uint32_t mip = streamer.GetResidentMip(handles[i]);
+				const TextureResidency residency = streamer.GetResidency(handles[i]);
+				// 一度使えたmipより粗いものに戻らない
+				increasedCount += mip > previousMips[i] || (previousMips[i] != TextureStreamer::kNoResidentMip && mip == TextureStreamer::kNoResidentMip);
+				inconsistentCount += residency == TextureResidency::Resident && mip != 0;
+				inconsistentCount += residency == TextureResidency::Decoding && mip != TextureStreamer::kNoResidentMip;
+				inconsistentCount += mip != TextureStreamer::kNoResidentMip && mip >= streamer.GetMipLevels(handles[i]);
+				previousMips[i] = mip;
+			}
+			sink.Tick();
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			++frameCount;
+		}
+		TEST_CHECK(streamer.IsIdle());
+		TEST_CHECK(increasedCount == 0);
+		TEST_CHECK(inconsistentCount == 0);
+
+		// 失敗の種類ごと: デコードの失敗、mipがない、入れ物を作れない、コピーを積めない
+		for (size_t i = 0; i < handles.size(); i++) {
+			const bool isFailing = paths[i].find("texture") == std::string::npos;
+			const TextureResidency expected = isFailing ? TextureResidency::Failed : TextureResidency::Resident;
+			TEST_CHECK(streamer.GetResidency(handles[i]) == expected);
+			if (!isFailing) {
+				TEST_CHECK(streamer.GetMipLevels(handles[i]) == 8 && streamer.GetTexture(handles[i]) != nullptr);
+				TEST_CHECK(streamer.GetFormat(handles[i]) == DXGI_FORMAT_R8G8B8A8_UNORM);
+			}
+			TEST_CHECK(streamer.GetPath(handles[i]) == paths[i]);
+		}
+		const TextureStreamingStats& stats = streamer.GetStats();
+		TEST_CHECK(stats.requestedCount == 40 && stats.residentCount == 36 && stats.failedCount == 4);
+		TEST_CHECK(stats.firstVisibleSeconds > 0.0 && stats.firstVisibleSeconds <= stats.firstResidentSeconds);
+		TEST_CHECK(stats.firstResidentSeconds <= stats.allResidentSeconds);
+		std::printf("workers %zu: %d frames, %u submits, first visible %.1f ms, all %.1f ms\n", workerCount, frameCount,
+			sink.submitCount, stats.firstVisibleSeconds * 1000.0, stats.allResidentSeconds * 1000.0);
+	}
+
+	// 送った順は粗いものからで、作ったテクスチャは破棄で1回ずつ解放される(コピーに失敗したものも)
+	bool isCoarseFirst = true;
+	for (const auto& texture : sink.textures) {
+		isCoarseFirst = isCoarseFirst && texture->isCoarseFirst && texture->isDestroyed;
+	}
+	TEST_CHECK(isCoarseFirst);
+	TEST_CHECK(sink.textures.size() == 37);
+	TEST_CHECK(sink.destroyedCount == sink.textures.size());
+	TEST_CHECK(sink.doubleDestroyCount == 0 && sink.uploadAfterDestroyCount == 0);
+}
+
+/// <summary>
+/// デコードを待っている要求は破棄で取り消され、すぐに止まる
+/// </summary>
+void TestCancellation() {
+	FakeTextureSink sink;
+	std::atomic<int> decodeCount{ 0 };
+	const int requestCount = 200;
+	BenchmarkTimer timer;
+	{
+		TextureStreamer streamer(sink, [&](const std::string& path, DecodedTexture& texture) {
+			++decodeCount;
+			return FakeDecodeTexture(path, texture, 64, std::chrono::milliseconds(5));
+		}, 2, 1 << 20);
+		for (int i = 0; i < requestCount; i++) {
+			streamer.Request("texture" + std::to_string(i));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		streamer.Update();
+	}
+	const double milliseconds = timer.GetElapsedMilliseconds();
+	// すべてデコードすると200 x 5ms / 2スレッドで500msかかる
+	TEST_CHECK(decodeCount < requestCount / 4);
+	TEST_CHECK(milliseconds < 250.0);
+	TEST_CHECK(sink.destroyedCount == sink.textures.size() && sink.doubleDestroyCount == 0);
+	std::printf("cancel: %d of %d decoded, destroyed in %.1f ms\n", decodeCount.load(), requestCount, milliseconds);
+}
+
+} // namespace
+
+int main() {
+	for (size_t workerCount : { size_t(1), size_t(3) }) {
+		TestStreaming(workerCount);
+	}
+	TestCancellation();
+	return FinishTest();
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "HeapPool.h"
+#include "TestCommon.h"
+
+namespace {
+
+/// <summary>
+/// 大きさだけを持つヒープの供給元
+/// </summary>
+class FakeHeapSource : public HeapSource {
+public:
+	bool CreateHeap(uint64_t size, void*& heap) override {
+		heap = new uint64_t(size);
+		return true;
+	}
+
+	void DestroyHeap(void* heap) override {
+		delete static_cast<uint64_t*>(heap);
+	}
+};
+
+} // namespace
+
+// テクスチャのような大きさの確保と解放を混ぜてHeapPoolに投げ、速さと断片化を見る
+// 使い方: TlsfAllocatorBenchmark [操作の数(既定は100万)]
+int main(int argc, char** argv) {
+	const uint64_t opCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+	FakeHeapSource source;
+	HeapPool pool(source, 64ull << 20, 4096);
+	std::mt19937_64 random(9);
+	std::vector<HeapAllocation> live;
+	live.reserve(1 << 16);
+
+	uint64_t allocateCount = 0;
+	uint64_t freeCount = 0;
+	float maxFragmentation = 0.0f;
+	double fragmentationSum = 0.0;
+	uint64_t sampleCount = 0;
+	double statsMilliseconds = 0.0;
+	BenchmarkTimer timer;
+	for (uint64_t op = 0; op < opCount; op++) {
+		// 2000個前後を行き来する
+		const bool isAllocate = live.empty() || random() % 100 < (live.size() < 2000 ? 60u : 40u);
+		if (isAllocate) {
+			// 6割は64KB以下、3割は1MB以下、1割は8MB以下
+			const uint64_t kind = random() % 10;
+			const uint64_t size = kind < 6 ? random() % (64 << 10) + 1 : kind < 9 ? random() % (1 << 20) + 1 : random() % (8 << 20) + 1;
+			const uint64_t alignment = kind < 6 ? 4096 : 65536;
+			HeapAllocation allocation{};
+			if (!pool.Allocate(size, alignment, allocation)) {
+				std::printf("allocation failed at op %llu\n", (unsigned long long)op);
+				return 1;
+			}
+			live.push_back(allocation);
+			++allocateCount;
+		} else {
+			const size_t index = random() % live.size();
+			pool.Free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+			++freeCount;
+		}
+		// 統計を取る時間は計測から除く
+		if (op % 4096 == 0) {
+			BenchmarkTimer statsTimer;
+			const HeapPoolStats stats = pool.GetStats();
+			maxFragmentation = std::max(maxFragmentation, stats.fragmentation);
+			fragmentationSum += stats.fragmentation;
+			++sampleCount;
+			statsMilliseconds += statsTimer.GetElapsedMilliseconds();
+		}
+	}
+	const double milliseconds = timer.GetElapsedMilliseconds() - statsMilliseconds;
+
+	const HeapPoolStats stats = pool.GetStats();
+	std::printf("%llu allocations + %llu frees in %.1f ms: %.2f Mops/s (%.0f ns/op)\n",
+		(unsigned long long)allocateCount, (unsigned long long)freeCount, milliseconds,
+		double(opCount) / milliseconds / 1000.0, milliseconds * 1e6 / double(opCount));
+	std::printf("live %zu, heaps %u, reserved %.1f MB, allocated %.1f MB (%.1f%% used)\n",
+		live.size(), stats.heapCount, stats.reservedSize / 1048576.0, stats.allocatedSize / 1048576.0,
+		100.0 * double(stats.allocatedSize) / double(stats.reservedSize));
+	std::printf("free blocks %u, largest %.1f MB, fragmentation %.3f at end, %.3f mean, %.3f max\n",
+		stats.freeBlockCount, stats.largestFreeBlock / 1048576.0, stats.fragmentation,
+		fragmentationSum / double(sampleCount), maxFragmentation);
+
+	for (const HeapAllocation& allocation : live) {
+		pool.Free(allocation);
+	}
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+#include "HeapPool.h"
+#include "TestCommon.h"
+#include "TlsfAllocator.h"
+
+namespace {
+
+/// <summary>
+/// ヒープの代わりに大きさだけを持つヒープの供給元
+/// </summary>
+class FakeHeapSource : public HeapSource {
+public:
+	bool CreateHeap(uint64_t size, void*& heap) override {
+		if (isFailing) {
+			return false;
+		}
+		heap = new uint64_t(size);
+		++liveCount;
+		reservedSize += size;
+		return true;
+	}
+
+	void DestroyHeap(void* heap) override {
+		reservedSize -= *static_cast<uint64_t*>(heap);
+		delete static_cast<uint64_t*>(heap);
+		--liveCount;
+	}
+
+	int liveCount = 0;
+	uint64_t reservedSize = 0;
+	bool isFailing = false;
+};
+
+/// <summary>
+/// ランダムな確保と解放を、使用中の範囲の写しと比べる
+/// </summary>
+void TestFuzz(uint64_t seed) {
+	TlsfAllocator allocator(64ull << 20, 4096);
+	std::mt19937_64 random(seed);
+	// offset -> (size, block)
+	std::map<uint64_t, std::pair<uint64_t, uint32_t>> live;
+	uint64_t allocatedSize = 0;
+	size_t misalignedCount = 0;
+	size_t overlapCount = 0;
+	size_t failedCount = 0;
+	for (int op = 0; op < 200000; op++) {
+		if (live.empty() || random() % 100 < 55) {
+			const uint64_t size = (random() % 3 == 0) ? random() % (4 << 20) + 1 : random() % (256 << 10) + 1;
+			const uint64_t alignment = (random() % 4 == 0) ? (4ull << 20) : (random() % 2) ? 65536 : 4096;
+			TlsfAllocation allocation{};
+			if (!allocator.Allocate(size, alignment, allocation)) {
+				++failedCount;
+				continue;
+			}
+			misalignedCount += allocation.offset % alignment != 0;
+			TEST_CHECK(allocation.size >= size && allocation.size % 4096 == 0);
+			TEST_CHECK(allocation.offset + allocation.size <= allocator.GetCapacity());
+			auto next = live.lower_bound(allocation.offset);
+			if (next != live.end()) {
+				overlapCount += allocation.offset + allocation.size > next->first;
+			}
+			if (next != live.begin()) {
+				const auto previous = std::prev(next);
+				overlapCount += previous->first + previous->second.first > allocation.offset;
+			}
+			live[allocation.offset] = { allocation.size, allocation.block };
+			allocatedSize += allocation.size;
+		} else {
+			auto it = live.begin();
+			std::advance(it, random() % live.size());
+			allocator.Free(it->second.second);
+			allocatedSize -= it->second.first;
+			live.erase(it);
+		}
+		if (op % 10000 == 0) {
+			const TlsfStats stats = allocator.GetStats();
+			TEST_CHECK(stats.allocatedSize == allocatedSize);
+			TEST_CHECK(stats.allocationCount == live.size());
+			TEST_CHECK(stats.allocatedSize + stats.freeSize == stats.capacity);
+			TEST_CHECK(stats.largestFreeBlock <= stats.freeSize);
+		}
+	}
+	TEST_CHECK(misalignedCount == 0);
+	TEST_CHECK(overlapCount == 0);
+
+	// すべて戻すと1つの空きブロックにまとまる
+	for (const auto& [offset, entry] : live) {
+		allocator.Free(entry.second);
+	}
+	const TlsfStats stats = allocator.GetStats();
+	TEST_CHECK(allocator.IsEmpty());
+	TEST_CHECK(stats.freeBlockCount == 1);
+	TEST_CHECK(stats.freeSize == allocator.GetCapacity() && stats.largestFreeBlock == allocator.GetCapacity());
+	TEST_CHECK(stats.fragmentation == 0.0f);
+	// まとまった後は全体を1つで切り出せる
+	TlsfAllocation whole{};
+	TEST_CHECK(allocator.Allocate(allocator.GetCapacity(), 4096, whole) && whole.offset == 0);
+	std::printf("fuzz %llu: %zu allocations failed for lack of space\n", (unsigned long long)seed, failedCount);
+}
+
+/// <summary>
+/// ちょうど埋めた後に1つおきに戻すと、空きはあっても2つ分の大きさは入らない
+/// </summary>
+void TestCheckerboard() {
+	TlsfAllocator allocator(1 << 20, 256);
+	std::vector<uint32_t> blocks;
+	TlsfAllocation allocation{};
+	while (allocator.Allocate(256, 256, allocation)) {
+		blocks.push_back(allocation.block);
+	}
+	TEST_CHECK(blocks.size() == 4096);
+	for (size_t i = 0; i < blocks.size(); i += 2) {
+		allocator.Free(blocks[i]);
+	}
+	TlsfStats stats = allocator.GetStats();
+	TEST_CHECK(stats.freeBlockCount == 2048 && stats.largestFreeBlock == 256);
+	TEST_CHECK(!allocator.Allocate(512, 256, allocation));
+	// 残りを戻すと隣どうしがつながる
+	for (size_t i = 1; i < blocks.size(); i += 2) {
+		allocator.Free(blocks[i]);
+	}
+	stats = allocator.GetStats();
+	TEST_CHECK(stats.freeBlockCount == 1 && stats.fragmentation == 0.0f);
+}
+
+/// <summary>
+/// プールはヒープに入らない大きさに専用のヒープを作り、空いたヒープは1つを残して解放する
+/// </summary>
+void TestHeapPool() {
+	FakeHeapSource source;
+	{
+		HeapPool pool(source, 16ull << 20, 4096);
+		std::vector<HeapAllocation> allocations;
+		HeapAllocation allocation{};
+		for (int i = 0; i < 40; i++) {
+			TEST_CHECK(pool.Allocate(1 << 20, 65536, allocation));
+			TEST_CHECK(allocation.offset % 65536 == 0 && allocation.heap != nullptr);
+			allocations.push_back(allocation);
+		}
+		TEST_CHECK(source.liveCount == 3);
+		TEST_CHECK(pool.Allocate(40ull << 20, 65536, allocation));
+		allocations.push_back(allocation);
+		TEST_CHECK(source.liveCount == 4);
+		TEST_CHECK(pool.GetStats().allocationCount == allocations.size());
+
+		source.isFailing = true;
+		TEST_CHECK(!pool.Allocate(64ull << 20, 65536, allocation));
+		source.isFailing = false;
+
+		for (const HeapAllocation& used : allocations) {
+			pool.Free(used);
+		}
+		const HeapPoolStats stats = pool.GetStats();
+		TEST_CHECK(source.liveCount == 1);
+		TEST_CHECK(stats.allocationCount == 0 && stats.allocatedSize == 0);
+		TEST_CHECK(stats.reservedSize == source.reservedSize);
+	}
+	TEST_CHECK(source.liveCount == 0);
+}
+
+} // namespace
+
+int main() {
+	for (uint64_t seed : { 5ull, 13ull, 2024ull }) {
+		TestFuzz(seed);
+	}
+	TestCheckerboard();
+	TestHeapPool();
+	return FinishTest();
+}
@@ -0,0 +1,76 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "MatrixMath.h"
+#include "TestCommon.h"
+#include "TransformBatch.h"
+
+namespace {
+
+/// <summary>
+/// 要素ごとの最大の差
+/// </summary>
+float MaxDifference(const Matrix4x4& a, const Matrix4x4& b) {
+	float difference = 0.0f;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			difference = std::fmax(difference, std::fabs(a.m[row][column] - b.m[row][column]));
+		}
+	}
+	return difference;
+}
+
+} // namespace
+
+// ComputeTransformationMatricesを命令セットごとに1つずつの計算と比べる
+int main() {
+	std::mt19937 random(2);
+	std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+	// チャンク(64個)とSIMDの幅で割り切れない数にして端数も通す
+	const size_t count = 10007;
+	std::vector<Transform> transforms(count);
+	for (Transform& transform : transforms) {
+		transform = { { value(random), value(random), value(random) }, { value(random), value(random), value(random) },
+			{ value(random), value(random), value(random) } };
+	}
+	const Matrix4x4 view = InverseAffine(MakeAffineMatrix(Vector3{ 1.0f, 1.0f, 1.0f }, Vector3{ 0.1f, 0.2f, 0.0f }, Vector3{ 0.0f, 0.0f, -5.0f }));
+	const Matrix4x4 viewProjection = Multiply(view, MakePerspectiveFovMatirx(0.45f, 16.0f / 9.0f, 0.1f, 100.0f));
+
+	SetMatrixMathLevel(SimdLevel::Scalar);
+	std::vector<TransformationMatrix> scalarOutputs(count);
+	ComputeTransformationMatrices(transforms.data(), count, viewProjection, scalarOutputs.data());
+
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		SetMatrixMathLevel(level);
+		// 書き込まれない要素がわかるようにNaNで埋めておく
+		std::vector<TransformationMatrix> outputs(count + 1);
+		for (TransformationMatrix& output : outputs) {
+			for (auto& row : output.WVP.m) {
+				for (float& element : row) {
+					element = NAN;
+				}
+			}
+		}
+		ComputeTransformationMatrices(transforms.data(), count, viewProjection, outputs.data());
+
+		float worldError = 0.0f;
+		float wvpError = 0.0f;
+		float levelError = 0.0f;
+		for (size_t i = 0; i < count; i++) {
+			const Matrix4x4 world = MakeAffineMatrix(transforms[i].scale, transforms[i].rotate, transforms[i].translate);
+			worldError = std::fmax(worldError, MaxDifference(outputs[i].world, world));
+			const float difference = MaxDifference(outputs[i].WVP, Multiply(world, viewProjection));
+			// NaNが残っていたら失敗にする
+			wvpError = (difference == difference) ? std::fmax(wvpError, difference) : INFINITY;
+			levelError = std::fmax(levelError, MaxDifference(outputs[i].WVP, scalarOutputs[i].WVP));
+		}
+		std::printf("%-6s world %.2g WVP %.2g vs scalar batch %.2g\n", GetSimdLevelName(GetMatrixMathLevel()), worldError, wvpError, levelError);
+		TEST_CHECK(worldError < 1e-5f);
+		TEST_CHECK(wvpError < 1e-4f);
+		TEST_CHECK(levelError < 1e-4f);
+		// 範囲の外には書かない
+		TEST_CHECK(std::isnan(outputs[count].WVP.m[0][0]));
+	}
+	SetMatrixMathLevel(GetSimdLevel());
+	return FinishTest();
+}
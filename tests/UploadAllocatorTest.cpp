@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+#include "TestCommon.h"
+#include "UploadAllocator.h"
+
+namespace {
+
+/// <summary>
+/// mallocでページを作るページの供給元(GPUアドレスはD3D12と同じく64KB境界から振る)
+/// </summary>
+class MallocPageSource : public UploadPageSource {
+public:
+	static constexpr size_t kPageAlignment = 65536;
+
+	bool CreatePage(size_t size, UploadPage& page) override {
+		if (isFailing) {
+			return false;
+		}
+		const size_t alignedSize = (size + kPageAlignment - 1) & ~(kPageAlignment - 1);
+		void* memory = std::aligned_alloc(kPageAlignment, alignedSize);
+		if (!memory) {
+			return false;
+		}
+		page = { static_cast<uint8_t*>(memory), nextGpuAddress_, size, memory };
+		nextGpuAddress_ += alignedSize;
+		pages.push_back(page);
+		++liveCount;
+		++createdCount;
+		return true;
+	}
+
+	void DestroyPage(const UploadPage& page) override {
+		pages.erase(std::find_if(pages.begin(), pages.end(), [&](const UploadPage& p) { return p.handle == page.handle; }));
+		std::free(page.handle);
+		--liveCount;
+	}
+
+	// 領域がどれかのページに収まり、CPUとGPUのアドレスがページ内の同じ位置を指すか
+	bool IsInsidePage(const UploadAllocation& allocation) const {
+		const uint8_t* cpuAddress = static_cast<const uint8_t*>(allocation.cpuAddress);
+		for (const UploadPage& page : pages) {
+			if (cpuAddress >= page.cpuAddress && cpuAddress + allocation.size <= page.cpuAddress + page.size) {
+				return allocation.gpuAddress - page.gpuAddress == uint64_t(cpuAddress - page.cpuAddress);
+			}
+		}
+		return false;
+	}
+
+	std::vector<UploadPage> pages;
+	int liveCount = 0;
+	int createdCount = 0;
+	bool isFailing = false;
+
+private:
+	uint64_t nextGpuAddress_ = kPageAlignment;
+};
+
+// 256バイトを超える定数
+struct LargeConstant {
+	float values[80];
+};
+
+/// <summary>
+/// 定数は256バイト境界に、256バイトの倍数の大きさで置かれる
+/// </summary>
+void TestConstants(MallocPageSource& source, LinearUploadAllocator& allocator) {
+	UploadAllocation allocation{};
+	bool isAligned = true;
+	for (int i = 0; i < 16; i++) {
+		TEST_CHECK(allocator.AllocateConstant(i, allocation));
+		isAligned = isAligned && allocation.gpuAddress % LinearUploadAllocator::kConstantBufferAlignment == 0 && allocation.size == 256;
+		TEST_CHECK(*static_cast<const int*>(allocation.cpuAddress) == i);
+		TEST_CHECK(source.IsInsidePage(allocation));
+	}
+	TEST_CHECK(isAligned);
+	TEST_CHECK(allocator.GetPageCount() == 1 && allocator.GetUsedSize() == 4096);
+	// ページが埋まったので次のページに移る
+	TEST_CHECK(allocator.AllocateConstant(LargeConstant{}, allocation));
+	TEST_CHECK(allocation.size == 512 && allocation.gpuAddress % 256 == 0);
+	TEST_CHECK(allocator.GetPageCount() == 2);
+}
+
+/// <summary>
+/// ランダムな大きさと境界で切り出した領域が境界を守り、重ならない
+/// </summary>
+void TestRandomAllocations(MallocPageSource& source, LinearUploadAllocator& allocator) {
+	allocator.Reset();
+	std::mt19937 random(12);
+	std::vector<std::pair<uint64_t, size_t>> ranges;
+	UploadAllocation allocation{};
+	bool isAligned = true;
+	bool isInside = true;
+	for (int i = 0; i < 2000; i++) {
+		const size_t size = random() % 600 + 1;
+		const size_t alignment = size_t(1) << (random() % 9);
+		TEST_CHECK(allocator.Allocate(size, alignment, allocation));
+		isAligned = isAligned && allocation.gpuAddress % alignment == 0 && allocation.size == size;
+		isInside = isInside && source.IsInsidePage(allocation);
+		ranges.push_back({ allocation.gpuAddress, size });
+	}
+	TEST_CHECK(isAligned);
+	TEST_CHECK(isInside);
+	std::sort(ranges.begin(), ranges.end());
+	bool isDisjoint = true;
+	for (size_t i = 1; i < ranges.size(); i++) {
+		isDisjoint = isDisjoint && ranges[i - 1].first + ranges[i - 1].second <= ranges[i].first;
+	}
+	TEST_CHECK(isDisjoint);
+	TEST_CHECK(allocator.GetPeakUsedSize() >= allocator.GetUsedSize());
+}
+
+/// <summary>
+/// ページより大きい領域は専用のページになり、Resetで解放される(普通のページは使い回す)
+/// </summary>
+void TestDedicatedPages(MallocPageSource& source, LinearUploadAllocator& allocator) {
+	allocator.Reset();
+	const size_t pageCount = allocator.GetPageCount();
+	const int liveCount = source.liveCount;
+	UploadAllocation allocation{};
+	for (size_t size : { size_t(10000), size_t(4097), size_t(70000) }) {
+		TEST_CHECK(allocator.Allocate(size, 256, allocation));
+		TEST_CHECK(allocation.size == size && allocation.gpuAddress % 256 == 0);
+		TEST_CHECK(source.IsInsidePage(allocation));
+	}
+	TEST_CHECK(source.liveCount == liveCount + 3);
+	TEST_CHECK(allocator.GetPageCount() == pageCount);
+	// 専用のページの後も普通のページから続けて切り出せる
+	TEST_CHECK(allocator.AllocateConstant(1, allocation));
+	allocator.Reset();
+	TEST_CHECK(source.liveCount == liveCount);
+
+	// Resetの後は既存のページだけで足りる
+	const int createdCount = source.createdCount;
+	for (size_t i = 0; i < pageCount * 16; i++) {
+		TEST_CHECK(allocator.AllocateConstant(int(i), allocation));
+	}
+	TEST_CHECK(source.createdCount == createdCount);
+	TEST_CHECK(allocator.GetPageCount() == pageCount);
+
+	// ページちょうどの大きさと、ページより大きい境界
+	allocator.Reset();
+	TEST_CHECK(allocator.Allocate(4096, 256, allocation) && allocator.Allocate(1, 1, allocation));
+	allocator.Reset();
+	TEST_CHECK(allocator.Allocate(16, 8192, allocation));
+	TEST_CHECK(allocation.gpuAddress % 8192 == 0);
+	allocator.Reset();
+}
+
+/// <summary>
+/// ページを作れなければfalseを返す
+/// </summary>
+void TestFailure(MallocPageSource& source, LinearUploadAllocator& allocator) {
+	allocator.Reset();
+	UploadAllocation allocation{};
+	for (size_t i = 0; i < allocator.GetPageCount() * 16; i++) {
+		allocator.AllocateConstant(1, allocation);
+	}
+	source.isFailing = true;
+	TEST_CHECK(!allocator.AllocateConstant(1, allocation));
+	TEST_CHECK(!allocator.Allocate(100000, 256, allocation));
+	source.isFailing = false;
+	TEST_CHECK(allocator.AllocateConstant(1, allocation));
+}
+
+} // namespace
+
+int main() {
+	MallocPageSource source;
+	{
+		LinearUploadAllocator allocator(source, 4096);
+		TestConstants(source, allocator);
+		TestRandomAllocations(source, allocator);
+		TestDedicatedPages(source, allocator);
+		TestFailure(source, allocator);
+		std::printf("pages %zu, peak %zu bytes\n", allocator.GetPageCount(), allocator.GetPeakUsedSize());
+	}
+	// 破棄ですべてのページを返す
+	TEST_CHECK(source.liveCount == 0);
+	return FinishTest();
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+#include "MeshGenerator.h"
+#include "TestCommon.h"
+#include "VertexCache.h"
+
+namespace {
+
+/// <summary>
+/// 三角形の頂点座標の組(回転しても同じになるように最小の頂点から並べる)
+/// </summary>
+std::array<float, 9> GetTriangleKey(const MeshData& mesh, size_t triangle) {
+	const uint32_t* corners = &mesh.indices[triangle * 3];
+	int first = 0;
+	for (int k = 1; k < 3; k++) {
+		const Vector4& a = mesh.vertices[corners[k]].position;
+		const Vector4& b = mesh.vertices[corners[first]].position;
+		if (std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z)) {
+			first = k;
+		}
+	}
+	std::array<float, 9> key{};
+	for (int k = 0; k < 3; k++) {
+		const Vector4& position = mesh.vertices[corners[(first + k) % 3]].position;
+		key[k * 3 + 0] = position.x;
+		key[k * 3 + 1] = position.y;
+		key[k * 3 + 2] = position.z;
+	}
+	return key;
+}
+
+/// <summary>
+/// 三角形の集合(向きを含む)
+/// </summary>
+std::vector<std::array<float, 9>> GetTriangleSet(const MeshData& mesh) {
+	std::vector<std::array<float, 9>> triangles(mesh.indices.size() / 3);
+	for (size_t i = 0; i < triangles.size(); i++) {
+		triangles[i] = GetTriangleKey(mesh, i);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+/// <summary>
+/// 外向きでない三角形の数(原点中心の球なので、法線と重心の内積が正になるはず)
+/// </summary>
+size_t CountInwardTriangles(const MeshData& mesh) {
+	size_t count = 0;
+	for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+		const Vector4& p0 = mesh.vertices[mesh.indices[i + 0]].position;
+		const Vector4& p1 = mesh.vertices[mesh.indices[i + 1]].position;
+		const Vector4& p2 = mesh.vertices[mesh.indices[i + 2]].position;
+		const float ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+		const float vx = p2.x - p0.x, vy = p2.y - p0.y, vz = p2.z - p0.z;
+		// 左手座標系で時計回りが表
+		const float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+		if (nx * (p0.x + p1.x + p2.x) + ny * (p0.y + p1.y + p2.y) + nz * (p0.z + p1.z + p2.z) <= 0.0f) {
+			count++;
+		}
+	}
+	return count;
+}
+
+} // namespace
+
+// 球のメッシュと頂点キャッシュ最適化が三角形を変えずにACMRを下げることを確かめる
+int main() {
+	for (uint32_t subdivision : { 2u, 3u, 16u, 64u, 256u }) {
+		MeshData mesh = GenerateSphereMesh(subdivision);
+		// 極は経度ごとに1頂点、それ以外は経度の継ぎ目に1列多く持つ
+		TEST_CHECK(mesh.vertices.size() == size_t(subdivision - 1) * (subdivision + 1) + 2 * subdivision);
+		TEST_CHECK(mesh.indices.size() == size_t(subdivision) * (subdivision - 1) * 6);
+		const bool isInRange = std::all_of(mesh.indices.begin(), mesh.indices.end(),
+			[&](uint32_t index) { return index < mesh.vertices.size(); });
+		TEST_CHECK(isInRange);
+		const size_t inwardBefore = CountInwardTriangles(mesh);
+
+		const auto trianglesBefore = GetTriangleSet(mesh);
+		const float acmrBefore = ComputeACMR(mesh.indices, mesh.vertices.size(), 16);
+		BenchmarkTimer timer;
+		OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+		const double milliseconds = timer.GetElapsedMilliseconds();
+		const float acmrAfter = ComputeACMR(mesh.indices, mesh.vertices.size(), 16);
+		TEST_CHECK(GetTriangleSet(mesh) == trianglesBefore);
+		TEST_CHECK(acmrAfter <= acmrBefore);
+
+		// 頂点の並べ替え後も同じ三角形で、初めて使う順に番号が振られている
+		const size_t vertexCount = mesh.vertices.size();
+		OptimizeVertexFetch(mesh);
+		TEST_CHECK(mesh.vertices.size() <= vertexCount);
+		TEST_CHECK(GetTriangleSet(mesh) == trianglesBefore);
+		uint32_t nextIndex = 0;
+		bool isFirstUseOrder = true;
+		for (uint32_t index : mesh.indices) {
+			if (index == nextIndex) {
+				nextIndex++;
+			} else if (index > nextIndex) {
+				isFirstUseOrder = false;
+			}
+		}
+		TEST_CHECK(isFirstUseOrder);
+		TEST_CHECK(CountInwardTriangles(mesh) == inwardBefore);
+
+		if (CanUseIndex16(mesh)) {
+			const std::vector<uint16_t> indices16 = MakeIndices16(mesh.indices);
+			TEST_CHECK(std::equal(indices16.begin(), indices16.end(), mesh.indices.begin(), mesh.indices.end()));
+		}
+		std::printf("subdivision %4u: %7zu vertices %7zu triangles, ACMR %.3f -> %.3f (%.1f ms), inward %zu\n",
+			subdivision, mesh.vertices.size(), mesh.indices.size() / 3, acmrBefore, acmrAfter, milliseconds, inwardBefore);
+		// 分割数2では赤道が2点しかなく、どの三角形も原点を通る平面に乗るので向きを調べない
+		if (subdivision >= 3) {
+			TEST_CHECK(inwardBefore == 0);
+		}
+		if (subdivision >= 16) {
+			TEST_CHECK(acmrAfter < 0.75f);
+		}
+	}
+	return FinishTest();
+}
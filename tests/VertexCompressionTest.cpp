@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include "MatrixMath.h"
+#include "MeshGenerator.h"
+#include "TestCommon.h"
+#include "VertexCompression.h"
+
+namespace {
+
+/// <summary>
+/// 半精度の変換をコンパイラの_Float16と比べる(使えないコンパイラでは調べない)
+/// </summary>
+void TestHalf() {
+#if defined(__FLT16_MAX__)
+	// すべての半精度の値
+	size_t mismatchCount = 0;
+	for (uint32_t bits = 0; bits < 65536; bits++) {
+		const uint16_t half = uint16_t(bits);
+		_Float16 reference;
+		std::memcpy(&reference, &half, sizeof(half));
+		const float value = HalfToFloat(half);
+		const float expected = float(reference);
+		if (std::isnan(value) || std::isnan(expected)) {
+			mismatchCount += std::isnan(value) != std::isnan(expected);
+			continue;
+		}
+		mismatchCount += std::memcmp(&value, &expected, sizeof(value)) != 0;
+		mismatchCount += FloatToHalf(value) != half;
+	}
+	TEST_CHECK(mismatchCount == 0);
+
+	// ランダムなビット列のfloat(丸め、オーバーフロー、非正規化数を含む)
+	std::mt19937 random(6);
+	size_t roundingMismatchCount = 0;
+	for (int i = 0; i < 20000000; i++) {
+		const uint32_t bits = uint32_t(random());
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		if (std::isnan(value)) {
+			continue;
+		}
+		const _Float16 reference = _Float16(value);
+		uint16_t expected;
+		std::memcpy(&expected, &reference, sizeof(expected));
+		roundingMismatchCount += FloatToHalf(value) != expected;
+	}
+	TEST_CHECK(roundingMismatchCount == 0);
+	std::printf("half: %zu / %zu mismatches\n", mismatchCount, roundingMismatchCount);
+#else
+	std::printf("half: skipped (no _Float16)\n");
+#endif
+}
+
+/// <summary>
+/// 八面体写像の法線の角度誤差
+/// </summary>
+void TestOctahedralNormal() {
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> angleDistribution(0.0f, 6.2831853f);
+	std::uniform_real_distribution<float> zDistribution(-1.0f, 1.0f);
+	double maxAngle = 0.0;
+	for (int i = 0; i < 1000000; i++) {
+		const float angle = angleDistribution(random);
+		const float z = zDistribution(random);
+		const float radius = std::sqrt(1.0f - z * z);
+		const Vector3 normal{ radius * std::cos(angle), radius * std::sin(angle), z };
+		int16_t x, y;
+		EncodeOctahedralNormal(normal, x, y);
+		const Vector3 decoded = DecodeOctahedralNormal(x, y);
+		const double dot = double(normal.x) * decoded.x + double(normal.y) * decoded.y + double(normal.z) * decoded.z;
+		maxAngle = std::max(maxAngle, std::acos(std::min(1.0, dot)));
+	}
+	// 軸の上の法線(八面体の頂点と折り返しの境目)
+	for (const Vector3& normal : { Vector3{ 1, 0, 0 }, Vector3{ -1, 0, 0 }, Vector3{ 0, 1, 0 }, Vector3{ 0, -1, 0 },
+		Vector3{ 0, 0, 1 }, Vector3{ 0, 0, -1 } }) {
+		int16_t x, y;
+		EncodeOctahedralNormal(normal, x, y);
+		const Vector3 decoded = DecodeOctahedralNormal(x, y);
+		TEST_CHECK(std::fabs(decoded.x - normal.x) + std::fabs(decoded.y - normal.y) + std::fabs(decoded.z - normal.z) < 1e-4f);
+	}
+	const double maxDegrees = maxAngle * 180.0 / 3.14159265358979;
+	std::printf("octahedral normal: max %.4f degrees\n", maxDegrees);
+	TEST_CHECK(maxDegrees < 0.05);
+}
+
+/// <summary>
+/// 球の頂点を圧縮し、展開の関数とシェーダーと同じ行列の経路で元に戻す
+/// </summary>
+void TestPackedSphere() {
+	const MeshData mesh = GenerateSphereMesh(64);
+	const VertexQuantization quantization = ComputeVertexQuantization(mesh.vertices.data(), mesh.vertices.size());
+	const std::vector<PackedVertexData> packed = PackVertices(mesh.vertices, quantization);
+	TEST_CHECK(packed.size() == mesh.vertices.size());
+	const Matrix4x4 dequantize = MakeDequantizeMatrix(quantization);
+
+	float positionError = 0.0f;
+	float texcoordError = 0.0f;
+	bool isWOne = true;
+	for (size_t i = 0; i < packed.size(); i++) {
+		const VertexData& original = mesh.vertices[i];
+		const VertexData unpacked = UnpackVertex(packed[i], quantization);
+		positionError = std::max(positionError, std::fabs(unpacked.position.x - original.position.x));
+		positionError = std::max(positionError, std::fabs(unpacked.position.y - original.position.y));
+		positionError = std::max(positionError, std::fabs(unpacked.position.z - original.position.z));
+		texcoordError = std::max(texcoordError, std::fabs(unpacked.texcoord.x - original.texcoord.x));
+		texcoordError = std::max(texcoordError, std::fabs(unpacked.texcoord.y - original.texcoord.y));
+
+		// wは32767(=1.0)で、行列の平行移動がそのまま足される
+		isWOne = isWOne && packed[i].position[3] == 32767;
+		const Vector4 snorm{ packed[i].position[0] / 32767.0f, packed[i].position[1] / 32767.0f,
+			packed[i].position[2] / 32767.0f, packed[i].position[3] / 32767.0f };
+		const Vector4 position = Multiply(snorm, dequantize);
+		positionError = std::max(positionError, std::fabs(position.x - original.position.x));
+		positionError = std::max(positionError, std::fabs(position.y - original.position.y));
+		positionError = std::max(positionError, std::fabs(position.z - original.position.z));
+		positionError = std::max(positionError, std::fabs(position.w - 1.0f));
+	}
+	std::printf("sphere: %zu -> %zu bytes per vertex, position %.2g, texcoord %.2g\n",
+		sizeof(VertexData), sizeof(PackedVertexData), positionError, texcoordError);
+	TEST_CHECK(sizeof(PackedVertexData) == 16);
+	TEST_CHECK(isWOne);
+	TEST_CHECK(positionError < 4e-5f);
+	TEST_CHECK(texcoordError < 5e-4f);
+}
+
+} // namespace
+
+int main() {
+	TestHalf();
+	TestOctahedralNormal();
+	TestPackedSphere();
+	return FinishTest();
+}
@@ -0,0 +1,159 @@
+// テクスチャの焼き込みツール
+// 元画像からmipを作ってBC圧縮し、<元のディレクトリ>/cooked/にDDSを書き出す。ゲームは読み込み時にこれを優先して使う
+//
+// 使い方: TextureCooker [--format auto|bc1|bc3|bc7|none] [--linear] [--quality fast|normal|slow] [--force] [--threads N] files...
+// 圧縮の速さ(blocks/s)も出すので、--force --threads 1,2,4...で比べればスレッド数による伸びが分かる
+// --qualityは圧縮の速さと品質(既定はnormal)。品質ごとに別の名前で出力し、ゲームは品質の高いものを使う
+// ゲームはsRGBで焼いたものだけを使う(--linearの出力はsRGBのテクスチャの代わりには読まれない)
+//
+// 効果を測るときは、焼く前と後にゲームを起動してログの"textures: ... all ...ms, ... MB"(読み込みの時間と送ったバイト数)を比べる
+//   TextureCooker resources/uvChecker.png resources/monsterBall.png
+//
+// CG2.vcxprojには入れない(mainを持つため)。tools/CMakeLists.txtでビルドする
+//   cmake -S tools -B build-tools -DCMAKE_PREFIX_PATH=<DirectX-HeadersとDirectXMathの場所> && cmake --build build-tools -j
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "TextureCooker.h"
+#include "externals/DirectXTex/DirectXTex.h"
+
+namespace {
+
+/// <summary>
+/// 圧縮の名前を読む
+/// </summary>
+bool ParseCompression(const char* name, TextureCompression& compression) {
+	const struct {
+		const char* name;
+		TextureCompression compression;
+	} kCompressions[] = {
+		{ "auto", TextureCompression::Auto },
+		{ "bc1", TextureCompression::BC1 },
+		{ "bc3", TextureCompression::BC3 },
+		{ "bc7", TextureCompression::BC7 },
+		{ "none", TextureCompression::None },
+	};
+	for (const auto& entry : kCompressions) {
+		if (std::strcmp(name, entry.name) == 0) {
+			compression = entry.compression;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// 品質の名前を読む
+/// </summary>
+bool ParseQuality(const char* name, TextureCookQuality& quality) {
+	const struct {
+		const char* name;
+		TextureCookQuality quality;
+	} kQualities[] = {
+		{ "fast", TextureCookQuality::Fast },
+		{ "normal", TextureCookQuality::Normal },
+		{ "slow", TextureCookQuality::Slow },
+	};
+	for (const auto& entry : kQualities) {
+		if (std::strcmp(name, entry.name) == 0) {
+			quality = entry.quality;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// 使い方を出す
+/// </summary>
+int PrintUsage() {
+	std::fprintf(stderr, "usage: TextureCooker [--format auto|bc1|bc3|bc7|none] [--linear] [--quality fast|normal|slow] [--force] [--threads N] files...\n");
+	return 2;
+}
+
+}
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+	// WICで元画像を読むため
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+#endif
+
+	TextureCookSettings settings{};
+	bool isForced = false;
+	std::vector<std::string> sourcePaths;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--format") == 0) {
+			if (i + 1 >= argc || !ParseCompression(argv[i + 1], settings.compression)) {
+				return PrintUsage();
+			}
+			++i;
+		} else if (std::strcmp(argv[i], "--linear") == 0) {
+			settings.isSrgb = false;
+		} else if (std::strcmp(argv[i], "--quality") == 0) {
+			if (i + 1 >= argc || !ParseQuality(argv[i + 1], settings.quality)) {
+				return PrintUsage();
+			}
+			++i;
+		} else if (std::strcmp(argv[i], "--force") == 0) {
+			isForced = true;
+		} else if (std::strcmp(argv[i], "--threads") == 0) {
+			if (i + 1 >= argc) {
+				return PrintUsage();
+			}
+			// 0ならすべてのハードウェアスレッドを使う
+			DirectX::SetParallelThreadLimit(size_t(std::strtoul(argv[i + 1], nullptr, 10)));
+			++i;
+		} else if (argv[i][0] == '-') {
+			return PrintUsage();
+		} else {
+			sourcePaths.push_back(argv[i]);
+		}
+	}
+	if (sourcePaths.empty()) {
+		return PrintUsage();
+	}
+
+	uint64_t totalUncompressedBytes = 0;
+	uint64_t totalCookedBytes = 0;
+	uint64_t totalBlocks = 0;
+	double totalCompressSeconds = 0.0;
+	int failedCount = 0;
+	const auto startTime = std::chrono::steady_clock::now();
+	for (const std::string& sourcePath : sourcePaths) {
+		const auto cookStartTime = std::chrono::steady_clock::now();
+		TextureCookResult result{};
+		if (!CookTexture(sourcePath, settings, isForced, result)) {
+			std::fprintf(stderr, "%s: failed\n", sourcePath.c_str());
+			++failedCount;
+			continue;
+		}
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cookStartTime).count();
+		std::printf("%s -> %s (%s, format %d, %ux%u, %u mips, %.2f MB -> %.2f MB, %.1fms)\n", sourcePath.c_str(), result.outputPath.c_str(),
+			result.isCached ? "cached" : "cooked", int(result.format), result.width, result.height, result.mipLevels,
+			double(result.uncompressedBytes) / (1024.0 * 1024.0), double(result.cookedBytes) / (1024.0 * 1024.0), milliseconds);
+		totalUncompressedBytes += result.uncompressedBytes;
+		totalCookedBytes += result.cookedBytes;
+		if (result.compressSeconds > 0.0) {
+			// BCは1ブロック4x4画素で、BC1は8byte、それ以外は16byte
+			const bool isBC1 = result.format == DXGI_FORMAT_BC1_UNORM || result.format == DXGI_FORMAT_BC1_UNORM_SRGB;
+			totalBlocks += result.cookedBytes / (isBC1 ? 8 : 16);
+			totalCompressSeconds += result.compressSeconds;
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::printf("%zu files, %d failed, %.2f MB -> %.2f MB (%.1fx), %.2fs\n", sourcePaths.size(), failedCount,
+		double(totalUncompressedBytes) / (1024.0 * 1024.0), double(totalCookedBytes) / (1024.0 * 1024.0),
+		totalCookedBytes ? double(totalUncompressedBytes) / double(totalCookedBytes) : 0.0, seconds);
+	if (totalCompressSeconds > 0.0) {
+		std::printf("compress: %llu blocks in %.2fs, %.0f blocks/s\n", static_cast<unsigned long long>(totalBlocks), totalCompressSeconds,
+			double(totalBlocks) / totalCompressSeconds);
+	}
+	return failedCount ? 1 : 0;
+}